@@ -463,6 +463,7 @@ public:
     enum EntryType { Directory, File, Symlink };
 
     void addEntry(EntryType type, const QString &fileName, const QByteArray &contents);
+    void addEntry(EntryType type, const QString &fileName, QIODevice *source);
 };
 
 LocalFileHeader CentralFileHeader::toLocalHeader() const
@@ -665,6 +666,125 @@ void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const Q
     dirtyFileTree = true;
 }
 
+// as above, but the contents are read from source a chunk at a time and
+// deflated as they are written, so large files are never held in memory.
+// The local header is written first and patched with the crc and sizes
+// once the contents are known (the device must be seekable).
+void ZipWriterPrivate::addEntry(EntryType type, const QString &fileName, QIODevice *source)
+{
+    if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
+        status = ZipWriter::FileOpenError;
+        return;
+    }
+    device->seek(start_of_directory);
+
+    // don't compress small files
+    ZipWriter::CompressionPolicy compression = compressionPolicy;
+    if (compressionPolicy == ZipWriter::AutoCompress) {
+        if (source->size() < 64)
+            compression = ZipWriter::NeverCompress;
+        else
+            compression = ZipWriter::AlwaysCompress;
+    }
+
+    FileHeader header;
+    memset(&header.h, 0, sizeof(CentralFileHeader));
+    writeUInt(header.h.signature, 0x02014b50);
+
+    writeUShort(header.h.version_needed, 0x14);
+    writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
+    if (compression == ZipWriter::AlwaysCompress)
+        writeUShort(header.h.compression_method, 8);
+
+    header.file_name = fileName.toLocal8Bit();
+    if (header.file_name.size() > 0xffff) {
+        qWarning("QZip: Filename too long, chopping it to 65535 characters");
+        header.file_name = header.file_name.left(0xffff);
+    }
+    writeUShort(header.h.file_name_length, header.file_name.length());
+    writeUShort(header.h.version_made, 3 << 8);
+    quint32 mode = permissionsToMode(permissions);
+    switch (type) {
+        case File: mode |= S_IFREG; break;
+        case Directory: mode |= S_IFDIR; break;
+        case Symlink: mode |= S_IFLNK; break;
+    }
+    writeUInt(header.h.external_file_attributes, mode << 16);
+    writeUInt(header.h.offset_local_header, start_of_directory);
+
+    // placeholder local header
+    LocalFileHeader h = header.h.toLocalHeader();
+    device->write((const char *)&h, sizeof(LocalFileHeader));
+    device->write(header.file_name);
+
+    z_stream stream;
+    bool deflating = (compression == ZipWriter::AlwaysCompress);
+    if (deflating) {
+        memset(&stream, 0, sizeof(z_stream));
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            qWarning("QZip: Z_MEM_ERROR: Not enough memory to compress file, skipping");
+            status = ZipWriter::FileError;
+            device->seek(start_of_directory);
+            return;
+        }
+    }
+
+    // stream the contents
+    const int chunk = 64 * 1024;
+    QByteArray in(chunk, 0), out(chunk, 0);
+    uint crc_32 = ::crc32(0, 0, 0);
+    uint uncompressed = 0, compressed = 0;
+    bool eof = false;
+    while (!eof) {
+
+        qint64 n = source->read(in.data(), chunk);
+        if (n < 0) {
+            // a truncated entry would look fine, so leave it out altogether
+            qWarning("QZip: error reading %s, skipping", header.file_name.constData());
+            if (deflating) deflateEnd(&stream);
+            status = ZipWriter::FileError;
+            device->seek(start_of_directory);
+            return;
+        }
+        if (n == 0) eof = true;
+
+        crc_32 = ::crc32(crc_32, (const uchar *)in.constData(), n);
+        uncompressed += n;
+
+        if (deflating) {
+            stream.next_in = (Bytef*)in.data();
+            stream.avail_in = (uInt)n;
+            do {
+                stream.next_out = (Bytef*)out.data();
+                stream.avail_out = chunk;
+                deflate(&stream, eof ? Z_FINISH : Z_NO_FLUSH);
+                int have = chunk - stream.avail_out;
+                device->write(out.constData(), have);
+                compressed += have;
+            } while (stream.avail_out == 0);
+        } else {
+            device->write(in.constData(), n);
+            compressed += n;
+        }
+    }
+    if (deflating) deflateEnd(&stream);
+
+    // now we know crc and sizes, patch the local header
+    writeUInt(header.h.crc_32, crc_32);
+    writeUInt(header.h.compressed_size, compressed);
+    writeUInt(header.h.uncompressed_size, uncompressed);
+
+    qint64 end = device->pos();
+    h = header.h.toLocalHeader();
+    device->seek(start_of_directory);
+    device->write((const char *)&h, sizeof(LocalFileHeader));
+    device->seek(end);
+
+    fileHeaders.append(header);
+    start_of_directory = end;
+    dirtyFileTree = true;
+}
+
 //////////////////////////////  Reader
 
 /*!
@@ -1180,8 +1300,9 @@ void ZipWriter::addFile(const QString &fileName, const QByteArray &data)
 
 /*!
     Add a file to the archive with \a device as the source of the contents.
-    The contents returned from QIODevice::readAll() will be used as the
-    filedata.
+    The contents are read and compressed a chunk at a time, so the whole
+    file is never held in memory. If reading fails the file is left out
+    and status() is FileError.
     The file will be stored in the archive using the \a fileName which
     includes the full path in the archive.
 */
@@ -1197,7 +1318,7 @@ void ZipWriter::addFile(const QString &fileName, QIODevice *device)
             return;
         }
     }
-    d->addEntry(ZipWriterPrivate::File, QDir::fromNativeSeparators(fileName), device->readAll());
+    d->addEntry(ZipWriterPrivate::File, QDir::fromNativeSeparators(fileName), device);
     if (opened)
         device->close();
 }
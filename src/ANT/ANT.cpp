@@ -98,6 +98,7 @@ ANT::ANT(QObject *parent, DeviceConfiguration *devConf, QString athlete) : QThre
     // device status and settings
     Status=0;
     deviceFilename = devConf ? devConf->portSpec : "";
+    replay = NULL;
     baud=115200;
     powerchannels=0;
     configuring = false;
@@ -175,6 +176,7 @@ ANT::ANT(QObject *parent, DeviceConfiguration *devConf, QString athlete) : QThre
 
 ANT::~ANT()
 {
+    delete replay;
 #if defined GC_HAVE_LIBUSB
     delete usb2;
 #endif
@@ -1068,6 +1070,13 @@ ANT::processMessage(void) {
 
 int ANT::closePort()
 {
+    if (replay) {
+        replay->close();
+        delete replay;
+        replay = NULL;
+        return 0;
+    }
+
 #ifdef WIN32
 #ifdef GC_HAVE_LIBUSB
     switch (usbMode) {
@@ -1111,6 +1120,15 @@ bool ANT::find()
 
 int ANT::openPort()
 {
+    // playing back an antlog instead of a stick
+    if (replaying()) {
+        delete replay;
+        replay = new ANTReplay(deviceFilename);
+        if (!replay->open()) return -1;
+        channels = 8;
+        return 0;
+    }
+
 #ifdef WIN32
 #ifdef GC_HAVE_LIBUSB
     int rc;
@@ -1206,6 +1224,9 @@ int ANT::rawWrite(uint8_t *bytes, int size) // unix!!
 
     int rc=0;
 
+    // the log already has the stick's responses
+    if (replay) return size;
+
 #ifdef WIN32
 #ifdef GC_HAVE_LIBUSB
     switch (usbMode) {
@@ -1255,6 +1276,8 @@ int ANT::rawWrite(uint8_t *bytes, int size) // unix!!
 
 int ANT::rawRead(uint8_t bytes[], int size)
 {
+    if (replay) return replay->read(bytes, size);
+
 #ifdef WIN32
 #ifdef GC_HAVE_LIBUSB
     switch (usbMode) {
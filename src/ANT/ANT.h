@@ -27,6 +27,7 @@
 #include "RealtimeData.h"
 #include "CalibrationData.h"
 #include "DeviceConfiguration.h"
+#include "ANTReplay.h"
 
 //
 // QT stuff
@@ -447,6 +448,7 @@ public slots:
         channelQueue.enqueue(setChannelAtom(channel, device_number, channel_type));
     }
     bool find();                              // find usb device
+    bool replaying() { return ANTReplay::isReplay(deviceFilename); } // port is an antlog to play back
     bool discover(QString name);              // confirm Server available at portSpec
 
     int channelCount() { return channels; }   // how many channels we got available?
@@ -686,6 +688,7 @@ private:
 
     // access to device file
     QString deviceFilename;
+    ANTReplay *replay;              // set when playing back an antlog
     int baud;
 #ifdef WIN32
     HANDLE devicePort;              // file descriptor for reading from com3
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ANTReplay.h"
+#include "ANT.h"
+
+#include <QDebug>
+
+// each record is 'R' or 'S', 8 byte little endian msecs timestamp and
+// the first 12 bytes of the message (see ANTLogger::logRawAntMessage)
+#define ANTLOG_RECORD (1 + 8 + ANT_MAX_MESSAGE_SIZE)
+
+static QString replayFile(QString portSpec)
+{
+    int at = portSpec.lastIndexOf(".raw@");
+    if (at >= 0) return portSpec.left(at + 4);
+    return portSpec;
+}
+
+bool
+ANTReplay::isReplay(QString portSpec)
+{
+    return replayFile(portSpec).endsWith(".raw");
+}
+
+ANTReplay::ANTReplay(QString portSpec) : speed(1.0), offset(0), due(0), first(0), started(false), ended(false),
+                                         messages(0), bytes(0), portLagTotal(0), portLagMax(0)
+{
+    antlog.setFileName(replayFile(portSpec));
+
+    int at = portSpec.lastIndexOf(".raw@");
+    if (at >= 0) speed = portSpec.mid(at + 5).toDouble();
+    if (speed < 0) speed = 1.0;
+}
+
+bool
+ANTReplay::open()
+{
+    if (!antlog.open(QIODevice::ReadOnly)) {
+        qDebug() << "antlog replay: can't open" << antlog.fileName();
+        return false;
+    }
+
+    pending.clear();
+    offset = 0;
+    started = ended = false;
+    messages = bytes = portLagTotal = portLagMax = 0;
+    return true;
+}
+
+void
+ANTReplay::close()
+{
+    if (!antlog.isOpen()) return;
+    if (started && !ended) summary();
+    antlog.close();
+}
+
+bool
+ANTReplay::next()
+{
+    pending.clear();
+    offset = 0;
+
+    char record[ANTLOG_RECORD];
+    while (antlog.read(record, ANTLOG_RECORD) == ANTLOG_RECORD) {
+
+        // only what the stick sent us
+        if (record[0] != 'R') continue;
+
+        qint64 millis = 0;
+        for (int i=8; i>0; i--) millis = (millis << 8) | (uint8_t)record[i];
+
+        // sync, length, id and data, the checksum wasn't logged so we
+        // put it back; anything longer than we log can't be replayed
+        const uint8_t *message = (const uint8_t *)record + 9;
+        int length = message[ANT_OFFSET_LENGTH];
+        if (message[0] != ANT_SYNC_BYTE || length + 3 > ANT_MAX_MESSAGE_SIZE) continue;
+
+        uint8_t checksum = 0;
+        for (int i=0; i<length + 3; i++) {
+            pending.append((char)message[i]);
+            checksum ^= message[i];
+        }
+        pending.append((char)checksum);
+
+        if (!started) {
+            first = millis;
+            started = true;
+            timer.start();
+        }
+        due = speed > 0 ? qint64((millis - first) / speed) : 0;
+        return true;
+    }
+    return false;
+}
+
+int
+ANTReplay::read(uint8_t out[], int size)
+{
+    if (ended) return -1;
+
+    if (offset >= pending.size() && !next()) {
+        ended = true;
+        summary();
+        return -1;
+    }
+
+    // not yet
+    qint64 now = timer.elapsed();
+    if (speed > 0 && now < due) return 0;
+
+    // first byte of a message, how late is it at the port? (not end
+    // to end, it has yet to be decoded and reach the telemetry)
+    if (offset == 0) {
+        qint64 lag = speed > 0 ? now - due : 0;
+        portLagTotal += lag;
+        if (lag > portLagMax) portLagMax = lag;
+        messages++;
+    }
+
+    int i=0;
+    while (i < size && offset < pending.size()) out[i++] = (uint8_t)pending[offset++];
+    bytes += i;
+    return i;
+}
+
+void
+ANTReplay::summary()
+{
+    qint64 elapsed = timer.elapsed();
+    qDebug() << "antlog replay:" << antlog.fileName()
+             << "speed" << speed
+             << "messages" << messages
+             << "bytes" << bytes
+             << "elapsed ms" << elapsed
+             << "messages/s" << (elapsed ? double(messages) * 1000.0 / double(elapsed) : 0.0)
+             << "mean port lag ms" << (messages ? double(portLagTotal) / double(messages) : 0.0)
+             << "max port lag ms" << portLagMax;
+}
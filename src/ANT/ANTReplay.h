@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_ANTReplay_h
+#define _GC_ANTReplay_h 1
+#include "GoldenCheetah.h"
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <stdint.h>
+
+//
+// Plays back an antlog.raw written by ANTLogger in place of an ANT stick,
+// so sessions can be replayed through the normal decode path and train
+// view without any hardware.
+//
+// The device port is set to the log file with an optional speed, e.g.
+//     /home/me/antlog.raw         real time
+//     /home/me/antlog.raw@10      10 times faster
+//     /home/me/antlog.raw@0       as fast as we can decode (benchmark)
+//
+// Messages the stick received are delivered as bytes when they are due,
+// those we sent are skipped (and anything we send now is discarded).
+// When the log ends the throughput and how far behind schedule messages
+// were handed to the port are written to the debug log. That port lag
+// is just replay scheduling, it doesn't include decoding or the time
+// taken to reach the telemetry and train view.
+//
+class ANTReplay
+{
+    public:
+
+        ANTReplay(QString portSpec);
+
+        // is the port an antlog to replay?
+        static bool isReplay(QString portSpec);
+
+        bool open();
+        void close();
+
+        // bytes that are due, 0 if none yet and -1 at the end of the log
+        int read(uint8_t bytes[], int size);
+
+    private:
+
+        // get the next received message from the log into pending
+        bool next();
+        void summary();
+
+        QFile antlog;
+        double speed;
+
+        QByteArray pending;         // bytes of the message being delivered
+        int offset;                 // how many of them have been
+        qint64 due;                 // when it is due, msecs from start
+        qint64 first;               // log timestamp of the first message
+
+        QElapsedTimer timer;
+        bool started, ended;
+
+        // stats
+        qint64 messages, bytes;
+        qint64 portLagTotal, portLagMax; // behind schedule at the port
+};
+
+#endif // _GC_ANTReplay_h
@@ -66,7 +66,7 @@ int
 ANTlocalController::start()
 {
     // Before we do the low level device opening, check for an active Garmin Service
-    if (GarminServiceHelper::isServiceRunning())
+    if (!myANTlocal->replaying() && GarminServiceHelper::isServiceRunning())
     {
         // HACK the event loop gets very angry when we open a dialog in response to a UI event
         QApplication::processEvents();
@@ -88,7 +88,8 @@ ANTlocalController::start()
         }
     }
 
-    logger->open();
+    // don't truncate the antlog we are about to play back
+    if (!myANTlocal->replaying()) logger->open();
     myANTlocal->start();
     myANTlocal->setup();
     return 0;
@@ -203,7 +203,8 @@ Aerolab::Aerolab(
   context(context),
   parent(parent),
   rideItem(NULL),
-  smooth(1), bydist(true), autoEoffset(true) {
+  smooth(1), bydist(true), autoEoffset(true),
+  basisDt(1.0), basisRide(NULL), basisStale(true) {
 
   crr       = 0.005;
   cda       = 0.500;
@@ -257,6 +258,10 @@ Aerolab::configChanged(qint32)
   QPen altPen = QPen(GColor(CAEROEL));
   altPen.setWidth(appsettings->value(this, GC_LINEWIDTH, 0.5).toDouble());
   altCurve->setPen(altPen);
+
+  // units may have changed
+  basisStale = true;
+
   QPen gridPen(GColor(CPLOTGRID));
   gridPen.setStyle(Qt::DotLine);
   grid->setPen(gridPen);
@@ -282,7 +287,6 @@ Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
 
   // HARD-CODED DATA: p1->kph
   double vfactor = 3.600;
-  double m       =  totalMass;
   double small_number = 0.00001;
 
   rideItem = _rideItem;
@@ -290,10 +294,24 @@ Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
 
   RideFile *ride = rideItem->ride();
 
+  // same ride and only the parameters have changed, so we just
+  // need to recombine the basis we already have
+  if (!new_zoom && !basisStale && ride == basisRide) {
+    updateVE();
+    recalc(false);
+    adjustEoffset();
+    return;
+  }
+
   veArray.clear();
   altArray.clear();
   distanceArray.clear();
   timeArray.clear();
+  powerBasis.clear();
+  speedBasis.clear();
+  windBasis.clear();
+  accelBasis.clear();
+  basisRide = NULL;
 
   if( ride ) {
 
@@ -310,6 +328,10 @@ Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
       altArray.resize(dataPresent->alt || constantAlt ? npoints : 0);
       timeArray.resize(dataPresent->watts ? npoints : 0);
       distanceArray.resize(dataPresent->watts ? npoints : 0);
+      powerBasis.resize(veArray.size());
+      speedBasis.resize(veArray.size());
+      windBasis.resize(veArray.size());
+      accelBasis.resize(veArray.size());
 
       // quickly erase old data
       veCurve->setVisible(false);
@@ -331,14 +353,11 @@ Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
         altCurve->setVisible(dataPresent->alt || constantAlt );
       }
 
-      // Fill the virtual elevation profile with data from the ride data:
-      double t = 0.0;
+      // Fill the virtual elevation basis with data from the ride data:
       double vlast = 0.0;
-      double e     = 0.0;
+      double sumPower = 0.0, sumSpeed = 0.0, sumWind = 0.0, sumAccel = 0.0;
       arrayLength = 0;
       foreach(const RideFilePoint *p1, ride->dataPoints()) {
-      if ( arrayLength == 0 )
-        e = eoffset;
 
       timeArray[arrayLength]  = p1->secs / 60.0;
       if ( have_recorded_alt_curve ) {
@@ -362,8 +381,8 @@ Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
       if( dataPresent->headwind ) {
         headwind   = p1->headwind/vfactor;
       }
-      double f     = 0.0;
-      double a     = 0.0;
+      double fv    = 0.0; // f * v
+      double av    = 0.0; // a * v
 
       // Use km data instead of formula for file with a stop (gap).
       //d += v * dt;
@@ -374,26 +393,34 @@ Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
 
 
       if( v > small_number ) {
-        f  = power/v;
-        a  = ( v*v - vlast*vlast ) / ( 2.0 * dt * v );
+        fv = power;
+        av = ( v*v - vlast*vlast ) / ( 2.0 * dt );
       } else {
-        a = ( v - vlast ) / dt;
+        av = v * ( v - vlast ) / dt;
       }
 
-      f *= eta; // adjust for drivetrain efficiency if using a crank-based meter
-      double s   = slope( f, a, m, crr, cda, rho, headwind );
-      double de  = s * v * dt * (GlobalContext::context()->useMetricUnits ? 1 : FEET_PER_METER);
-
-      e += de;
-      t += dt;
+      // the change in elevation is slope(f, a, ...) * v * dt which is linear
+      // in the parameters, so we keep running sums of each of its terms
+      sumPower += fv;
+      sumSpeed += v;
+      sumWind  += headwind * headwind * v;
+      sumAccel += av;
 
-      veArray[arrayLength] = e;
+      powerBasis[arrayLength] = sumPower;
+      speedBasis[arrayLength] = sumSpeed;
+      windBasis[arrayLength]  = sumWind;
+      accelBasis[arrayLength] = sumAccel;
 
       vlast = v;
 
       ++arrayLength;
     }
 
+    basisDt = dt;
+    basisRide = ride;
+    basisStale = false;
+    updateVE();
+
   } else {
       veCurve->setVisible(false);
       altCurve->setVisible(false);
@@ -406,6 +433,38 @@ Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
   }
 }
 
+//
+// Virtual elevation from the basis, at each point it is
+//
+//   eoffset + dt * ( eta/(m*g) * sum(f*v) - crr * sum(v)
+//                    - cda*rho/(2*m*g) * sum(headwind^2 * v) - sum(a*v)/g )
+//
+// i.e. the running sum of slope() * v * dt, so a parameter change
+// is a single pass over the points without touching the ride.
+//
+void
+Aerolab::updateVE()
+{
+  double g = KG_FORCE_PER_METER;
+  double m = totalMass;
+  double scale = basisDt * (GlobalContext::context()->useMetricUnits ? 1 : FEET_PER_METER);
+
+  double kpower = scale * eta / (m * g);
+  double kspeed = scale * crr;
+  double kwind  = scale * cda * rho / (2.0 * m * g);
+  double kaccel = scale / g;
+
+  int n = qMin(veArray.size(), powerBasis.size());
+  double *ve = veArray.data();
+  const double *power = powerBasis.constData();
+  const double *speed = speedBasis.constData();
+  const double *wind = windBasis.constData();
+  const double *accel = accelBasis.constData();
+
+  for (int i = 0; i < n; i++)
+    ve[i] = eoffset + kpower * power[i] - kspeed * speed[i] - kwind * wind[i] - kaccel * accel[i];
+}
+
 void
 Aerolab::setAxisTitle(int axis, QString label)
 {
@@ -592,6 +651,7 @@ void
 Aerolab::setConstantAlt(int value)
 {
     constantAlt = value;
+    basisStale = true;
 }
 
 void
@@ -602,25 +662,6 @@ Aerolab::setByDistance(int value) {
 }
 
 
-double
-Aerolab::slope(
-           double f,
-           double a,
-           double m,
-           double crr,
-           double cda,
-           double rho,
-           double v
-        )  {
-
-  double g = KG_FORCE_PER_METER;
-
-  // Small angle version of slope calculation:
-  double s = f/(m*g) - crr - cda*rho*v*v/(2.0*m*g) - a/g;
-
-  return s;
-}
-
 // At slider 1000, we want to get max Crr=0.1000
 // At slider 1    , we want to get min Crr=0.0001
 void
@@ -630,7 +671,7 @@ Aerolab::setIntCrr(
 
   crr = (double) value / 1000000.0;
 
-  recalc(false);
+  updateVE();
 }
 
 // At slider 1000, we want to get max CdA=1.000
@@ -640,7 +681,7 @@ Aerolab::setIntCda(
            int value
             )  {
   cda = (double) value / 10000.0;
-  recalc(false);
+  updateVE();
 }
 
 // At slider 1000, we want to get max CdA=1.000
@@ -651,7 +692,7 @@ Aerolab::setIntTotalMass(
               ) {
 
   totalMass = (double) value / 100.0;
-  recalc(false);
+  updateVE();
 }
 
 
@@ -663,7 +704,7 @@ Aerolab::setIntRho(
             ) {
 
   rho = (double) value / 10000.0;
-  recalc(false);
+  updateVE();
 }
 
 
@@ -675,7 +716,7 @@ Aerolab::setIntEta(
                      ) {
 
   eta = (double) value / 10000.0;
-  recalc(false);
+  updateVE();
 }
 
 
@@ -687,7 +728,7 @@ Aerolab::setIntEoffset(
                      ) {
 
   eoffset = (double) value / 100.0;
-  recalc(false);
+  updateVE();
 }
 
 
@@ -782,66 +823,89 @@ QString Aerolab::estimateCdACrr(RideItem *rideItem)
         const RideFileDataPresent *dataPresent = ride->areDataPresent();
         if(( dataPresent->alt || constantAlt )  && dataPresent->watts) {
             double dt = ride->recIntSecs();
-            int npoints = ride->dataPoints().size() + 1;
-#ifdef Q_CC_MSVC
-            double* X1 = new double[npoints];
-            double* X2 = new double[npoints];
-            double* Egain = new double[npoints];
-#else
-            double X1[npoints], X2[npoints], Egain[npoints];
-#endif
-            int nSeg = -1;
-            double altInit = 0, vInit = 0;
+
+            // the selected intervals, or the whole ride if none
+            QList<QPair<int,int> > ranges;
+            foreach(IntervalItem *interval, rideItem->intervalsSelected())
+                ranges << QPair<int,int>(ride->timeIndex(interval->start), ride->timeIndex(interval->stop));
+            if (ranges.isEmpty()) ranges << QPair<int,int>(0, ride->dataPoints().count()-1);
+
+            // normal equation, see below
+            double A11 = 0, A12 = 0, A21 = 0, A22 = 0, B1 = 0, B2 = 0;
+            int nSeg = 0;
+
             /* For each segment, defined between points with alt != 0,
              * this loop computes X1, X2 and Egain to verify:
              * Aero-Loss + RR-Loss = Egain
              * where
-             *      Aero-Loss = X1[nSgeg] * CdA
-             *      RR-Loss = X2[nSgeg] * Crr
+             *      Aero-Loss = X1 * CdA
+             *      RR-Loss = X2 * Crr
              * are the aero and rr components of the energy loss with
-             *      X1[nSeg] = sum(0.5 * rho * headwind*headwind * distance)
-             *      X2[nSeg] = sum(totalMass * g * distance)
+             *      X1 = sum(0.5 * rho * headwind*headwind * distance)
+             *      X2 = sum(totalMass * g * distance)
              * and the energy gain sums power in the segment with
              * potential and kinetic variations:
              *      Egain = sum(eta * power * dt) +
              *              totalMass * (g * (altInit - alt) +
              *              0.5 * (vInit*vInit - v*v))
+             *
+             * Each segment only contributes to the normal equation
+             * so they are folded in as they are closed, segments from
+             * all of the selected intervals contribute to the same fit.
              */
-            foreach(const RideFilePoint *p1, ride->dataPoints()) {
-                // Unpack:
-                double power = max(0, p1->watts);
-                double v     = p1->kph/vfactor;
-                double distance = v * dt;
-                double headwind = v;
-                if( dataPresent->headwind ) {
-                    headwind   = p1->headwind/vfactor;
-                }
-                double alt = p1->alt;
-                // start initial segment
-                if (nSeg < 0 && alt != 0) {
-                    nSeg = 0;
-                    X1[nSeg] = X2[nSeg] = Egain[nSeg] = 0.0;
-                    altInit = alt;
-                    vInit = v;
-                }
-                // accumulate segment data
-                if (nSeg >= 0) {
-                    // X1[nSgeg] * CdA == Aero-Loss
-                    X1[nSeg] += 0.5 * rho * headwind*headwind * distance;
-                    // X2[nSgeg] * Crr == RR-Loss
-                    X2[nSeg] += totalMass * g * distance;
-                    // Energy supplied
-                    Egain[nSeg] += eta * power * dt;
-                }
-                // close current segment and start a new one
-                if (nSeg >= 0 && alt != 0) {
-                    // Add change in potential and kinetic energy
-                    Egain[nSeg] += totalMass * (g * (altInit - alt) + 0.5 * (vInit*vInit - v*v));
-                    // Start a new segment
-                    nSeg++;
-                    X1[nSeg] = X2[nSeg] = Egain[nSeg] = 0.0;
-                    altInit = alt;
-                    vInit = v;
+            for (int r = 0; r < ranges.count(); r++) {
+
+                bool open = false;
+                double X1 = 0, X2 = 0, Egain = 0;
+                double altInit = 0, vInit = 0;
+
+                for (int i = qMax(0, ranges[r].first); i <= ranges[r].second && i < ride->dataPoints().count(); i++) {
+                    const RideFilePoint *p1 = ride->dataPoints().at(i);
+
+                    // Unpack:
+                    double power = max(0, p1->watts);
+                    double v     = p1->kph/vfactor;
+                    double distance = v * dt;
+                    double headwind = v;
+                    if( dataPresent->headwind ) {
+                        headwind   = p1->headwind/vfactor;
+                    }
+                    double alt = p1->alt;
+                    // start initial segment
+                    if (!open && alt != 0) {
+                        open = true;
+                        X1 = X2 = Egain = 0.0;
+                        altInit = alt;
+                        vInit = v;
+                    }
+                    // accumulate segment data
+                    if (open) {
+                        // X1 * CdA == Aero-Loss
+                        X1 += 0.5 * rho * headwind*headwind * distance;
+                        // X2 * Crr == RR-Loss
+                        X2 += totalMass * g * distance;
+                        // Energy supplied
+                        Egain += eta * power * dt;
+                    }
+                    // close current segment and start a new one
+                    if (open && alt != 0) {
+                        // Add change in potential and kinetic energy
+                        Egain += totalMass * (g * (altInit - alt) + 0.5 * (vInit*vInit - v*v));
+
+                        // A = X'*X and B = X'*Egain
+                        A11 += X1 * X1;
+                        A12 += X1 * X2;
+                        A21 += X2 * X1;
+                        A22 += X2 * X2;
+                        B1  += X1 * Egain;
+                        B2  += X2 * Egain;
+                        nSeg++;
+
+                        // Start a new segment
+                        X1 = X2 = Egain = 0.0;
+                        altInit = alt;
+                        vInit = v;
+                    }
                 }
             }
             /* At least two segmentes needed to approximate:
@@ -854,18 +918,6 @@ QString Aerolab::estimateCdACrr(RideItem *rideItem)
              *    A * [ CdA ; Crr ] = B
              */
             if (nSeg >= 2) {
-                // compute the normal equation: A * [ CdA ; Crr ] = B
-                // A = X'*X
-                // B = X'*Egain
-                double A11 = 0, A12 = 0, A21 = 0, A22 = 0, B1 = 0, B2 = 0;
-                for (int i = 0; i < nSeg; i++) {
-                    A11 += X1[i] * X1[i];
-                    A12 += X1[i] * X2[i];
-                    A21 += X2[i] * X1[i];
-                    A22 += X2[i] * X2[i];
-                    B1  += X1[i] * Egain[i];
-                    B2  += X2[i] * Egain[i];
-                }
                 // Solve the normal equation
                 // A11 * CdA + A12 * Crr = B1
                 // A21 * CdA + A22 * Crr = B2
@@ -887,11 +939,6 @@ QString Aerolab::estimateCdACrr(RideItem *rideItem)
             } else {
                 errMsg = tr("At least two segments must be defined");
             }
-#ifdef Q_CC_MSVC
-            delete[] X1;
-            delete[] X2;
-            delete[] Egain;
-#endif
         } else {
             errMsg = tr("Altitude and Power data must be present");
         }
@@ -35,6 +35,7 @@
 
 // forward references
 class RideItem;
+class RideFile;
 struct RideFilePoint;
 class QwtPlotCurve;
 class QwtPlotGrid;
@@ -123,7 +124,17 @@ class Aerolab : public QwtPlot {
   double eoffset;
 
 
-  double   slope(double, double, double, double, double, double, double);
+  // virtual elevation is linear in the parameters, so we keep running
+  // sums of each term per point and recombine when they change
+  QVector<double> powerBasis; // sum(f*v)
+  QVector<double> speedBasis; // sum(v)
+  QVector<double> windBasis;  // sum(headwind^2*v)
+  QVector<double> accelBasis; // sum(a*v)
+  double basisDt;
+  RideFile *basisRide;        // ride the basis was computed for
+  bool basisStale;            // altitude or units changed
+
+  void     updateVE();
   void     recalc(bool);
   void     setYMax(bool);
   void     setXTitle();
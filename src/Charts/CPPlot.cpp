@@ -41,6 +41,7 @@
 #include <qwt_color_map.h>
 #include <qwt_curve_fitter.h>
 #include <algorithm> // for std::lower_bound
+#include <QtConcurrent>
 
 #include "CriticalPowerWindow.h"
 #include "GcOverlayWidget.h"
@@ -426,10 +427,15 @@ CPPlot::initModel()
         QwtPlotIntervalCurve* icurve;   Q_UNUSED(icurve);
         CpPlotCurve *qcurve;            Q_UNUSED(qcurve);
 
+        // the versions are fitted in parallel
+        QFuture<TestModel> fit7_3 = QtConcurrent::run([=]() { return ecp->deriveExtendedCP_7_3_Parameters(true, bestsCache, rideSeries, sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2); });
+        QFuture<TestModel> fit6_3 = QtConcurrent::run([=]() { return ecp->deriveExtendedCP_6_3_Parameters(true, bestsCache, rideSeries, sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2); });
+        QFuture<TestModel> fit5_3 = QtConcurrent::run([=]() { return ecp->deriveExtendedCP_5_3_Parameters(true, bestsCache, rideSeries, sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2); });
+
         //
         // Version 7.3 of Model
         //
-        model = ecp->deriveExtendedCP_7_3_Parameters(true, bestsCache, rideSeries, sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2);
+        model = fit7_3.result();
 
         // model curve
         curve = ecp->getPlotCurveForExtendedCP_7_3(model);
@@ -456,7 +462,7 @@ CPPlot::initModel()
         //
         // Version 6.3 of Model
         //
-        model = ecp->deriveExtendedCP_6_3_Parameters(true, bestsCache, rideSeries, sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2);
+        model = fit6_3.result();
 
         // model curve
         curve = ecp->getPlotCurveForExtendedCP_6_3(model);
@@ -466,7 +472,7 @@ CPPlot::initModel()
         //
         // Current 5.3 Version of Model
         //
-        model = ecp->deriveExtendedCP_5_3_Parameters(true, bestsCache, rideSeries, sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2);
+        model = fit5_3.result();
 
         // model curve
         curve = ecp->getPlotCurveForExtendedCP_5_3(model);
@@ -2734,6 +2740,19 @@ CPPlot::calculateForDateRanges(QList<CompareDateRange> compareDateRanges)
         return;
     }
 
+    // the extended model is slow to fit, so fit them all in parallel
+    // first, the models below then get the results from the cache
+    // (they use minutes, so must we)
+    if (model == 3 && (rideSeries == RideFile::watts || rideSeries == RideFile::wattsKg || rideSeries == RideFile::aPower || rideSeries == RideFile::aPowerKg || rideSeries == RideFile::kph)) {
+
+        QList<QVector<double> > meanmax;
+        for (int j = 0; j < compareDateRanges.size(); ++j) {
+            if (compareDateRanges[j].isChecked() && compareDateRanges[j].rideFileCache())
+                meanmax << compareDateRanges[j].rideFileCache()->meanMaxArray(rideSeries);
+        }
+        ExtendedModel::prefit(meanmax, true, sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2);
+    }
+
     double ymax = 0;
     double ymin = 0;
 
@@ -38,6 +38,7 @@
 #include "IntervalItem.h"
 
 #include "PMCData.h" // for LTS/STS calculation
+#include "MetricBuckets.h" // for trends day buckets
 #include "Zones.h"
 #include "HrZones.h"
 #include "PaceZones.h"
@@ -2666,6 +2667,48 @@ LTMPlot::createMetricData(Context *context, LTMSettings *settings, MetricDetail
     if (!SearchFilterBox::isNull(metricDetail.datafilter))
         spec.addMatches(SearchFilterBox::matches(context, metricDetail.datafilter));
 
+    // unfiltered curves are plotted from the athlete's day buckets
+    // so we don't need to rescan and re-aggregate all the rides
+    if (!spec.isFiltered()) {
+
+        // sum totals, average averages and choose best for Peaks
+        int type = metricDetail.metric ? metricDetail.metric->type() : RideMetric::Average;
+        if (metricDetail.uunits == "Ramp" ||
+            metricDetail.uunits == tr("Ramp")) type = RideMetric::Total;
+
+        bool metadata = (metricDetail.type == METRIC_META);
+        MetricBuckets *buckets = context->athlete->getBucketsFor(metadata ? metricDetail.name : metricDetail.symbol,
+                                                                 metadata, type, GlobalContext::context()->useMetricUnits);
+
+        int startDay = groupForDate(settings->start.date(), settings->groupBy);
+        QList<QPair<int,double> > groups = buckets->aggregate(spec.dateRange(), settings->groupBy,
+                                                              settings->start.date(), wantZero);
+        for(int i=0; i<groups.count(); i++) {
+
+            int currentDay = groups[i].first;
+            if (lastDay && wantZero) {
+                while (lastDay<currentDay && n<=maxdays) {
+                    lastDay++;
+                    n++;
+                    x[n]=lastDay - startDay;
+                    y[n]=0;
+                }
+            } else {
+                n++;
+            }
+
+            // drop out of range
+            if (n>maxdays) break;
+            // first time thru
+            if (n<0) n=0;
+
+            y[n] = groups[i].second;
+            x[n] = currentDay - startDay;
+            lastDay = currentDay;
+        }
+        return;
+    }
+
     //
     double ymean_prev=0.0;
 
@@ -3990,20 +4033,8 @@ LTMPlot::replot() {
 int
 LTMPlot::groupForDate(QDate date, int groupby)
 {
-    switch(groupby) {
-    case LTM_WEEK:
-        {
-        // must start from 1 not zero!
-        return 1 + ((date.toJulianDay() - settings->start.date().toJulianDay()) / 7);
-        }
-    case LTM_MONTH: return (date.year()*12) + date.month();
-    case LTM_YEAR:  return date.year();
-    case LTM_DAY:
-    default:
-        return date.toJulianDay();
-    case LTM_ALL: return 1;
-
-    }
+    // weeks are counted from the start of the chart
+    return MetricBuckets::groupForDate(date, groupby, settings->start.date());
 }
 
 void
@@ -19,6 +19,7 @@
 #include "Overview.h"
 #include "ChartSpace.h"
 #include "OverviewItems.h"
+#include "OverviewData.h"
 #include "AddChartWizard.h"
 #include "Utils.h"
 
@@ -51,6 +52,7 @@ OverviewWindow::OverviewWindow(Context *context, int scope) : GcChartWindow(cont
     }
 
     if (scope & OverviewScope::TRENDS) {
+        space->setDataService(new OverviewDataService(space)); // tiles share a scan
         connect(this, SIGNAL(dateRangeChanged(DateRange)), space, SLOT(dateRangeChanged(DateRange)));
         connect(context, SIGNAL(filterChanged()), space, SLOT(filterChanged()));
         connect(context, SIGNAL(homeFilterChanged()), space, SLOT(filterChanged()));
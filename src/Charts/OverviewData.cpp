@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "OverviewData.h"
+
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "RideItem.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+
+// more than this and we start again, they're cheap to rescan
+#define OVERVIEWCACHEMAX 256
+
+OverviewDataService::OverviewDataService(ChartSpace *space) : QObject(space), space(space), context(space->context),
+    stale(false), again(false)
+{
+    rescanTimer.setSingleShot(true);
+    rescanTimer.setInterval(500);
+
+    connect(&watcher, SIGNAL(finished()), this, SLOT(scanFinished()));
+    connect(&rescanTimer, SIGNAL(timeout()), this, SLOT(rescan()));
+
+    connect(context->athlete->rideCache, SIGNAL(itemChanged(RideItem*)), this, SLOT(itemChanged(RideItem*)));
+    connect(context, SIGNAL(rideAdded(RideItem*)), this, SLOT(itemChanged(RideItem*)));
+    connect(context, SIGNAL(rideDeleted(RideItem*)), this, SLOT(rideDeleted(RideItem*)));
+    connect(context, SIGNAL(configChanged(qint32)), this, SLOT(invalidate()));
+}
+
+OverviewDataService::~OverviewDataService()
+{
+    future.waitForFinished();
+    foreach(Pending p, pending) delete p.accumulator;
+}
+
+QString
+OverviewDataService::key(DateRange dr, ChartSpaceItem *item) const
+{
+    if (item->dataKey().isEmpty()) return QString();
+
+    return QString("%1|%2|%3|%4|%5").arg(dr.from.toString(Qt::ISODate))
+                                    .arg(dr.to.toString(Qt::ISODate))
+                                    .arg(item->type)
+                                    .arg(item->dataKey())
+                                    .arg(item->datafilter);
+}
+
+void
+OverviewDataService::dateRangeChanged(DateRange dr, QList<ChartSpaceItem*> items)
+{
+    // one at a time, we'll get to it when this one finishes
+    if (future.isRunning()) {
+        if (again && againRange.from == dr.from && againRange.to == dr.to) {
+            foreach(ChartSpaceItem *item, items) if (!againItems.contains(item)) againItems << item;
+        } else {
+            againRange = dr;
+            againItems = items;
+        }
+        again = true;
+        return;
+    }
+
+    QList<ChartSpaceAccumulator*> accumulators;
+    foreach(ChartSpaceItem *item, items) {
+
+        // can't share, so it does its own
+        QString k = key(dr, item);
+        if (k.isEmpty()) {
+            item->setDateRange(dr);
+            continue;
+        }
+
+        // seen it before
+        if (cache.contains(k)) {
+            item->setAccumulated(cache.value(k).accumulator.data());
+            continue;
+        }
+
+        ChartSpaceAccumulator *accumulator = item->accumulator(dr);
+        if (accumulator == NULL) {
+            item->setDateRange(dr);
+            continue;
+        }
+
+        Pending add;
+        add.item = item;
+        add.key = k;
+        add.accumulator = accumulator;
+        pending << add;
+        accumulators << accumulator;
+    }
+
+    if (accumulators.isEmpty()) return;
+
+    // the scan works on a copy of the ride list, the items themselves
+    // are only deleted later so they outlive it (see rideDeleted)
+    scanning = dr;
+    stale = false;
+    future = QtConcurrent::run(OverviewDataService::scan, dr, context->athlete->rideCache->rides(), accumulators);
+    watcher.setFuture(future);
+}
+
+static bool rideBeforeDate(const RideItem *item, const QDate &date) { return item->dateTime.date() < date; }
+
+void
+OverviewDataService::scan(DateRange dr, const QVector<RideItem*> &rides, QList<ChartSpaceAccumulator*> accumulators)
+{
+    // rides are in date order, so skip straight to the start
+    int i = 0;
+    if (dr.from.isValid()) i = std::lower_bound(rides.begin(), rides.end(), dr.from, rideBeforeDate) - rides.begin();
+
+    for(; i<rides.count(); i++) {
+
+        RideItem *item = rides.at(i);
+        if (dr.to.isValid() && item->dateTime.date() > dr.to) break;
+
+        foreach(ChartSpaceAccumulator *accumulator, accumulators)
+            if (accumulator->spec.pass(item)) accumulator->add(item);
+    }
+}
+
+void
+OverviewDataService::scanFinished()
+{
+    // keep the results, unless they were out of date before we finished
+    if (cache.count() > OVERVIEWCACHEMAX) cache.clear();
+
+    QList<ChartSpaceItem*> live = space->allItems();
+    foreach(Pending p, pending) {
+
+        QSharedPointer<ChartSpaceAccumulator> accumulator(p.accumulator);
+        if (!stale) {
+            Cached add;
+            add.dr = scanning;
+            add.accumulator = accumulator;
+            cache.insert(p.key, add);
+        }
+
+        // removed whilst we were scanning?
+        if (live.contains(p.item)) p.item->setAccumulated(accumulator.data());
+    }
+    pending.clear();
+    space->updateView();
+
+    // and anything asked for whilst we were busy
+    if (again) {
+        again = false;
+
+        QList<ChartSpaceItem*> items;
+        foreach(ChartSpaceItem *item, againItems) if (live.contains(item)) items << item;
+        againItems.clear();
+
+        dateRangeChanged(againRange, items);
+    }
+}
+
+void
+OverviewDataService::invalidate()
+{
+    cache.clear();
+    if (future.isRunning()) stale = true;
+}
+
+void
+OverviewDataService::dropCached(QDate date)
+{
+    QMutableHashIterator<QString, Cached> it(cache);
+    while (it.hasNext()) {
+        it.next();
+        if (it.value().dr.pass(date)) it.remove();
+    }
+    if (future.isRunning() && scanning.pass(date)) stale = true;
+}
+
+void
+OverviewDataService::itemChanged(RideItem *item)
+{
+    // a refresh will update everything when it ends
+    if (item == NULL || context->athlete->rideCache->isRunning()) return;
+
+    // only the results that include it are out of date
+    QDate date = item->dateTime.date();
+    dropCached(date);
+
+    // and only need redoing now if we're showing them, wait a
+    // moment as changes tend to come in bunches
+    if (space->currentDateRange.pass(date)) rescanTimer.start();
+}
+
+void
+OverviewDataService::rideDeleted(RideItem *item)
+{
+    // don't let it go whilst we're looking at it
+    future.waitForFinished();
+    itemChanged(item);
+}
+
+void
+OverviewDataService::rescan()
+{
+    space->dateRangeChanged(space->currentDateRange);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_OverviewData_h
+#define _GC_OverviewData_h 1
+#include "GoldenCheetah.h"
+
+#include "ChartSpace.h"
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+
+//
+// Shared data source for the trends overview tiles.
+//
+// Rather than every tile scanning the ride cache on the GUI thread
+// each time the date range changes, the tiles that can supply a
+// ChartSpaceAccumulator have all of them filled in a single pass
+// over the rides in the date range on a worker thread; each tile
+// then applies its results when the scan completes.
+//
+// Results are cached by date range and tile config (dataKey and
+// filter) so returning to a date range already seen is immediate.
+// When a ride changes only the cached results for date ranges that
+// include it are dropped, and the tiles are rescanned only if it
+// is in the date range currently being shown.
+//
+class OverviewDataService : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        OverviewDataService(ChartSpace *space);
+        ~OverviewDataService();
+
+        // fill the accumulators for these items, those that don't
+        // have one are just told the date range as before
+        void dateRangeChanged(DateRange dr, QList<ChartSpaceItem*> items);
+
+        // fill on the calling thread, rides must be in date order
+        static void scan(DateRange dr, const QVector<RideItem*> &rides, QList<ChartSpaceAccumulator*> accumulators);
+
+    public slots:
+
+        // forget all cached results (filters, config or rides refreshed)
+        void invalidate();
+
+    private slots:
+
+        void itemChanged(RideItem *item);
+        void rideDeleted(RideItem *item);
+        void scanFinished();
+        void rescan();
+
+    private:
+
+        struct Pending {
+            ChartSpaceItem *item;
+            QString key;
+            ChartSpaceAccumulator *accumulator;
+        };
+        struct Cached {
+            DateRange dr;
+            QSharedPointer<ChartSpaceAccumulator> accumulator;
+        };
+
+        QString key(DateRange dr, ChartSpaceItem *item) const;
+        void dropCached(QDate date);
+
+        ChartSpace *space;
+        Context *context;
+
+        // the scan running now
+        QFuture<void> future;
+        QFutureWatcher<void> watcher;
+        DateRange scanning;
+        QList<Pending> pending;
+        bool stale;                 // invalidated whilst scanning
+
+        // asked again whilst scanning
+        bool again;
+        DateRange againRange;
+        QList<ChartSpaceItem*> againItems;
+
+        QHash<QString, Cached> cache;
+        QTimer rescanTimer;         // coalesce ride changes
+};
+
+#endif // _GC_OverviewData_h
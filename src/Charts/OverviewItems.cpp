@@ -17,6 +17,7 @@
  */
 
 #include "OverviewItems.h"
+#include "OverviewData.h"
 
 #include "TabView.h"
 #include "Athlete.h"
@@ -84,6 +85,17 @@ static void setFilter(ChartSpaceItem *item, Specification &spec)
     return;
 }
 
+// just the one item to update, so scan the rides here
+static void accumulate(ChartSpaceItem *item, DateRange dr)
+{
+    ChartSpaceAccumulator *accumulator = item->accumulator(dr);
+    if (accumulator == NULL) return;
+
+    OverviewDataService::scan(dr, item->parent->context->athlete->rideCache->rides(), QList<ChartSpaceAccumulator*>() << accumulator);
+    item->setAccumulated(accumulator);
+    delete accumulator;
+}
+
 RPEOverviewItem::RPEOverviewItem(ChartSpace *parent, QString name) : ChartSpaceItem(parent, name)
 {
 
@@ -475,7 +487,7 @@ RPEOverviewItem::setData(RideItem *item)
     points << QPointF(SPARKDAYS, value.toDouble());
 
     // set the chart values with the last 10 rides
-    int index = parent->context->athlete->rideCache->rides().indexOf(item);
+    int index = parent->context->athlete->rideCache->find(item);
 
     int offset = 1;
     double min = v;
@@ -550,7 +562,7 @@ MetricOverviewItem::setData(RideItem *item)
     points << QPointF(SPARKDAYS, v);
 
     // set the chart values with the last 10 rides
-    int index = parent->context->athlete->rideCache->rides().indexOf(item);
+    int index = parent->context->athlete->rideCache->find(item);
 
     int offset = 1;
     double min = v;
@@ -692,56 +704,107 @@ MetricOverviewItem::setData(RideItem *item)
     }
 }
 
-void
-MetricOverviewItem::setDateRange(DateRange dr)
+// aggregate and sparkline for a metric over the date range
+class MetricAccumulator : public ChartSpaceAccumulator
 {
-    if (!metric) return; // avoid crashes when metric is not available
+    public:
+        MetricAccumulator(QString symbol, RideMetric *metric, DateRange dr) :
+            symbol(symbol), type(metric->type()), aggregateZero(metric->aggregateZero()),
+            useMetricUnits(GlobalContext::context()->useMetricUnits), dr(dr), earliest(1900,01,01),
+            v(0), c(0), first(true), min(0), max(0), sum(0), firstpoint(true) {}
 
-    // for metrics lets truncate to today
-    if (dr.to > QDate::currentDate()) dr.to = QDate::currentDate();
+        void add(RideItem *item) {
 
-    Specification spec;
-    spec.setDateRange(dr);
-    setFilter(this, spec);
+            double value = item->getForSymbol(symbol, useMetricUnits);
 
-    // aggregate sum and count etc
-    double v=0; // value
-    double c=0; // count
-    bool first=true;
-    foreach(RideItem *item, parent->context->athlete->rideCache->rides()) {
+            // metric history, no zero values
+            if (value != 0) {
 
-        if (!spec.pass(item)) continue;
+                // cum sum for Total and RunningTotals
+                double y = value;
+                if (type == RideMetric::Total || type == RideMetric::RunningTotal) {
+                    sum += y;
+                    y = sum;
+                }
 
-        // get value and count
-        double value = item->getForSymbol(symbol, GlobalContext::context()->useMetricUnits);
-        double count = item->getCountForSymbol(symbol);
-        if (count <= 0) count = 1;
+                points << QPointF(earliest.daysTo(item->dateTime.date()) - earliest.daysTo(dr.from), y);
 
-        // ignore zeroes when aggregating?
-        if (metric->aggregateZero() == false && value == 0) continue;
+                if (y < min) min=y;
+                if (firstpoint || y > max) max=y;
+                firstpoint = false;
+            }
 
-        // what we gonna do with this?
-        switch(metric->type()) {
-        case RideMetric::StdDev:
-        case RideMetric::MeanSquareRoot:
-        case RideMetric::Average:
-            v += value*count;
-            c += count;
-            break;
-        case RideMetric::Total:
-        case RideMetric::RunningTotal:
-            v += value;
-            break;
-        case RideMetric::Peak:
-            if (first || value > v) v = value;
-            break;
-        case RideMetric::Low:
-            if (first || value < v) v = value;
-            break;
-            break;
+            // get count
+            double count = item->getCountForSymbol(symbol);
+            if (count <= 0) count = 1;
+
+            // ignore zeroes when aggregating?
+            if (aggregateZero == false && value == 0) return;
+
+            // what we gonna do with this?
+            switch(type) {
+            case RideMetric::StdDev:
+            case RideMetric::MeanSquareRoot:
+            case RideMetric::Average:
+                v += value*count;
+                c += count;
+                break;
+            case RideMetric::Total:
+            case RideMetric::RunningTotal:
+                v += value;
+                break;
+            case RideMetric::Peak:
+                if (first || value > v) v = value;
+                break;
+            case RideMetric::Low:
+                if (first || value < v) v = value;
+                break;
+            }
+            first = false;
         }
-        first = false;
-    }
+
+        QString symbol;
+        int type;
+        bool aggregateZero, useMetricUnits;
+        DateRange dr;
+        QDate earliest;
+
+        // aggregate sum and count etc
+        double v, c;
+        bool first;
+
+        // metric history
+        QList<QPointF> points;
+        double min, max, sum;
+        bool firstpoint;
+};
+
+void
+MetricOverviewItem::setDateRange(DateRange dr)
+{
+    accumulate(this, dr);
+}
+
+ChartSpaceAccumulator *
+MetricOverviewItem::accumulator(DateRange dr)
+{
+    if (!metric) return NULL; // avoid crashes when metric is not available
+
+    // for metrics lets truncate to today
+    if (dr.to > QDate::currentDate()) dr.to = QDate::currentDate();
+
+    MetricAccumulator *accumulator = new MetricAccumulator(symbol, metric, dr);
+    accumulator->spec.setDateRange(dr);
+    setFilter(this, accumulator->spec);
+    return accumulator;
+}
+
+void
+MetricOverviewItem::setAccumulated(ChartSpaceAccumulator *p)
+{
+    MetricAccumulator *accumulated = static_cast<MetricAccumulator*>(p);
+    double v = accumulated->v;
+    double c = accumulated->c;
 
     // now apply averaging etc
     switch(metric->type()) {
@@ -767,46 +830,18 @@ MetricOverviewItem::setDateRange(DateRange dr)
         if (value == "nan") value ="";
     }
 
-    // metric history
-    QList<QPointF> points;
-
     // how many days
-    QDate earliest(1900,01,01);
-    sparkline->setDays(earliest.daysTo(dr.to) - earliest.daysTo(dr.from));
-
-    double min=0, max=0;
-    double sum=0;
-    first=true;
-    foreach(RideItem *item, parent->context->athlete->rideCache->rides()) {
-
-        if (!spec.pass(item)) continue;
-
-        double v = item->getForSymbol(symbol, GlobalContext::context()->useMetricUnits);
-
-        // no zero values
-        if (v == 0) continue;
-
-        // cum sum for Total and RunningTotals
-        if (metric->type() == RideMetric::Total || metric->type() == RideMetric::RunningTotal) {
-            sum += v;
-            v = sum;
-        }
-
-        points << QPointF(earliest.daysTo(item->dateTime.date()) - earliest.daysTo(dr.from), v);
-
-        if (v < min) min=v;
-        if (first || v > max) max=v;
-        first = false;
-    }
+    DateRange dr = accumulated->dr;
+    sparkline->setDays(accumulated->earliest.daysTo(dr.to) - accumulated->earliest.daysTo(dr.from));
 
     // do we want fill?
     sparkline->setFill(metric->type()== RideMetric::Total || metric->type()== RideMetric::RunningTotal);
 
     // update the sparkline
-    sparkline->setPoints(points);
+    sparkline->setPoints(accumulated->points);
 
     // set range
-    sparkline->setRange(min*1.1,max*1.1); // add 10% to each direction
+    sparkline->setRange(accumulated->min*1.1,accumulated->max*1.1); // add 10% to each direction
 
 }
 
@@ -815,47 +850,71 @@ static bool entrylessthan(struct topnentry &a, const topnentry &b)
     return a.v < b.v;
 }
 
+// the values for each activity in the date range, to rank
+class TopNAccumulator : public ChartSpaceAccumulator
+{
+    public:
+        TopNAccumulator(QString symbol) : symbol(symbol), useMetricUnits(GlobalContext::context()->useMetricUnits) {}
+
+        void add(RideItem *item) {
+            double v = item->getForSymbol(symbol, useMetricUnits);
+            QString value = item->getStringForSymbol(symbol, useMetricUnits);
+            entries << topnentry(item->dateTime.date(), v, value, item->color, 0, item);
+        }
+
+        QString symbol;
+        bool useMetricUnits;
+        QList<topnentry> entries;
+};
+
 void
 TopNOverviewItem::setDateRange(DateRange dr)
 {
-    if (!metric) return; // avoid crashes when metric is not available
+    accumulate(this, dr);
+}
 
-    // clear out the old values
-    ranked.clear();
+ChartSpaceAccumulator *
+TopNOverviewItem::accumulator(DateRange dr)
+{
+    if (!metric) return NULL; // avoid crashes when metric is not available
 
     // filtering
-    Specification spec;
-    spec.setDateRange(dr);
-    setFilter(this, spec);
+    TopNAccumulator *accumulator = new TopNAccumulator(symbol);
+    accumulator->spec.setDateRange(dr);
+    setFilter(this, accumulator->spec);
+    return accumulator;
+}
+
+void
+TopNOverviewItem::setAccumulated(ChartSpaceAccumulator *p)
+{
+    TopNAccumulator *accumulated = static_cast<TopNAccumulator*>(p);
+
+    // clear out the old values
+    ranked.clear();
 
     // pmc data
-    PMCData stressdata(parent->context, spec, "coggan_tss");
+    PMCData stressdata(parent->context, accumulated->spec, "coggan_tss");
     maxvalue="";
     maxv=0; // must never have -ve max
     minv=0; // always zero minimum
-    foreach(RideItem *item, parent->context->athlete->rideCache->rides()) {
+    foreach(topnentry entry, accumulated->entries) {
 
-        if (!spec.pass(item)) continue;
-
-        // get value and count
-        double v = item->getForSymbol(symbol, GlobalContext::context()->useMetricUnits);
-        QString value = item->getStringForSymbol(symbol, GlobalContext::context()->useMetricUnits);
-        int index = stressdata.indexOf(item->dateTime.date());
-        double tsb = 0;
-        if (index >= 0 && index < stressdata.sb().count()) tsb = stressdata.sb()[index];
+        int index = stressdata.indexOf(entry.date);
+        if (index >= 0 && index < stressdata.sb().count()) entry.tsb = stressdata.sb()[index];
 
         // add to the list
-        QColor color = (item->color.red() == 1 && item->color.green() == 1 && item->color.blue() == 1) ? GColor(CPLOTMARKER) : item->color;
-        ranked << topnentry(item->dateTime.date(), v, value, color, tsb, item);
+        if (entry.color.red() == 1 && entry.color.green() == 1 && entry.color.blue() == 1) entry.color = GColor(CPLOTMARKER);
+        ranked << entry;
 
         // biggest value?
-        if (v > maxv) {
-            maxvalue=value;
-            maxv = v;
+        if (entry.v > maxv) {
+            maxvalue=entry.value;
+            maxv = entry.v;
         }
 
         // minv should be 0 unless it goes negative
-        if (v < minv) minv=v;
+        if (entry.v < minv) minv=entry.v;
     }
 
     // sort the list
@@ -899,7 +958,7 @@ MetaOverviewItem::setData(RideItem *item)
         points << QPointF(SPARKDAYS, v);
 
         // set the chart values with the last 10 rides
-        int index = parent->context->athlete->rideCache->rides().indexOf(item);
+        int index = parent->context->athlete->rideCache->find(item);
 
         int offset = 1;
         double min = v;
@@ -986,10 +1045,93 @@ static bool lessthan(const aggmeta &a, const aggmeta &b)
     return a.value > b.value;
 }
 
+// metric aggregated by metadata value over the date range
+struct aggregator {
+    aggregator(double v, double c) : value(v), count(c) {}
+    double value, count;
+};
+
+class DonutAccumulator : public ChartSpaceAccumulator
+{
+    public:
+        DonutAccumulator(QString symbol, QString meta, RideMetric *metric) :
+            symbol(symbol), meta(meta), type(metric->type()), aggregateZero(metric->aggregateZero()),
+            useMetricUnits(GlobalContext::context()->useMetricUnits) {}
+
+        void add(RideItem *item) {
+
+            // get meta value
+            QString category = item->getText(meta, "");
+            aggregator d = data.value(category, aggregator(-1,-1));
+
+            // is this first time we've seen this meta value?
+            bool first = false;
+            if (d.value == -1 && d.count == -1) {
+                first = true;
+                d.value=0;
+                d.count=0;
+            }
+
+            // get metric value and count
+            double value = item->getForSymbol(symbol, useMetricUnits);
+            double count = item->getCountForSymbol(symbol);
+            if (count <= 0) count = 1;
+
+            // ignore zeroes when aggregating?
+            if (aggregateZero == false && value == 0) return;
+
+            // what we gonna do with this?
+            switch(type) {
+            case RideMetric::StdDev:
+            case RideMetric::MeanSquareRoot:
+            case RideMetric::Average:
+                d.value = (d.value*d.count) + (value * count); // convert to sum
+                d.count += count;
+                d.value = d.value / d.count; // turn back to average
+                break;
+            case RideMetric::Total:
+            case RideMetric::RunningTotal:
+                d.value += value;
+                break;
+            case RideMetric::Peak:
+                if (first || value > d.value) d.value = value;
+                break;
+            case RideMetric::Low:
+                if (first || value < d.value) d.value = value;
+                break;
+            }
+
+            // update map
+            data.insert(category, d);
+        }
+
+        QString symbol, meta;
+        int type;
+        bool aggregateZero, useMetricUnits;
+        QMap<QString, aggregator> data;
+};
+
 void
 DonutOverviewItem::setDateRange(DateRange dr)
 {
-    if (!metric) return; // avoid crashes when metric is not available
+    accumulate(this, dr);
+}
+
+ChartSpaceAccumulator *
+DonutOverviewItem::accumulator(DateRange dr)
+{
+    if (!metric) return NULL; // avoid crashes when metric is not available
+
+    DonutAccumulator *accumulator = new DonutAccumulator(symbol, meta, metric);
+    accumulator->spec.setDateRange(dr);
+    setFilter(this, accumulator->spec);
+    return accumulator;
+}
+
+void
+DonutOverviewItem::setAccumulated(ChartSpaceAccumulator *p)
+{
+    const QMap<QString, aggregator> &data = static_cast<DonutAccumulator*>(p)->data;
 
     // stop any animation before starting, just in case- stops a crash
     // when we update a chart in the middle of its animation
@@ -998,67 +1140,6 @@ DonutOverviewItem::setDateRange(DateRange dr)
     // enable animation when setting values (disabled at all other times)
     if (chart) chart->setAnimationOptions(QChart::SeriesAnimations);
 
-    struct aggregator {
-        aggregator(double v, double c) : value(v), count(c) {}
-        double value, count;
-    };
-
-    Specification spec;
-    spec.setDateRange(dr);
-    setFilter(this, spec);
-
-    // aggregate sum and count etc
-    QMap<QString, aggregator> data;
-    foreach(RideItem *item, parent->context->athlete->rideCache->rides()) {
-
-        if (!spec.pass(item)) continue;
-
-        // get meta value
-        QString category = item->getText(meta, "");
-        aggregator d = data.value(category, aggregator(-1,-1));
-
-        // is this first time we've seen this meta value?
-        bool first = false;
-        if (d.value == -1 && d.count == -1) {
-            first = true;
-            d.value=0;
-            d.count=0;
-        }
-
-        // get metric value and count
-        double value = item->getForSymbol(symbol, GlobalContext::context()->useMetricUnits);
-        double count = item->getCountForSymbol(symbol);
-        if (count <= 0) count = 1;
-
-        // ignore zeroes when aggregating?
-        if (metric->aggregateZero() == false && value == 0) continue;
-
-        // what we gonna do with this?
-        switch(metric->type()) {
-        case RideMetric::StdDev:
-        case RideMetric::MeanSquareRoot:
-        case RideMetric::Average:
-            d.value = (d.value*d.count) + (value * count); // convert to sum
-            d.count += count;
-            d.value = d.value / d.count; // turn back to average
-            break;
-        case RideMetric::Total:
-        case RideMetric::RunningTotal:
-            d.value += value;
-            break;
-        case RideMetric::Peak:
-            if (first || value > d.value) d.value = value;
-            break;
-        case RideMetric::Low:
-            if (first || value < d.value) d.value = value;
-            break;
-            break;
-        }
-
-        // update map
-        data.insert(category, d);
-    }
-
     // now create a sorted list of values
     values.clear();
 
@@ -1158,103 +1239,123 @@ DonutOverviewItem::hoverSlice(QPieSlice *slice, bool state)
     update();
 }
 
-void
-ZoneOverviewItem::setDateRange(DateRange dr)
+// time in zone summed over the date range
+class ZoneAccumulator : public ChartSpaceAccumulator
 {
-    QVector<double> vals(10); // max 10 seems ok
-    vals.fill(0);
+    public:
+        ZoneAccumulator(Context *context, RideFile::seriestype series, int categories) :
+            context(context), series(series), categories(categories), vals(10) { vals.fill(0); } // max 10 seems ok
 
-    // stop any animation before starting, just in case- stops a crash
-    // when we update a chart in the middle of its animation
-    if (chart) chart->setAnimationOptions(QChart::NoAnimation);;
+        void add(RideItem *item) {
 
-    // enable animation when setting values (disabled at all other times)
-    if (chart) chart->setAnimationOptions(QChart::SeriesAnimations);
+            switch(series) {
 
-    Specification spec;
-    spec.setDateRange(dr);
-    setFilter(this, spec);
+                //
+                // HEARTRATE
+                //
+                case RideFile::hr:
+                {
+                    if (context->athlete->hrZones(item->isRun)) {
 
-    // aggregate sum and count etc
-    foreach(RideItem *item, parent->context->athlete->rideCache->rides()) {
+                        int numhrzones;
+                        int hrrange = context->athlete->hrZones(item->isRun)->whichRange(item->dateTime.date());
 
-        if (!spec.pass(item)) continue;
+                        if (hrrange > -1) {
 
-        switch(series) {
-
-            //
-            // HEARTRATE
-            //
-            case RideFile::hr:
-            {
-                if (parent->context->athlete->hrZones(item->isRun)) {
-
-                    int numhrzones;
-                    int hrrange = parent->context->athlete->hrZones(item->isRun)->whichRange(item->dateTime.date());
-
-                    if (hrrange > -1) {
-
-                        numhrzones = parent->context->athlete->hrZones(item->isRun)->numZones(hrrange);
-                        for(int i=0; i<categories.count() && i < numhrzones;i++) {
-                            vals[i] += item->getForSymbol(timeInZonesHR[i]);
+                            numhrzones = context->athlete->hrZones(item->isRun)->numZones(hrrange);
+                            for(int i=0; i<categories && i < numhrzones;i++) {
+                                vals[i] += item->getForSymbol(timeInZonesHR[i]);
+                            }
                         }
                     }
                 }
-            }
-            break;
+                break;
 
-            //
-            // POWER
-            //
-            default:
-            case RideFile::watts:
-            {
-                if (parent->context->athlete->zones(item->isRun)) {
+                //
+                // POWER
+                //
+                default:
+                case RideFile::watts:
+                {
+                    if (context->athlete->zones(item->isRun)) {
 
-                    int numzones;
-                    int range = parent->context->athlete->zones(item->isRun)->whichRange(item->dateTime.date());
+                        int numzones;
+                        int range = context->athlete->zones(item->isRun)->whichRange(item->dateTime.date());
 
-                    if (range > -1) {
+                        if (range > -1) {
 
-                        numzones = parent->context->athlete->zones(item->isRun)->numZones(range);
-                        for(int i=0; i<categories.count() && i < numzones;i++) {
-                            vals[i] += item->getForSymbol(timeInZones[i]);
+                            numzones = context->athlete->zones(item->isRun)->numZones(range);
+                            for(int i=0; i<categories && i < numzones;i++) {
+                                vals[i] += item->getForSymbol(timeInZones[i]);
+                            }
                         }
                     }
                 }
-            }
-            break;
+                break;
 
-            //
-            // PACE
-            //
-            case RideFile::kph:
-            {
-                if ((item->isRun || item->isSwim) && parent->context->athlete->paceZones(item->isSwim)) {
+                //
+                // PACE
+                //
+                case RideFile::kph:
+                {
+                    if ((item->isRun || item->isSwim) && context->athlete->paceZones(item->isSwim)) {
 
-                    int numzones;
-                    int range = parent->context->athlete->paceZones(item->isSwim)->whichRange(item->dateTime.date());
+                        int numzones;
+                        int range = context->athlete->paceZones(item->isSwim)->whichRange(item->dateTime.date());
 
-                    if (range > -1) {
+                        if (range > -1) {
 
-                        numzones = parent->context->athlete->paceZones(item->isSwim)->numZones(range);
-                        for(int i=0; i<categories.count() && i < numzones;i++) {
-                            vals[i] += item->getForSymbol(paceTimeInZones[i]);
+                            numzones = context->athlete->paceZones(item->isSwim)->numZones(range);
+                            for(int i=0; i<categories && i < numzones;i++) {
+                                vals[i] += item->getForSymbol(paceTimeInZones[i]);
+                            }
                         }
                     }
                 }
-            }
-            break;
+                break;
 
-            case RideFile::wbal:
-            {
-                for(int i=0; i<4; i++) {
-                    vals[i] += item->getForSymbol(timeInZonesWBAL[i]);
+                case RideFile::wbal:
+                {
+                    for(int i=0; i<4; i++) {
+                        vals[i] += item->getForSymbol(timeInZonesWBAL[i]);
+                    }
                 }
+                break;
             }
-            break;
         }
-    }
+
+        Context *context;
+        RideFile::seriestype series;
+        int categories;
+        QVector<double> vals;
+};
+
+void
+ZoneOverviewItem::setDateRange(DateRange dr)
+{
+    accumulate(this, dr);
+}
+
+ChartSpaceAccumulator *
+ZoneOverviewItem::accumulator(DateRange dr)
+{
+    ZoneAccumulator *accumulator = new ZoneAccumulator(parent->context, series, categories.count());
+    accumulator->spec.setDateRange(dr);
+    setFilter(this, accumulator->spec);
+    return accumulator;
+}
+
+void
+ZoneOverviewItem::setAccumulated(ChartSpaceAccumulator *p)
+{
+    const QVector<double> &vals = static_cast<ZoneAccumulator*>(p)->vals;
+
+    // stop any animation before starting, just in case- stops a crash
+    // when we update a chart in the middle of its animation
+    if (chart) chart->setAnimationOptions(QChart::NoAnimation);;
+
+    // enable animation when setting values (disabled at all other times)
+    if (chart) chart->setAnimationOptions(QChart::SeriesAnimations);
 
     // now update the barset converting to percentages
     double sum=0;
@@ -1425,8 +1526,63 @@ RouteOverviewItem::setData(RideItem *item)
     }
 }
 
+// bubbles for each activity in the date range
+class IntervalAccumulator : public ChartSpaceAccumulator
+{
+    public:
+        IntervalAccumulator(QString xsymbol, QString ysymbol, QString zsymbol, bool xdate, bool ydate) :
+            xsymbol(xsymbol), ysymbol(ysymbol), zsymbol(zsymbol), xdate(xdate), ydate(ydate),
+            useMetricUnits(GlobalContext::context()->useMetricUnits),
+            minx(0), maxx(0), miny(0), maxy(0), xoff(0), yoff(0), first(true) {}
+
+        void add(RideItem *item) {
+
+            // get the x and y VALUE
+            double x = item->getForSymbol(xsymbol, useMetricUnits);
+            double y = item->getForSymbol(ysymbol, useMetricUnits);
+            double z = item->getForSymbol(zsymbol, useMetricUnits);
+
+            // truncate dates and use offsets
+            if (first && xdate)  xoff = x;
+            if (first && ydate)  yoff = y;
+            x -= xoff;
+            y -= yoff;
+
+            BPointF add;
+            add.x = x;
+            add.xoff = xoff;
+            add.y = y;
+            add.yoff = yoff;
+            add.z = z;
+            add.fill = item->color;
+            add.item = item; // for click thru
+            add.label = item->getText("Workout Code","blank");
+            points << add;
+
+            if (first || x<minx) minx=x;
+            if (first || y<miny) miny=y;
+            if (first || x>maxx) maxx=x;
+            if (first || y>maxy) maxy=y;
+            first = false;
+        }
+
+        QString xsymbol, ysymbol, zsymbol;
+        bool xdate, ydate, useMetricUnits;
+
+        QList<BPointF> points;
+        double minx, maxx, miny, maxy;
+        double xoff, yoff;
+        bool first;
+};
+
 void
 IntervalOverviewItem::setDateRange(DateRange dr)
+{
+    accumulate(this, dr);
+}
+
+ChartSpaceAccumulator *
+IntervalOverviewItem::accumulator(DateRange dr)
 {
     // for metrics lets truncate to today
     if (dr.to > QDate::currentDate()) dr.to = QDate::currentDate();
@@ -1438,54 +1594,27 @@ IntervalOverviewItem::setDateRange(DateRange dr)
     ydp = ym->precision();
     bubble->setAxisNames(xm ? xm->name() : "NA", ym ? ym->name() : "NA");
 
-    Specification spec;
-    spec.setDateRange(dr);
-    setFilter(this, spec);
-
-    double minx = 0;
-    double maxx = 0;
-    double miny = 0;
-    double maxy = 0;
-    double xoff = 0;
-    double yoff = 0;
-    bool first=true;
-
-    QList<BPointF> points;
-    foreach(RideItem *item, parent->context->athlete->rideCache->rides()) {
-
-        if (!spec.pass(item)) continue;
-
-
-        // get the x and y VALUE
-        double x = item->getForSymbol(xsymbol, GlobalContext::context()->useMetricUnits);
-        double y = item->getForSymbol(ysymbol, GlobalContext::context()->useMetricUnits);
-        double z = item->getForSymbol(zsymbol, GlobalContext::context()->useMetricUnits);
-
-        // truncate dates and use offsets
-        if (first && xm->isDate())  xoff = x;
-        if (first && ym->isDate())  yoff = y;
-        x -= xoff;
-        y -= yoff;
+    IntervalAccumulator *accumulator = new IntervalAccumulator(xsymbol, ysymbol, zsymbol, xm->isDate(), ym->isDate());
+    accumulator->spec.setDateRange(dr);
+    setFilter(this, accumulator->spec);
+    return accumulator;
+}
 
-        BPointF add;
-        add.x = x;
-        add.xoff = xoff;
-        add.y = y;
-        add.yoff = yoff;
-        add.z = z;
-        add.fill = item->color;
-        add.item = item; // for click thru
-        if (add.fill.red() == 1 && add.fill.green() == 1 && add.fill.blue() == 1) add.fill = GColor(CPLOTMARKER);
-        add.label = item->getText("Workout Code","blank");
-        points << add;
+void
+IntervalOverviewItem::setAccumulated(ChartSpaceAccumulator *p)
+{
+    IntervalAccumulator *accumulated = static_cast<IntervalAccumulator*>(p);
 
-        if (first || x<minx) minx=x;
-        if (first || y<miny) miny=y;
-        if (first || x>maxx) maxx=x;
-        if (first || y>maxy) maxy=y;
-        first = false;
+    QList<BPointF> points = accumulated->points;
+    for(int i=0; i<points.count(); i++) {
+        QColor &fill = points[i].fill;
+        if (fill.red() == 1 && fill.green() == 1 && fill.blue() == 1) fill = GColor(CPLOTMARKER);
     }
 
+    double minx = accumulated->minx;
+    double maxx = accumulated->maxx;
+    double miny = accumulated->miny;
+    double maxy = accumulated->maxy;
 
     // set scale
     double ydiff = (maxy-miny) / 10.0f;
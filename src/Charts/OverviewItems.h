@@ -161,6 +161,9 @@ class MetricOverviewItem : public ChartSpaceItem
         void itemGeometryChanged();
         void setData(RideItem *item);
         void setDateRange(DateRange);
+        ChartSpaceAccumulator *accumulator(DateRange);
+        void setAccumulated(ChartSpaceAccumulator *);
+        QString dataKey() const { return symbol; }
         QWidget *config() { return new OverviewItemConfig(this); }
 
         // create and config
@@ -217,6 +220,9 @@ class TopNOverviewItem : public ChartSpaceItem
         void itemGeometryChanged();
         void setData(RideItem *) {} // doesn't support analysis view
         void setDateRange(DateRange);
+        ChartSpaceAccumulator *accumulator(DateRange);
+        void setAccumulated(ChartSpaceAccumulator *);
+        QString dataKey() const { return symbol; }
         QRectF hotspot();
         QWidget *config() { return new OverviewItemConfig(this); }
 
@@ -305,6 +311,9 @@ class ZoneOverviewItem : public ChartSpaceItem
         void itemGeometryChanged();
         void setData(RideItem *item);
         void setDateRange(DateRange);
+        ChartSpaceAccumulator *accumulator(DateRange);
+        void setAccumulated(ChartSpaceAccumulator *);
+        QString dataKey() const { return QString::number(series); }
         void dragChanged(bool x);
         QWidget *config() { return new OverviewItemConfig(this); }
 
@@ -341,6 +350,9 @@ class DonutOverviewItem : public ChartSpaceItem
         void itemGeometryChanged();
         void setData(RideItem *) {} // trends view only
         void setDateRange(DateRange);
+        ChartSpaceAccumulator *accumulator(DateRange);
+        void setAccumulated(ChartSpaceAccumulator *);
+        QString dataKey() const { return symbol + "|" + meta; }
         void dragChanged(bool x);
         QWidget *config() { return new OverviewItemConfig(this); }
 
@@ -399,6 +411,9 @@ class IntervalOverviewItem : public ChartSpaceItem
         void itemGeometryChanged();
         void setData(RideItem *item);
         void setDateRange(DateRange);
+        ChartSpaceAccumulator *accumulator(DateRange);
+        void setAccumulated(ChartSpaceAccumulator *);
+        QString dataKey() const { return xsymbol + "|" + ysymbol + "|" + zsymbol; }
         QWidget *config() { return new OverviewItemConfig(this); }
 
         // create and config
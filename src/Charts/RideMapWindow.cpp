@@ -38,6 +38,10 @@
 
 #include <QtWebChannel>
 #include <QWebEngineView>
+#include <QDataStream>
+
+#include <algorithm>
+#include <limits>
 #include <QWebEngineSettings>
 
 // overlay helper
@@ -47,7 +51,7 @@
 #include <QDebug>
 
 RideMapWindow::RideMapWindow(Context *context, int mapType) : GcChartWindow(context), context(context),
-                                                       range(-1), current(NULL), firstShow(true), stale(false)
+                                                       range(-1), current(NULL), firstShow(true), routeTree(NULL), stale(false)
 {
     //
     // Chart settings
@@ -173,6 +177,7 @@ RideMapWindow::RideMapWindow(Context *context, int mapType) : GcChartWindow(cont
 RideMapWindow::~RideMapWindow()
 {
     delete webBridge;
+    delete routeTree;
 }
 
 void
@@ -351,19 +356,9 @@ void RideMapWindow::createHtml()
 {
     RideItem * ride = myRideItem;
     currentPage = "";
-    double minLat, minLon, maxLat, maxLon;
-    minLat = minLon = 1000;
-    maxLat = maxLon = -1000; // larger than 360
 
-    // get bounding co-ordinates for ride
-    foreach(RideFilePoint *rfp, myRideItem->ride()->dataPoints()) {
-        if (rfp->lat || rfp->lon) {
-            minLat = std::min(minLat,rfp->lat);
-            maxLat = std::max(maxLat,rfp->lat);
-            minLon = std::min(minLon,rfp->lon);
-            maxLon = std::max(maxLon,rfp->lon);
-        }
-    }
+    // get bounding co-ordinates, simplification and index for ride
+    buildRoute();
 
     // No GPS data, so sorry no map
     QColor bgColor = GColor(CPLOTBACKGROUND);
@@ -427,14 +422,43 @@ void RideMapWindow::createHtml()
     "var markerList;\n"  // array of markers
     "var polyList;\n"  // array of polylines
     "var tmpIntervalHighlighter;\n"  // temp interval
+    "var route;\n"  // the route polyline
+    "var shadedList = new Array();\n"  // shaded route polylines
+    "var shaded = false;\n"  // draw shaded route when zooming
+
+    // zoom before the map has settled is undefined
+    "function mapZoom() {\n"
+    "   var zoom = map.getZoom();\n"
+    "   return (zoom === undefined) ? -1 : zoom;\n"
+    "}\n"
+
+    // routes are sent as base64 encoded Int32Array of
+    // lat/lon pairs in 1e-7 degrees, much smaller than
+    // a list of doubles or generated javascript
+    "function decodeLatLons(encoded) {\n"
+    "   var bytes = atob(encoded);\n"
+    "   var buffer = new ArrayBuffer(bytes.length);\n"
+    "   var view = new Uint8Array(buffer);\n"
+    "   for (var i=0; i<bytes.length; i++) view[i] = bytes.charCodeAt(i);\n"
+    "   var ints = new Int32Array(buffer);\n"
+    "   var latlons = new Float64Array(ints.length);\n"
+    "   for (var i=0; i<ints.length; i++) latlons[i] = ints[i] / 10000000;\n"
+    "   return latlons;\n"
+    "}\n"
 
     // Draw the entire route, we use a local webbridge
     // to supply the data to a) reduce bandwidth and
     // b) allow local manipulation. This makes the UI
-    // considerably more 'snappy'
+    // considerably more 'snappy'. The route is simplified
+    // for the zoom level and redrawn when zooming.
     "function drawRoute() {\n"
     // load the GPS co-ordinates
-    "   webBridge.getLatLons(0, drawRouteForLatLons);\n"
+    "   webBridge.getRoute(mapZoom(), function(encoded) { drawRouteForLatLons(decodeLatLons(encoded)); });\n"
+    "}\n"
+    "\n"
+
+    "function drawShadedRoute() {\n"
+    "   webBridge.getShadedRoute(mapZoom(), drawShadedForRoute);\n"
     "}\n"
     "\n");
 
@@ -462,7 +486,10 @@ void RideMapWindow::createHtml()
             "        j += 2;\n"
             "    };\n"
 
+            // replaces the route drawn at the last zoom level
+            "    if (route) map.removeLayer(route);\n"
             "    var routeYellow = new L.Polyline(path, routeOptionsYellow).addTo(map);\n"
+            "    route = routeYellow;\n"
 
             // Listen mouse events
             "routeYellow.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n" // map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true});
@@ -472,6 +499,30 @@ void RideMapWindow::createHtml()
 
             "}\n").arg(styleoptions == "" ? "#FFFF00" : GColor(CPLOTMARKER).name())
                   .arg(styleoptions == "" ? 0.4 : 1.0);
+
+        // shaded route, a polyline per segment
+        currentPage += QString("function drawShadedForRoute(shade) {\n"
+            "    while (shadedList.length) map.removeLayer(shadedList.pop());\n"
+            "    var latlons = decodeLatLons(shade.route);\n"
+            "    var from = 0;\n"
+            "    for (var s=0; s<shade.breaks.length; s++) {\n"
+            "        var path = [];\n"
+            "        for (var j=from; j<shade.breaks[s]; j++) path.push([latlons[j*2], latlons[j*2+1]]);\n"
+            "        from = shade.breaks[s];\n"
+            "        var polyOptions = {\n"
+            "            stroke: true,\n"
+            "            color: shade.colors[s],\n"
+            "            weight: 3,\n"
+            "            opacity: shade.opacity,\n" // for out and backs, we need both
+            "            zIndex: 0\n"
+            "        };\n"
+            "        var polyline = new L.Polyline(path, polyOptions).addTo(map);\n"
+            "        polyline.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n"
+            "        polyline.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event);webBridge.mouseup(); });\n"
+            "        polyline.on('mouseover', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
+            "        shadedList.push(polyline);\n"
+            "    }\n"
+            "}\n");
     }
     else if (mapCombo->currentIndex() == GOOGLE) {
 
@@ -488,9 +539,12 @@ void RideMapWindow::createHtml()
            "        zIndex: -2\n"
            "    };\n"
 
-           // create the route Polyline
+           // create the route Polyline, replacing the
+           // route drawn at the last zoom level
+           "    if (route) route.setMap(null);\n"
            "    var routeYellow = new google.maps.Polyline(routeOptionsYellow);\n"
            "    routeYellow.setMap(map);\n"
+           "    route = routeYellow;\n"
 
            // lastly, populate the route path
            "    var path = routeYellow.getPath();\n"
@@ -507,6 +561,30 @@ void RideMapWindow::createHtml()
 
            "}\n").arg(styleoptions == "" ? "#FFFF00" : GColor(CPLOTMARKER).name())
                  .arg(styleoptions == "" ? 0.4f : 1.0f);
+
+       // shaded route, a polyline per segment
+       currentPage += QString("function drawShadedForRoute(shade) {\n"
+           "    while (shadedList.length) shadedList.pop().setMap(null);\n"
+           "    var latlons = decodeLatLons(shade.route);\n"
+           "    var from = 0;\n"
+           "    for (var s=0; s<shade.breaks.length; s++) {\n"
+           "        var polyOptions = {\n"
+           "            strokeColor: shade.colors[s],\n"
+           "            strokeWeight: 3,\n"
+           "            strokeOpacity: shade.opacity,\n" // for out and backs, we need both
+           "            zIndex: 0,\n"
+           "        }\n"
+           "        var polyline = new google.maps.Polyline(polyOptions);\n"
+           "        polyline.setMap(map);\n"
+           "        var path = polyline.getPath();\n"
+           "        for (var j=from; j<shade.breaks[s]; j++) path.push(new google.maps.LatLng(latlons[j*2], latlons[j*2+1]));\n"
+           "        from = shade.breaks[s];\n"
+           "        google.maps.event.addListener(polyline, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
+           "        google.maps.event.addListener(polyline, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
+           "        google.maps.event.addListener(polyline, 'mouseover', function(event) { webBridge.hoverPath(event.latLng.lat(), event.latLng.lng()); });\n"
+           "        shadedList.push(polyline);\n"
+           "    }\n"
+           "}\n");
     }
 
     currentPage += QString("function drawIntervals() { \n"
@@ -614,6 +692,9 @@ void RideMapWindow::createHtml()
                                // Liste mouse events
                                "    map.on('mouseup', function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event); webBridge.mouseup(); });\n"
 
+                               // more or less detail as we zoom
+                               "    map.on('zoomend', function(event) { drawRoute(); if (shaded) drawShadedRoute(); });\n"
+
 
                                "}\n"
                                "</script>\n");
@@ -718,6 +799,9 @@ void RideMapWindow::createHtml()
             // Liste mouse events
             "    google.maps.event.addListener(map, 'mouseup', function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
 
+            // more or less detail as we zoom
+            "    google.maps.event.addListener(map, 'zoom_changed', function() { drawRoute(); if (shaded) drawShadedRoute(); });\n"
+
 
             "}\n"
             "</script>\n");
@@ -742,40 +826,36 @@ QColor RideMapWindow::GetColor(int watts)
 void
 RideMapWindow::drawShadedRoute()
 {
+    // the page fetches the segments from the web bridge
+    // and redraws them as the zoom level changes
+    view->page()->runJavaScript(QString("shaded = true;\n"
+                                        "drawShadedRoute();\n"));
+}
+
+QVariantMap
+RideMapWindow::shadedRoute(int zoom)
+{
+    QVariantMap returning;
+    if (!myRideItem || !myRideItem->ride() || routeIndex.count() == 0) return returning;
+
+    const QVector<RideFilePoint*> &points = myRideItem->ride()->dataPoints();
+    double tolerance = routeTolerance(zoom);
+
     int intervalTime = 60;  // 60 seconds
     double rtime=0; // running total for accumulated data
     int count=0;  // how many samples ?
     int rwatts=0; // running total of watts
     double prevtime=0; // time for previous point
 
-    QString code;
+    QVector<int> keep, segment;
+    QVariantList breaks;
+    QStringList colors;
+    int next=0; // next gps point in routeIndex
 
-    foreach(RideFilePoint *rfp, myRideItem->ride()->dataPoints()) {
-        if (mapCombo->currentIndex() == OSM) {
-            // Get GPS coordinates.
-            if (count == 0) {
-                // Start of segment.
-                code = QString("{\n"
-                               "var latLons = [");
-            }
+    for(int i=0; i<points.count(); i++) {
 
-            if (rfp->lat || rfp->lon)
-                code += QString("[%1, %2], ").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-        } else if (mapCombo->currentIndex() == GOOGLE) {
-            if (count == 0) {
-                code = QString("{\nvar polyline = new google.maps.Polyline();\n"
-                       "   polyline.setMap(map);\n"
-                       "   path = polyline.getPath();\n");
-
-                // Listen mouse events
-                code += QString("google.maps.event.addListener(polyline, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
-                                "google.maps.event.addListener(polyline, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
-                                "google.maps.event.addListener(polyline, 'mouseover', function(event) { webBridge.hoverPath(event.latLng.lat(), event.latLng.lng()); });\n");
-            } else {
-                if (rfp->lat || rfp->lon)
-                    code += QString("path.push(new google.maps.LatLng(%1,%2));\n").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-            }
-        }
+        RideFilePoint *rfp = points[i];
+        if (next < routeIndex.count() && routeIndex[next] == i) segment << next++;
 
         // running total of time
         rtime += rfp->secs - prevtime;
@@ -785,52 +865,195 @@ RideMapWindow::drawShadedRoute()
 
         // end of segment
         if (rtime >= intervalTime) {
-            if (mapCombo->currentIndex() == OSM) {
-                // Finalize variable "latLons" for the segment.
-                if (code.endsWith(", "))
-                    code.resize(code.length() - 2);
-                code += QString("];\n");
-            }
+
+            // simplified, but keep the ends so segments join up
+            for(int j=0; j<segment.count(); j++)
+                if (j == 0 || j == segment.count()-1 || routeError[segment[j]] >= tolerance)
+                    keep << routeIndex[segment[j]];
 
             int avgWatts = rwatts / count;
-            QColor color = GetColor(avgWatts);
-            // thats this segment done, so finish off and
-            // add tooltip junk
+            breaks << keep.count();
+            colors << (styleoptions == "" ? GetColor(avgWatts).name() : GColor(CPLOTMARKER).name());
+
+            // thats this segment done
             count = rwatts = rtime = 0;
+            segment.clear();
+        }
+    }
 
-            if (mapCombo->currentIndex() == OSM) {
-                // Create and color a polyline for the segment.
-                code += QString("var polyOptions = {\n"
-                                "    stroke: true,\n"
-                                "    color: '%1',\n"
-                                "    weight: 3,\n"
-                                "    opacity: %2,\n" // for out and backs, we need both
-                                "    zIndex: 0\n"
-                                "};\n"
-                                "var polyline = new L.Polyline(latLons, polyOptions).addTo(map);\n"
-                                "polyline.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n" // map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true});
-                                "polyline.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event);webBridge.mouseup(); });\n" // setOptions ?
-                                "polyline.on('mouseover', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
-                                "path = polyline.getLatLngs();\n"
-                                "}\n").arg(styleoptions == "" ? color.name() : GColor(CPLOTMARKER).name())
-                                .arg(styleoptions == "" ? 0.5 : 1.0);
-            } else if (mapCombo->currentIndex() == GOOGLE) {
-                // color the polyline
-                code += QString("var polyOptions = {\n"
-                                "    strokeColor: '%1',\n"
-                                "    strokeWeight: 3,\n"
-                                "    strokeOpacity: %2,\n" // for out and backs, we need both
-                                "    zIndex: 0,\n"
-                                "}\n"
-                                "polyline.setOptions(polyOptions);\n"
-                                "}\n").arg(styleoptions == "" ? color.name() : GColor(CPLOTMARKER).name())
-                                      .arg(styleoptions == "" ? 0.5f : 1.0f);
+    returning.insert("route", encodeLatLons(myRideItem->ride(), keep));
+    returning.insert("breaks", breaks);
+    returning.insert("colors", colors);
+    returning.insert("opacity", styleoptions == "" ? 0.5 : 1.0);
+    return returning;
+}
+
+//
+// Route simplification and lookup
+//
+// Long rides have tens of thousands of GPS points, far more than can be
+// seen at most zoom levels. We run Douglas-Peucker once per ride, but
+// rather than using a single tolerance we record the tolerance at which
+// each point would be dropped (bounded by its parent so the pyramid is
+// consistent). Any zoom level is then a single pass over that array.
+//
+void
+RideMapWindow::buildRoute()
+{
+    routeIndex.clear();
+    routeError.clear();
+    delete routeTree;
+    routeTree = NULL;
+
+    minLat = minLon = 1000;
+    maxLat = maxLon = -1000; // larger than 360
+    routeCos = 1;
 
+    if (!myRideItem || !myRideItem->ride()) return;
+
+    // get bounding co-ordinates for ride
+    const QVector<RideFilePoint*> &points = myRideItem->ride()->dataPoints();
+    for(int i=0; i<points.count(); i++) {
+        RideFilePoint *rfp = points[i];
+        if (rfp->lat || rfp->lon) {
+            minLat = std::min(minLat,rfp->lat);
+            maxLat = std::max(maxLat,rfp->lat);
+            minLon = std::min(minLon,rfp->lon);
+            maxLon = std::max(maxLon,rfp->lon);
+            routeIndex << i;
+        }
+    }
+
+    int n = routeIndex.count();
+    if (n == 0) return;
+
+    // scale longitude so distances are roughly even
+    routeCos = cos((minLat + maxLat) / 2.0 * M_PI / 180.0);
+
+    // end points are always kept
+    routeError.fill(0, n);
+    routeError[0] = routeError[n-1] = std::numeric_limits<double>::max();
+
+    // iterative, long rides would blow the stack
+    struct span { int first, last; double bound; };
+    QVector<span> todo;
+    todo << span { 0, n-1, std::numeric_limits<double>::max() };
+
+    while (!todo.isEmpty()) {
+
+        span s = todo.takeLast();
+        if (s.last - s.first < 2) continue;
+
+        RideFilePoint *a = points[routeIndex[s.first]];
+        RideFilePoint *b = points[routeIndex[s.last]];
+        double dx = (b->lon - a->lon) * routeCos;
+        double dy = b->lat - a->lat;
+        double len2 = dx*dx + dy*dy;
+
+        // furthest point from the line a-b
+        int worst = s.first+1;
+        double worstd = -1;
+        for(int k=s.first+1; k<s.last; k++) {
+            RideFilePoint *p = points[routeIndex[k]];
+            double px = (p->lon - a->lon) * routeCos;
+            double py = p->lat - a->lat;
+            if (len2 > 0) {
+                double t = qBound(0.0, (px*dx + py*dy) / len2, 1.0);
+                px -= t*dx;
+                py -= t*dy;
             }
-            view->page()->runJavaScript(code);
+            double d = px*px + py*py;
+            if (d > worstd) { worstd = d; worst = k; }
         }
+
+        double error = std::min(sqrt(worstd), s.bound);
+        routeError[worst] = error;
+        todo << span { s.first, worst, error } << span { worst, s.last, error };
+    }
+
+    // spatial index for hover and click, padded by the smallest pick box
+    // so a due N-S or E-W route, or a stationary ride, still has an area
+    const double pad = 0.0001;
+    routeTree = new Quadtree(QPointF(minLon-pad, minLat-pad), QPointF(maxLon+pad, maxLat+pad));
+    for(int i=0; i<n; i++) {
+        RideFilePoint *p = points[routeIndex[i]];
+        routeTree->insert(GPointF(p->lon, p->lat, routeIndex[i]));
     }
+}
 
+double
+RideMapWindow::routeTolerance(int zoom) const
+{
+    // all points, or a pixel at this zoom (256 pixel tiles, web mercator)
+    if (zoom < 0) return 0;
+    return 360.0 * routeCos / (256.0 * pow(2.0, zoom));
+}
+
+QVector<int>
+RideMapWindow::routePoints(int zoom)
+{
+    QVector<int> returning;
+    double tolerance = routeTolerance(zoom);
+    for(int i=0; i<routeIndex.count(); i++)
+        if (routeError[i] >= tolerance) returning << routeIndex[i];
+    return returning;
+}
+
+QString
+RideMapWindow::encodeLatLons(RideFile *ride, const QVector<int> &points)
+{
+    // Int32Array of lat/lon pairs in 1e-7 degrees
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    foreach(int i, points) {
+        RideFilePoint *p = ride->dataPoints()[i];
+        stream << (qint32)qRound(p->lat * 10000000.0) << (qint32)qRound(p->lon * 10000000.0);
+    }
+    return QString::fromLatin1(bytes.toBase64());
+}
+
+QList<RideFilePoint*>
+RideMapWindow::nearestPoints(double lat, double lng)
+{
+    QList<RideFilePoint*> list;
+    if (!routeTree || !myRideItem || !myRideItem->ride()) return list;
+
+    const QVector<RideFilePoint*> &points = myRideItem->ride()->dataPoints();
+
+    // look close by, but widen the search when the cursor
+    // is on a simplified stretch of route away from samples
+    QList<GPointF> found;
+    double box = 0.0001;
+    while (true) {
+        routeTree->candidates(QRectF(QPointF(lng-box, lat-box), QPointF(lng+box, lat+box)), found);
+        if (found.count() || box > 0.01) break;
+        box *= 2;
+    }
+
+    // in time order
+    QVector<int> indexes;
+    foreach(GPointF p, found) indexes << p.index;
+    std::sort(indexes.begin(), indexes.end());
+
+    // each time the route passes through, use the last sample
+    int covered = -1;
+    foreach(int index, indexes) {
+
+        if (index <= covered) continue;
+
+        int last = index;
+        for(int j=index+1; j<points.count(); j++) {
+            RideFilePoint *p = points[j];
+            if (p->lat == 0 && p->lon == 0) continue;
+            if (fabs(p->lat-lat) < box && fabs(p->lon-lng) < box) last = j;
+            else break;
+        }
+        covered = last;
+        list.append(points[last]);
+    }
+    return list;
 }
 
 void
@@ -1217,6 +1440,22 @@ MapWebBridge::getLatLons(int i)
     return latlons;
 }
 
+// simplified route for the zoom level
+QString
+MapWebBridge::getRoute(int zoom)
+{
+    RideItem *rideItem = mw->property("ride").value<RideItem*>();
+    if (!rideItem || !rideItem->ride()) return QString();
+
+    return RideMapWindow::encodeLatLons(rideItem->ride(), mw->routePoints(zoom));
+}
+
+QVariantMap
+MapWebBridge::getShadedRoute(int zoom)
+{
+    return mw->shadedRoute(zoom);
+}
+
 // once the basic map and route have been marked, overlay markers, shaded areas etc
 void
 MapWebBridge::drawOverlays()
@@ -1288,26 +1527,8 @@ MapWebBridge::clearHover()
 QList<RideFilePoint*>
 MapWebBridge::searchPoint(double lat, double lng)
 {
-    QList<RideFilePoint*> list;
-
-    RideItem *rideItem = mw->property("ride").value<RideItem*>();
-
-    RideFilePoint *candidat = NULL;
-    foreach (RideFilePoint *p1, rideItem->ride()->dataPoints()) {
-        if (p1->lat == 0 && p1->lon == 0)
-            continue;
-
-        if (((p1->lat-lat> 0 && p1->lat-lat< 0.0001) || (p1->lat-lat< 0 && p1->lat-lat> -0.0001)) &&
-            ((p1->lon-lng> 0 && p1->lon-lng< 0.0001) || (p1->lon-lng< 0 && p1->lon-lng> -0.0001))) {
-            // Verifie distance avec dernier candidat
-            candidat = p1;
-        } else if (candidat)  {
-            list.append(candidat);
-            candidat = NULL;
-        }
-    }
-
-    return list;
+    // spatial index, rather than checking every sample
+    return mw->nearestPoints(lat, lng);
 }
 
 void
@@ -32,6 +32,7 @@
 #include "RideFile.h"
 #include "IntervalItem.h"
 #include "Context.h"
+#include "Quadtree.h"
 
 #include <QDialog>
 
@@ -79,6 +80,11 @@ class MapWebBridge : public QObject
         Q_INVOKABLE int intervalCount();
         Q_INVOKABLE QVariantList getLatLons(int i); // get array of latitudes for highlighted n
 
+        // simplified route for the zoom level, base64 encoded Int32Array
+        Q_INVOKABLE QString getRoute(int zoom);
+        // as above, with segment breaks and colors for the shaded route
+        Q_INVOKABLE QVariantMap getShadedRoute(int zoom);
+
         // once map and basic route is loaded
         // this slot is called to draw additional
         // overlays e.g. shaded route, markers
@@ -149,6 +155,17 @@ class RideMapWindow : public GcChartWindow
         QString googleKey() const { return gkey->text(); }
         void setGoogleKey(QString x) { gkey->setText(x); }
 
+        // route geometry, simplified for the zoom level (-1 for all points)
+        // the indexes into dataPoints() of the points kept are returned
+        QVector<int> routePoints(int zoom);
+        static QString encodeLatLons(RideFile *ride, const QVector<int> &points);
+
+        // shaded route segments for the zoom level
+        QVariantMap shadedRoute(int zoom);
+
+        // samples close to the lat/lng, the last sample of each pass
+        QList<RideFilePoint*> nearestPoints(double lat, double lng);
+
 
     public slots:
         void mapTypeSelected(int x);
@@ -201,6 +218,15 @@ class RideMapWindow : public GcChartWindow
         QColor GetColor(int watts);
         void createHtml();
 
+        // simplification pyramid and spatial index, once per ride
+        void buildRoute();
+        double routeTolerance(int zoom) const;
+        double minLat, minLon, maxLat, maxLon;
+        double routeCos;            // cos(latitude) to scale longitude
+        QVector<int> routeIndex;    // dataPoints() index of each GPS point
+        QVector<double> routeError; // tolerance at which the point is dropped
+        Quadtree *routeTree;        // lon/lat -> routeIndex
+
     private slots:
         void loadRide();
         void updateFrame();
@@ -25,14 +25,33 @@
 #include "RideFile.h"
 #include "RideFileCache.h"
 #include "CsvRideFile.h"
+#include "JsonRideFile.h"
+#include "TcxRideFile.h"
+#include "PwxRideFile.h"
 
 #include "Zones.h"
 #include "HrZones.h"
 #include "PaceZones.h"
 #include "Measures.h"
 
-#include <QTemporaryFile>
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "DataFilter.h"
+#include "Specification.h"
+#include "HeadlessRebuild.h"
+#include "MainWindow.h"
+
 #include <QFile>
+#include <QIODevice>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMap>
+#include <QSet>
+#include <QFileInfo>
+
+extern QStringList DataFiltererrors; // DataFilter.y
 
 void
 APIWebService::service(HttpRequest &request, HttpResponse &response)
@@ -92,6 +111,38 @@ APIWebService::athleteData(QStringList &paths, HttpRequest &request, HttpRespons
         QString athlete = paths[0];
         paths.removeFirst();
 
+        // GET ACTIVITIES
+        // http://localhost:12021/athlete/activity
+        // as multipart/mixed, one part per activity
+        // optional query parameters:
+        //      ?format=json    (default)
+        //      ?format=<xx>    xx = one of (csv, tcx, pwx)
+        //      ?since=yyyy/mm/dd
+        //      ?before=yyyy/mm/dd
+        //      ?filenames=<a,b,..> just these ones
+        if (paths[0] == "activity") {
+            listActivities(athlete, request, response);
+            return;
+        }
+
+        // QUERY
+        // http://localhost:12021/athlete/query?value=<expression>
+        // evaluated against the athlete's rides in memory, returns
+        // csv of period, value, count
+        // optional query parameters:
+        //      ?filter=<expression>    rides where it is non-zero
+        //      ?group=none             (default)
+        //      ?group=<xx>             xx = one of (day, week, month, year)
+        //      ?aggregate=sum          (default)
+        //      ?aggregate=<xx>         xx = one of (avg, max, min, count)
+        //      ?since=yyyy/mm/dd
+        //      ?before=yyyy/mm/dd
+        //      ?budget=<ms>            (default 10000, at most 60000)
+        if (paths[0] == "query") {
+            query(athlete, request, response);
+            return;
+        }
+
         // GET ZONES
         // http://localhost:12021/athlete/zones
         if (paths[0] == "zones") {
@@ -291,73 +342,234 @@ APIWebService::writeRideLine(RideItem &item, HttpRequest *request, HttpResponse
     }
 }
 
+// formats we convert activities to; tcx/pwx as xml, full csv (not powertap) and GC json
+static QStringList activityFormats()
+{
+    QStringList formats;
+    formats << "tcx"; // garmin training centre
+    formats << "csv"; // full csv list (not powertap)
+    formats << "json"; // gc json
+    formats << "pwx"; // gc json
+    return formats;
+}
+
+static QByteArray activityContentType(QString format)
+{
+    // the writers all write utf-8
+    if (format == "tcx") return "application/vnd.garmin.tcx+xml; charset=UTF-8";
+    if (format == "csv") return "text/csv; charset=UTF-8";
+    if (format == "pwx") return "application/vnd.trainingpeaks.pwx+xml; charset=UTF-8";
+    return "application/json; charset=UTF-8";
+}
+
+// largest converted activity we will keep, and all of them, in kbytes
+#define CONVERTED_MAX   (8*1024)
+#define CONVERTED_TOTAL (64*1024)
+
+// query results we keep, in kbytes, and time allowed for each in msecs
+#define QUERIES_TOTAL   (4*1024)
+#define QUERY_BUDGET    10000
+#define QUERY_BUDGET_MAX 60000
+
+// writes go out in the response body as they are made, rather than
+// being collected first, and are kept for the cache if not too big
+class ActivityResponseDevice : public QIODevice
+{
+    public:
+        ActivityResponseDevice(HttpResponse &response, QByteArray *keep) : response(response), keep(keep) {
+            open(QIODevice::WriteOnly);
+        }
+
+    protected:
+        qint64 readData(char *, qint64) { return -1; }
+        qint64 writeData(const char *data, qint64 len) {
+            QByteArray chunk(data, len);
+            response.bwrite(chunk);
+            if (keep && keep->size() + len > CONVERTED_MAX * 1024) {
+                keep->clear();
+                keep = NULL;
+            }
+            if (keep) keep->append(chunk);
+            return len;
+        }
+
+    private:
+        HttpResponse &response;
+        QByteArray *keep;
+};
+
+APIWebService::APIWebService(QDir home, QObject *parent) : HttpRequestHandler(parent), home(home)
+{
+    converted.setMaxCost(CONVERTED_TOTAL);
+    queries.setMaxCost(QUERIES_TOTAL);
+}
+
+QString
+APIWebService::activityFormat(HttpRequest &request)
+{
+    // what format to use ?
+    QString format(request.getParameter("format"));
+    if (format == "") {
+
+        // if not passed in the URL then is content type
+        // caller can accept listed in the header?
+        // there is probably a more complete way of handling
+        // wildcards etc, but the user can always force via     
+        // the format parameter in the URL
+        foreach(QByteArray accepts, request.getHeaders("Accept")) {
+            if (accepts == "application/json") format="json";
+            if (accepts == "text/csv") format="csv";
+            if (accepts == "application/vnd.garmin.tcx") format="tcx";
+            if (accepts == "application/vnd.trainingpeaks.pwx") format="pwx";
+            if (accepts == "application/xml" || accepts == "text/xml") format="tcx";
+            if (format != "") break;
+        }
+    }
+
+    // default to json
+    if (format == "") format = "json";
+
+    return format;
+}
+
+static QByteArray activityTag(QString format, qint64 a, qint64 b)
+{
+    return QString("\"%1-%2-%3\"").arg(a).arg(b).arg(format).toLatin1();
+}
+
+QMap<QString, QByteArray>
+APIWebService::activityTags(QString athlete, QStringList names, QString format)
+{
+    QMap<QString, QByteArray> tags;
+    QSet<QString> wanted = names.toSet();
+
+    // the ride cache already knows the crc of each activity and when it
+    // was refreshed, so we don't read them again. It belongs to the gui
+    // thread so we look over there, opening the athlete when running as
+    // a server, as we do for queries.
+    auto lookup = [&]() {
+
+        QString error;
+        Context *context = Context::find(athlete);
+        if (context == NULL && mainwindows.isEmpty()) context = HeadlessRebuild::open(home, athlete, error);
+        if (context == NULL) return;
+
+        foreach(RideItem *item, context->athlete->rideCache->rides()) {
+            if (item->planned || !wanted.contains(item->fileName)) continue;
+
+            // only if the file is still the one it was refreshed from
+            RideFileSignature now(QFileInfo(item->path + "/" + item->fileName));
+            if (!item->rideSignature.isValid() || item->rideSignature != now) continue;
+
+            tags.insert(item->fileName, activityTag(format, item->crc, item->timestamp));
+        }
+    };
+
+    if (QThread::currentThread() == thread()) lookup();
+    else QMetaObject::invokeMethod(this, lookup, Qt::BlockingQueuedConnection);
+
+    // anything it doesn't know about (yet) goes on size and modified time
+    QDir activities(QString("%1/%2/activities").arg(home.absolutePath()).arg(athlete));
+    foreach(QString name, names) {
+        if (tags.contains(name)) continue;
+        RideFileSignature signature(QFileInfo(activities.absoluteFilePath(name)));
+        tags.insert(name, activityTag(format, signature.size, signature.modified));
+    }
+    return tags;
+}
+
+bool
+APIWebService::writeActivity(QString filename, QString format, QByteArray tag, HttpResponse &response, QStringList &errors)
+{
+    // converted it already ?
+    QString key = filename + "|" + tag;
+    QByteArray cached;
+    {
+        QMutexLocker locker(&convertedMutex);
+        QByteArray *found = converted.object(key);
+        if (found) cached = *found;
+    }
+
+    if (!cached.isEmpty()) {
+        response.bwrite(cached);
+        return true;
+    }
+
+    // lets read the file in as a ridefile
+    QFile file(filename);
+    RideFile *f = RideFileFactory::instance().openRideFile(NULL, file, errors);
+    if (f == NULL) return false;
+
+    // and stream it out in the format requested
+    QByteArray *keep = new QByteArray;
+    ActivityResponseDevice out(response, keep);
+
+    if (format == "csv") {
+        CsvFileReader writer;
+        writer.toDevice(NULL, f, out, CsvFileReader::gc);
+    } else if (format == "tcx") {
+        TcxFileReader writer;
+        out.write(writer.toByteArray(NULL, f, true, true, true, true));
+    } else if (format == "pwx") {
+        PwxFileReader writer;
+        out.write(writer.toByteArray(NULL, f));
+    } else {
+        JsonFileReader writer;
+        writer.toDevice(NULL, f, out, true, true, true, true);
+    }
+    delete f;
+
+    // keep for next time, too big and keep was cleared
+    if (keep->size()) {
+        QMutexLocker locker(&convertedMutex);
+        converted.insert(key, keep, qMax(1, keep->size() / 1024));
+    } else delete keep;
+
+    return true;
+}
+
 void
 APIWebService::listActivity(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response)
 {
     // does it exist ?
     QString filename = QString("%1/%2/activities/%3").arg(home.absolutePath()).arg(athlete).arg(paths[0]);
 
-    QString contents;
     QFile file(filename);
-    if (file.exists() && file.open(QFile::ReadOnly | QFile::Text)) {
+    if (file.exists() && file.open(QFile::ReadOnly)) {
 
         // close as we will open properly below
         file.close();
 
         // what format to use ?
-        QString format(request.getParameter("format"));
-        if (format == "") {
-
-            // if not passed in the URL then is content type
-            // caller can accept listed in the header?
-            // there is probably a more complete way of handling
-            // wildcards etc, but the user can always force via     
-            // the format parameter in the URL
-            foreach(QByteArray accepts, request.getHeaders("Accept")) {
-                if (accepts == "application/json") format="json";
-                if (accepts == "text/csv") format="csv";
-                if (accepts == "application/vnd.garmin.tcx") format="tcx";
-                if (accepts == "application/vnd.trainingpeaks.pwx") format="pwx";
-                if (accepts == "application/xml" || accepts == "text/xml") format="tcx";
-                if (format != "") break;
-            }
-        }
-
-        // default to json
-        if (format == "") format = "json";
-
-        // lets go with tcx/pwx as xml, full csv (not powertap) and GC json
-        QStringList formats;
-        formats << "tcx"; // garmin training centre
-        formats << "csv"; // full csv list (not powertap)
-        formats << "json"; // gc json
-        formats << "pwx"; // gc json
+        QString format = activityFormat(request);
 
         // unsupported format
-        if (!formats.contains(format)) {
+        if (!activityFormats().contains(format)) {
             response.setStatus(500);
             response.write("unsupported format; we support:");
-            foreach(QString fmt, formats) {
+            foreach(QString fmt, activityFormats()) {
                 response.write(" ");
                 response.write(fmt.toLocal8Bit());
             }
             response.write("\r\n");
             return;
-        } else {
-
-            // set the content type appropriately
-            if (format == "tcx") response.setHeader("Content-Type", "application/vnd.garmin.tcx+xml; charset=ISO-8859-1");
-            if (format == "csv") response.setHeader("Content-Type", "text/csv; charset=ISO-8859-1");
-            if (format == "json") response.setHeader("Content-Type", "application/json; charset=ISO-8859-1");
-            if (format == "pwx") response.setHeader("Content-Type", "application/vnd.trainingpeaks.pwx+xml; charset=ISO-8859-1");
         }
 
-        // lets read the file in as a ridefile
-        QStringList errors;
-        RideFile *f = RideFileFactory::instance().openRideFile(NULL, file, errors);
+        // set the content type appropriately
+        response.setHeader("Content-Type", activityContentType(format));
+
+        // they already have it ?
+        QByteArray tag = activityTags(athlete, QStringList() << paths[0], format).value(paths[0]);
+        response.setHeader("ETag", tag);
+        if (request.getHeader("If-None-Match") == tag) {
+            response.setStatus(304, "Not Modified");
+            response.write(QByteArray(), true);
+            return;
+        }
 
         // error reading (!)
-        if (f == NULL) {
+        QStringList errors;
+        if (!writeActivity(filename, format, tag, response, errors)) {
             response.setStatus(500);
             foreach(QString error, errors) {
                 response.write(error.toLocal8Bit());
@@ -365,53 +577,322 @@ APIWebService::listActivity(QString athlete, QStringList paths, HttpRequest &req
             }
             return;
         }
+        response.flush();
 
-        // write out to a temporary file in
-        // the format requested
-        bool success;
-        QTemporaryFile tempfile; // deletes file when goes out of scope
-        QString tempname;
-        if (tempfile.open()) tempname = tempfile.fileName();
-        else {
-            response.setStatus(500);
-            response.write("error opening temporary file");
-            return;
+    } else {
+
+       // nope?
+       response.setStatus(404);
+       response.write("file not found");
+       return;
+    }
+}
+
+void
+APIWebService::listActivities(QString athlete, HttpRequest &request, HttpResponse &response)
+{
+    // what format to use ?
+    QString format = activityFormat(request);
+
+    // unsupported format
+    if (!activityFormats().contains(format)) {
+        response.setStatus(500);
+        response.write("unsupported format; we support:");
+        foreach(QString fmt, activityFormats()) {
+            response.write(" ");
+            response.write(fmt.toLocal8Bit());
         }
-        QFile out(tempname);
+        response.write("\r\n");
+        return;
+    }
 
-        if (format == "csv") {
-            CsvFileReader writer;
-            success = writer.writeRideFile(NULL, f, out, CsvFileReader::gc);
-        } else {
-            success = RideFileFactory::instance().writeRideFile(NULL, f, out, format);
+    // honour the since parameter
+    QString sincep(request.getParameter("since"));
+    QDate since(1900,01,01);
+    if (sincep != "") since = QDate::fromString(sincep,"yyyy/MM/dd");
+
+    // before parameter
+    QString beforep(request.getParameter("before"));
+    QDate before(3000,01,01);
+    if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
+
+    // or just the ones they asked for
+    QStringList filenames;
+    QString filenamesp(request.getParameter("filenames"));
+    if (filenamesp != "") filenames = filenamesp.split(",", QString::SkipEmptyParts);
+
+    QDir activities(QString("%1/%2/activities").arg(home.absolutePath()).arg(athlete));
+    if (filenames.count()) {
+
+        // names only, nothing outside the activities folder
+        foreach(QString name, filenames) {
+            QDateTime dateTime;
+            if (name.contains('/') || name.contains('\\') || !RideFile::parseRideFileName(name, &dateTime)) {
+                response.setStatus(400);
+                response.write("filenames must be activity file names\r\n");
+                return;
+            }
+        }
+
+    } else {
+        QStringList names;
+        names << "*"; // anything
+        foreach(QString name, activities.entryList(names, QDir::Files, QDir::Name)) {
+
+            QDateTime dateTime;
+            if (!RideFile::parseRideFileName(name, &dateTime)) continue;
+            if (dateTime.date() < since || dateTime.date() > before) continue;
+            if (name.endsWith(".bak")) continue;
+
+            filenames << name;
         }
+    }
+
+    // each one is a part with its own headers, the tag is the
+    // same as the ETag for the activity on its own
+    QByteArray boundary = "GoldenCheetahActivity";
+    response.setHeader("Content-Type", "multipart/mixed; boundary=" + boundary);
+
+    QMap<QString, QByteArray> tags = activityTags(athlete, filenames, format);
+    foreach(QString name, filenames) {
+
+        QString filename = activities.absoluteFilePath(name);
+        if (!QFile(filename).exists()) continue;
+
+        QByteArray tag = tags.value(name);
 
-        if (success) {
+        response.bwrite("--" + boundary + "\r\n");
+        response.bwrite("Content-Type: " + activityContentType(format) + "\r\n");
+        response.bwrite("Content-Disposition: attachment; filename=\"" + name.toLocal8Bit() + "\"\r\n");
+        response.bwrite("ETag: " + tag + "\r\n\r\n");
+
+        // error reading (!) goes in the part instead
+        QStringList errors;
+        if (!writeActivity(filename, format, tag, response, errors)) {
+            foreach(QString error, errors) {
+                response.bwrite(error.toLocal8Bit());
+                response.bwrite("\r\n");
+            }
+        }
+        response.bwrite("\r\n");
+    }
+    response.bwrite("--" + boundary + "--\r\n");
+    response.flush();
+}
+
+// the start of the period a date is grouped into
+static QDate queryPeriod(QDate date, QString group)
+{
+    if (group == "day") return date;
+    if (group == "week") return date.addDays(1 - date.dayOfWeek()); // monday
+    if (group == "month") return QDate(date.year(), date.month(), 1);
+    if (group == "year") return QDate(date.year(), 1, 1);
+    return QDate();
+}
+
+void
+APIWebService::query(QString athlete, HttpRequest &request, HttpResponse &response)
+{
+    response.setHeader("Content-Type", "text/csv; charset=ISO-8859-1");
+
+    QString valuep(request.getParameter("value"));
+    QString filterp(request.getParameter("filter"));
+
+    QString group(request.getParameter("group"));
+    if (group == "") group = "none";
+    QString aggregate(request.getParameter("aggregate"));
+    if (aggregate == "") aggregate = "sum";
+
+    QStringList groups, aggregates;
+    groups << "none" << "day" << "week" << "month" << "year";
+    aggregates << "sum" << "avg" << "max" << "min" << "count";
+
+    if (valuep == "" || !groups.contains(group) || !aggregates.contains(aggregate)) {
+        response.setStatus(400);
+        response.write("value is required, group is one of (none, day, week, month, year) and "
+                       "aggregate is one of (sum, avg, max, min, count)\r\n");
+        return;
+    }
+
+    // honour the since parameter
+    QString sincep(request.getParameter("since"));
+    QDate since(1900,01,01);
+    if (sincep != "") since = QDate::fromString(sincep,"yyyy/MM/dd");
 
-            // read in the whole thing
-            out.open(QFile::ReadOnly | QFile::Text);
-            QTextStream in(&out);
-            in.setCodec ("UTF-8");
-            contents = in.readAll();
-            out.close();
+    // before parameter
+    QString beforep(request.getParameter("before"));
+    QDate before(3000,01,01);
+    if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
 
-            // write back in one hit
-            response.write(contents.toLocal8Bit(), true);
+    // how long we will spend on it
+    int budget = QUERY_BUDGET;
+    QString budgetp(request.getParameter("budget"));
+    if (budgetp != "") budget = qBound(1, budgetp.toInt(), QUERY_BUDGET_MAX);
+
+    // the parser isn't reentrant and the ride cache belongs to the
+    // gui thread, so the athlete is found (or opened when running as
+    // a server) and the expressions compiled over there. We only
+    // evaluate them here, which is what the refresh threads do too.
+    Context *context = NULL;
+    DataFilter *filter = NULL, *value = NULL;
+    QVector<RideItem*> rides;
+    QString error;
+    uint version = 0;
+    bool refreshing = false;
+
+    auto prepare = [&]() {
+
+        context = Context::find(athlete);
+        if (context == NULL && mainwindows.isEmpty()) context = HeadlessRebuild::open(home, athlete, error);
+        if (context == NULL) {
+            if (error == "") error = "athlete is not open";
             return;
+        }
 
-        } else {
-            response.setStatus(500);
-            response.write("unable to write output, internal error.\n");
+        // anyone who can reach the port can send a query, so they
+        // may only compute values; no python and nothing that
+        // changes rides or charts
+        value = new DataFilter(context, context, valuep);
+        if (DataFiltererrors.count()) {
+            error = "value: " + DataFiltererrors.join("; ");
+            return;
+        }
+        if (value->root() && value->root()->hasSideEffects(value->root())) {
+            error = "value: python, set, unset, annotate, autoprocess and postprocess are not allowed";
             return;
         }
+        if (filterp != "") {
+            filter = new DataFilter(context, context, filterp);
+            if (DataFiltererrors.count()) {
+                error = "filter: " + DataFiltererrors.join("; ");
+                return;
+            }
+            if (filter->root() && filter->root()->hasSideEffects(filter->root())) {
+                error = "filter: python, set, unset, annotate, autoprocess and postprocess are not allowed";
+                return;
+            }
+        }
 
-    } else {
+        // what the results depend on, so we know when they change
+        rides = context->athlete->rideCache->rides();
+        refreshing = context->athlete->rideCache->isRunning();
+        version = qHash(context->athlete->rideCache->generation(), rides.count());
+        foreach(RideItem *item, rides)
+            version = qHash(item->fileName, version) ^ item->timestamp ^ item->crc ^ item->metacrc;
+    };
+
+    if (QThread::currentThread() == thread()) prepare();
+    else QMetaObject::invokeMethod(this, prepare, Qt::BlockingQueuedConnection);
+
+    if (error != "") {
+        if (filter) filter->deleteLater();
+        if (value) value->deleteLater();
+        response.setStatus(context ? 400 : 404);
+        response.write(error.toLocal8Bit());
+        response.write("\r\n");
+        return;
+    }
 
-       // nope?
-       response.setStatus(404);
-       response.write("file not found");
-       return;
+    // asked for this before and nothing has changed?
+    QString key = QString("%1|%2|%3|%4|%5|%6|%7|%8").arg(athlete)
+                  .arg(DataFilter::fingerprint(filterp)).arg(DataFilter::fingerprint(valuep))
+                  .arg(group).arg(aggregate)
+                  .arg(since.toString(Qt::ISODate)).arg(before.toString(Qt::ISODate))
+                  .arg(version);
+    QByteArray cached;
+    if (!refreshing) {
+        QMutexLocker locker(&queriesMutex);
+        QByteArray *found = queries.object(key);
+        if (found) cached = *found;
+    }
+    if (!cached.isEmpty()) {
+        if (filter) filter->deleteLater();
+        value->deleteLater();
+        response.write(cached, true);
+        return;
     }
+
+    // aggregate by period, QDate() when not grouping
+    QMap<QDate, QPair<double,int> > results;
+
+    Specification spec;
+    spec.setDateRange(DateRange(since, before));
+
+    // the budget covers the whole query, evaluation gives up part
+    // way through a ride (e.g. a long while loop) once it is spent
+    QElapsedTimer timer;
+    timer.start();
+    value->rt.timer = &timer;
+    value->rt.budget = budget;
+    if (filter) {
+        filter->rt.timer = &timer;
+        filter->rt.budget = budget;
+    }
+    bool expired = false;
+    foreach(RideItem *item, rides) {
+
+        if (timer.elapsed() > budget) {
+            expired = true;
+            break;
+        }
+
+        if (item->planned || !spec.pass(item)) continue;
+        bool pass = filter == NULL || filter->evaluate(item, NULL).number() != 0;
+        if (filter && filter->rt.expired) {
+            expired = true;
+            break;
+        }
+        if (!pass) continue;
+
+        double x = value->evaluate(item, NULL).number();
+        if (value->rt.expired) {
+            expired = true;
+            break;
+        }
+        QDate period = queryPeriod(item->dateTime.date(), group);
+
+        QMap<QDate, QPair<double,int> >::iterator it = results.find(period);
+        if (it == results.end()) {
+            results.insert(period, QPair<double,int>(x, 1));
+            continue;
+        }
+
+        if (aggregate == "max") it.value().first = qMax(it.value().first, x);
+        else if (aggregate == "min") it.value().first = qMin(it.value().first, x);
+        else it.value().first += x;
+        it.value().second++;
+    }
+
+    if (filter) filter->deleteLater();
+    value->deleteLater();
+
+    if (expired) {
+        response.setStatus(503);
+        response.write(QString("query exceeded budget of %1ms\r\n").arg(budget).toLocal8Bit());
+        return;
+    }
+
+    QByteArray out("period, value, count\n");
+    QMapIterator<QDate, QPair<double,int> > it(results);
+    while (it.hasNext()) {
+        it.next();
+
+        double x = it.value().first;
+        if (aggregate == "avg") x /= it.value().second;
+        if (aggregate == "count") x = it.value().second;
+
+        out += it.key().isValid() ? it.key().toString("yyyy/MM/dd").toLocal8Bit() : QByteArray("all");
+        out += ", " + QString("%1").arg(x, 'f').simplified().toLocal8Bit();
+        out += ", " + QByteArray::number(it.value().second) + "\n";
+    }
+
+    // results whilst refreshing won't last
+    if (!refreshing) {
+        QMutexLocker locker(&queriesMutex);
+        queries.insert(key, new QByteArray(out), qMax(1, out.size() / 1024));
+    }
+
+    response.write(out, true);
 }
 
 void
@@ -23,6 +23,9 @@
 #include "RideItem.h"
 #include "RideMetadata.h"
 #include <QDir>
+#include <QCache>
+#include <QMutex>
+#include <QMap>
 
 struct listRideSettings {
     bool intervals;
@@ -36,8 +39,7 @@ class APIWebService : public HttpRequestHandler
 
     public:
 
-        // nothing to do in constructor
-        APIWebService(QDir home, QObject *parent=NULL) : HttpRequestHandler(parent), home(home) {}
+        APIWebService(QDir home, QObject *parent=NULL);
 
         // request despatchers
         void service(HttpRequest &request, HttpResponse &response);
@@ -47,15 +49,31 @@ class APIWebService : public HttpRequestHandler
         void listAthletes(HttpRequest &request, HttpResponse &response);
         void listRides(QString athlete, HttpRequest &request, HttpResponse &response);
         void listActivity(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response);
+        void listActivities(QString athlete, HttpRequest &request, HttpResponse &response);
         void listMMP(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response);
         void listZones(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response);
         void listMeasures(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response);
+        void query(QString athlete, HttpRequest &request, HttpResponse &response);
 
         // utility
         void writeRideLine(RideItem &item, HttpRequest *request, HttpResponse *response);
 
     private:
         QDir home;
+
+        // activity downloads, converted to the format asked for
+        QString activityFormat(HttpRequest &request);
+        QMap<QString, QByteArray> activityTags(QString athlete, QStringList names, QString format);
+        bool writeActivity(QString filename, QString format, QByteArray tag, HttpResponse &response, QStringList &errors);
+
+        // converted activities, keyed by filename and tag (crc, timestamp and format)
+        // requests are serviced by a pool of threads, hence the mutex
+        QMutex convertedMutex;
+        QCache<QString, QByteArray> converted;
+
+        // query results, keyed by the expressions and the data they ran on
+        QMutex queriesMutex;
+        QCache<QString, QByteArray> queries;
 };
 
 #endif
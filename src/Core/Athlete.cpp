@@ -28,6 +28,7 @@
 #include "RideFileCache.h"
 #include "RideMetric.h"
 #include "Settings.h"
+#include "SettingsSnapshot.h"
 #include "TimeUtils.h"
 #include "Units.h"
 #include "Zones.h"
@@ -36,6 +37,7 @@
 #include "WithingsDownload.h"
 #include "CalendarDownload.h"
 #include "PMCData.h"
+#include "MetricBuckets.h"
 #include "Banister.h"
 #include "ErgDB.h"
 #ifdef GC_HAVE_ICAL
@@ -91,15 +93,16 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
     if (returnCode != 0) return;
 
 
-    // Power Zones for Bike & Run
+    // Power Zones for Bike & Run, errors are only
+    // reported when there is a main window to show them
     for (int i=0; i < 2; i++) {
         zones_[i] = new Zones(i>0);
         QFile zonesFile(home->config().canonicalPath() + "/" + zones_[i]->fileName());
         if (zonesFile.exists()) {
             if (!zones_[i]->read(zonesFile)) {
-                QMessageBox::critical(context->mainWindow, tr("Zones File %1 Error").arg(zones_[i]->fileName()), zones_[i]->errorString());
+                if (context->mainWindow) QMessageBox::critical(context->mainWindow, tr("Zones File %1 Error").arg(zones_[i]->fileName()), zones_[i]->errorString());
             } else if (! zones_[i]->warningString().isEmpty()) {
-                QMessageBox::warning(context->mainWindow, tr("Reading Zones File %1").arg(zones_[i]->fileName()), zones_[i]->warningString());
+                if (context->mainWindow) QMessageBox::warning(context->mainWindow, tr("Reading Zones File %1").arg(zones_[i]->fileName()), zones_[i]->warningString());
             }
         }
         if (i == 1 && zones_[i]->getRangeSize() == 0) { // No running Power zones
@@ -116,9 +119,9 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
         QFile hrzonesFile(home->config().canonicalPath() + "/" + hrzones_[i]->fileName());
         if (hrzonesFile.exists()) {
             if (!hrzones_[i]->read(hrzonesFile)) {
-                QMessageBox::critical(context->mainWindow, tr("HR Zones File %1 Error").arg(hrzones_[i]->fileName()), hrzones_[i]->errorString());
+                if (context->mainWindow) QMessageBox::critical(context->mainWindow, tr("HR Zones File %1 Error").arg(hrzones_[i]->fileName()), hrzones_[i]->errorString());
             } else if (! hrzones_[i]->warningString().isEmpty()) {
-                QMessageBox::warning(context->mainWindow, tr("Reading HR Zones File %1").arg(hrzones_[i]->fileName()), hrzones_[i]->warningString());
+                if (context->mainWindow) QMessageBox::warning(context->mainWindow, tr("Reading HR Zones File %1").arg(hrzones_[i]->fileName()), hrzones_[i]->warningString());
             }
         }
         if (i == 1 && hrzones_[i]->getRangeSize() == 0) { // No running HR zones
@@ -135,11 +138,14 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
         QFile pacezonesFile(home->config().canonicalPath() + "/" + pacezones_[i]->fileName());
         if (pacezonesFile.exists()) {
             if (!pacezones_[i]->read(pacezonesFile)) {
-                QMessageBox::critical(context->mainWindow, tr("Pace Zones File %1 Error").arg(pacezones_[i]->fileName()), pacezones_[i]->errorString());
+                if (context->mainWindow) QMessageBox::critical(context->mainWindow, tr("Pace Zones File %1 Error").arg(pacezones_[i]->fileName()), pacezones_[i]->errorString());
             }
         }
     }
 
+    // zones are needed for the settings used when refreshing
+    updateSettings();
+
     // read athlete's autoimport configuration and initialize the autoimport process
     autoImportConfig = new RideAutoImportConfig(home->config());
     autoImport = NULL;
@@ -164,7 +170,7 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
 
     // auto downloader
     cloudAutoDownload = new CloudServiceAutoDownload(context);
-    connect(context, SIGNAL(refreshEnd()), cloudAutoDownload, SLOT(autoDownload()));
+    if (context->mainWindow) connect(context, SIGNAL(refreshEnd()), cloudAutoDownload, SLOT(autoDownload()));
 
     // now most dependencies are in get cache
     QEventLoop loop;
@@ -173,7 +179,8 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
     connect(rideCache, SIGNAL(loadComplete()), this, SLOT(loadComplete()));
 
     // we need to block on load complete if first (before mainwindow ready)
-    if (context->mainWindow->progress)  loop.exec();
+    // or there isn't one at all (headless rebuild)
+    if (!context->mainWindow || context->mainWindow->progress)  loop.exec();
 }
 
 void
@@ -347,6 +354,16 @@ Athlete::translateDefaultCharts(QList<LTMSettings>&charts)
     }
 }
 
+void
+Athlete::updateSettings()
+{
+    // we never delete the old one, it may still be in use on
+    // another thread, they're small and config changes are rare
+    const SettingsSnapshot *snapshot = new SettingsSnapshot(this);
+    settings_.storeRelease(snapshot);
+    SettingsSnapshot::publish(snapshot);
+}
+
 void
 Athlete::configChanged(qint32 state)
 {
@@ -359,6 +376,11 @@ Athlete::configChanged(qint32 state)
             pmcs.value()->invalidate();
         }
     }
+
+    // invalidate trends buckets
+    if (state & (CONFIG_FIELDS | CONFIG_USERMETRICS)) {
+        foreach(MetricBuckets *buckets, bucketData) buckets->invalidate();
+    }
 }
 
 void
@@ -581,6 +603,24 @@ Athlete::getPMCFor(Leaf *expr, DataFilterRuntime *df, int stsdays, int ltsdays)
     return returning;
 }
 
+MetricBuckets *
+Athlete::getBucketsFor(QString symbol, bool metadata, int type, bool useMetricUnits)
+{
+    QString key = MetricBuckets::key(symbol, metadata, type, useMetricUnits);
+
+    // if we don't already have one, create it
+    MetricBuckets *returning = bucketData.value(key, NULL);
+    if (!returning) {
+
+        returning = new MetricBuckets(context, symbol, metadata, type, useMetricUnits);
+
+        // add to our collection
+        bucketData.insert(key, returning);
+    }
+
+    return returning;
+}
+
 PDEstimate
 Athlete::getPDEstimateFor(QDate date, QString model, bool wpk, bool run)
 {
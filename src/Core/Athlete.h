@@ -28,6 +28,7 @@
 #include <QUuid>
 #include <QNetworkReply>
 #include <QHeaderView>
+#include <QAtomicPointer>
 
 
 class Zones;
@@ -48,6 +49,7 @@ class IntervalItem;
 class IntervalTreeView;
 class PDEstimate;
 class PMCData;
+class MetricBuckets;
 class LTMSettings;
 class Routes;
 class AthleteDirectoryStructure;
@@ -63,6 +65,7 @@ class Leaf;
 class DataFilterRuntime;
 class CloudServiceAutoDownload;
 class Banister;
+class SettingsSnapshot;
 
 class Athlete : public QObject
 {
@@ -88,6 +91,12 @@ class Athlete : public QObject
         PaceZones *pacezones_[2];
         void setCriticalPower(int cp);
 
+        // settings used when refreshing rides, replaced whole when the
+        // config changes so worker threads can read them without locking
+        const SettingsSnapshot *settings() const { return settings_.loadAcquire(); }
+        void updateSettings();
+        QAtomicPointer<const SettingsSnapshot> settings_;
+
         // Data
         Seasons *seasons;
         Routes *routes;
@@ -111,6 +120,10 @@ class Athlete : public QObject
         Banister *getBanisterFor(QString metricName, QString perfMetricName, int t1, int t2); // t1/t2 not used yet
         QMap<QString, Banister*> banisterData;
 
+        // Trends day buckets
+        MetricBuckets *getBucketsFor(QString symbol, bool metadata, int type, bool useMetricUnits);
+        QMap<QString, MetricBuckets*> bucketData;
+
         // athlete measures
         // note ride can override if passed
         double getWeight(QDate date, RideFile *ride=NULL);
@@ -134,8 +134,19 @@ GlobalContext *GlobalContext::context()
 }
 
 bool Context::isValid(Context *p) { return p != NULL &&_contexts.contains(p); }
+
+Context *
+Context::find(QString cyclist)
+{
+    foreach(Context *p, _contexts)
+        if (p->athlete && p->athlete->cyclist == cyclist)
+            return p;
+    return NULL;
+}
+
 Context::Context(MainWindow *mainWindow): mainWindow(mainWindow)
 {
+    athlete = NULL;
     ride = NULL;
     workout = NULL;
     videosync = NULL;
@@ -190,6 +201,9 @@ Context::notifyCompareDateRangesChanged()
 void
 Context::notifyConfigChanged(qint32 state)
 {
+    // before anyone starts refreshing with the old values
+    if (athlete) athlete->updateSettings();
+
     emit configChanged(state);
 }
 
@@ -111,6 +111,9 @@ class Context : public QObject
         // check if valid (might be deleted)
         static bool isValid(Context *);
 
+        // the context for an athlete that is open, NULL if not
+        static Context *find(QString cyclist);
+
         // mainwindow state
         NavigationModel *nav;
         int viewIndex;
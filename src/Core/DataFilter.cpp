@@ -635,6 +635,51 @@ Leaf::isDynamic(Leaf *leaf)
     return false;
 }
 
+// scripts and functions that change rides or charts, rather
+// than just computing a value from them
+bool
+Leaf::hasSideEffects(Leaf *leaf)
+{
+    if (leaf == NULL) return false;
+
+    switch(leaf->type) {
+    default:
+        return false;
+    case Leaf::Script :
+        return true;
+    case Leaf::UnaryOperation :
+        return leaf->hasSideEffects(leaf->lvalue.l);
+    case Leaf::Logical  :
+        if (leaf->op == 0)
+            return leaf->hasSideEffects(leaf->lvalue.l);
+        // intentional fallthrough
+    case Leaf::Operation :
+    case Leaf::BinaryOperation :
+        return (leaf->hasSideEffects(leaf->lvalue.l) ||
+                leaf->hasSideEffects(leaf->rvalue.l));
+    case Leaf::Function :
+        if (leaf->function == "set" || leaf->function == "unset" ||
+            leaf->function == "annotate" || leaf->function == "autoprocess" ||
+            leaf->function == "postprocess")
+            return true;
+        if (leaf->series && leaf->lvalue.l && leaf->hasSideEffects(leaf->lvalue.l))
+            return true;
+        foreach(Leaf *p, leaf->fparms) if (leaf->hasSideEffects(p)) return true;
+        return false;
+    case Leaf::Conditional :
+        return (leaf->hasSideEffects(leaf->cond.l) ||
+                leaf->hasSideEffects(leaf->lvalue.l) ||
+                leaf->hasSideEffects(leaf->rvalue.l));
+    case Leaf::Index :
+    case Leaf::Select :
+        return (leaf->hasSideEffects(leaf->lvalue.l) ||
+                leaf->hasSideEffects(leaf->fparms[0]));
+    case Leaf::Compound :
+        foreach(Leaf *p, *(leaf->lvalue.b)) if (leaf->hasSideEffects(p)) return true;
+        return false;
+    }
+}
+
 void
 DataFilter::setSignature(QString &query)
 {
@@ -2685,6 +2730,12 @@ DataFilter::DataFilter(QObject *parent, Context *context) : QObject(parent), con
     // be sure not to enable this by accident!
     rt.isdynamic = false;
 
+    // unbounded unless a budget is set
+    rt.timer = NULL;
+    rt.budget = 0;
+    rt.ticks = 0;
+    rt.expired = false;
+
     // set up the models we support
     rt.models << new CP2Model(context);
     rt.models << new CP3Model(context);
@@ -2713,6 +2764,12 @@ DataFilter::DataFilter(QObject *parent, Context *context, QString formula) : QOb
     // be sure not to enable this by accident!
     rt.isdynamic = false;
 
+    // unbounded unless a budget is set
+    rt.timer = NULL;
+    rt.budget = 0;
+    rt.ticks = 0;
+    rt.expired = false;
+
     // set up the models we support
     rt.models << new CP2Model(context);
     rt.models << new CP3Model(context);
@@ -3030,6 +3087,12 @@ Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, Result x, long it, RideItem
     // if error state all bets are off
     //if (inerror) return Result(0);
 
+    // out of time, unwind without evaluating anything else
+    if (df->timer) {
+        if (!df->expired && (++df->ticks & 0xff) == 0 && df->timer->hasExpired(df->budget)) df->expired = true;
+        if (df->expired) return Result(0);
+    }
+
     switch(leaf->type) {
 
     //
@@ -6869,3 +6932,419 @@ DataFilterRuntime::runPythonScript(Context *context, QString script, RideItem *m
     return result;
 }
 #endif
+
+//
+// Column at a time evaluation of accumulating user functions
+//
+struct DataFilterReduction::Node {
+    enum { Constant, Series, Symbol, Unary, Binary, Logical, Ternary, Function } type;
+    int op;
+    double value;                   // Constant, or Symbol once evaluated
+    RideFile::SeriesType series;    // Series
+    Leaf *leaf;                     // Symbol
+    double (*func)(double);         // Function
+    Node *lhs, *rhs, *cond;
+};
+
+struct DataFilterReduction::Statement {
+    enum { Sum, Difference, Max, Min, If } type;
+    QString symbol;     // accumulator
+    bool accfirst;      // max(acc, x) rather than max(x, acc)
+    Node *expr;         // value to fold in, or the condition for If
+    QList<Statement*> then, otherwise;
+};
+
+struct DataFilterReduction::Frame {
+    int n;
+    QHash<int, QVector<double> > columns;   // series -> values
+    QHash<const Node*, double> constants;   // symbol -> value
+    QHash<QString, double> accumulators;
+};
+
+static struct {
+    const char *name;
+    double (*func)(double);
+} DataFilterReductionFunctions[] = {
+    { "cos", cos }, { "tan", tan }, { "sin", sin },
+    { "acos", acos }, { "atan", atan }, { "asin", asin },
+    { "cosh", cosh }, { "tanh", tanh }, { "sinh", sinh },
+    { "acosh", acosh }, { "atanh", atanh }, { "asinh", asinh },
+    { "exp", exp }, { "log", log }, { "log10", log10 },
+    { "ceil", ceil }, { "floor", floor }, { "round", round },
+    { "fabs", fabs }, { "isinf", myisinf }, { "isnan", myisnan },
+    { NULL, NULL }
+};
+
+DataFilterReduction *
+DataFilterReduction::compile(DataFilterRuntime *df, Leaf *function)
+{
+    if (function == NULL || function->type != Leaf::Compound) return NULL;
+
+    DataFilterReduction *returning = new DataFilterReduction();
+    bool ok = returning->compileStatements(df, function, returning->program);
+
+    // each accumulator is only folded once per sample and never read
+    // other than to fold into it, otherwise order of evaluation matters
+    if (ok && returning->accumulators.removeDuplicates()) ok = false;
+    foreach(QString symbol, returning->referenced) if (returning->accumulators.contains(symbol)) ok = false;
+
+    // nothing to do is not worth the bother
+    if (!ok || returning->accumulators.isEmpty()) {
+        delete returning;
+        return NULL;
+    }
+    return returning;
+}
+
+DataFilterReduction::~DataFilterReduction()
+{
+    foreach(Node *node, nodes) delete node;
+    foreach(Statement *statement, statements) delete statement;
+}
+
+DataFilterReduction::Node *
+DataFilterReduction::compileExpression(DataFilterRuntime *df, Leaf *leaf)
+{
+    if (leaf == NULL) return NULL;
+
+    Node *node = new Node();
+    node->type = Node::Constant;
+    node->op = 0;
+    node->value = 0;
+    node->series = RideFile::none;
+    node->leaf = NULL;
+    node->func = NULL;
+    node->lhs = node->rhs = node->cond = NULL;
+    nodes << node;
+
+    switch(leaf->type) {
+
+    case Leaf::Float: node->value = leaf->lvalue.f; return node;
+    case Leaf::Integer: node->value = leaf->lvalue.i; return node;
+
+    case Leaf::Symbol:
+    {
+        QString symbol = *(leaf->lvalue.n);
+
+        // sample series are checked first in eval, so here too
+        if (df->dataSeriesSymbols.contains(symbol)) {
+            node->series = RideFile::seriesForSymbol(symbol);
+            if (node->series == RideFile::index) return NULL; // needs the point index
+            node->type = Node::Series;
+            if (!series.contains(node->series)) series << node->series;
+            return node;
+        }
+
+        // anything else doesn't change from one sample to the next
+        // as long as it isn't an accumulator, compile() checks that
+        node->type = Node::Symbol;
+        node->leaf = leaf;
+        referenced << symbol;
+        constants << node;
+        return node;
+    }
+
+    case Leaf::UnaryOperation:
+        if (leaf->op != '-' && leaf->op != '!') return NULL;
+        node->type = Node::Unary;
+        node->op = leaf->op;
+        node->lhs = compileExpression(df, leaf->lvalue.l);
+        return node->lhs ? node : NULL;
+
+    case Leaf::BinaryOperation:
+    case Leaf::Operation:
+        switch(leaf->op) {
+        case ADD: case SUBTRACT: case DIVIDE: case MULTIPLY: case POW:
+        case EQ: case NEQ: case LT: case LTE: case GT: case GTE: case ELVIS:
+            break;
+        default:
+            return NULL; // assignment, string matching etc
+        }
+        node->type = Node::Binary;
+        node->op = leaf->op;
+        node->lhs = compileExpression(df, leaf->lvalue.l);
+        node->rhs = compileExpression(df, leaf->rvalue.l);
+        return node->lhs && node->rhs ? node : NULL;
+
+    case Leaf::Logical:
+        node->type = Node::Logical;
+        node->op = leaf->op;
+        node->lhs = compileExpression(df, leaf->lvalue.l);
+        if (leaf->op == AND || leaf->op == OR) {
+            node->rhs = compileExpression(df, leaf->rvalue.l);
+            return node->lhs && node->rhs ? node : NULL;
+        }
+        return node->lhs ? node : NULL;
+
+    case Leaf::Conditional:
+        if (leaf->op != 0 || leaf->rvalue.l == NULL) return NULL; // only ternary
+        node->type = Node::Ternary;
+        node->cond = compileExpression(df, leaf->cond.l);
+        node->lhs = compileExpression(df, leaf->lvalue.l);
+        node->rhs = compileExpression(df, leaf->rvalue.l);
+        return node->cond && node->lhs && node->rhs ? node : NULL;
+
+    case Leaf::Function:
+        // user defined functions take precedence in eval
+        if (leaf->series || df->functions.contains(leaf->function) || leaf->fparms.count() != 1) return NULL;
+        for(int i=0; DataFilterReductionFunctions[i].name; i++) {
+            if (leaf->function == DataFilterReductionFunctions[i].name) {
+                node->type = Node::Function;
+                node->func = DataFilterReductionFunctions[i].func;
+                node->lhs = compileExpression(df, leaf->fparms[0]);
+                return node->lhs ? node : NULL;
+            }
+        }
+        return NULL;
+
+    default:
+        return NULL;
+    }
+}
+
+bool
+DataFilterReduction::compileStatements(DataFilterRuntime *df, Leaf *leaf, QList<Statement*> &into)
+{
+    if (leaf == NULL) return false;
+
+    // a block of them
+    if (leaf->type == Leaf::Compound) {
+        foreach(Leaf *statement, *(leaf->lvalue.b))
+            if (!compileStatements(df, statement, into)) return false;
+        return true;
+    }
+
+    Statement *statement = new Statement();
+    statement->accfirst = true;
+    statement->expr = NULL;
+    statements << statement;
+
+    // if (cond) { ... } else { ... }
+    if (leaf->type == Leaf::Conditional && leaf->op == IF_) {
+        statement->type = Statement::If;
+        statement->expr = compileExpression(df, leaf->cond.l);
+        if (statement->expr == NULL) return false;
+        if (!compileStatements(df, leaf->lvalue.l, statement->then)) return false;
+        if (leaf->rvalue.l && !compileStatements(df, leaf->rvalue.l, statement->otherwise)) return false;
+        into << statement;
+        return true;
+    }
+
+    // acc <- ...
+    if (leaf->type != Leaf::Operation || leaf->op != ASSIGN || leaf->lvalue.l->type != Leaf::Symbol) return false;
+
+    QString symbol = *(leaf->lvalue.l->lvalue.n);
+    if (df->dataSeriesSymbols.contains(symbol)) return false; // would read the sample not the symbol
+    statement->symbol = symbol;
+
+    Leaf *rhs = leaf->rvalue.l;
+    Leaf *value = NULL;
+    bool isacc;
+#define ISACC(l) ((l)->type == Leaf::Symbol && *((l)->lvalue.n) == symbol)
+
+    if (rhs->type == Leaf::BinaryOperation && (rhs->op == ADD || rhs->op == SUBTRACT)) {
+
+        // acc + x, acc - x or x + acc
+        statement->type = rhs->op == ADD ? Statement::Sum : Statement::Difference;
+        if (ISACC(rhs->lvalue.l)) value = rhs->rvalue.l;
+        else if (rhs->op == ADD && ISACC(rhs->rvalue.l)) value = rhs->lvalue.l;
+
+    } else if (rhs->type == Leaf::Function && !rhs->series && !df->functions.contains(rhs->function)
+               && (rhs->function == "max" || rhs->function == "min") && rhs->fparms.count() == 2) {
+
+        // max(acc, x) or max(x, acc), min the same
+        statement->type = rhs->function == "max" ? Statement::Max : Statement::Min;
+        if ((isacc = ISACC(rhs->fparms[0])) == true) value = rhs->fparms[1];
+        else if (ISACC(rhs->fparms[1])) value = rhs->fparms[0];
+        statement->accfirst = isacc;
+    }
+#undef ISACC
+
+    if (value == NULL) return false;
+    statement->expr = compileExpression(df, value);
+    if (statement->expr == NULL) return false;
+
+    accumulators << symbol;
+    into << statement;
+    return true;
+}
+
+void
+DataFilterReduction::evaluate(const Node *node, Frame &frame, QVector<double> &out) const
+{
+    int n = frame.n;
+    out.resize(n);
+    double *o = out.data();
+
+    switch(node->type) {
+
+    case Node::Constant:
+    case Node::Symbol:
+    {
+        double v = node->type == Node::Constant ? node->value : frame.constants.value(node);
+        for(int i=0; i<n; i++) o[i] = v;
+    }
+    break;
+
+    case Node::Series:
+        out = frame.columns.value(node->series);
+        break;
+
+    case Node::Unary:
+    {
+        evaluate(node->lhs, frame, out);
+        o = out.data();
+        if (node->op == '-') for(int i=0; i<n; i++) o[i] = o[i] * -1;
+        else for(int i=0; i<n; i++) o[i] = !o[i];
+    }
+    break;
+
+    case Node::Function:
+    {
+        evaluate(node->lhs, frame, out);
+        o = out.data();
+        for(int i=0; i<n; i++) o[i] = node->func(o[i]);
+    }
+    break;
+
+    case Node::Logical:
+    {
+        evaluate(node->lhs, frame, out);
+        if (node->op != AND && node->op != OR) break; // parenthesis
+
+        QVector<double> rhs;
+        evaluate(node->rhs, frame, rhs);
+        o = out.data();
+        const double *r = rhs.constData();
+        if (node->op == AND) for(int i=0; i<n; i++) o[i] = (o[i] && r[i]) ? 1 : 0;
+        else for(int i=0; i<n; i++) o[i] = (o[i] || r[i]) ? 1 : 0;
+    }
+    break;
+
+    case Node::Ternary:
+    {
+        QVector<double> cond, rhs;
+        evaluate(node->cond, frame, cond);
+        evaluate(node->lhs, frame, out);
+        evaluate(node->rhs, frame, rhs);
+        o = out.data();
+        const double *c = cond.constData();
+        const double *r = rhs.constData();
+        for(int i=0; i<n; i++) if (!c[i]) o[i] = r[i];
+    }
+    break;
+
+    case Node::Binary:
+    {
+        QVector<double> rhs;
+        evaluate(node->lhs, frame, out);
+        evaluate(node->rhs, frame, rhs);
+        o = out.data();
+        const double *r = rhs.constData();
+
+        // same as eval for numbers
+        switch(node->op) {
+        case ADD: for(int i=0; i<n; i++) o[i] = o[i] + r[i]; break;
+        case SUBTRACT: for(int i=0; i<n; i++) o[i] = o[i] - r[i]; break;
+        case DIVIDE: for(int i=0; i<n; i++) o[i] = r[i] ? o[i] / r[i] : 0; break;
+        case MULTIPLY: for(int i=0; i<n; i++) o[i] = o[i] * r[i]; break;
+        case POW: for(int i=0; i<n; i++) o[i] = pow(o[i], r[i]); break;
+        case EQ: for(int i=0; i<n; i++) o[i] = o[i] == r[i]; break;
+        case NEQ: for(int i=0; i<n; i++) o[i] = o[i] != r[i]; break;
+        case LT: for(int i=0; i<n; i++) o[i] = o[i] < r[i]; break;
+        case LTE: for(int i=0; i<n; i++) o[i] = o[i] <= r[i]; break;
+        case GT: for(int i=0; i<n; i++) o[i] = o[i] > r[i]; break;
+        case GTE: for(int i=0; i<n; i++) o[i] = o[i] >= r[i]; break;
+        case ELVIS: for(int i=0; i<n; i++) if (!o[i]) o[i] = r[i]; break;
+        }
+    }
+    break;
+    }
+}
+
+void
+DataFilterReduction::execute(const QList<Statement*> &list, const QVector<bool> &mask, Frame &frame) const
+{
+    int n = frame.n;
+    const bool *m = mask.constData();
+    QVector<double> values;
+
+    foreach(const Statement *statement, list) {
+
+        evaluate(statement->expr, frame, values);
+        const double *v = values.constData();
+
+        if (statement->type == Statement::If) {
+
+            QVector<bool> then(n), otherwise(n);
+            for(int i=0; i<n; i++) {
+                then[i] = m[i] && v[i];
+                otherwise[i] = m[i] && !v[i];
+            }
+            execute(statement->then, then, frame);
+            execute(statement->otherwise, otherwise, frame);
+            continue;
+        }
+
+        // fold in sample order, exactly as eval would
+        double acc = frame.accumulators.value(statement->symbol);
+        switch(statement->type) {
+        case Statement::Sum: for(int i=0; i<n; i++) if (m[i]) acc = acc + v[i]; break;
+        case Statement::Difference: for(int i=0; i<n; i++) if (m[i]) acc = acc - v[i]; break;
+        case Statement::Max:
+            if (statement->accfirst) { for(int i=0; i<n; i++) if (m[i] && v[i] > acc) acc = v[i]; }
+            else { for(int i=0; i<n; i++) if (m[i] && !(acc > v[i])) acc = v[i]; }
+            break;
+        case Statement::Min:
+            if (statement->accfirst) { for(int i=0; i<n; i++) if (m[i] && v[i] < acc) acc = v[i]; }
+            else { for(int i=0; i<n; i++) if (m[i] && !(acc < v[i])) acc = v[i]; }
+            break;
+        default: break;
+        }
+        frame.accumulators.insert(statement->symbol, acc);
+    }
+}
+
+bool
+DataFilterReduction::run(DataFilterRuntime *df, RideItem *m, const QHash<QString,RideMetric*> *c,
+                         Specification spec, RideFileIterator &it) const
+{
+    Frame frame;
+
+    // accumulators must already be numbers, otherwise eval
+    // would be doing string concatenation or metric lookups
+    foreach(QString symbol, accumulators) {
+        if (!df->symbols.contains(symbol)) return false;
+        Result value = df->symbols.value(symbol);
+        if (!value.isNumber || value.isVector()) return false;
+        frame.accumulators.insert(symbol, value.number());
+    }
+
+    // constants, same for every sample
+    foreach(const Node *node, constants) {
+        Result value = node->leaf->eval(df, node->leaf, Result(0), 0, m, NULL, c, spec);
+        if (!value.isNumber || value.isVector()) return false;
+        frame.constants.insert(node, value.number());
+    }
+
+    // the samples
+    QVector<RideFilePoint*> points;
+    while(it.hasNext()) points << it.next();
+    frame.n = points.count();
+    if (frame.n == 0) return true;
+
+    foreach(RideFile::SeriesType type, series) {
+        QVector<double> &column = frame.columns[type];
+        column.resize(frame.n);
+        for(int i=0; i<frame.n; i++) column[i] = points[i]->value(type);
+    }
+
+    // run and update
+    execute(program, QVector<bool>(frame.n, true), frame);
+    QHashIterator<QString, double> i(frame.accumulators);
+    while(i.hasNext()) {
+        i.next();
+        df->symbols.insert(i.key(), Result(i.value()));
+    }
+    return true;
+}
@@ -27,6 +27,7 @@
 #include <QHash>
 #include <QStringList>
 #include <QTextDocument>
+#include <QElapsedTimer>
 #include "RideCache.h"
 #include "RideFile.h" //for SeriesType
 #include "Utils.h" //for SeriesType
@@ -130,6 +131,7 @@ class Leaf {
         void print(int level, DataFilterRuntime*);  // print leaf and all children
         void color(Leaf *, QTextDocument *);  // update the document to match
         bool isDynamic(Leaf *);
+        bool hasSideEffects(Leaf *); // python, set, unset, annotate ...
         void validateFilter(Context *context, DataFilterRuntime *, Leaf*); // validate
         bool isNumber(DataFilterRuntime *df, Leaf *leaf);
         void findSymbols(QStringList &symbols); // when working with formulas
@@ -178,6 +180,13 @@ public:
     // needs to be reapplied as the ride selection changes
     bool isdynamic;
 
+    // evaluation is abandoned, returning zero, once timer has run
+    // for more than budget ms; NULL for no limit (web api queries)
+    const QElapsedTimer *timer;
+    qint64 budget;
+    int ticks;
+    bool expired;
+
     // the user chart if were used for that
     // enables use of cache() command
     UserChart *chart;
@@ -271,6 +280,55 @@ class DataFilter : public QObject
         QString sig;
 };
 
+// A user function run for every sample, typically the sample/before/after
+// functions of a user metric, that does nothing more than accumulate; sums,
+// counts, maxima and minima of expressions over the sample series, possibly
+// under an if/else.
+//
+// e.g. sample { if (POWER>0) { secs <- secs + RECINTSECS; total <- total + POWER; } }
+//
+// In this case evaluating the AST for every sample (tens of millions of
+// calls in a rebuild) is avoidable; the expressions can be evaluated a
+// column at a time and folded into the accumulators. The accumulators are
+// folded in sample order, so the results are identical to calling eval.
+//
+// Anything else (assignments that aren't accumulations, reading an
+// accumulator, user defined functions, vectors, strings ...) is left
+// to eval, compile returns NULL.
+class DataFilterReduction
+{
+    public:
+        // analyse the function, NULL if it can't be reduced
+        static DataFilterReduction *compile(DataFilterRuntime *df, Leaf *function);
+        ~DataFilterReduction();
+
+        // fold the samples into the accumulators in df->symbols.
+        // returns false and leaves the iterator untouched if the
+        // accumulators or constants are not plain numbers at runtime
+        bool run(DataFilterRuntime *df, RideItem *m, const QHash<QString,RideMetric*> *c,
+                 Specification spec, RideFileIterator &it) const;
+
+    private:
+        DataFilterReduction() {}
+
+        struct Node;
+        struct Statement;
+        struct Frame;
+
+        Node *compileExpression(DataFilterRuntime *df, Leaf *leaf);
+        bool compileStatements(DataFilterRuntime *df, Leaf *leaf, QList<Statement*> &into);
+        void evaluate(const Node *node, Frame &frame, QVector<double> &out) const;
+        void execute(const QList<Statement*> &statements, const QVector<bool> &mask, Frame &frame) const;
+
+        QList<Node*> nodes;             // all the nodes, we own them
+        QList<Statement*> statements;   // all the statements, we own them
+        QList<Statement*> program;      // top level statements
+        QStringList accumulators;       // symbols assigned
+        QStringList referenced;         // non-series symbols read (constant during the loop)
+        QList<Node*> constants;         // symbol nodes evaluated once per run
+        QList<RideFile::SeriesType> series; // sample series read
+};
+
 // general purpose model fitting to x/y data
 class DFModel : public PDModel
 {
@@ -0,0 +1,476 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "HeadlessBenchmark.h"
+#include "RideFile.h"
+#include "BestEfforts.h"
+#include "AddIntervalDialog.h"
+#include "HeadlessRebuild.h"
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "RideMetric.h"
+#include "RideFileCache.h"
+#include "GcbRideFile.h"
+
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QApplication>
+#include <QThread>
+#include <cmath>
+#include <stdio.h>
+
+// timed passes after a warm up, the best is reported
+#define BENCHMARK_PASSES 3
+
+QStringList
+HeadlessBenchmark::names()
+{
+    return QStringList() << "fit" << "bests" << "usermetrics" << "distributions" << "gcb";
+}
+
+int
+HeadlessBenchmark::error(QString message)
+{
+    QJsonObject out;
+    out.insert("benchmark", name);
+    out.insert("error", message);
+    fprintf(stdout, "%s\n", QJsonDocument(out).toJson(QJsonDocument::Compact).constData());
+    fflush(stdout);
+    return 1;
+}
+
+int
+HeadlessBenchmark::run()
+{
+    QJsonObject out;
+    out.insert("benchmark", name);
+
+    int ret;
+    if (name == "fit") ret = fit(out);
+    else if (name == "bests") ret = bests(out);
+    else if (name == "usermetrics") ret = usermetrics(out);
+    else if (name == "distributions") ret = distributions(out);
+    else if (name == "gcb") ret = gcb(out);
+    else return error("unknown benchmark, expected one of: " + names().join(", "));
+
+    if (ret) return ret;
+
+    fprintf(stdout, "%s\n", QJsonDocument(out).toJson(QJsonDocument::Compact).constData());
+    fflush(stdout);
+
+    // the fast path didn't get the same answer
+    return out.value("mismatches").toInt() ? 1 : 0;
+}
+
+QList<RideFile*>
+HeadlessBenchmark::activities(QString &folder, QStringList &failed)
+{
+    folder = target;
+    if (!QFileInfo(folder).isDir()) folder = home.canonicalPath() + "/" + target + "/activities";
+
+    QStringList files;
+    QDirIterator it(folder, QDir::Files);
+    while (it.hasNext()) {
+        QString filename = it.next();
+        if (RideFileFactory::instance().readerForSuffix(QFileInfo(filename).suffix())) files << filename;
+    }
+    files.sort();
+
+    QList<RideFile*> rides;
+    foreach(QString filename, files) {
+        QFile file(filename);
+        QStringList errors;
+        RideFile *ride = RideFileFactory::instance().openRideFile(NULL, file, errors);
+        if (ride) rides << ride;
+        else failed << QFileInfo(filename).fileName();
+    }
+    return rides;
+}
+
+int
+HeadlessBenchmark::fit(QJsonObject &out)
+{
+    // a folder of files, or the athlete's imports
+    QString folder = target;
+    if (!QFileInfo(folder).isDir()) folder = home.canonicalPath() + "/" + target + "/imports";
+    if (!QFileInfo(folder).isDir()) return error("no folder of fit files");
+
+    RideFileReader *reader = RideFileFactory::instance().readerForSuffix("fit");
+    if (reader == NULL) return error("no fit reader");
+
+    QStringList files;
+    QDirIterator it(folder, QStringList() << "*.fit" << "*.FIT", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) files << it.next();
+    if (files.isEmpty()) return error("no fit files in " + folder);
+
+    qint64 bytes = 0, samples = 0, best = -1;
+    int failed = 0;
+
+    // the first pass warms the disk cache, so we time decoding
+    for (int pass=0; pass <= BENCHMARK_PASSES; pass++) {
+
+        QElapsedTimer timer;
+        timer.start();
+
+        bytes = samples = 0;
+        failed = 0;
+        foreach(QString filename, files) {
+
+            QFile file(filename);
+            QStringList errors;
+            RideFile *ride = reader->openRideFile(file, errors);
+
+            bytes += file.size();
+            if (ride) {
+                samples += ride->dataPoints().count();
+                delete ride;
+            } else failed++;
+        }
+
+        qint64 nsecs = timer.nsecsElapsed();
+        if (pass && (best < 0 || nsecs < best)) best = nsecs;
+    }
+
+    double secs = double(best) / 1000000000.0;
+    out.insert("folder", folder);
+    out.insert("files", files.count());
+    out.insert("failed", failed);
+    out.insert("bytes", double(bytes));
+    out.insert("samples", double(samples));
+    out.insert("ms", secs * 1000.0);
+    out.insert("mb_per_sec", secs > 0 ? double(bytes) / 1048576.0 / secs : 0);
+    out.insert("samples_per_sec", secs > 0 ? double(samples) / secs : 0);
+    return 0;
+}
+
+int
+HeadlessBenchmark::bests(QJsonObject &out)
+{
+    QString folder;
+    QStringList failed;
+    QList<RideFile*> rides = activities(folder, failed);
+    if (rides.isEmpty()) return error("no activities in " + folder);
+
+    // what the peak metrics and interval discovery look for
+    QList<RideFile::SeriesType> series;
+    series << RideFile::watts << RideFile::hr << RideFile::kph;
+    QList<double> durations;
+    durations << 1 << 5 << 10 << 15 << 20 << 30 << 60 << 120 << 180 << 300 << 360 << 480
+              << 600 << 1200 << 1800 << 3600 << 5400;
+
+    int peaks = 0, mismatches = 0;
+    qint64 findpeaks = -1, besteffort = -1;
+
+    // the first pass is a warm up, both are checked every pass
+    for (int pass=0; pass <= BENCHMARK_PASSES; pass++) {
+
+        qint64 old = 0, fast = 0;
+        peaks = mismatches = 0;
+        foreach(RideFile *ride, rides) {
+
+            if (ride->dataPoints().isEmpty()) continue;
+
+            QElapsedTimer timer;
+            timer.start();
+            QList<AddIntervalDialog::AddedInterval> original;
+            foreach(RideFile::SeriesType s, series)
+                foreach(double secs, durations)
+                    AddIntervalDialog::findPeaks(NULL, true, ride, Specification(), s, RideFile::original, secs, 1, original, "", "");
+            old += timer.nsecsElapsed();
+
+            timer.restart();
+            QList<AddIntervalDialog::AddedInterval> found;
+            BestEfforts efforts(ride, Specification());
+            foreach(RideFile::SeriesType s, series)
+                foreach(double secs, durations)
+                    efforts.findPeak(s, secs, found);
+            fast += timer.nsecsElapsed();
+
+            // exactly the same, not just close
+            peaks += original.count();
+            if (original.count() != found.count()) {
+                mismatches++;
+                continue;
+            }
+            for (int i=0; i<original.count(); i++) {
+                if (original[i].start != found[i].start || original[i].stop != found[i].stop
+                    || original[i].avg != found[i].avg) mismatches++;
+            }
+        }
+        if (pass && (findpeaks < 0 || old < findpeaks)) findpeaks = old;
+        if (pass && (besteffort < 0 || fast < besteffort)) besteffort = fast;
+    }
+    qDeleteAll(rides);
+
+    out.insert("folder", folder);
+    out.insert("activities", rides.count());
+    out.insert("failed", failed.count());
+    out.insert("peaks", peaks);
+    out.insert("mismatches", mismatches);
+    out.insert("findpeaks_ms", double(findpeaks) / 1000000.0);
+    out.insert("besteffort_ms", double(besteffort) / 1000000.0);
+    out.insert("speedup", besteffort > 0 ? double(findpeaks) / double(besteffort) : 0);
+    return 0;
+}
+
+Context *
+HeadlessBenchmark::athlete(QString &message)
+{
+    Context *context = HeadlessRebuild::open(home, target, message);
+    if (context == NULL) return NULL;
+
+    // let it finish refreshing, as --rebuild does
+    while (context->athlete->rideCache->isRunning()) {
+        QApplication::processEvents(QEventLoop::AllEvents, 50);
+        QThread::msleep(10);
+    }
+    QApplication::processEvents();
+    return context;
+}
+
+int
+HeadlessBenchmark::usermetrics(QJsonObject &out)
+{
+    QString message;
+    Context *context = athlete(message);
+    if (context == NULL) return error(message);
+
+    // the built in metrics don't use the data filter
+    QList<RideMetric*> metrics;
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    foreach(QString symbol, factory.allMetrics()) {
+        const RideMetric *metric = factory.rideMetric(symbol);
+        if (metric && metric->isUser()) metrics << metric->clone();
+    }
+    if (metrics.isEmpty()) return error("athlete has no user metrics");
+
+    int activities = 0, computed = 0, mismatches = 0;
+    qint64 eval = 0, fast = 0;
+    QHash<QString,RideMetric*> deps; // none, they use the item's values
+
+    foreach(RideItem *item, context->athlete->rideCache->rides()) {
+
+        bool wasOpen = item->isOpen();
+        if (item->planned || item->ride() == NULL) continue;
+        activities++;
+
+        // the first pass is a warm up, the best of each is kept
+        QVector<double> evalValues(metrics.count()), fastValues(metrics.count());
+        qint64 bestEval = -1, bestFast = -1;
+        for (int pass=0; pass <= BENCHMARK_PASSES; pass++) {
+
+            QElapsedTimer timer;
+
+            UserMetric::reductions = false;
+            timer.start();
+            for (int i=0; i<metrics.count(); i++) {
+                metrics[i]->compute(item, Specification(), deps);
+                evalValues[i] = metrics[i]->value(true);
+            }
+            qint64 nsecs = timer.nsecsElapsed();
+            if (pass && (bestEval < 0 || nsecs < bestEval)) bestEval = nsecs;
+
+            UserMetric::reductions = true;
+            timer.restart();
+            for (int i=0; i<metrics.count(); i++) {
+                metrics[i]->compute(item, Specification(), deps);
+                fastValues[i] = metrics[i]->value(true);
+            }
+            nsecs = timer.nsecsElapsed();
+            if (pass && (bestFast < 0 || nsecs < bestFast)) bestFast = nsecs;
+        }
+        eval += bestEval;
+        fast += bestFast;
+
+        // exactly the same, not just close
+        for (int i=0; i<metrics.count(); i++) {
+            computed++;
+            if (evalValues[i] != fastValues[i] && !(std::isnan(evalValues[i]) && std::isnan(fastValues[i])))
+                mismatches++;
+        }
+
+        if (!wasOpen) item->close();
+    }
+    qDeleteAll(metrics);
+
+    out.insert("athlete", target);
+    out.insert("activities", activities);
+    out.insert("metrics", metrics.count());
+    out.insert("computed", computed);
+    out.insert("mismatches", mismatches);
+    out.insert("eval_ms", double(eval) / 1000000.0);
+    out.insert("fast_ms", double(fast) / 1000000.0);
+    out.insert("speedup", fast > 0 ? double(eval) / double(fast) : 0);
+    return 0;
+}
+
+// everything computeDistributions() fills in
+QList<QVector<float> >
+HeadlessBenchmark::distributionArrays(RideFileCache &cache)
+{
+    QList<QVector<float> > arrays;
+    arrays << cache.wattsDistribution << cache.hrDistribution << cache.cadDistribution
+           << cache.gearDistribution << cache.nmDistribution << cache.kphDistribution
+           << cache.wattsKgDistribution << cache.aPowerDistribution << cache.smo2Distribution
+           << cache.wattsTimeInZone << cache.wattsCPTimeInZone << cache.hrTimeInZone
+           << cache.hrCPTimeInZone << cache.paceTimeInZone << cache.paceCPTimeInZone;
+    return arrays;
+}
+
+int
+HeadlessBenchmark::distributions(QJsonObject &out)
+{
+    QString message;
+    Context *context = athlete(message);
+    if (context == NULL) return error(message);
+
+    int activities = 0, samples = 0, mismatches = 0;
+    qint64 perseries = 0, single = 0;
+
+    foreach(RideItem *item, context->athlete->rideCache->rides()) {
+
+        bool wasOpen = item->isOpen();
+        if (item->planned || item->ride() == NULL) continue;
+        activities++;
+        samples += item->ride()->dataPoints().count();
+
+        // the arrays accumulate, so a new cache for each run
+        // the first pass is a warm up, the best of each is kept
+        QList<QVector<float> > before, after;
+        qint64 bestBefore = -1, bestAfter = -1;
+        for (int pass=0; pass <= BENCHMARK_PASSES; pass++) {
+
+            QElapsedTimer timer;
+
+            RideFileCache old(item->ride(), false);
+            timer.start();
+            old.computeDistributionsPerSeries();
+            qint64 nsecs = timer.nsecsElapsed();
+            if (pass && (bestBefore < 0 || nsecs < bestBefore)) bestBefore = nsecs;
+
+            RideFileCache now(item->ride(), false);
+            timer.restart();
+            now.computeDistributions();
+            nsecs = timer.nsecsElapsed();
+            if (pass && (bestAfter < 0 || nsecs < bestAfter)) bestAfter = nsecs;
+
+            if (pass == 0) {
+                before = distributionArrays(old);
+                after = distributionArrays(now);
+            }
+        }
+        perseries += bestBefore;
+        single += bestAfter;
+
+        // exactly the same, not just close
+        for (int i=0; i<before.count(); i++) if (before[i] != after[i]) mismatches++;
+
+        if (!wasOpen) item->close();
+    }
+
+    out.insert("athlete", target);
+    out.insert("activities", activities);
+    out.insert("samples", samples);
+    out.insert("mismatches", mismatches);
+    out.insert("perseries_ms", double(perseries) / 1000000.0);
+    out.insert("single_ms", double(single) / 1000000.0);
+    out.insert("speedup", single > 0 ? double(perseries) / double(single) : 0);
+    return 0;
+}
+
+int
+HeadlessBenchmark::gcb(QJsonObject &out)
+{
+    // a folder of files, or the athlete's activities
+    QString folder = target;
+    if (!QFileInfo(folder).isDir()) folder = home.canonicalPath() + "/" + target + "/activities";
+    if (!QFileInfo(folder).isDir()) return error("no folder of gcb files");
+
+    QStringList files;
+    QDirIterator it(folder, QStringList() << "*.gcb", QDir::Files);
+    while (it.hasNext()) files << it.next();
+    files.sort();
+    if (files.isEmpty()) return error("no gcb files in " + folder);
+
+    // what a chart of power and heartrate would ask for
+    QStringList series;
+    series << "SECS" << "WATTS" << "HR";
+
+    GcbFileReader reader;
+    qint64 bytes = 0, samples = 0, bestAll = -1, bestSubset = -1;
+    int failed = 0, mismatches = 0;
+
+    // the first pass warms the disk cache and checks the subset
+    // against everything, the best of the rest is kept
+    for (int pass=0; pass <= BENCHMARK_PASSES; pass++) {
+
+        QElapsedTimer timer;
+        qint64 all = 0, subset = 0;
+
+        bytes = samples = 0;
+        failed = 0;
+        foreach(QString filename, files) {
+
+            QStringList errors;
+            QFile allFile(filename);
+            timer.start();
+            RideFile *full = reader.openRideFile(allFile, errors);
+            all += timer.nsecsElapsed();
+
+            QFile subsetFile(filename);
+            timer.restart();
+            RideFile *part = reader.openRideFile(subsetFile, errors, series, false);
+            subset += timer.nsecsElapsed();
+
+            bytes += allFile.size();
+            if (full == NULL || part == NULL) failed++;
+            else {
+                samples += full->dataPoints().count();
+
+                if (pass == 0) {
+                    bool same = part->dataPoints().count() == full->dataPoints().count() && part->xdata().isEmpty();
+                    for (int i=0; same && i<full->dataPoints().count(); i++) {
+                        const RideFilePoint *a = full->dataPoints()[i], *b = part->dataPoints()[i];
+                        same = a->secs == b->secs && a->watts == b->watts && a->hr == b->hr;
+                    }
+                    if (!same) mismatches++;
+                }
+            }
+            delete full;
+            delete part;
+        }
+
+        if (pass && (bestAll < 0 || all < bestAll)) bestAll = all;
+        if (pass && (bestSubset < 0 || subset < bestSubset)) bestSubset = subset;
+    }
+
+    out.insert("folder", folder);
+    out.insert("files", files.count());
+    out.insert("failed", failed);
+    out.insert("bytes", double(bytes));
+    out.insert("samples", double(samples));
+    out.insert("series", series.join(","));
+    out.insert("mismatches", mismatches);
+    out.insert("all_ms", double(bestAll) / 1000000.0);
+    out.insert("subset_ms", double(bestSubset) / 1000000.0);
+    out.insert("speedup", bestSubset > 0 ? double(bestAll) / double(bestSubset) : 0);
+    return 0;
+}
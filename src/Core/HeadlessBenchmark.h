@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_HeadlessBenchmark_h
+#define _GC_HeadlessBenchmark_h 1
+#include "GoldenCheetah.h"
+
+#include <QDir>
+#include <QString>
+#include <QJsonObject>
+#include <QList>
+#include <QVector>
+
+class RideFile;
+class Context;
+class RideFileCache;
+
+//
+// Benchmarks run without a gui (--benchmark=name on the command line)
+// so changes to the hot paths can be measured and checked. Results
+// are written to stdout as json, like --rebuild.
+//
+//  fit     - decode every FIT file in a folder, or the athlete's imports
+//  bests   - find the peak power, hr and speed of each activity with
+//            BestEfforts and with findPeaks, they must be the same
+//  usermetrics - compute the athlete's user metrics for each activity
+//            a column at a time and with eval, they must be the same
+//  distributions - bin the samples and time in zone for each of the
+//            athlete's activities in one pass and with a pass per
+//            series as before, they must be the same
+//  gcb     - read every .gcb file in a folder, or the athlete's
+//            activities, in full and just secs, power and heartrate
+//            skipping the other columns, the series read must be the same
+//
+// Benchmarks that compare a fast path with the original report any
+// mismatches and exit with 1 if there were some.
+//
+class HeadlessBenchmark
+{
+    public:
+
+        HeadlessBenchmark(QDir home, QString target, QString name) : home(home), target(target), name(name) {}
+
+        // returns the exit code
+        int run();
+
+        static QStringList names();
+
+    private:
+
+        int fit(QJsonObject &out);
+        int bests(QJsonObject &out);
+        int usermetrics(QJsonObject &out);
+        int distributions(QJsonObject &out);
+        int gcb(QJsonObject &out);
+        static QList<QVector<float> > distributionArrays(RideFileCache &cache);
+
+        // a folder of activities, or the athlete's, read in (not timed)
+        QList<RideFile*> activities(QString &folder, QStringList &failed);
+
+        // the athlete opened and refreshed, so metrics are up to date
+        Context *athlete(QString &message);
+
+        int error(QString message);
+
+        QDir home;
+        QString target;     // athlete, or folder of files
+        QString name;
+};
+
+#endif // _GC_HeadlessBenchmark_h
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "HeadlessRebuild.h"
+#include "RebuildStats.h"
+
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "Estimator.h"
+#include "Settings.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <stdio.h>
+
+int
+HeadlessRebuild::error(QString message)
+{
+    QJsonObject out;
+    out.insert("athlete", cyclist);
+    out.insert("error", message);
+    fprintf(stdout, "%s\n", QJsonDocument(out).toJson(QJsonDocument::Compact).constData());
+    fflush(stdout);
+    return 1;
+}
+
+bool
+HeadlessRebuild::canOpen(QDir home, QString cyclist, QString &error)
+{
+    QDir athlete(home.canonicalPath() + "/" + cyclist);
+    if (cyclist == "" || !athlete.exists()) {
+        error = "unknown athlete";
+        return false;
+    }
+
+    // we can't run the upgrade wizard without a gui, so it
+    // must have been opened in the gui at least once before
+    appsettings->initializeQSettingsAthlete(home.canonicalPath(), cyclist);
+    if (appsettings->cvalue(cyclist, GC_VERSION_USED, 0).toInt() == 0) {
+        error = "athlete has not been opened yet, open it in GoldenCheetah first";
+        return false;
+    }
+    return true;
+}
+
+Context *
+HeadlessRebuild::open(QDir home, QString cyclist, QString &error)
+{
+    if (!canOpen(home, cyclist, error)) return NULL;
+
+    // the athlete blocks until the ride cache is loaded
+    Context *context = new Context(NULL);
+    new Athlete(context, QDir(home.canonicalPath() + "/" + cyclist));
+    return context;
+}
+
+int
+HeadlessRebuild::run()
+{
+    QElapsedTimer total;
+    total.start();
+
+    RebuildStats::setEnabled(true);
+
+    // check before we delete anything
+    QString message;
+    if (!canOpen(home, cyclist, message)) return error(message);
+
+    // everything, so the .cpx files are recreated too
+    if (full) {
+        QDir cache(home.canonicalPath() + "/" + cyclist + "/cache");
+        foreach(QString name, cache.entryList(QStringList() << "*.cpx", QDir::Files))
+            cache.remove(name);
+    }
+
+    // open, the athlete then starts refreshing anything out of date
+    QElapsedTimer timer;
+    timer.start();
+    Context *context = open(home, cyclist, message);
+    if (context == NULL) return error(message);
+    RideCache *rideCache = context->athlete->rideCache;
+    qint64 load = timer.elapsed();
+
+    // refresh
+    timer.restart();
+    if (full) rideCache->refreshAll();
+    while (rideCache->isRunning()) {
+
+        // items signal changes to the gui thread as they go
+        QApplication::processEvents(QEventLoop::AllEvents, 50);
+        QThread::msleep(10);
+    }
+    QApplication::processEvents();
+    rideCache->save();
+    qint64 refresh = timer.elapsed();
+
+    // estimates
+    timer.restart();
+    rideCache->estimator->calculate();
+    rideCache->estimator->wait();
+    qint64 estimates = timer.elapsed();
+
+    appsettings->setCValue(cyclist, GC_SAFEEXIT, true);
+
+    // times for each stage are summed across all the threads
+    QJsonObject stages;
+    for(int i=0; i<RebuildStats::Stages; i++) {
+        RebuildStats::stage s = static_cast<RebuildStats::stage>(i);
+        stages.insert(RebuildStats::name(s), double(RebuildStats::nsecs(s)) / 1000000.0);
+    }
+    stages.insert("estimates", double(estimates));
+
+    QJsonObject wall;
+    wall.insert("load", double(load));
+    wall.insert("refresh", double(refresh));
+    wall.insert("estimates", double(estimates));
+    wall.insert("total", double(total.elapsed()));
+
+    QJsonObject out;
+    out.insert("athlete", cyclist);
+    out.insert("mode", full ? "full" : "incremental");
+    out.insert("threads", QThreadPool::globalInstance()->maxThreadCount());
+    out.insert("rides", rideCache->count());
+    out.insert("refreshed", RebuildStats::refreshCount());
+    out.insert("stages_ms", stages);
+    out.insert("wall_ms", wall);
+    out.insert("peak_rss_kb", double(RebuildStats::peakRSS()));
+
+    fprintf(stdout, "%s\n", QJsonDocument(out).toJson(QJsonDocument::Compact).constData());
+    fflush(stdout);
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_HeadlessRebuild_h
+#define _GC_HeadlessRebuild_h 1
+#include "GoldenCheetah.h"
+
+#include <QDir>
+#include <QString>
+
+class Context;
+
+//
+// Rebuild an athlete without a main window (--rebuild on the command line)
+// for nightly rebuilds on servers and tracking performance.
+//
+// The athlete is opened, the ride cache refreshed using all cores
+// (everything when full, otherwise just what is out of date) and the
+// estimates recalculated. Timings for each stage and the peak memory
+// used are written to stdout as json.
+//
+class HeadlessRebuild
+{
+    public:
+
+        HeadlessRebuild(QDir home, QString cyclist, bool full) : home(home), cyclist(cyclist), full(full) {}
+
+        // returns the exit code
+        int run();
+
+        // open an athlete without a main window, blocks until the
+        // ride cache is loaded and returns NULL with error set if
+        // it can't be opened this way
+        static Context *open(QDir home, QString cyclist, QString &error);
+
+        // the athlete exists and has been opened in the gui before
+        static bool canOpen(QDir home, QString cyclist, QString &error);
+
+    private:
+
+        int error(QString message);
+
+        QDir home;
+        QString cyclist;
+        bool full;
+};
+
+#endif // _GC_HeadlessRebuild_h
@@ -103,13 +103,26 @@ IntervalItem::refresh()
     metrics_.fill(0, factory.metricCount());
     count_.fill(0, factory.metricCount());
 
+    refresh(factory.allMetrics());
+}
+
+void
+IntervalItem::refresh(const QStringList &symbols)
+{
+    // metrics
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+
+    // the others keep their values
+    metrics_.resize(factory.metricCount());
+    count_.resize(factory.metricCount());
+
     // don't open on our account - we should be called with a ride available
     RideFile *f = rideItem_->ride_;
     if (!f) return;
 
 
     // ok, lets collect the metrics
-    QHash<QString,RideMetricPtr> computed=RideMetric::computeMetrics(rideItem_, Specification(this, f->recIntSecs()), factory.allMetrics());
+    QHash<QString,RideMetricPtr> computed=RideMetric::computeMetrics(rideItem_, Specification(this, f->recIntSecs()), symbols);
     // take a deep copy, quick before the thread exits.
     //XXXcomputed.detach();
 
@@ -121,6 +134,8 @@ IntervalItem::refresh()
         count_[i.value()->index()] = i.value()->count();
         double stdmean = i.value()->stdmean();
         double stdvariance = i.value()->stdvariance();
+        stdmean_.remove(i.value()->index());
+        stdvariance_.remove(i.value()->index());
         if (stdmean || stdvariance) {
             stdmean_.insert(i.value()->index(), stdmean);
             stdvariance_.insert(i.value()->index(), stdvariance);
@@ -75,6 +75,7 @@ class IntervalItem
 
         // precomputed metrics
         void refresh();
+        void refresh(const QStringList &symbols); // just these metrics
         QVector<double> metrics_;
         QVector<double> count_;
         QMap <int, double>stdmean_;
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RebuildStats.h"
+
+#ifdef Q_OS_WIN
+#define PSAPI_VERSION 2 // in kernel32, no need to link psapi
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+bool RebuildStats::enabled_ = false;
+QAtomicInteger<qint64> RebuildStats::nsecs_[RebuildStats::Stages];
+QAtomicInteger<int> RebuildStats::refreshed_;
+
+QString
+RebuildStats::name(stage s)
+{
+    switch(s) {
+    case Open : return "open";
+    case Derived : return "derived";
+    case Metrics : return "metrics";
+    case Intervals : return "intervals";
+    case Cpx : return "cpx";
+    default: return "";
+    }
+}
+
+qint64
+RebuildStats::peakRSS()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize / 1024;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef Q_OS_MAC
+    return usage.ru_maxrss / 1024; // bytes on a mac
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RebuildStats_h
+#define _GC_RebuildStats_h 1
+#include "GoldenCheetah.h"
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QString>
+
+//
+// Time spent in each stage of refreshing rides, summed across all of
+// the refresh threads. Only collected when enabled (the headless
+// rebuild) so there is no cost otherwise.
+//
+class RebuildStats
+{
+    public:
+
+        enum stage { Open=0, Derived, Metrics, Intervals, Cpx, Stages };
+
+        static void setEnabled(bool x) { enabled_ = x; }
+        static bool enabled() { return enabled_; }
+
+        static void add(stage s, qint64 nsecs) { nsecs_[s].fetchAndAddRelaxed(nsecs); }
+        static qint64 nsecs(stage s) { return nsecs_[s].load(); }
+        static QString name(stage s);
+
+        // rides refreshed
+        static void refreshed() { if (enabled_) refreshed_.fetchAndAddRelaxed(1); }
+        static int refreshCount() { return refreshed_.load(); }
+
+        // peak resident set size for the process, in kbytes
+        static qint64 peakRSS();
+
+        // times the scope it is declared in
+        class Timer
+        {
+            public:
+                Timer(stage s) : s(s) { if (enabled_) timer.start(); }
+                ~Timer() { if (timer.isValid()) add(s, timer.nsecsElapsed()); }
+
+            private:
+                stage s;
+                QElapsedTimer timer;
+        };
+
+    private:
+        static bool enabled_;
+        static QAtomicInteger<qint64> nsecs_[Stages];
+        static QAtomicInteger<int> refreshed_;
+};
+
+#endif // _GC_RebuildStats_h
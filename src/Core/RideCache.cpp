@@ -68,7 +68,12 @@ RideCache::RideCache(Context *context) : context(context)
 
     progress_ = 100;
     exiting = false;
+    generation_ = 0;
     estimator = new Estimator(context);
+    fswatcher = NULL;
+
+    // signatures of the files that were up to date last time
+    loadJournal();
 
     // initial load of user defined metrics - do once we have an initial context
     // but before we refresh or check metrics for the first time
@@ -169,6 +174,218 @@ RideCache::postLoad()
     connect(&watcher, SIGNAL(finished()), context, SLOT(notifyRefreshEnd()));
     connect(&watcher, SIGNAL(started()), context, SLOT(notifyRefreshStart()));
     connect(&watcher, SIGNAL(progressValueChanged(int)), this, SLOT(progressing(int)));
+
+    // files added, changed or removed behind our back, we wait for
+    // things to settle since sync tools tend to write in bursts
+    foreach(RideItem *item, rides_) listing_.insert(rideKey(item), RideFileSignature(QFileInfo(rideFilePath(item))));
+    rescanTimer.setSingleShot(true);
+    rescanTimer.setInterval(1000);
+    connect(&rescanTimer, SIGNAL(timeout()), this, SLOT(rescan()));
+    fswatcher = new QFileSystemWatcher(this);
+    fswatcher->addPath(directory.canonicalPath());
+    fswatcher->addPath(plannedDirectory.canonicalPath());
+    connect(fswatcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+}
+
+//
+// File signature journal
+//
+// Checking if a ride is stale means looking at the ride file and
+// its .cpx, computing a crc for the former and reading the header
+// of the latter. With thousands of rides that adds up at startup.
+//
+// When we save rideDB.json we also note the size and timestamp of
+// the ride file and .cpx for every ride that is up to date, as they
+// were when the ride was last refreshed or checked (not as they are
+// now, an edit we missed since would look up to date). If they are
+// the same at startup there is no need to look any further.
+//
+// The journal is only valid for the schema and cache versions it was
+// written with, when either changes everything is checked as before.
+//
+static const quint32 RideJournalMagic = 0x47435347; // "GCSG"
+
+QString
+RideCache::rideFilePath(RideItem *item) const
+{
+    return (item->planned ? plannedDirectory : directory).canonicalPath() + "/" + item->fileName;
+}
+
+QString
+RideCache::cacheFilePath(RideItem *item) const
+{
+    return context->athlete->home->cache().canonicalPath() + (item->planned ? "/planned/" : "/")
+           + QFileInfo(item->fileName).baseName() + ".cpx";
+}
+
+QString
+RideCache::rideKey(RideItem *item) const
+{
+    return QString(item->planned ? "planned/" : "activities/") + item->fileName;
+}
+
+void
+RideCache::loadJournal()
+{
+    journal_.clear();
+
+    QFile file(context->athlete->home->cache().canonicalPath() + "/rideDB.sig");
+    if (!file.open(QFile::ReadOnly)) return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, cacheversion;
+    qint32 schemaversion;
+    in >> magic >> schemaversion >> cacheversion;
+    if (magic != RideJournalMagic || schemaversion != DBSchemaVersion || cacheversion != RideFileCacheVersion) return;
+
+    quint32 count;
+    in >> count;
+    for (quint32 i=0; i<count && in.status() == QDataStream::Ok; i++) {
+        QString key;
+        RideFileSignature ride, cpx;
+        in >> key >> ride.size >> ride.modified >> cpx.size >> cpx.modified;
+        journal_.insert(key, ride);
+        journal_.insert(key + ".cpx", cpx);
+    }
+
+    // truncated or corrupt, trust none of it
+    if (in.status() != QDataStream::Ok) journal_.clear();
+}
+
+void
+RideCache::saveJournal()
+{
+    journal_.clear();
+
+    QFile file(context->athlete->home->cache().canonicalPath() + "/rideDB.sig");
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) return;
+
+    // only those that are up to date and we know the files for
+    QList<RideItem*> clean;
+    foreach(RideItem *item, rides_)
+        if (!item->isstale && !item->isdirty && item->rideSignature.isValid() && item->cpxSignature.isValid())
+            clean << item;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << RideJournalMagic << qint32(DBSchemaVersion) << quint32(RideFileCacheVersion) << quint32(clean.count());
+
+    foreach(RideItem *item, clean) {
+        const RideFileSignature &ride = item->rideSignature;
+        const RideFileSignature &cpx = item->cpxSignature;
+        out << rideKey(item) << ride.size << ride.modified << cpx.size << cpx.modified;
+    }
+    file.close();
+}
+
+bool
+RideCache::isUnchanged(RideItem *item)
+{
+    QString key = rideKey(item);
+    QHash<QString, RideFileSignature>::const_iterator ride = journal_.constFind(key);
+    if (ride == journal_.constEnd() || ride.value().size < 0) return false;
+
+    // we still stat, an edit in place doesn't change the folder
+    if (RideFileSignature(QFileInfo(rideFilePath(item))) != ride.value()) return false;
+
+    QHash<QString, RideFileSignature>::const_iterator cpx = journal_.constFind(key + ".cpx");
+    if (cpx == journal_.constEnd() || cpx.value().size < 0) return false;
+    if (RideFileSignature(QFileInfo(cacheFilePath(item))) != cpx.value()) return false;
+
+    // still what we knew was up to date
+    item->rideSignature = ride.value();
+    item->cpxSignature = cpx.value();
+    return true;
+}
+
+void
+RideCache::directoryChanged(QString)
+{
+    // restart the clock, we rescan once it all goes quiet
+    rescanTimer.start();
+}
+
+void
+RideCache::rescan()
+{
+    // not while we're refreshing, try again later
+    if (future.isRunning()) {
+        rescanTimer.start();
+        return;
+    }
+
+    // adding a ride closes the current one, so wait until
+    // any changes to it are saved (which will get us back here)
+    if (context->ride && context->ride->isdirty) return;
+
+    bool changed = false;
+    QHash<QString, RideFileSignature> listing;
+
+    for (int p=0; p<2; p++) {
+
+        bool planned = (p == 1);
+        QDir &dir = planned ? plannedDirectory : directory;
+        QString prefix = planned ? "planned/" : "activities/";
+
+        foreach(QString name, RideFileFactory::instance().listRideFiles(dir)) {
+
+            QDateTime dt;
+            if (!RideFile::parseRideFileName(name, &dt)) continue;
+
+            QString key = prefix + name;
+            RideFileSignature sig(QFileInfo(dir.canonicalPath() + "/" + name));
+            listing.insert(key, sig);
+
+            // a new one
+            if (!listing_.contains(key)) {
+                if (getRide(name) == NULL) {
+                    addRide(name, true, false, false, planned);
+                    changed = true;
+                }
+                continue;
+            }
+
+            // modified, checkStale will work out if its really changed (crc)
+            // but we close it so the new content gets read on refresh
+            if (sig != listing_.value(key)) {
+                RideItem *item = getRide(name);
+                if (item && !item->isdirty && item != context->ride) {
+                    if (item->isOpen()) item->close();
+                    journal_.remove(key);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // removed, but leave alone if being worked on
+    QHashIterator<QString, RideFileSignature> i(listing_);
+    while (i.hasNext()) {
+        i.next();
+        if (listing.contains(i.key())) continue;
+
+        RideItem *item = getRide(i.key().mid(i.key().indexOf('/')+1));
+        if (item == NULL || item->isdirty || item == context->ride) continue;
+
+        int index = rides_.indexOf(item);
+        if (index < 0) continue;
+
+        model_->startRemove(index);
+        rides_.remove(index, 1);
+        delete_ << item;
+        model_->endRemove(index);
+        journal_.remove(i.key());
+
+        context->notifyRideDeleted(item);
+        changed = true;
+    }
+
+    listing_ = listing;
+
+    // recompute the ones that changed
+    if (changed) refresh();
 }
 
 struct comparerideitem { bool operator()(const RideItem *p1, const RideItem *p2) { return p1->dateTime < p2->dateTime; } };
@@ -218,6 +435,8 @@ RideCache::initEstimates()
 void
 RideCache::configChanged(qint32 what)
 {
+    // zones, cp, weight, user metrics ... may all change results
+    generation_++;
 
     // if the wbal formula changed invalidate all cached values
     if (what & CONFIG_WBAL) {
@@ -289,18 +508,21 @@ RideCache::addRide(QString name, bool dosignal, bool select, bool useTempActivit
     bool added = false;
     for (int index=0; index < rides_.count(); index++) {
         if (rides_[index]->fileName == last->fileName) {
+            model_->itemChanged(rides_[index]);
             rides_[index] = last;
             added = true;
             break;
         }
     }
 
-    // add and sort, model needs to know !
+    // insert in date order, model needs to know !
+    // but no need to reset the whole thing
     if (!added) {
-        model_->beginReset();
-        rides_ << last;
-        qSort(rides_.begin(), rides_.end(), rideCacheLessThan);
-        model_->endReset();
+        QVector<RideItem*>::iterator i = std::upper_bound(rides_.begin(), rides_.end(), last, comparerideitem());
+        int index = i - rides_.begin();
+        model_->startInsert(index);
+        rides_.insert(index, last);
+        model_->endInsert(index);
     }
 
     // refresh metrics for *this ride only*
@@ -539,6 +761,7 @@ RideCache::refresh()
     // start if there is work to do
     // and future watcher can notify of updates
     if (staleCount)  {
+        generation_++;
         reverse_ = rides_;
         qSort(reverse_.begin(), reverse_.end(), rideCacheGreaterThan);
         future = QtConcurrent::map(reverse_, itemRefresh);
@@ -554,6 +777,18 @@ RideCache::refresh()
     }
 }
 
+void
+RideCache::refreshAll()
+{
+    cancel();
+
+    foreach(RideItem *item, rides_) {
+        item->isstale = true;
+        item->staleinputs = 0;
+    }
+    refresh();
+}
+
 QString
 RideCache::getAggregate(QString name, Specification spec, bool useMetricUnits, bool nofmt)
 {
@@ -27,6 +27,10 @@
 
 #include <QVector>
 #include <QThread>
+#include <QHash>
+#include <QTimer>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 
 #include <QFuture>
 #include <QFutureWatcher>
@@ -40,6 +44,7 @@ class AthleteBest;
 class RideCacheModel;
 class Estimator;
 class Banister;
+class HeadlessRebuild;
 
 class RideCache : public QObject
 {
@@ -82,6 +87,10 @@ class RideCache : public QObject
         // is running ?
         bool isRunning() { return future.isRunning(); }
 
+        // changes each time the config changes or a refresh starts, anything
+        // computed from the metrics (e.g. api queries) is out of date when it does
+        int generation() const { return generation_; }
+
         // the ride list
 	    QVector<RideItem*>&rides() { return rides_; } 
 
@@ -94,8 +103,19 @@ class RideCache : public QObject
 
         // the background refresher !
         void refresh();
+
+        // refresh all of them, even if up to date (headless --rebuild --full)
+        void refreshAll();
         double progress() { return progress_; }
 
+        // are the ride file and its .cpx the same as when they
+        // were last known to be up to date (see saveJournal)
+        bool isUnchanged(RideItem *);
+
+        // where the ride file and its .cpx live
+        QString rideFilePath(RideItem *) const;
+        QString cacheFilePath(RideItem *) const;
+
     public slots:
 
         // restore / dump cache to disk (json)
@@ -124,6 +144,10 @@ class RideCache : public QObject
         // first run to initialise estimates
         void initEstimates();
 
+        // files added, changed or removed by something else
+        void directoryChanged(QString);
+        void rescan();
+
     signals:
 
         void modelProgress(int, int); // let others know when we're refreshing the model estimates
@@ -142,6 +166,7 @@ class RideCache : public QObject
         friend class ::Leaf; // get weekly performances
         friend class ::RideItem; // adds to deletelist in destructor
         friend class ::NavigationModel; // checks deletelist during redo/undo
+        friend class ::HeadlessRebuild; // runs the estimates
 
         Context *context;
         QDir directory, plannedDirectory;
@@ -152,6 +177,7 @@ class RideCache : public QObject
         QVector<RideItem*> rides_, reverse_, delete_, deletelist;
         RideCacheModel *model_;
         bool exiting;
+        int generation_;
 	    double progress_; // percent
 
         QFuture<void> future;
@@ -159,6 +185,19 @@ class RideCache : public QObject
 
         Estimator *estimator;
         bool first; // updated when estimates are marked stale
+
+        // journal of file signatures for rides that were up to date
+        // when rideDB.json was saved, keyed by path relative to home
+        QHash<QString, RideFileSignature> journal_;
+        void loadJournal();
+        void saveJournal();
+        QString rideKey(RideItem *) const;
+
+        // watch the activity folders for changes made by other
+        // programs (sync tools, scripts) while we are running
+        QFileSystemWatcher *fswatcher;
+        QTimer rescanTimer;
+        QHash<QString, RideFileSignature> listing_; // what we saw last time
 };
 
 class AthleteBest
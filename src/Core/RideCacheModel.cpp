@@ -62,14 +62,46 @@ RideCacheModel::flags(const QModelIndex &index) const
 QVariant 
 RideCacheModel::data(const QModelIndex &index, int role) const
 {
-    Q_UNUSED(role);
-
     if (!index.isValid() || index.row() < 0 || index.row() >= rideCache->count() ||
         index.column() < 0 || index.column() >= columns_) return QVariant();
 
     const RideItem *item = rideCache->rides().at(index.row());
 
-    switch (index.column()) {
+    // sort on the raw value
+    if (role == SortRole) return value(item, index.column());
+
+    // only metrics are expensive to format, so we only keep those
+    int i = index.column()-5;
+    if (index.column() <= 5 || i >= columnMetrics.count()) return format(item, index.column());
+
+    // formatted already ?
+    QHash<const RideItem*, QVector<QVariant> >::iterator cells = formatted.find(item);
+    if (cells == formatted.end()) cells = formatted.insert(item, QVector<QVariant>(columnMetrics.count()));
+
+    QVariant &cell = (*cells)[i];
+    if (!cell.isValid()) cell = format(item, index.column());
+    return cell;
+}
+
+QVariant
+RideCacheModel::value(const RideItem *item, int column) const
+{
+    int i = column-5;
+    if (column <= 5 || i >= columnMetrics.count()) return format(item, column);
+
+    // the metric value, converted to imperial if needed
+    RideMetric *m = columnMetrics[i];
+    double value = item->metrics_[m->index()];
+    if (!m->isTime() && GlobalContext::context()->useMetricUnits == false)
+        value = (value * m->conversion()) + m->conversionSum();
+
+    return value;
+}
+
+QVariant
+RideCacheModel::format(const RideItem *item, int column) const
+{
+    switch (column) {
         case 0 : return item->path;
         case 1 : return item->fileName;
         case 2 : return item->dateTime;
@@ -81,29 +113,29 @@ RideCacheModel::data(const QModelIndex &index, int role) const
         {
             // from here we're either a metric or meta
             // lets work that out ...
-            if (index.column()-5 < factory->metricCount()) {
+            if (column-5 < columnMetrics.count()) {
 
                 // is a metric
-                int i=index.column()-5;
+                int i=column-5;
 
                 // unpack metric value into ridemetric and use it to get a stringified
                 // version using the right metric/imperial conversion
-                RideMetric *m = const_cast<RideMetric*>(factory->rideMetric(factory->metricName(i)));
+                RideMetric *m = columnMetrics[i];
 
                 // bit of a kludge, but will return times as QTime,
                 // stuff with no decimal places as a number,
                 // but not if high precision, which means
                 // metrics with high precision don't sort this is crap XXX
                 if (m->isTime()) {
-                    return QTime(0,0,0).addSecs(rideCache->rides().at(index.row())->metrics_[m->index()]);
+                    return QTime(0,0,0).addSecs(item->metrics_[m->index()]);
                 } else if (m->units(true) != "km" && m->precision() > 0) {
-                    m->setValue(rideCache->rides().at(index.row())->metrics_[m->index()]);
+                    m->setValue(item->metrics_[m->index()]);
                     return m->toString(GlobalContext::context()->useMetricUnits); // string
                 } else {
 
                     // make low precision numbers sort, including distance which we picked
                     // up as a special case. not sure about pace ....
-                    double value = rideCache->rides().at(index.row())->metrics_[m->index()];
+                    double value = item->metrics_[m->index()];
 
                     // convert to imperial if needed
                     if (GlobalContext::context()->useMetricUnits == false) 
@@ -115,7 +147,7 @@ RideCacheModel::data(const QModelIndex &index, int role) const
             } else {
 
                 // is a metadata
-                int i = index.column() -5 - factory->metricCount();
+                int i = column -5 - columnMetrics.count();
                 return item->getText(metadata[i].name, "");
             }
         }
@@ -125,9 +157,15 @@ RideCacheModel::data(const QModelIndex &index, int role) const
 void
 RideCacheModel::itemChanged(RideItem *item)
 {
+    // reformat when next painted
+    formatted.remove(item);
+
+    // binary search, but it may have moved if the date changed
+    int row = rideCache->find(item);
+    if (row < 0 || rideCache->rides().at(row) != item) row = rideCache->rides().indexOf(item);
+
     // ok so lets signal that
-    int row = rideCache->rides().indexOf(item);
-    if (row >= 0 && row <= rideCache->count()) {
+    if (row >= 0 && row < rideCache->count()) {
         emit dataChanged(createIndex(row,0), createIndex(row,columns_-1));
     }
     //XXX hack to get the navigator to redraw
@@ -148,6 +186,7 @@ RideCacheModel::itemAdded(RideItem*)
 void
 RideCacheModel::startRemove(int index)
 {
+    formatted.remove(rideCache->rides().at(index));
     beginRemoveRows(QModelIndex(), index, index);
 }
 
@@ -157,6 +196,18 @@ RideCacheModel::endRemove(int)
     endRemoveRows();
 }
 
+void
+RideCacheModel::startInsert(int index)
+{
+    beginInsertRows(QModelIndex(), index, index);
+}
+
+void
+RideCacheModel::endInsert(int)
+{
+    endInsertRows();
+}
+
 bool 
 RideCacheModel::setHeaderData (int section, Qt::Orientation orientation, const QVariant &value, int role)
 {
@@ -189,6 +240,14 @@ RideCacheModel::configChanged(qint32)
     // get field config
     metadata = GlobalContext::context()->rideMetadata->getFields();
 
+    // metric columns, looked up once not on every call to data()
+    columnMetrics.clear();
+    for (int i=0; i<factory->metricCount(); i++)
+        columnMetrics << const_cast<RideMetric*>(factory->rideMetric(factory->metricName(i)));
+
+    // units, precision or fields may have changed
+    formatted.clear();
+
     // set new column count
     // 0    QString path;
     // 1    QString fileName;
@@ -241,6 +300,8 @@ RideCacheModel::configChanged(qint32)
 void 
 RideCacheModel::refreshUpdate(QDate)
 {
+    // metrics are being recomputed
+    formatted.clear();
 }
 
 void 
@@ -251,4 +312,5 @@ RideCacheModel::refreshStart()
 void 
 RideCacheModel::refreshEnd()
 {
+    formatted.clear();
 }
@@ -40,6 +40,11 @@ class RideCacheModel : public QAbstractTableModel
     public:
         RideCacheModel(Context *, RideCache *);
 
+        // raw numeric values for sorting metric columns, the
+        // display role returns formatted values which sort badly
+        // NOTE: Qt::UserRole to UserRole+2 are used by the navigator
+        enum { SortRole = Qt::UserRole + 10 };
+
         // must reimplement these
         int rowCount(const QModelIndex &parent = QModelIndex()) const; 
         int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -70,11 +75,27 @@ class RideCacheModel : public QAbstractTableModel
         void startRemove(int);
         void endRemove(int);
 
+        // start / end insert
+        void startInsert(int);
+        void endInsert(int);
+
     private:
+
+        // formatting and raw values for a cell
+        QVariant format(const RideItem *item, int column) const;
+        QVariant value(const RideItem *item, int column) const;
+
         Context *context;
         RideCache *rideCache;
         RideMetricFactory *factory;
 
+        // metric for each metric column, so we don't look up by name
+        QVector<RideMetric*> columnMetrics;
+
+        // formatted values, created lazily as cells are painted
+        // and dropped when the ride changes or config is updated
+        mutable QHash<const RideItem*, QVector<QVariant> > formatted;
+
         int columns_; // column count, based upon metric + meta config
         QStringList headings_;
 
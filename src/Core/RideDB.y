@@ -138,6 +138,8 @@ rideelement: ride_tuple
 ride_tuple: string ':' string                                   { 
                                                                      if ($1 == "filename") jc->item.fileName = $3;
                                                                      else if ($1 == "fingerprint") jc->item.fingerprint = $3.toULongLong();
+                                                                     else if ($1 == "hrvfingerprint") jc->item.hrvfingerprint = $3.toULongLong();
+                                                                     else if ($1 == "intervalfingerprint") jc->item.intervalfingerprint = $3.toULongLong();
                                                                      else if ($1 == "crc") jc->item.crc = $3.toULongLong();
                                                                      else if ($1 == "metacrc") jc->item.metacrc = $3.toULongLong();
                                                                      else if ($1 == "timestamp") jc->item.timestamp = $3.toULongLong();
@@ -536,6 +538,8 @@ void RideCache::save(bool opendata, QString filename)
                 // we don't send this info when sharing as opendata
                 stream << "\t\t\"filename\":\"" <<item->fileName <<"\",\n";
                 stream << "\t\t\"fingerprint\":\"" <<item->fingerprint <<"\",\n";
+                stream << "\t\t\"hrvfingerprint\":\"" <<item->hrvfingerprint <<"\",\n";
+                stream << "\t\t\"intervalfingerprint\":\"" <<item->intervalfingerprint <<"\",\n";
                 stream << "\t\t\"crc\":\"" <<item->crc <<"\",\n";
                 stream << "\t\t\"metacrc\":\"" <<item->metacrc <<"\",\n";
                 stream << "\t\t\"timestamp\":\"" <<item->timestamp <<"\",\n";
@@ -846,6 +850,9 @@ void RideCache::save(bool opendata, QString filename)
         stream << "\n  ]\n}";
 
         rideDB.close();
+
+        // and the file signatures that go with it
+        if (!opendata && filename == "") saveJournal();
     }
 }
 
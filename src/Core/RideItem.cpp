@@ -29,10 +29,13 @@
 #include "HrZones.h"
 #include "PaceZones.h"
 #include "Settings.h"
+#include "SettingsSnapshot.h"
 #include "Colors.h" // for ColorEngine
 #include "AddIntervalDialog.h" // till we fixup ridefilecache to have offsets
 #include "TimeUtils.h" // time_to_string()
 #include "WPrime.h" // for matches
+#include "RebuildStats.h"
+#include "BestEfforts.h"
 
 #include <cmath>
 #include <QtAlgorithms>
@@ -46,7 +49,7 @@
 RideItem::RideItem() 
     : 
     ride_(NULL), fileCache_(NULL), context(NULL), isdirty(false), isstale(true), isedit(false), skipsave(false), path(""), fileName(""),
-    color(QColor(1,1,1)), sport(""), isBike(false), isRun(false), isSwim(false), isXtrain(false), samples(false), zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0), metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0) {
+    color(QColor(1,1,1)), sport(""), isBike(false), isRun(false), isSwim(false), isXtrain(false), samples(false), zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0), hrvfingerprint(0), intervalfingerprint(0), metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0), staleinputs(0) {
     metrics_.fill(0, RideMetricFactory::instance().metricCount());
     count_.fill(0, RideMetricFactory::instance().metricCount());
 }
@@ -54,7 +57,7 @@ RideItem::RideItem()
 RideItem::RideItem(RideFile *ride, Context *context) 
     : 
     ride_(ride), fileCache_(NULL), context(context), isdirty(false), isstale(true), isedit(false), skipsave(false), path(""), fileName(""),
-    color(QColor(1,1,1)), sport(""), isBike(false), isRun(false), isSwim(false), isXtrain(false), samples(false), zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0), metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0)
+    color(QColor(1,1,1)), sport(""), isBike(false), isRun(false), isSwim(false), isXtrain(false), samples(false), zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0), hrvfingerprint(0), intervalfingerprint(0), metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0), staleinputs(0)
 {
     metrics_.fill(0, RideMetricFactory::instance().metricCount());
     count_.fill(0, RideMetricFactory::instance().metricCount());
@@ -63,8 +66,8 @@ RideItem::RideItem(RideFile *ride, Context *context)
 RideItem::RideItem(QString path, QString fileName, QDateTime &dateTime, Context *context, bool planned)
     :
     ride_(NULL), fileCache_(NULL), context(context), isdirty(false), isstale(true), isedit(false), skipsave(false), path(path), fileName(fileName),
-    dateTime(dateTime), color(QColor(1,1,1)), planned(planned), sport(""), isBike(false), isRun(false), isSwim(false), isXtrain(false), samples(false), zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0),
-    metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0) 
+    dateTime(dateTime), color(QColor(1,1,1)), planned(planned), sport(""), isBike(false), isRun(false), isSwim(false), isXtrain(false), samples(false), zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0), hrvfingerprint(0), intervalfingerprint(0),
+    metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0), staleinputs(0) 
 {
     metrics_.fill(0, RideMetricFactory::instance().metricCount());
     count_.fill(0, RideMetricFactory::instance().metricCount());
@@ -75,7 +78,7 @@ RideItem::RideItem(QString path, QString fileName, QDateTime &dateTime, Context
 RideItem::RideItem(RideFile *ride, QDateTime &dateTime, Context *context)
     :
     ride_(ride), fileCache_(NULL), context(context), isdirty(true), isstale(true), isedit(false), skipsave(false), dateTime(dateTime),
-    zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0), metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0)
+    zoneRange(-1), hrZoneRange(-1), paceZoneRange(-1), fingerprint(0), hrvfingerprint(0), intervalfingerprint(0), metacrc(0), crc(0), timestamp(0), dbversion(0), udbversion(0), weight(0), staleinputs(0)
 {
     metrics_.fill(0, RideMetricFactory::instance().metricCount());
     count_.fill(0, RideMetricFactory::instance().metricCount());
@@ -115,9 +118,14 @@ RideItem::setFrom(RideItem&here, bool temp) // used when loading cache/rideDB.js
     hrZoneRange = here.hrZoneRange;
     paceZoneRange = here.paceZoneRange;
     fingerprint = here.fingerprint;
+    hrvfingerprint = here.hrvfingerprint;
+    intervalfingerprint = here.intervalfingerprint;
+    staleinputs = here.staleinputs;
     metacrc = here.metacrc;
     crc = here.crc;
     timestamp = here.timestamp;
+    rideSignature = here.rideSignature;
+    cpxSignature = here.cpxSignature;
     dbversion = here.dbversion;
     udbversion = here.udbversion;
     color = here.color;
@@ -353,6 +361,7 @@ RideItem::notifyRideDataChanged()
 {
     // refresh the metrics
     isstale=true;
+    staleinputs=0;
 
     // wipe user data
     userCache.clear();
@@ -377,6 +386,7 @@ RideItem::notifyRideMetadataChanged()
 {
     // refresh the metrics
     isstale=true;
+    staleinputs=0;
     refresh();
 
     emit rideMetadataChanged();
@@ -393,6 +403,7 @@ RideItem::saved()
 {
     setDirty(false);
     isstale=true;
+    staleinputs=0;
     refresh(); // update !
     context->notifyRideSaved(this);
 }
@@ -402,6 +413,7 @@ RideItem::reverted()
 {
     setDirty(false);
     isstale=true;
+    staleinputs=0;
     refresh();
 }
 
@@ -471,79 +483,106 @@ RideItem::checkStale()
     // just change it .. its as quick to change as it is to check !
     color = GlobalContext::context()->colorEngine->colorFor(getText(GlobalContext::context()->rideMetadata->getColorField(), ""));
 
+    // what has changed, when it is only the settings some metrics
+    // depend upon then only those metrics need to be recomputed
+    bool all = false;
+    int changed = 0;
+    bool unchanged = context->athlete->rideCache && context->athlete->rideCache->isUnchanged(this);
+
+    // the files as they are before we look, if they turn out to be
+    // up to date this is what gets noted in the journal
+    RideFileSignature rideWas, cpxWas;
+    if (!unchanged && context->athlete->rideCache) {
+        rideWas = RideFileSignature(QFileInfo(context->athlete->rideCache->rideFilePath(this)));
+        cpxWas = RideFileSignature(QFileInfo(context->athlete->rideCache->cacheFilePath(this)));
+    }
+
     // upgraded metrics
-    if (udbversion != UserMetricSchemaVersion || dbversion != DBSchemaVersion) {
+    if (dbversion != DBSchemaVersion) {
 
-        isstale = true;
+        all = true;
 
     } else {
 
+        // user metrics added, removed or edited
+        if (udbversion != UserMetricSchemaVersion) changed |= RideMetric::InputProgram;
+
         // has weight changed?
         unsigned long prior  = 1000.0f * weight;
         unsigned long now = 1000.0f * getWeight();
 
-        if (prior != now) {
+        if (prior != now) changed |= RideMetric::InputWeight;
 
-            getWeight();
-            isstale = true;
+        // or have cp / zones fingerprints changed ?
+        // note we now get the fingerprint from the zone range
+        // and not the entire config so that if you add a new
+        // range (e.g. set CP from today) but none of the other
+        // ranges change then there is no need to recompute the
+        // metrics for older rides !
+        if (fingerprint != zoneFingerprint()) changed |= RideMetric::InputZones;
 
-        } else {
+        // HRV fingerprint added to detect changes on HRV Measures
+        if (hrvfingerprint != static_cast<unsigned long>(getHrvFingerprint())) changed |= RideMetric::InputHrv;
 
-            // or have cp / zones or routes fingerprints changed ?
-            // note we now get the fingerprint from the zone range
-            // and not the entire config so that if you add a new
-            // range (e.g. set CP from today) but none of the other
-            // ranges change then there is no need to recompute the
-            // metrics for older rides !
-            // HRV fingerprint added to detect changes on HRV Measures
+        // routes and discovery change the intervals
+        if (intervalfingerprint != intervalFingerprint()) all = true;
 
-            // get the new zone configuration fingerprint that applies for the ride date
-            unsigned long rfingerprint = static_cast<unsigned long>(context->athlete->zones(isRun)->getFingerprint(dateTime.date()))
-                        + (appsettings->cvalue(context->athlete->cyclist, context->athlete->zones(isRun)->useCPforFTPSetting(), 0).toInt() ? 1 : 0)
-                        + static_cast<unsigned long>(context->athlete->paceZones(isSwim)->getFingerprint(dateTime.date()))
-                        + static_cast<unsigned long>(context->athlete->hrZones(isRun)->getFingerprint(dateTime.date()))
-                        + static_cast<unsigned long>(context->athlete->routes->getFingerprint())
-                        + static_cast<unsigned long>(getHrvFingerprint())
-                        + appsettings->cvalue(context->athlete->cyclist, GC_DISCOVERY, 57).toInt(); // 57 does not include search for PEAKS
+        // or has file content changed ?
+        QString fullPath =  QString(context->athlete->home->activities().absolutePath()) + "/" + fileName;
+        QFile file(fullPath);
 
-            if (fingerprint != rfingerprint) {
+        // has timestamp changed ? (not if the file and .cpx are just as
+        // they were when we last saved, that saves reading them both)
+        if (!unchanged && timestamp < QFileInfo(file).lastModified().toTime_t()) {
 
-                isstale = true;
+            // if timestamp has changed then check crc
+            unsigned long fcrc = RideFile::computeFileCRC(fullPath);
 
-            } else {
-
-                // or has file content changed ?
-                QString fullPath =  QString(context->athlete->home->activities().absolutePath()) + "/" + fileName;
-                QFile file(fullPath);
+            if (crc == 0 || crc != fcrc) {
+                crc = fcrc; // update as expensive to calculate
+                all = true;
+            }
+        }
 
-                // has timestamp changed ?
-                if (timestamp < QFileInfo(file).lastModified().toTime_t()) {
+        // no intervals ?
+        if (samples && intervals_.count() == 0) all = true;
+    }
 
-                    // if timestamp has changed then check crc
-                    unsigned long fcrc = RideFile::computeFileCRC(fullPath);
+    isstale = all || changed;
 
-                    if (crc == 0 || crc != fcrc) {
-                        crc = fcrc; // update as expensive to calculate
-                        isstale = true;
-                    }
-                }
+    // still reckon its clean? what about the cache ?
+    if (isstale == false && !unchanged) all = isstale = RideFileCache::checkStale(context, this);
 
+    // we need to mark stale in case "special" fields may have changed (e.g. CP)
+    if (metacrc != metaCRC()) all = isstale = true;
 
-                // no intervals ?
-                if (samples && intervals_.count() == 0)
-                    isstale = true;
+    // just the metrics whose inputs changed ?
+    staleinputs = all ? 0 : changed;
 
-            }
-        }
+    // refresh notes them when it is done
+    if (isstale) rideSignature = cpxSignature = RideFileSignature();
+    else if (!unchanged) {
+        rideSignature = rideWas;
+        cpxSignature = cpxWas;
     }
 
-    // still reckon its clean? what about the cache ?
-    if (isstale == false) isstale = RideFileCache::checkStale(context, this);
+    return isstale;
+}
 
-    // we need to mark stale in case "special" fields may have changed (e.g. CP)
-    if (metacrc != metaCRC()) isstale = true;
+unsigned long
+RideItem::zoneFingerprint()
+{
+    return static_cast<unsigned long>(context->athlete->zones(isRun)->getFingerprint(dateTime.date()))
+           + (SettingsSnapshot::current(context)->cpforftp[isRun] ? 1 : 0)
+           + static_cast<unsigned long>(context->athlete->paceZones(isSwim)->getFingerprint(dateTime.date()))
+           + static_cast<unsigned long>(context->athlete->hrZones(isRun)->getFingerprint(dateTime.date()));
+}
 
-    return isstale;
+unsigned long
+RideItem::intervalFingerprint()
+{
+    return static_cast<unsigned long>(context->athlete->routes->getFingerprint())
+           + SettingsSnapshot::current(context)->discovery;
 }
 
 void
@@ -554,6 +593,15 @@ RideItem::refresh()
     // update current state coz we'll fix it below
     isstale = false;
 
+    // everything, or just the metrics using inputs that changed
+    int inputs = staleinputs;
+    staleinputs = 0;
+
+    // the ride file as it is before we read it
+    RideFileSignature rideWas;
+    if (context->athlete->rideCache) rideWas = RideFileSignature(QFileInfo(context->athlete->rideCache->rideFilePath(this)));
+    rideSignature = cpxSignature = RideFileSignature();
+
     // open ride file will extract details too, but only if not
     // already open since its a user entry point and will call
     // refresh when opened. We don't want a recursion here.
@@ -561,12 +609,15 @@ RideItem::refresh()
     RideFile *f;
     bool doclose = false;
     if (!isOpen()) { 
+        RebuildStats::Timer timer(RebuildStats::Open);
         doclose = true;
         f = ride(); // will call us but isstale is false above
     } else f=ride_;
 
     if (f) {
 
+        RebuildStats::refreshed();
+
         // get the metadata
         metadata_ = f->tags();
 
@@ -611,18 +662,38 @@ RideItem::refresh()
         else paceZoneRange = -1;
 
         // RideFile cache refresh before metrics, as meanmax may be used in user formulas
-        RideFileCache updater(context, context->athlete->home->activities().canonicalPath() + "/" + fileName, getWeight(), ride_, true);
+        {
+            RebuildStats::Timer timer(RebuildStats::Cpx);
+            RideFileCache updater(context, context->athlete->home->activities().canonicalPath() + "/" + fileName, getWeight(), ride_, true);
+        }
+        if (context->athlete->rideCache) cpxSignature = RideFileSignature(QFileInfo(context->athlete->rideCache->cacheFilePath(this)));
+
+        // peaks are shared by the metrics and interval discovery below
+        BestEfforts::beginRefresh(this, ride_);
 
         // refresh metrics etc
         const RideMetricFactory &factory = RideMetricFactory::instance();
 
         // ressize and initialize so we can store metric values at
         // RideMetric::index offsets into the metrics_ qvector
-        metrics_.fill(0, factory.metricCount());
-        count_.fill(0, factory.metricCount());
+        // when only some inputs changed we keep the rest as they are
+        QStringList todo;
+        if (inputs) {
+            todo = factory.metricsFor(inputs);
+            metrics_.resize(factory.metricCount());
+            count_.resize(factory.metricCount());
+        } else {
+            todo = factory.allMetrics();
+            metrics_.fill(0, factory.metricCount());
+            count_.fill(0, factory.metricCount());
+        }
 
         // we compute all with not specification (not an interval)
-        QHash<QString,RideMetricPtr> computed= RideMetric::computeMetrics(this, Specification(), factory.allMetrics());
+        QHash<QString,RideMetricPtr> computed;
+        {
+            RebuildStats::Timer timer(RebuildStats::Metrics);
+            computed = RideMetric::computeMetrics(this, Specification(), todo);
+        }
 
         // snaffle away all the computed values into the array
         QHashIterator<QString, RideMetricPtr> i(computed);
@@ -633,6 +704,8 @@ RideItem::refresh()
             count_[i.value()->index()] = i.value()->count();
             double stdmean = i.value()->stdmean();
             double stdvariance = i.value()->stdvariance();
+            stdmean_.remove(i.value()->index());
+            stdvariance_.remove(i.value()->index());
             if (stdmean || stdvariance) {
                 stdmean_.insert(i.value()->index(), stdmean);
                 stdvariance_.insert(i.value()->index(), stdvariance);
@@ -647,16 +720,20 @@ RideItem::refresh()
             }
 
         // Update auto intervals AFTER ridefilecache as used for bests
-        updateIntervals();
+        // EFFORT discovery uses CP, W' and Pmax so zone changes need it
+        // otherwise the intervals are the same, just update the metrics
+        {
+            RebuildStats::Timer timer(RebuildStats::Intervals);
+            if (inputs == 0 || (inputs & RideMetric::InputZones)) updateIntervals();
+            else foreach(IntervalItem *interval, intervals_) interval->refresh(todo);
+        }
+
+        BestEfforts::endRefresh();
 
         // update fingerprints etc, crc done above
-        fingerprint = static_cast<unsigned long>(context->athlete->zones(isRun)->getFingerprint(dateTime.date()))
-                    + (appsettings->cvalue(context->athlete->cyclist, context->athlete->zones(isRun)->useCPforFTPSetting(), 0).toInt() ? 1 : 0)
-                    + static_cast<unsigned long>(context->athlete->paceZones(isSwim)->getFingerprint(dateTime.date()))
-                    + static_cast<unsigned long>(context->athlete->hrZones(isRun)->getFingerprint(dateTime.date()))
-                    + static_cast<unsigned long>(context->athlete->routes->getFingerprint()) +
-                    + static_cast<unsigned long>(getHrvFingerprint())
-                    + appsettings->cvalue(context->athlete->cyclist, GC_DISCOVERY, 57).toInt(); // 57 does not include search for PEAKS
+        fingerprint = zoneFingerprint();
+        hrvfingerprint = static_cast<unsigned long>(getHrvFingerprint());
+        intervalfingerprint = intervalFingerprint();
 
         dbversion = DBSchemaVersion;
         udbversion = UserMetricSchemaVersion;
@@ -664,6 +741,7 @@ RideItem::refresh()
 
         // we now match
         metacrc = metaCRC();
+        rideSignature = rideWas;
 
         // Construct the summary text used on the calendar
         metadata_.insert("Calendar Text", GlobalContext::context()->rideMetadata->calendarText(this));
@@ -702,7 +780,7 @@ RideItem::getWeight(int type)
         if (weight <= 0.00) weight = metadata_.value("Weight", "0.0").toDouble();
 
         // global options and if not set default to 75 kg.
-        if (weight <= 0.00) weight = appsettings->cvalue(context->athlete->cyclist, GC_WEIGHT, "75.0").toString().toDouble();
+        if (weight <= 0.00) weight = SettingsSnapshot::current(context)->weight;
 
         // No weight default is weird, we'll set to 80kg
         if (weight <= 0.00) weight = 80.00;
@@ -841,7 +919,8 @@ void
 RideItem::updateIntervals()
 {
     // what do we need ?
-    int discovery = appsettings->cvalue(context->athlete->cyclist, GC_DISCOVERY, 57).toInt(); // 57 does not include search for PEAKS
+    const SettingsSnapshot *settings = SettingsSnapshot::current(context);
+    int discovery = settings->discovery;
 
     // DO NOT USE ride() since it will call a refresh !
     RideFile *f = ride_;
@@ -965,7 +1044,7 @@ RideItem::updateIntervals()
 
             // go hunting for best peak
             QList<AddIntervalDialog::AddedInterval> results;
-            AddIntervalDialog::findPeaks(context, true, f, Specification(), RideFile::watts, RideFile::original, durations[i], 1, results, "", "");
+            BestEfforts::findPeak(this, Specification(), RideFile::watts, durations[i], results);
 
             // did we get one ?
             if (results.count() > 0 && results[0].avg > 0 && results[0].stop > 0) {
@@ -995,12 +1074,12 @@ RideItem::updateIntervals()
                                 tr("1 minute"), tr("5 minutes"), tr("10 minutes"), tr("20 minutes"), tr("30 minutes"), tr("45 minutes"),
                                 tr("1 hour") };
 
-        bool metric = appsettings->value(this, context->athlete->paceZones(f->isSwim())->paceSetting(), GlobalContext::context()->useMetricUnits).toBool();
+        bool metric = settings->metricPace[f->isSwim()];
         for(int i=0; durations[i] != 0; i++) {
 
             // go hunting for best peak
             QList<AddIntervalDialog::AddedInterval> results;
-            AddIntervalDialog::findPeaks(context, true, f, Specification(), RideFile::kph, RideFile::original, durations[i], 1, results, "", "");
+            BestEfforts::findPeak(this, Specification(), RideFile::kph, durations[i], results);
 
             // did we get one ?
             if (results.count() > 0 && results[0].avg > 0 && results[0].stop > 0) {
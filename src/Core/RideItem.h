@@ -26,6 +26,8 @@
 
 #include <QString>
 #include <QMap>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QVector>
 
 class RideFile;
@@ -38,6 +40,21 @@ class Context;
 class UserData;
 class ComparePane;
 
+// size and last modified of a file on disk, if they are the same as
+// when we last knew it was up to date we don't need to look inside
+struct RideFileSignature
+{
+    RideFileSignature() : size(-1), modified(0) {}
+    RideFileSignature(const QFileInfo &info) : size(info.exists() ? info.size() : -1),
+                                               modified(info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0) {}
+
+    bool isValid() const { return size >= 0; }
+    bool operator==(const RideFileSignature &other) const { return size == other.size && modified == other.modified; }
+    bool operator!=(const RideFileSignature &other) const { return !(*this == other); }
+
+    qint64 size, modified;
+};
+
 class RideItem : public QObject
 {
 
@@ -149,7 +166,10 @@ class RideItem : public QObject
 
         // context the item was updated to
         unsigned long fingerprint; // zones
+        unsigned long hrvfingerprint; // hrv measures
+        unsigned long intervalfingerprint; // routes and discovery
         unsigned long metacrc, crc, timestamp; // file content
+        RideFileSignature rideSignature, cpxSignature; // files as they were when last known up to date
         int dbversion; // metric version
         int udbversion; // user metric version
         double weight; // what weight was used ?
@@ -218,6 +238,14 @@ class RideItem : public QObject
 
     private:
         void updateIntervals();
+
+        // config fingerprints that apply for the ride date
+        unsigned long zoneFingerprint();
+        unsigned long intervalFingerprint();
+
+        // RideMetric inputs that changed when checkStale() found only
+        // some metrics need recomputing, 0 means refresh everything
+        int staleinputs;
 };
 
 Q_DECLARE_OPAQUE_POINTER(RideItem*);
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SettingsSnapshot.h"
+
+#include "Context.h"
+#include "Athlete.h"
+#include "Settings.h"
+#include "Zones.h"
+#include "DataProcessor.h"
+
+#include <QAtomicPointer>
+
+// the last one published, for callers without an athlete
+static QAtomicPointer<const SettingsSnapshot> last;
+
+SettingsSnapshot::SettingsSnapshot(const Athlete *athlete)
+{
+    // athlete preferences
+    if (athlete) {
+        discovery = appsettings->cvalue(athlete->cyclist, GC_DISCOVERY, 57).toInt(); // 57 does not include search for PEAKS
+        weight = appsettings->cvalue(athlete->cyclist, GC_WEIGHT, "75.0").toString().toDouble();
+        wheelsize = appsettings->cvalue(athlete->cyclist, GC_WHEELSIZE, 2100).toInt();
+        for (int i=0; i<2; i++)
+            cpforftp[i] = appsettings->cvalue(athlete->cyclist, athlete->zones(i)->useCPforFTPSetting(), 0).toInt();
+        dob = appsettings->cvalue(athlete->cyclist, GC_DOB).toDate();
+        sex = appsettings->cvalue(athlete->cyclist, GC_SEX).toInt();
+    } else {
+        discovery = 57;
+        weight = 75.0;
+        wheelsize = 2100;
+        cpforftp[0] = cpforftp[1] = 0;
+        sex = 0;
+    }
+
+    // global settings
+    rrMax = appsettings->value(NULL, GC_RR_MAX, "2000.0").toDouble();
+    rrMin = appsettings->value(NULL, GC_RR_MIN, "270.0").toDouble();
+    rrFilt = appsettings->value(NULL, GC_RR_FILT, "0.2").toDouble();
+    rrWindow = appsettings->value(NULL, GC_RR_WINDOW, "20").toInt();
+    hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+    metricPace[0] = appsettings->value(NULL, GC_PACE, GlobalContext::context()->useMetricUnits).toBool();
+    metricPace[1] = appsettings->value(NULL, GC_SWIMPACE, GlobalContext::context()->useMetricUnits).toBool();
+
+    // data processors
+    foreach(QString name, DataProcessorFactory::instance().getProcessors().keys()) {
+        QString configsetting = QString("dp/%1/apply").arg(name);
+        apply.insert(name, appsettings->value(NULL, GC_QSETTINGS_GLOBAL_GENERAL+configsetting, "Manual").toString());
+    }
+}
+
+const SettingsSnapshot *
+SettingsSnapshot::current(Context *context)
+{
+    if (context && context->athlete) {
+        const SettingsSnapshot *snapshot = context->athlete->settings();
+        if (snapshot) return snapshot;
+    }
+
+    const SettingsSnapshot *snapshot = last.loadAcquire();
+    if (snapshot) return snapshot;
+
+    // nobody has published one yet, first one in wins
+    SettingsSnapshot *fresh = new SettingsSnapshot(NULL);
+    if (last.testAndSetOrdered(NULL, fresh)) return fresh;
+    delete fresh;
+    return last.loadAcquire();
+}
+
+void
+SettingsSnapshot::publish(const SettingsSnapshot *snapshot)
+{
+    // the old one is left alone, a reader may still be using it
+    last.storeRelease(snapshot);
+}
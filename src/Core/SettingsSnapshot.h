@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_SettingsSnapshot_h
+#define _GC_SettingsSnapshot_h 1
+#include "GoldenCheetah.h"
+
+#include <QString>
+#include <QHash>
+#include <QDate>
+
+class Athlete;
+class Context;
+
+//
+// The settings read whilst refreshing, opening and computing metrics
+// for each ride, read once from appsettings into plain typed values.
+//
+// Appsettings lookups take a lock and build string keys, so doing them
+// per ride (or per sample) from the refresh threads makes them queue up
+// behind each other. Instead the athlete publishes a snapshot when it
+// is opened and a new one whenever the config changes, before anyone
+// is told about the change. A snapshot is never modified or deleted
+// once published, so a reader can keep using the one it got without
+// any locking even if it is replaced part way through.
+//
+class SettingsSnapshot
+{
+    public:
+
+        // read them now, athlete preferences are defaults if athlete is NULL
+        SettingsSnapshot(const Athlete *athlete);
+
+        // the snapshot in force for this context, or the last one published
+        // (global settings are the same for everyone) if there is no athlete
+        static const SettingsSnapshot *current(Context *context);
+
+        // athlete preferences
+        int discovery;              // GC_DISCOVERY interval types to find
+        double weight;              // GC_WEIGHT default weight in kg
+        int wheelsize;              // GC_WHEELSIZE in mm
+        int cpforftp[2];            // zones useCPforFTPSetting, bike and run
+        QDate dob;                  // GC_DOB
+        int sex;                    // GC_SEX, 0 is male
+
+        // global settings
+        double rrMax, rrMin, rrFilt; // GC_RR_* hrv filtering
+        int rrWindow;
+        double hysteresis;          // GC_ELEVATION_HYSTERESIS
+        bool metricPace[2];         // GC_PACE and GC_SWIMPACE
+
+        // data processors, when they are applied automatically
+        // (Auto, Save or Manual) keyed by processor name
+        QHash<QString, QString> apply;
+
+    private:
+        friend class ::Athlete;
+        static void publish(const SettingsSnapshot *);
+};
+
+#endif // _GC_SettingsSnapshot_h
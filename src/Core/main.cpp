@@ -28,6 +28,8 @@
 #include "IdleTimer.h"
 #include "PowerProfile.h"
 #include "GcCrashDialog.h" // for versionHTML
+#include "HeadlessBenchmark.h"
+#include "HeadlessRebuild.h"
 
 #include <QApplication>
 #include <QDesktopWidget>
@@ -204,6 +206,9 @@ main(int argc, char *argv[])
     bool debug = false;
 #endif
     bool server = false;
+    bool rebuild = false;
+    bool fullrebuild = false;
+    QString benchmark;
     nogui = false;
     bool help = false;
     bool newgui = false;
@@ -228,6 +233,11 @@ main(int argc, char *argv[])
 #ifdef GC_WANT_HTTP
             fprintf(stderr, "--server            to run as an API server\n");
 #endif
+            fprintf(stderr, "--rebuild           to refresh the athlete's rides, intervals and estimates without\n");
+            fprintf(stderr, "                    a gui, writing timings and peak memory as json to stdout\n");
+            fprintf(stderr, "--full              with --rebuild to refresh everything, not just what changed\n");
+            fprintf(stderr, "--benchmark=name    to time one of the hot paths without a gui, writing json to stdout\n");
+            fprintf(stderr, "                    (%s)\n", HeadlessBenchmark::names().join(", ").toLatin1().constData());
 #ifdef GC_DEBUG
             fprintf(stderr, "--debug             to turn on redirection of messages to goldencheetah.log [debug build]\n");
 #else
@@ -255,6 +265,19 @@ main(int argc, char *argv[])
             const char *c_str = ba.data();
             fprintf(stderr, "\n%s\n\n", c_str);
 
+        } else if (arg == "--rebuild") {
+
+            nogui = rebuild = true;
+
+        } else if (arg == "--full") {
+
+            fullrebuild = true;
+
+        } else if (arg.startsWith("--benchmark=")) {
+
+            nogui = true;
+            benchmark = arg.mid(12);
+
         } else if (arg == "--server") {
 #ifdef GC_WANT_HTTP
             nogui = server = true;
@@ -352,6 +375,9 @@ main(int argc, char *argv[])
     // what to do. We may add our own error handler later.
     gsl_set_error_handler_off();
 
+    // no display needed when rebuilding on a server
+    if ((rebuild || benchmark != "") && qgetenv("QT_QPA_PLATFORM").isEmpty()) qputenv("QT_QPA_PLATFORM", "offscreen");
+
     // create the application -- only ever ONE regardless of restarts
     application = new QApplication(argc, argv);
     //XXXIdleEventFilter idleFilter;
@@ -601,6 +627,29 @@ main(int argc, char *argv[])
             
         }
 
+        // headless rebuild of the athlete, then we're done
+        // $ ./GoldenCheetah --rebuild [--full] [~/Athletes] Mark
+        if (rebuild) {
+            ret = 1;
+            if (lastOpened == QVariant()) {
+                fprintf(stdout, "{\"error\":\"no athlete to rebuild\"}\n");
+                fflush(stdout);
+            }
+            else ret = HeadlessRebuild(home, lastOpened.toString(), fullrebuild).run();
+
+            delete trainDB;
+            terminate(ret);
+        }
+
+        // headless benchmark, the athlete or a folder of files, then we're done
+        // $ ./GoldenCheetah --benchmark=fit ../test
+        if (benchmark != "") {
+            ret = HeadlessBenchmark(home, lastOpened.toString(), benchmark).run();
+
+            delete trainDB;
+            terminate(ret);
+        }
+
 #ifdef GC_WANT_HTTP
 
         // The API server offers webservices (default port 12021, see httpserver.ini)
@@ -20,6 +20,10 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QStorageInfo>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QSet>
+#include <QMap>
 
 #include "Athlete.h"
 #include "AthleteBackup.h"
@@ -102,7 +106,10 @@ AthleteBackup::backupImmediate()
         break;
     }
     if (backup(tr("Abort Backup"))) {
-       QMessageBox::information(NULL, tr("Athlete Backup"), tr("Backup successfully stored in \n%1").arg(backupFolder));
+       if (lastArchive == "")
+           QMessageBox::information(NULL, tr("Athlete Backup"), tr("No files have changed since the last backup in \n%1").arg(backupFolder));
+       else
+           QMessageBox::information(NULL, tr("Athlete Backup"), tr("Backup successfully stored in \n%1").arg(backupFolder));
     }
 
 }
@@ -112,25 +119,75 @@ AthleteBackup::backupImmediate()
 bool
 AthleteBackup::backup(QString progressText)
 {
+    lastArchive = "";
+    bool incremental = appsettings->cvalue(athlete, GC_AUTOBACKUP_INCREMENTAL, false).toBool();
 
-    // backup requested so lets see if we have something to backup and if yes, how much
-    int fileCount = 0;
-    qint64 fileSize = 0;
-    // count the files for the progress bar and the calculate the overall size
+    // what we stored last time, a full backup stores everything
+    QJsonObject previous;
+    if (incremental) previous = readManifest().value("files").toObject();
+
+    // backup requested so lets see if we have something to backup
+    QList<QFileInfo> sourceFiles;
+    QStringList names;
     foreach (QDir folder, sourceFolderList) {
         // get all files
         foreach (QFileInfo fileName, folder.entryInfoList(QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
-           fileCount++;
-           fileSize += fileName.size();
-
+           sourceFiles << fileName;
+           names << folder.dirName()+"/"+fileName.fileName();
         }
     }
+    int fileCount = sourceFiles.count();
 
     if (fileCount == 0) {
        QMessageBox::information(NULL, tr("Athlete Backup"), tr("No files found for athlete %1 - all athlete sub-directories are empty.").arg(athlete));
        return false;
     }
 
+    QProgressDialog progress(tr("Checking files for athlete %1 ...").arg(athlete), progressText, 0, fileCount, NULL);
+    progress.setWindowModality(Qt::WindowModal);
+
+    // work out which files need storing and how much space we need.
+    // files with the same size and modified time as last time are
+    // assumed unchanged, if only the modified time differs we compare
+    // the contents hash so touched-but-identical files are not stored
+    QJsonObject files;
+    QList<int> changed;
+    qint64 fileSize = 0;
+    for (int i=0; i<fileCount; i++) {
+
+        if (progress.wasCanceled()) return false;
+        progress.setValue(i);
+
+        QJsonObject entry = previous.value(names[i]).toObject();
+        QString modified = sourceFiles[i].lastModified().toUTC().toString(Qt::ISODate);
+        qint64 size = sourceFiles[i].size();
+        bool samesize = !entry.isEmpty() && entry.value("size").toDouble() == double(size);
+
+        if (!samesize || entry.value("modified").toString() != modified) {
+
+            // hashed even when we know it changed, so next time we can tell
+            QString hash = hashFile(sourceFiles[i].canonicalFilePath());
+            if (hash == "") {
+                QMessageBox::warning(NULL, tr("Athlete Backup"), tr("File %1 cannot be read - no backup .zip file created").arg(names[i]));
+                return false;
+            }
+            if (!samesize || hash != entry.value("hash").toString()) {
+                changed << i;
+                fileSize += size;
+            }
+            entry.insert("size", double(size));
+            entry.insert("modified", modified);
+            entry.insert("hash", hash);
+        }
+        files.insert(names[i], entry);
+    }
+
+    // nothing changed, nothing to store
+    if (changed.isEmpty()) {
+        progress.setValue(fileCount);
+        return true;
+    }
+
     // if if there is enough space available for the backup
     QStorageInfo storage(backupFolder);
     if (storage.isValid() && storage.isReady()) {
@@ -145,7 +202,7 @@ AthleteBackup::backup(QString progressText)
     }
 
     QChar zero = QLatin1Char('0');
-    QString targetFileName = QString( "GC_%1_%2_%3_%4_%5_%6_%7_%8.zip" )
+    QString targetFileName = QString( "GC_%1_%2_%3_%4_%5_%6_%7_%8%9.zip" )
                        .arg ( VERSION_LATEST )
                        .arg ( athlete )
                        .arg ( QDate::currentDate().year(), 4, 10, zero )
@@ -153,7 +210,8 @@ AthleteBackup::backup(QString progressText)
                        .arg ( QDate::currentDate().day(), 2, 10, zero )
                        .arg ( QTime::currentTime().hour(), 2, 10, zero )
                        .arg ( QTime::currentTime().minute(), 2, 10, zero )
-                       .arg ( QTime::currentTime().second(), 2, 10, zero );
+                       .arg ( QTime::currentTime().second(), 2, 10, zero )
+                       .arg ( previous.isEmpty() ? "" : "_incremental" );
 
 
     // add files using zip writer
@@ -165,29 +223,55 @@ AthleteBackup::backup(QString progressText)
     zipFile.close();
     ZipWriter writer(zipFile.fileName());
 
-    QProgressDialog progress(tr("Adding files to backup %1 for athlete %2 ...").arg(targetFileName).arg(athlete), progressText, 0, fileCount, NULL);
-    progress.setWindowModality(Qt::WindowModal);
+    progress.setLabelText(tr("Adding files to backup %1 for athlete %2 ...").arg(targetFileName).arg(athlete));
+    progress.setMaximum(changed.count());
+    progress.setValue(0);
+
+    foreach (QDir folder, sourceFolderList) writer.addDirectory(folder.dirName());
 
-    // now do the Zipping
+    // now do the Zipping, files are streamed into the archive
+    // and anything already compressed is stored as-is. A file we
+    // can't read would leave a hole in the backup set, so that
+    // fails the backup rather than being skipped
     bool userCanceled = false;
+    QString failed;
     int fileCounter = 0;
-    foreach (QDir folder, sourceFolderList) {
-        // get all files
-        writer.addDirectory(folder.dirName());
-        foreach (QFileInfo fileName, folder.entryInfoList(QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
-            QFile file(fileName.canonicalFilePath());
-            if (file.open(QIODevice::ReadOnly)) {
-                if (progress.wasCanceled()) {
-                    userCanceled = true;
-                    break;
-                }
-                writer.addFile(folder.dirName()+"/"+fileName.fileName(), file.readAll());
-                progress.setValue(fileCounter);
-                fileCounter++;
-                file.close();
-            }
+    foreach (int i, changed) {
+        if (progress.wasCanceled()) {
+            userCanceled = true;
+            break;
+        }
+        QFile file(sourceFiles[i].canonicalFilePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            failed = names[i];
+            break;
+        }
+        writer.setCompressionPolicy(isCompressed(names[i]) ? ZipWriter::NeverCompress : ZipWriter::AutoCompress);
+        writer.addFile(names[i], &file);
+        file.close();
+        if (writer.status() != ZipWriter::NoError) {
+            failed = names[i];
+            break;
         }
-        if (userCanceled) break;
+        progress.setValue(fileCounter);
+        fileCounter++;
+
+        QJsonObject entry = files.value(names[i]).toObject();
+        entry.insert("archive", targetFileName);
+        files.insert(names[i], entry);
+    }
+
+    // the manifest goes in the archive too, so the backup set
+    // can be reassembled from the archives alone
+    QJsonObject manifest;
+    manifest.insert("athlete", athlete);
+    manifest.insert("version", VERSION_LATEST);
+    manifest.insert("archive", targetFileName);
+    manifest.insert("files", files);
+    QByteArray manifestData = QJsonDocument(manifest).toJson();
+    if (!userCanceled && failed == "") {
+        writer.setCompressionPolicy(ZipWriter::AutoCompress);
+        writer.addFile("manifest.json", manifestData);
     }
 
     // final processing
@@ -199,10 +283,192 @@ AthleteBackup::backup(QString progressText)
         return false;
     }
 
+    // or it is incomplete
+    if (failed != "" || writer.status() != ZipWriter::NoError) {
+        zipFile.remove();
+        QMessageBox::warning(NULL, tr("Athlete Backup"), tr("File %1 cannot be read - no backup .zip file created").arg(failed));
+        return false;
+    }
+
+    // only now is it safe to base the next backup on this one
+    QFile manifestOut(manifestFile());
+    if (manifestOut.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        manifestOut.write(manifestData);
+        manifestOut.close();
+    }
+    lastArchive = targetFileName;
+
     // we are done, full progress
-    progress.setValue(fileCount);
+    progress.setValue(changed.count());
+    return true;
+
+}
+
+QString
+AthleteBackup::manifestFile() const
+{
+    return backupFolder + "/GC_" + athlete + "_manifest.json";
+}
+
+QJsonObject
+AthleteBackup::readManifest() const
+{
+    QFile file(manifestFile());
+    if (!file.open(QIODevice::ReadOnly)) return QJsonObject();
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    // ignore manifests for another athlete
+    QJsonObject manifest = doc.object();
+    if (manifest.value("athlete").toString() != athlete) return QJsonObject();
+
+    // or if any archive in the backup set has gone, files that
+    // haven't changed are only in the archive they were stored in
+    if (!archivesMissing(backupFolder, manifest).isEmpty()) return QJsonObject();
+
+    return manifest;
+}
+
+QStringList
+AthleteBackup::archivesMissing(QString folder, QJsonObject manifest)
+{
+    QSet<QString> archives;
+    archives << manifest.value("archive").toString();
+    QJsonObject files = manifest.value("files").toObject();
+    foreach(QString name, files.keys()) archives << files.value(name).toObject().value("archive").toString();
+
+    QStringList missing;
+    foreach(QString archive, archives)
+        if (archive == "" || !QFile(folder + "/" + archive).exists()) missing << archive;
+    return missing;
+}
+
+void
+AthleteBackup::restoreImmediate()
+{
+    QString manifest = QFileDialog::getOpenFileName(NULL, tr("Select Backup Manifest"), QDir::homePath(),
+                                                    tr("Backup Manifest (GC_*_manifest.json)"));
+    if (manifest == "") return;
+
+    QString dir = QFileDialog::getExistingDirectory(NULL, tr("Select Empty Directory to Restore to"),
+                            QDir::homePath(), QFileDialog::ShowDirsOnly | QFileDialog::DontResolveSymlinks);
+    if (dir == "") {
+        QMessageBox::information(NULL, tr("Athlete Restore"), tr("No directory selected - restore aborted"));
+        return;
+    }
+
+    // we never overwrite anything, not least an athlete that is open
+    if (!QDir(dir).entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty()) {
+        QMessageBox::warning(NULL, tr("Athlete Restore"), tr("Directory %1 is not empty - restore aborted").arg(dir));
+        return;
+    }
+
+    QStringList errors;
+    if (restore(manifest, QDir(dir), errors))
+        QMessageBox::information(NULL, tr("Athlete Restore"), tr("Backup successfully restored to \n%1").arg(dir));
+    else if (!errors.isEmpty())
+        QMessageBox::warning(NULL, tr("Athlete Restore"), errors.join("\n"));
+}
+
+bool
+AthleteBackup::restore(QString manifestFile, QDir target, QStringList &errors)
+{
+    QFile file(manifestFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errors << tr("Backup manifest %1 cannot be read.").arg(manifestFile);
+        return false;
+    }
+    QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    QJsonObject files = manifest.value("files").toObject();
+    if (files.isEmpty()) {
+        errors << tr("%1 is not a backup manifest.").arg(manifestFile);
+        return false;
+    }
+
+    // all of the backup set must be there before we start
+    QString folder = QFileInfo(manifestFile).absolutePath();
+    QStringList missing = archivesMissing(folder, manifest);
+    if (!missing.isEmpty()) {
+        errors << tr("Backup set is incomplete, missing: %1").arg(missing.join(", "));
+        return false;
+    }
+
+    // each archive is read once, for the files it holds the latest copy of
+    QMap<QString, QStringList> archives;
+    foreach(QString name, files.keys()) archives[files.value(name).toObject().value("archive").toString()] << name;
+
+    QProgressDialog progress(tr("Restoring files for athlete %1 ...").arg(manifest.value("athlete").toString()),
+                             tr("Abort Restore"), 0, files.count(), NULL);
+    progress.setWindowModality(Qt::WindowModal);
+
+    int fileCounter = 0;
+    QMapIterator<QString, QStringList> i(archives);
+    while (i.hasNext()) {
+        i.next();
+
+        ZipReader reader(folder + "/" + i.key());
+        if (!reader.isReadable()) {
+            errors << tr("Backup file %1 cannot be read.").arg(i.key());
+            return false;
+        }
+        QSet<QString> held;
+        foreach(ZipReader::FileInfo info, reader.fileInfoList()) held << info.filePath;
+
+        foreach(QString name, i.value()) {
+
+            if (progress.wasCanceled()) return false;
+            progress.setValue(fileCounter++);
+
+            // only ever into the target folder
+            if (name.split("/").contains("..") || QDir::isAbsolutePath(name)) {
+                errors << tr("%1 in backup file %2 is not an athlete file.").arg(name).arg(i.key());
+                return false;
+            }
+
+            // the hash tells us it is the same as when it was backed up
+            QByteArray data = reader.fileData(name);
+            QString hash = files.value(name).toObject().value("hash").toString();
+            if (!held.contains(name)
+                || (hash != "" && hash != QString(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex()))) {
+                errors << tr("%1 in backup file %2 is missing or damaged.").arg(name).arg(i.key());
+                return false;
+            }
+
+            QFileInfo info(target.absoluteFilePath(name));
+            QFile out(info.absoluteFilePath());
+            if (!target.mkpath(info.absolutePath()) || !out.open(QIODevice::WriteOnly)
+                || out.write(data) != data.size()) {
+                errors << tr("%1 cannot be written.").arg(info.absoluteFilePath());
+                return false;
+            }
+            out.close();
+        }
+    }
+    progress.setValue(files.count());
     return true;
+}
+
+QString
+AthleteBackup::hashFile(QString path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return "";
 
+    // empty if it couldn't all be read
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file)) return "";
+    return QString(hash.result().toHex());
 }
 
+bool
+AthleteBackup::isCompressed(QString fileName)
+{
+    static QStringList compressed = QStringList() << "zip" << "gz" << "bz2" << "7z" << "xz"
+                                                  << "jpg" << "jpeg" << "png" << "gif"
+                                                  << "mp3" << "mp4" << "m4v" << "mov" << "avi" << "mkv" << "webm";
 
+    return compressed.contains(QFileInfo(fileName).suffix().toLower());
+}
@@ -20,6 +20,7 @@
 #define _GC_AthleteBackup_h 1
 
 #include <QString>
+#include <QJsonObject>
 
 #include "Athlete.h"
 
@@ -34,13 +35,29 @@ class AthleteBackup : public QObject
         void backupOnClose();
         void backupImmediate();
 
+        // rebuild the athlete folders from a backup set, the archives
+        // holding the files listed in the manifest (a full backup and
+        // any incremental backups after it), into an empty folder
+        static void restoreImmediate();
+        static bool restore(QString manifestFile, QDir target, QStringList &errors);
+
     private:
         AthleteDirectoryStructure *athleteDirs;
         QString athlete;
         QString backupFolder;
         QList<QDir> sourceFolderList;
+        QString lastArchive;
         bool backup(QString progressText);
 
+        // every backup writes a manifest of the files it covers (size,
+        // modified time, content hash and the archive holding the current
+        // contents) so an incremental backup only stores what changed
+        QString manifestFile() const;
+        QJsonObject readManifest() const;
+        static QStringList archivesMissing(QString folder, QJsonObject manifest);
+        static QString hashFile(QString path);
+        static bool isCompressed(QString fileName);
+
 };
 
 
@@ -1517,16 +1517,25 @@ RideFile *CsvFileReader::openRideFile(QFile &file, QStringList &errors, QList<Ri
 }
 
 bool
-CsvFileReader::writeRideFile(Context *, const RideFile *ride, QFile &file, CsvType format) const
+CsvFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &file, CsvType format) const
 {
     if (!file.open(QIODevice::WriteOnly)) return(false);
 
+    toDevice(context, ride, file, format);
+
+    file.close();
+    return true;
+}
+
+void
+CsvFileReader::toDevice(Context *, const RideFile *ride, QIODevice &device, CsvType format) const
+{
     // always save CSV in metric format
     bool bIsMetric = true;
 
     // Use the column headers that make WKO+ happy.
     double convertUnit;
-    QTextStream out(&file);
+    QTextStream out(&device);
 
     if (format == gc) {
         // CSV File header
@@ -1636,7 +1645,4 @@ CsvFileReader::writeRideFile(Context *, const RideFile *ride, QFile &file, CsvTy
             out << "\n";
         }
     }
-
-    file.close();
-    return true;
 }
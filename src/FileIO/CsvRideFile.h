@@ -34,6 +34,9 @@ struct CsvFileReader : public RideFileReader {
 
     // write but able to select format
     bool writeRideFile(Context *context, const RideFile *ride, QFile &file, CsvType format) const;
+
+    // write to a device that is already open
+    void toDevice(Context *context, const RideFile *ride, QIODevice &device, CsvType format) const;
     bool hasWrite() const { return true; }
 };
 
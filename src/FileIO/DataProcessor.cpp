@@ -21,6 +21,7 @@
 #include "Context.h"
 #include "AllPlot.h"
 #include "Settings.h"
+#include "SettingsSnapshot.h"
 #include "Units.h"
 #include "Colors.h"
 #ifdef GC_WANT_PYTHON
@@ -93,16 +94,23 @@ DataProcessorFactory::autoProcess(RideFile *ride, QString mode, QString op)
 #endif
 
     bool changed = false;
+    const SettingsSnapshot *settings = SettingsSnapshot::current(ride->context);
 
     // run through the processors and execute them!
     QMapIterator<QString, DataProcessor*> i(processors);
     i.toFront();
     while (i.hasNext()) {
         i.next();
-        QString configsetting = QString("dp/%1/apply").arg(i.key());
+
+        // registered since the settings were read?
+        QString apply = settings->apply.value(i.key());
+        if (apply.isEmpty()) {
+            QString configsetting = QString("dp/%1/apply").arg(i.key());
+            apply = appsettings->value(NULL, GC_QSETTINGS_GLOBAL_GENERAL+configsetting, "Manual").toString();
+        }
 
         // if we're being run manually, run all that are defined
-        if (appsettings->value(NULL, GC_QSETTINGS_GLOBAL_GENERAL+configsetting, "Manual").toString() == mode)
+        if (apply == mode)
             i.value()->postProcess(ride, NULL, op);
     }
 
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "DataProcessorPipeline.h"
+
+#include "DataProcessor.h"
+#include "RideFile.h"
+#include "RideFileCommand.h"
+#include "RideItem.h"
+#include "RideCache.h"
+#include "CsvRideFile.h"
+#include "Context.h"
+#include "Athlete.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+
+QMutex DataProcessorPipeline::scriptMutex;
+
+// a job on the worker pool
+class DataProcessorPipelineTask : public QRunnable
+{
+    public:
+        DataProcessorPipelineTask(DataProcessorPipeline *pipeline, int index) : pipeline(pipeline), index(index) {}
+
+        void run() {
+            // jobs is never resized whilst we're running, and
+            // each task only ever touches its own entry
+            QMetaObject::invokeMethod(pipeline, "itemStarted", Qt::QueuedConnection, Q_ARG(int, index));
+            pipeline->process(pipeline->jobs.data()[index]);
+            QMetaObject::invokeMethod(pipeline, "done", Qt::QueuedConnection, Q_ARG(int, index));
+        }
+
+    private:
+        DataProcessorPipeline *pipeline;
+        int index;
+};
+
+DataProcessorPipeline::DataProcessorPipeline(Context *context, QObject *parent)
+    : QObject(parent), context(context), save_(true), overwrite(false),
+      completed(0), running(false), saved(false), cancelled(0)
+{
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+DataProcessorPipeline::~DataProcessorPipeline()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+void
+DataProcessorPipeline::setProcessors(QStringList names)
+{
+    processors.clear();
+
+    QMap<QString,DataProcessor*> all = DataProcessorFactory::instance().getProcessors();
+    foreach(QString name, names) {
+        DataProcessor *dp = all.value(name, NULL);
+        if (dp) processors << dp;
+    }
+}
+
+void
+DataProcessorPipeline::setExport(QString dir, QString suffix, bool overwrite)
+{
+    exportDir = dir;
+    exportSuffix = suffix;
+    this->overwrite = overwrite;
+}
+
+void
+DataProcessorPipeline::start(QList<RideItem*> items)
+{
+    if (running) return;
+
+    running = true;
+    saved = false;
+    completed = 0;
+    cancelled.store(0);
+    jobs.clear();
+    inmemory.clear();
+
+    // only when the activities themselves are going to be changed
+    bool updating = save_ && processors.count();
+
+    jobs.resize(items.count());
+    for(int i=0; i<items.count(); i++) {
+
+        Job &job = jobs[i];
+        RideItem *item = items[i];
+
+        job.item = item;
+        job.filename = (item->planned ? context->athlete->home->planned() : context->athlete->home->activities()).canonicalPath()
+                       + "/" + item->fileName;
+
+        // when updating, those with unsaved changes or being looked at are
+        // done in memory, the rest are closed and the file worked on in the
+        // background. Otherwise (e.g. just exporting) it's the file as saved
+        job.inmemory = updating && item->isOpen() && (item->isDirty() || item == context->ride);
+        if (updating && !job.inmemory && item->isOpen()) item->close();
+    }
+
+    emit progress(0, jobs.count());
+
+    // the workers get their own copy of everything else
+    for(int i=0; i<jobs.count(); i++) {
+        if (jobs[i].inmemory) inmemory << i;
+        else pool.start(new DataProcessorPipelineTask(this, i));
+    }
+
+    // and we do the open ones on the GUI thread, one per turn of the event loop
+    if (inmemory.count()) QTimer::singleShot(0, this, SLOT(processInMemory()));
+
+    // nothing to do at all
+    if (jobs.count() == 0) {
+        running = false;
+        emit finished();
+    }
+}
+
+void
+DataProcessorPipeline::cancel()
+{
+    cancelled.store(1);
+}
+
+void
+DataProcessorPipeline::processInMemory()
+{
+    if (inmemory.isEmpty()) return;
+
+    int index = inmemory.takeFirst();
+    Job &job = jobs[index];
+
+    emit itemStarted(index);
+    process(job);
+
+    // update the views and let the user save it
+    if (job.changed) {
+        job.item->setDirty(true);
+        if (job.item == context->ride) context->notifyRideSelected(job.item);
+    }
+    done(index);
+
+    if (inmemory.count()) QTimer::singleShot(0, this, SLOT(processInMemory()));
+}
+
+void
+DataProcessorPipeline::done(int index)
+{
+    if (jobs[index].result == Done && jobs[index].changed && !jobs[index].inmemory && save_) saved = true;
+
+    completed++;
+    emit itemDone(index);
+    emit progress(completed, jobs.count());
+
+    if (completed == jobs.count()) {
+        running = false;
+
+        // pick up the changes, checkStale will see the files changed
+        if (saved) context->athlete->rideCache->refresh();
+
+        emit finished();
+    }
+}
+
+void
+DataProcessorPipeline::process(Job &job)
+{
+    if (cancelled.load()) {
+        job.result = Cancelled;
+        job.status = tr("Cancelled");
+        return;
+    }
+
+    // get the ride
+    RideFile *ride = NULL;
+    if (job.inmemory) {
+        ride = job.item->ride();
+    } else {
+        QFile file(job.filename);
+        ride = RideFileFactory::instance().openRideFile(context, file, job.errors);
+    }
+
+    if (ride == NULL) {
+        job.result = Failed;
+        job.status = tr("Read error");
+        return;
+    }
+
+    // process, and save if it changed
+    if (apply(ride, job) && processors.count() && job.changed && save_ && !job.inmemory) {
+        if (!write(ride, job.filename, QFileInfo(job.filename).suffix(), job.errors)) {
+            job.result = Failed;
+            job.status = tr("Write failed");
+        }
+    }
+
+    // and export
+    if (job.result == Pending && !exportDir.isEmpty()) {
+
+        QString filename = exportDir + "/" + QFileInfo(job.filename).baseName() + "." + exportSuffix;
+        if (QFile(filename).exists() && !overwrite) {
+            job.result = Skipped;
+            job.status = tr("Exists - not exported");
+
+        } else if (!write(ride, filename, exportSuffix, job.errors)) {
+            job.result = Failed;
+            job.status = tr("Write failed");
+
+        } else {
+            job.status = tr("Exported");
+        }
+    }
+
+    if (job.result == Pending) {
+        job.result = Done;
+        if (job.status.isEmpty()) job.status = job.changed ? tr("Updated") : tr("Unchanged");
+    }
+
+    if (!job.inmemory) delete ride;
+}
+
+bool
+DataProcessorPipeline::apply(RideFile *ride, Job &job)
+{
+    // each processor makes its changes in a LUW, so we
+    // can wind back to here if we get cancelled
+    int undo = ride->command->undoCount();
+
+    foreach(DataProcessor *dp, processors) {
+
+        if (cancelled.load()) break;
+
+        if (dp->isCoreProcessor()) {
+            job.changed |= dp->postProcess(ride, NULL, "UPDATE");
+        } else {
+            QMutexLocker locker(&scriptMutex);
+            job.changed |= dp->postProcess(ride, NULL, "UPDATE");
+        }
+    }
+    if (ride->command->undoCount() != undo) job.changed = true;
+
+    // part way through, leave it as it was
+    if (cancelled.load()) {
+        while (ride->command->undoCount() > undo) ride->command->undoCommand();
+        job.changed = false;
+        job.result = Cancelled;
+        job.status = tr("Cancelled");
+        return false;
+    }
+    return true;
+}
+
+bool
+DataProcessorPipeline::write(RideFile *ride, QString filename, QString suffix, QStringList &errors)
+{
+    // write alongside and swap in, so a failure doesn't lose the original
+    QString tmpname = filename + ".tmp";
+    QFile tmp(tmpname);
+
+    bool success;
+    if (suffix == "csv") {
+        CsvFileReader writer;
+        success = writer.writeRideFile(context, ride, tmp, CsvFileReader::gc);
+    } else {
+        success = RideFileFactory::instance().writeRideFile(context, ride, tmp, suffix);
+    }
+
+    if (success && QFile::exists(filename) && !QFile::remove(filename)) success = false;
+    if (success && !QFile::rename(tmpname, filename)) success = false;
+
+    if (!success) {
+        QFile::remove(tmpname);
+        errors << tr("Could not write %1").arg(filename);
+    }
+    return success;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _DataProcessorPipeline_h
+#define _DataProcessorPipeline_h
+#include "GoldenCheetah.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThreadPool>
+
+class Context;
+class RideItem;
+class RideFile;
+class DataProcessor;
+
+//
+// Apply an ordered set of data processors, and optionally export, to
+// a batch of activities.
+//
+// Activities that are closed are opened, processed, saved and exported
+// on a bounded pool of worker threads, each one independently. Those
+// that are open and have unsaved changes (or are the current activity)
+// are processed in memory on the GUI thread instead and marked dirty,
+// so the changes show up and can be undone like any other edit.
+//
+// When the activities are not being changed (not saving, or there are
+// no processors) the files are always read as saved, open or not, so
+// an export is of what is on disk and nothing is closed.
+//
+// The data processors each record their changes as a LUW on the ride
+// command stack; when the batch is cancelled part way through an
+// activity those are undone and it is left as it was. Any errors are
+// kept for each activity so one bad file doesn't stop the batch.
+//
+// Processors run with their saved settings, as they do when run
+// automatically on import or save. Scripted (non-core) processors are
+// not thread safe so they are only ever run one at a time.
+//
+class DataProcessorPipeline : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        DataProcessorPipeline(Context *context, QObject *parent = NULL);
+        ~DataProcessorPipeline(); // cancels and waits for workers
+
+        // what to do; processors by registered name, in the order given
+        void setProcessors(QStringList names);
+        void setSave(bool save) { save_ = save; } // write back if changed, default true
+        void setExport(QString dir, QString suffix, bool overwrite); // suffix "csv" for GC csv
+        void setMaxThreads(int n) { pool.setMaxThreadCount(n); }
+
+        // process them, progress is signalled and finished()
+        // is emitted when all of them have been dealt with
+        void start(QList<RideItem*> items);
+        bool isRunning() const { return running; }
+
+        // outcome, by position in the list passed to start()
+        enum outcome { Pending, Done, Skipped, Failed, Cancelled };
+        int count() const { return jobs.count(); }
+        RideItem *item(int index) const { return jobs[index].item; }
+        int result(int index) const { return jobs[index].result; }
+        bool changed(int index) const { return jobs[index].changed; }
+        QString status(int index) const { return jobs[index].status; }
+        QStringList errors(int index) const { return jobs[index].errors; }
+
+    public slots:
+
+        void cancel();
+
+    signals:
+
+        void itemStarted(int index);
+        void itemDone(int index);
+        void progress(int done, int total);
+        void finished();
+
+    private slots:
+
+        // called on the GUI thread
+        void processInMemory();
+        void done(int index);
+
+    private:
+
+        friend class DataProcessorPipelineTask;
+
+        struct Job {
+            Job() : item(NULL), inmemory(false), result(Pending), changed(false) {}
+            RideItem *item;
+            QString filename;   // absolute path to the activity file
+            bool inmemory;      // process the open ride on the GUI thread
+            int result;
+            bool changed;
+            QString status;
+            QStringList errors;
+        };
+
+        // process one activity, thread safe for distinct jobs
+        void process(Job &job);
+        bool apply(RideFile *ride, Job &job);
+        bool write(RideFile *ride, QString filename, QString suffix, QStringList &errors);
+
+        Context *context;
+        QList<DataProcessor*> processors;
+        bool save_;
+        QString exportDir, exportSuffix;
+        bool overwrite;
+
+        QThreadPool pool;
+        QVector<Job> jobs;
+        QList<int> inmemory;    // jobs waiting for the GUI thread
+        int completed;
+        bool running;
+        bool saved;             // any written back, need a refresh
+        QAtomicInt cancelled;
+
+        static QMutex scriptMutex; // non-core processors run one at a time
+};
+
+#endif // _DataProcessorPipeline_h
@@ -30,6 +30,7 @@
 #include <QDebug>
 #include <QTime>
 #include <cstdio>
+#include <cstring>
 #include <stdint.h>
 #include <time.h>
 #include <limits>
@@ -70,11 +71,58 @@ typedef qint64 fit_value_t;
 typedef std::string fit_string_value;
 typedef float fit_float_value;
 
+// decode a single value from the record buffer
+static inline fit_value_t fit_int8(const uchar *p) {
+    qint8 i = *p;
+    return i == 0x7f ? NA_VALUE : i;
+}
+static inline fit_value_t fit_uint8(const uchar *p) {
+    return *p == 0xff ? NA_VALUE : *p;
+}
+static inline fit_value_t fit_uint8z(const uchar *p) {
+    return *p == 0x00 ? NA_VALUE : *p;
+}
+static inline fit_value_t fit_int16(const uchar *p, bool is_big_endian) {
+    qint16 i = is_big_endian ? qFromBigEndian<qint16>(p) : qFromLittleEndian<qint16>(p);
+    return i == 0x7fff ? NA_VALUE : i;
+}
+static inline fit_value_t fit_uint16(const uchar *p, bool is_big_endian) {
+    quint16 i = is_big_endian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+    return i == 0xffff ? NA_VALUE : i;
+}
+static inline fit_value_t fit_uint16z(const uchar *p, bool is_big_endian) {
+    quint16 i = is_big_endian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+    return i == 0x0000 ? NA_VALUE : i;
+}
+static inline fit_value_t fit_int32(const uchar *p, bool is_big_endian) {
+    qint32 i = is_big_endian ? qFromBigEndian<qint32>(p) : qFromLittleEndian<qint32>(p);
+    return i == 0x7fffffff ? NA_VALUE : i;
+}
+static inline fit_value_t fit_uint32(const uchar *p, bool is_big_endian) {
+    quint32 i = is_big_endian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+    return i == 0xffffffff ? NA_VALUE : i;
+}
+static inline fit_value_t fit_uint32z(const uchar *p, bool is_big_endian) {
+    quint32 i = is_big_endian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+    return i == 0x00000000 ? NA_VALUE : i;
+}
+static inline fit_float_value fit_float32(const uchar *p) {
+    float f;
+    memcpy(&f, p, 4);
+    return f;
+}
+
 struct FitField {
     int num;
     int type; // FIT base_type
     int size; // in bytes
     int deve_idx; // Developer Data Index
+
+    // decode plan, see FitFileReaderState::compile()
+    int offset; // from the start of the data record
+    int elements; // array length, 0 for a single value
+    int decoded; // bytes decoded as values
+    int consumed; // bytes consumed from the record
 };
 
 struct FitDeveField {
@@ -90,9 +138,13 @@ struct FitDeveField {
 };
 
 struct FitDefinition {
+    FitDefinition() : global_msg_num(0), is_big_endian(false), record_size(0), defined(false) {}
+
     int global_msg_num;
     bool is_big_endian;
     std::vector<FitField> fields;
+    int record_size; // bytes in a data record
+    bool defined;
 };
 
 enum fitValueType { SingleValue, ListValue, FloatValue, StringValue };
@@ -119,7 +171,7 @@ struct FitFileReaderState
     quint32 last_event_timestamp;
     double start_timestamp;
     double last_distance;
-    QMap<int, FitDefinition> local_msg_types;
+    FitDefinition local_msg_types[16];
     QMap<QString, FitDeveField>  local_deve_fields; // All developer fields
     QMap<int, int> record_extra_fields;
     QMap<QString, int> record_deve_fields; // Developer fields in DEVELOPER XDATA or STANDARD DATA
@@ -154,160 +206,225 @@ struct FitFileReaderState
     QList<QMap<int, QString>> session_device_info_list_;
     QList<QList<QString>> session_data_info_list_;
 
+    // the file is decoded from memory, mapped if possible
+    QByteArray buffer;
+    const uchar *data;
+    qint64 pos, len;
+
+    // reused for every data record
+    std::vector<FitValue> values;
+
     FitFileReaderState(QFile &file, QStringList &errors) :
         file(file), errors(errors), rideFile(NULL), start_time(0),
         last_time(0), last_distance(0.00f), interval(0), calibration(0),
         devices(0), stopped(true), isLapSwim(false), last_length(0.0),
         last_event_type(-1), last_event(-1), last_msg_type(-1),
-        last_altitude(0.0)
+        last_altitude(0.0), data(NULL), pos(0), len(0)
     {}
 
     struct TruncatedRead {};
 
-    void read_unknown( int size, int *count = NULL ) {
-        if (!file.seek(file.pos() + size))
+    // advance over n bytes, returning where they start
+    const uchar *take(qint64 n, int *count = NULL) {
+        if (n < 0 || len - pos < n)
             throw TruncatedRead();
+        const uchar *p = data + pos;
+        pos += n;
         if (count)
-            (*count) += size;
+            (*count) += n;
+        return p;
+    }
+
+    // another FIT file follows the one just read
+    bool more_files() const {
+        return len - pos >= 12 && memcmp(data + pos + 8, ".FIT", 4) == 0;
+    }
+
+    void read_unknown( int size, int *count = NULL ) {
+        take(size, count);
     }
 
     fit_string_value read_text(int len, int *count = NULL) {
-        char c;
+        const uchar *p = take(len, count);
         fit_string_value res = "";
         for (int i = 0; i < len; ++i) {
-            if (file.read(&c, 1) != 1)
-                throw TruncatedRead();
-            if (count)
-                *count += 1;
-
-            if (c != 0)
-                res += c;
+            if (p[i] != 0)
+                res += p[i];
         }
         return res;
     }
 
     fit_value_t read_int8(int *count = NULL) {
-        qint8 i;
-        if (file.read(reinterpret_cast<char*>( &i), 1) != 1)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 1;
-
-        return i == 0x7f ? NA_VALUE : i;
+        return fit_int8(take(1, count));
     }
 
     fit_value_t read_uint8(int *count = NULL) {
-        quint8 i;
-        if (file.read(reinterpret_cast<char*>( &i), 1) != 1)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 1;
-
-        return i == 0xff ? NA_VALUE : i;
+        return fit_uint8(take(1, count));
     }
 
     fit_value_t read_uint8z(int *count = NULL) {
-        quint8 i;
-        if (file.read(reinterpret_cast<char*>( &i), 1) != 1)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 1;
-
-        return i == 0x00 ? NA_VALUE : i;
+        return fit_uint8z(take(1, count));
     }
 
     fit_value_t read_int16(bool is_big_endian, int *count = NULL) {
-        qint16 i;
-        if (file.read(reinterpret_cast<char*>(&i), 2) != 2)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 2;
-
-        i = is_big_endian
-            ? qFromBigEndian<qint16>( i )
-            : qFromLittleEndian<qint16>( i );
-
-        return i == 0x7fff ? NA_VALUE : i;
+        return fit_int16(take(2, count), is_big_endian);
     }
 
     fit_value_t read_uint16(bool is_big_endian, int *count = NULL) {
-        quint16 i;
-        if (file.read(reinterpret_cast<char*>(&i), 2) != 2)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 2;
-
-        i = is_big_endian
-            ? qFromBigEndian<quint16>( i )
-            : qFromLittleEndian<quint16>( i );
-
-        return i == 0xffff ? NA_VALUE : i;
+        return fit_uint16(take(2, count), is_big_endian);
     }
 
     fit_value_t read_uint16z(bool is_big_endian, int *count = NULL) {
-        quint16 i;
-        if (file.read(reinterpret_cast<char*>(&i), 2) != 2)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 2;
-
-        i = is_big_endian
-            ? qFromBigEndian<quint16>( i )
-            : qFromLittleEndian<quint16>( i );
-
-        return i == 0x0000 ? NA_VALUE : i;
+        return fit_uint16z(take(2, count), is_big_endian);
     }
 
     fit_value_t read_int32(bool is_big_endian, int *count = NULL) {
-        qint32 i;
-        if (file.read(reinterpret_cast<char*>(&i), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
-
-        i = is_big_endian
-            ? qFromBigEndian<qint32>( i )
-            : qFromLittleEndian<qint32>( i );
-
-        return i == 0x7fffffff ? NA_VALUE : i;
+        return fit_int32(take(4, count), is_big_endian);
     }
 
     fit_value_t read_uint32(bool is_big_endian, int *count = NULL) {
-        quint32 i;
-        if (file.read(reinterpret_cast<char*>(&i), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
+        return fit_uint32(take(4, count), is_big_endian);
+    }
 
-        i = is_big_endian
-            ? qFromBigEndian<quint32>( i )
-            : qFromLittleEndian<quint32>( i );
+    fit_value_t read_uint32z(bool is_big_endian, int *count = NULL) {
+        return fit_uint32z(take(4, count), is_big_endian);
+    }
 
-        return i == 0xffffffff ? NA_VALUE : i;
+    fit_float_value read_float32(int *count = NULL) {
+        return fit_float32(take(4, count));
     }
 
-    fit_value_t read_uint32z(bool is_big_endian, int *count = NULL) {
-        quint32 i;
-        if (file.read(reinterpret_cast<char*>(&i), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
+    // work out once where each field lives in a data record and how
+    // many bytes it uses, so records can be decoded without a read
+    // per value. The sizes match what was consumed when fields were
+    // read one at a time, including for malformed definitions.
+    void compile(FitDefinition &def) {
+        int offset = 0;
+        for (size_t n = 0; n < def.fields.size(); ++n) {
+            FitField &field = def.fields[n];
+            field.offset = offset;
+            field.elements = -1;
+
+            switch (field.type) {
+                // may be arrays, any odd bytes are not skipped
+                case 0: case 2: case 10: // UINT8, UINT8Z
+                case 4: // UINT16
+                case 6: case 8: // UINT32, FLOAT32
+                    {
+                        int size = (field.type == 4) ? 2 : (field.type == 6 || field.type == 8) ? 4 : 1;
+                        if (field.size != size) {
+                            field.elements = field.size / size;
+                            field.decoded = field.size;
+                            field.consumed = field.elements * size;
+                        } else {
+                            field.decoded = field.consumed = size;
+                        }
+                    }
+                    break;
 
-        i = is_big_endian
-            ? qFromBigEndian<quint32>( i )
-            : qFromLittleEndian<quint32>( i );
+                // single values, anything extra is skipped
+                case 1: field.decoded = 1; field.consumed = qMax(1, field.size); break;
+                case 3: case 11: field.decoded = 2; field.consumed = qMax(2, field.size); break;
+                case 5: case 12: field.decoded = 4; field.consumed = qMax(4, field.size); break;
 
-        return i == 0x00000000 ? NA_VALUE : i;
+                case 7: // STRING
+                case 13: // BYTE
+                    field.elements = field.size;
+                    field.decoded = field.consumed = field.size;
+                    break;
+
+                default: // skipped
+                    field.decoded = field.consumed = field.size > 0 ? field.size : 0;
+                    break;
+            }
+            offset += field.consumed;
+        }
+        def.record_size = offset;
     }
 
-    fit_float_value read_float32(int *count = NULL) {
-        float f;
-        if (file.read(reinterpret_cast<char*>(&f), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
+    void decode_value(const FitField &field, bool is_big_endian, const uchar *p, FitValue &value) {
+        // the slot is reused, nothing can be left from the last value decoded into it
+        value.v = 0;
+        value.f = 0;
+        value.s.clear();
+        value.list.clear();
+
+        switch (field.type) {
+            case 0:
+            case 2:
+                if (field.elements < 0) {
+                    value.type = SingleValue; value.v = fit_uint8(p);
+                } else { // Multi-values
+                    value.type = ListValue;
+                    for (int i=0;i<field.elements;i++) value.list.append(fit_uint8(p+i));
+                }
+                break;
+            case 1: value.type = SingleValue; value.v = fit_int8(p); break;
+            case 3: value.type = SingleValue; value.v = fit_int16(p, is_big_endian); break;
+            case 4:
+                if (field.elements < 0) {
+                    value.type = SingleValue; value.v = fit_uint16(p, is_big_endian);
+                } else { // Multi-values
+                    value.type = ListValue;
+                    for (int i=0;i<field.elements;i++) value.list.append(fit_uint16(p+2*i, is_big_endian));
+                }
+                break;
+            case 5: value.type = SingleValue; value.v = fit_int32(p, is_big_endian); break;
+            case 6:
+                if (field.elements < 0) {
+                    value.type = SingleValue; value.v = fit_uint32(p, is_big_endian);
+                } else { // Multi-values
+                    value.type = ListValue;
+                    for (int i=0;i<field.elements;i++) value.list.append(fit_uint32(p+4*i, is_big_endian));
+                }
+                break;
+            case 7:
+                value.type = StringValue;
+                for (int i=0;i<field.elements;i++) if (p[i] != 0) value.s += p[i];
+                break;
 
-        return f;
+            case 8: // FLOAT32
+                if (field.elements < 0) {
+                    value.type = FloatValue;
+                    value.f = fit_float32(p);
+                    if (value.f != value.f) // No NAN
+                        value.f = 0;
+                } else { // Multi-values
+                    value.type = ListValue;
+                    for (int i=0;i<field.elements;i++) value.list.append(fit_float32(p+4*i));
+                }
+                break;
+
+            //case 9: // FLOAT64
+
+            case 10:
+                if (field.elements < 0) {
+                    value.type = SingleValue; value.v = fit_uint8z(p);
+                } else { // Multi-values
+                    value.type = ListValue;
+                    for (int i=0;i<field.elements;i++) value.list.append(fit_uint8z(p+i));
+                }
+                break;
+            case 11: value.type = SingleValue; value.v = fit_uint16z(p, is_big_endian); break;
+            case 12: value.type = SingleValue; value.v = fit_uint32z(p, is_big_endian); break;
+            case 13: // BYTE
+                value.type = ListValue;
+                for (int i=0;i<field.elements;i++) value.list.append(fit_uint8(p+i));
+                break;
+
+            // we may need to add support for float, string + byte base types here
+            default:
+                if (FIT_DEBUG && FIT_DEBUG_LEVEL>1)  {
+                    // TODO: Dump raw data.
+                    printf("unknown type: %d size: %d \n", field.type,
+                           field.size);
+
+                }
+                value.type = SingleValue;
+                value.v = NA_VALUE;
+                unknown_base_type.insert(field.type);
+        }
+        value.size = field.decoded;
     }
 
     void DumpFitValue(const FitValue& v) {
@@ -1684,9 +1801,9 @@ struct FitFileReaderState
         fit_value_t lati = NA_VALUE, lngi = NA_VALUE;
         int i = 0;
         foreach(const FitField &field, def.fields) {
-            FitValue _values = values[i];
+            const FitValue &_values = values[i];
             fit_value_t value = values[i].v;
-            QList<fit_value_t> valueList = values[i++].list;
+            const QList<fit_value_t> &valueList = values[i++].list;
 
             double deve_value = 0.0;
 
@@ -2706,10 +2823,7 @@ struct FitFileReaderState
 
             data_size = read_uint32(false); // always littleEndian
             char fit_str[5];
-            if (file.read(fit_str, 4) != 4) {
-                errors << "truncated header";
-                stop = true;
-            }
+            memcpy(fit_str, take(4), 4);
             fit_str[4] = '\0';
             if (strcmp(fit_str, ".FIT") != 0) {
                 errors << QString("bad header, expected \".FIT\" but got \"%1\"").arg(fit_str);
@@ -2733,7 +2847,7 @@ struct FitFileReaderState
             int local_msg_type = header_byte & 0xf;
             bool with_deve_data = (header_byte & 0x20) == 0x20 ;
 
-            local_msg_types.insert(local_msg_type, FitDefinition());
+            local_msg_types[local_msg_type] = FitDefinition();
             FitDefinition &def = local_msg_types[local_msg_type];
 
             int reserved = read_uint8(&count); (void) reserved; // unused
@@ -2789,6 +2903,9 @@ struct FitFileReaderState
                     }
                 }
             }
+
+            compile(def);
+            def.defined = true;
         }
         else {
             // Data record
@@ -2803,7 +2920,7 @@ struct FitFileReaderState
                 local_msg_type = header_byte & 0xf;
             }
 
-            if (!local_msg_types.contains(local_msg_type)) {
+            if (!local_msg_types[local_msg_type].defined) {
                 printf( "local type %d without previous definition\n", local_msg_type );
                 errors << QString("local type %1 without previous definition").arg(local_msg_type);
                 stop = true;
@@ -2816,135 +2933,16 @@ struct FitFileReaderState
                     def.global_msg_num, time_offset );
             }
 
-            std::vector<FitValue> values;
-            foreach(const FitField &field, def.fields) {
-                FitValue value;
-                int size;
-
-                switch (field.type) {
-                    case 0: size = 1;
-                            if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint8(&count);;
-                             } else { // Multi-values
-                                value.type = ListValue;
-                                value.list.clear();
-                                for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint8(&count));
-                                }
-                                size = field.size;
-                            }
-                            break;
-                    case 1: value.type = SingleValue; value.v = read_int8(&count); size = 1;  break;
-                    case 2: size = 1;
-                            if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint8(&count);
-                            } else { // Multi-values
-                                value.type = ListValue;
-                                value.list.clear();
-                                for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint8(&count));
-                                }
-                                size = field.size;
-                            }
-                            break;
-                    case 3: value.type = SingleValue; value.v = read_int16(def.is_big_endian, &count); size = 2;  break;
-                    case 4: size = 2;
-                            if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint16(def.is_big_endian, &count);
-                            } else { // Multi-values
-                                value.type = ListValue;
-                                value.list.clear();
-                                for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint16(def.is_big_endian, &count));
-                                }
-                                size = field.size;
-                            }
-                            break;
-                    case 5: value.type = SingleValue; value.v = read_int32(def.is_big_endian, &count); size = 4;  break;
-                    case 6: size = 4;
-                            if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint32(def.is_big_endian, &count);
-                            } else { // Multi-values
-                                value.type = ListValue;
-                                value.list.clear();
-                                for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint32(def.is_big_endian, &count));
-                                }
-                                size = field.size;
-                            }
-                            break;
-                    case 7:
-                        value.type = StringValue;
-                        value.s = read_text(field.size, &count);
-                        size = field.size;
-                        break;
-
-                    case 8: // FLOAT32
-                        size = 4;
-                        if (field.size==size) {
-                            value.type = FloatValue;
-                            value.f = read_float32(&count);
-                            if (value.f != value.f) // No NAN
-                                value.f = 0;
-                        } else { // Multi-values
-                            value.type = ListValue;
-                            value.list.clear();
-                            for (int i=0;i<field.size/size;i++) {
-                                value.list.append(read_float32(&count));
-                            }
-                            size = field.size;
-                        }
-                        break;
+            // the whole record at once, then decode each field from it
+            const uchar *record = take(def.record_size, &count);
+            values.resize(def.fields.size());
 
-                    //case 9: // FLOAT64
+            for (size_t n = 0; n < def.fields.size(); ++n) {
+                const FitField &field = def.fields[n];
+                FitValue &value = values[n];
+                int size = field.decoded;
 
-                    case 10: size = 1;
-                             if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint8z(&count); size = 1;
-                             } else { // Multi-values
-                                 value.type = ListValue;
-                                 value.list.clear();
-                                 for (int i=0;i<field.size/size;i++) {
-                                     value.list.append(read_uint8z(&count));
-                                 }
-                                 size = field.size;
-                             }
-                             break;
-                    case 11: value.type = SingleValue; value.v = read_uint16z(def.is_big_endian, &count); size = 2; break;
-                    case 12: value.type = SingleValue; value.v = read_uint32z(def.is_big_endian, &count); size = 4; break;
-                    case 13: // BYTE
-                             value.type = ListValue;
-                             value.list.clear();
-                             for (int i=0;i<field.size;i++) {
-                                value.list.append(read_uint8(&count));
-                             }
-                             size = value.list.size();
-                             break;
-
-                    // we may need to add support for float, string + byte base types here
-                    default:
-                        if (FIT_DEBUG && FIT_DEBUG_LEVEL>1)  {
-                            // TODO: Dump raw data.
-                            printf("unknown type: %d size: %d \n", field.type,
-                                   field.size);
-
-                        }
-                        if (field.size > 0) read_unknown( field.size, &count );
-                        value.type = SingleValue;
-                        value.v = NA_VALUE;
-                        unknown_base_type.insert(field.type);
-                        size = field.size;
-                }
-                // Size is greater than expected
-                if (size < field.size) {
-                    if (FIT_DEBUG && FIT_DEBUG_LEVEL>1)  {
-                         printf( "   warning : size=%d for type=%d (num=%d)\n",
-                                 field.size, field.type, field.num);
-                    }
-                    read_unknown( field.size-size, &count );
-                }
-
-                values.push_back(value);
+                decode_value(field, def.is_big_endian, record + field.offset, value);
 
                 if (FIT_DEBUG && ((FIT_DEBUG_LEVEL>2 && def.global_msg_num!=RECORD_MSG_NUM) || FIT_DEBUG_LEVEL>3 )) {
                     QString nativeName = "";
@@ -3113,6 +3111,15 @@ struct FitFileReaderState
             return NULL;
         }
 
+        // decode from memory, rather than a read for every value
+        len = file.size();
+        data = file.map(0, len);
+        if (data == NULL) {
+            buffer = file.readAll();
+            data = reinterpret_cast<const uchar*>(buffer.constData());
+            len = buffer.size();
+        }
+
         int data_size = 0;
         weatherXdata = new XDataSeries();
         weatherXdata->name = "WEATHER";
@@ -3197,7 +3204,7 @@ struct FitFileReaderState
 
                 // second file ?
                 try {
-                    while (file.canReadLine()) {
+                    while (more_files()) {
                         read_header(stop, errors, data_size);
                         if (!stop) {
 
@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "GcbRideFile.h"
+#include "Context.h"
+#include "RideItem.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QColor>
+#include <cmath>
+
+static int gcbFileReaderRegistered =
+    RideFileFactory::instance().registerReader(
+        "gcb", "GoldenCheetah Binary", new GcbFileReader());
+
+static const char gcbMagic[4] = { 'G', 'C', 'B', '1' };
+static const quint16 gcbVersion = 1;
+
+// column encodings
+static const quint8 GCB_RAW = 0;        // float64 per sample
+static const quint8 GCB_DELTA = 1;      // 1+e zigzag varint deltas of value * 10^e
+static const int GCB_MAXEXP = 6;
+
+// the sample series, same names and same set as the .json SAMPLES
+// SECS is always written and always read
+static const struct {
+    const char *name;
+    double RideFilePoint::*value;
+    bool RideFileDataPresent::*present;
+} gcbSeries[] = {
+    { "SECS", &RideFilePoint::secs, &RideFileDataPresent::secs },
+    { "KM", &RideFilePoint::km, &RideFileDataPresent::km },
+    { "WATTS", &RideFilePoint::watts, &RideFileDataPresent::watts },
+    { "NM", &RideFilePoint::nm, &RideFileDataPresent::nm },
+    { "CAD", &RideFilePoint::cad, &RideFileDataPresent::cad },
+    { "KPH", &RideFilePoint::kph, &RideFileDataPresent::kph },
+    { "HR", &RideFilePoint::hr, &RideFileDataPresent::hr },
+    { "ALT", &RideFilePoint::alt, &RideFileDataPresent::alt },
+    { "LAT", &RideFilePoint::lat, &RideFileDataPresent::lat },
+    { "LON", &RideFilePoint::lon, &RideFileDataPresent::lon },
+    { "HEADWIND", &RideFilePoint::headwind, &RideFileDataPresent::headwind },
+    { "SLOPE", &RideFilePoint::slope, &RideFileDataPresent::slope },
+    { "TEMP", &RideFilePoint::temp, &RideFileDataPresent::temp },
+    { "LRBALANCE", &RideFilePoint::lrbalance, &RideFileDataPresent::lrbalance },
+    { "LTE", &RideFilePoint::lte, &RideFileDataPresent::lte },
+    { "RTE", &RideFilePoint::rte, &RideFileDataPresent::rte },
+    { "LPS", &RideFilePoint::lps, &RideFileDataPresent::lps },
+    { "RPS", &RideFilePoint::rps, &RideFileDataPresent::rps },
+    { "LPCO", &RideFilePoint::lpco, &RideFileDataPresent::lpco },
+    { "RPCO", &RideFilePoint::rpco, &RideFileDataPresent::rpco },
+    { "LPPB", &RideFilePoint::lppb, &RideFileDataPresent::lppb },
+    { "RPPB", &RideFilePoint::rppb, &RideFileDataPresent::rppb },
+    { "LPPE", &RideFilePoint::lppe, &RideFileDataPresent::lppe },
+    { "RPPE", &RideFilePoint::rppe, &RideFileDataPresent::rppe },
+    { "LPPPB", &RideFilePoint::lpppb, &RideFileDataPresent::lpppb },
+    { "RPPPB", &RideFilePoint::rpppb, &RideFileDataPresent::rpppb },
+    { "LPPPE", &RideFilePoint::lpppe, &RideFileDataPresent::lpppe },
+    { "RPPPE", &RideFilePoint::rpppe, &RideFileDataPresent::rpppe },
+    { "SMO2", &RideFilePoint::smo2, &RideFileDataPresent::smo2 },
+    { "THB", &RideFilePoint::thb, &RideFileDataPresent::thb },
+    { "RCAD", &RideFilePoint::rcad, &RideFileDataPresent::rcad },
+    { "RVERT", &RideFilePoint::rvert, &RideFileDataPresent::rvert },
+    { "RCON", &RideFilePoint::rcontact, &RideFileDataPresent::rcontact },
+};
+static const int gcbSeriesCount = sizeof(gcbSeries) / sizeof(gcbSeries[0]);
+
+//
+// Column encoding
+//
+
+// can every value be held exactly as an integer once scaled by 10^e
+static int exponentFor(const QVector<double> &values)
+{
+    double scale = 1;
+    for (int e=0; e <= GCB_MAXEXP; e++, scale *= 10) {
+        bool exact = true;
+        foreach(double v, values) {
+            double s = v * scale;
+            if (!std::isfinite(s) || std::fabs(s) >= 1e15 || (v == 0 && std::signbit(v))
+                || double(qint64(std::llround(s))) / scale != v) {
+                exact = false;
+                break;
+            }
+        }
+        if (exact) return e;
+    }
+    return -1;
+}
+
+static void putVarint(QByteArray &bytes, quint64 u)
+{
+    while (u >= 0x80) {
+        bytes.append(char((u & 0x7f) | 0x80));
+        u >>= 7;
+    }
+    bytes.append(char(u));
+}
+
+static bool getVarint(const uchar *&p, const uchar *end, quint64 &u)
+{
+    u = 0;
+    for (int shift=0; p < end && shift < 64; shift += 7) {
+        uchar b = *p++;
+        u |= quint64(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static void encodeColumn(const QVector<double> &values, quint8 &encoding, QByteArray &bytes)
+{
+    bytes.clear();
+    int e = exponentFor(values);
+
+    if (e < 0) {
+        // raw little endian doubles
+        encoding = GCB_RAW;
+        bytes.resize(values.count() * sizeof(double));
+        uchar *p = reinterpret_cast<uchar*>(bytes.data());
+        foreach(double v, values) {
+            quint64 u;
+            memcpy(&u, &v, sizeof(u));
+            for (int i=0; i<8; i++) *p++ = uchar(u >> (8*i));
+        }
+        return;
+    }
+
+    // samples mostly change a little from one to the next
+    // so the deltas are small and fit in a byte or two
+    encoding = GCB_DELTA + e;
+    bytes.reserve(values.count() * 2);
+    double scale = std::pow(10.0, e);
+    qint64 last = 0;
+    foreach(double v, values) {
+        qint64 n = std::llround(v * scale);
+        qint64 d = n - last;
+        putVarint(bytes, (quint64(d) << 1) ^ quint64(d >> 63));
+        last = n;
+    }
+}
+
+static bool decodeColumn(const QByteArray &bytes, quint8 encoding, int count, QVector<double> &values)
+{
+    values.resize(count);
+    const uchar *p = reinterpret_cast<const uchar*>(bytes.constData());
+    const uchar *end = p + bytes.size();
+
+    if (encoding == GCB_RAW) {
+        if (bytes.size() != count * int(sizeof(double))) return false;
+        for (int i=0; i<count; i++) {
+            quint64 u = 0;
+            for (int b=0; b<8; b++) u |= quint64(*p++) << (8*b);
+            memcpy(&values[i], &u, sizeof(u));
+        }
+        return true;
+    }
+
+    if (encoding > GCB_DELTA + GCB_MAXEXP) return false;
+    double scale = std::pow(10.0, encoding - GCB_DELTA);
+    qint64 last = 0;
+    for (int i=0; i<count; i++) {
+        quint64 u;
+        if (!getVarint(p, end, u)) return false;
+        last += qint64(u >> 1) ^ -qint64(u & 1);
+        values[i] = double(last) / scale;
+    }
+    return p == end;
+}
+
+static void writeColumn(QDataStream &out, const QString &name, const QVector<double> &values)
+{
+    quint8 encoding;
+    QByteArray bytes;
+    encodeColumn(values, encoding, bytes);
+    out << name << encoding << quint32(bytes.size());
+    out.writeRawData(bytes.constData(), bytes.size());
+}
+
+// read the next column, the bytes are skipped without decoding if not
+// in the series list, an empty list means all of them and SECS is
+// always wanted
+static bool readColumn(QDataStream &in, QString &name, const QStringList &series,
+                       int count, QVector<double> &values, bool &got)
+{
+    quint8 encoding;
+    quint32 length;
+    in >> name >> encoding >> length;
+    if (in.status() != QDataStream::Ok) return false;
+
+    got = name == "SECS" || series.isEmpty() || series.contains(name);
+    if (!got) return in.skipRawData(length) == int(length);
+
+    QByteArray bytes(length, Qt::Uninitialized);
+    if (in.readRawData(bytes.data(), length) != int(length)) return false;
+    return decodeColumn(bytes, encoding, count, values);
+}
+
+static void setupStream(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+//
+// Write
+//
+bool
+GcbFileReader::writeRideFile(Context *, const RideFile *ride, QFile &file) const
+{
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QDataStream out(&file);
+    setupStream(out);
+
+    out.writeRawData(gcbMagic, sizeof(gcbMagic));
+    out << gcbVersion;
+
+    // first class variables
+    out << ride->startTime().toMSecsSinceEpoch() << ride->recIntSecs() << ride->deviceType() << ride->id();
+    out << ride->tags() << ride->metricOverrides;
+
+    // intervals
+    out << quint32(ride->intervals().count());
+    foreach(RideFileInterval *i, ride->intervals())
+        out << i->name << i->start << i->stop << i->color.name() << i->test;
+
+    // calibrations
+    out << quint32(ride->calibrations().count());
+    foreach(RideFileCalibration *i, ride->calibrations())
+        out << i->name << i->start << qint32(i->value);
+
+    // references
+    out << quint32(ride->referencePoints().count());
+    foreach(RideFilePoint *p, ride->referencePoints())
+        out << p->watts << p->cad << p->hr << p->secs;
+
+    // samples, a column for each series present
+    const QVector<RideFilePoint*> &points = ride->dataPoints();
+    const RideFileDataPresent *present = ride->areDataPresent();
+    QVector<double> values(points.count());
+
+    QList<int> columns;
+    for (int s=0; s<gcbSeriesCount; s++)
+        if (s == 0 || present->*gcbSeries[s].present) columns << s;
+
+    out << quint32(points.count()) << quint32(points.isEmpty() ? 0 : columns.count());
+    if (points.count()) {
+        foreach(int s, columns) {
+            for (int i=0; i<points.count(); i++) values[i] = points[i]->*gcbSeries[s].value;
+            writeColumn(out, gcbSeries[s].name, values);
+        }
+    }
+
+    // xdata, like .json we only keep series with value names
+    QList<XDataSeries*> xdata;
+    foreach(XDataSeries *series, const_cast<RideFile*>(ride)->xdata())
+        if (!series->valuename.isEmpty()) xdata << series;
+
+    out << quint32(xdata.count());
+    foreach(XDataSeries *series, xdata) {
+
+        int count = series->datapoints.count();
+        int n = qMin(series->valuename.count(), XDATA_MAXVALUES);
+        out << series->name << series->valuename << series->unitname << quint32(count);
+
+        values.resize(count);
+        for (int i=0; i<count; i++) values[i] = series->datapoints[i]->secs;
+        writeColumn(out, "SECS", values);
+        for (int i=0; i<count; i++) values[i] = series->datapoints[i]->km;
+        writeColumn(out, "KM", values);
+        for (int v=0; v<n; v++) {
+            for (int i=0; i<count; i++) values[i] = series->datapoints[i]->number[v];
+            writeColumn(out, series->valuename[v], values);
+        }
+    }
+
+    file.close();
+    return out.status() == QDataStream::Ok && file.error() == QFile::NoError;
+}
+
+//
+// Read
+//
+RideFile *
+GcbFileReader::openRideFile(QFile &file, QStringList &errors, QList<RideFile*>*) const
+{
+    return openRideFile(file, errors, QStringList(), true);
+}
+
+RideFile *
+GcbFileReader::openRideFile(QFile &file, QStringList &errors, const QStringList &series, bool withXData) const
+{
+    if (!file.open(QFile::ReadOnly)) {
+        errors << "unable to open file" + file.fileName();
+        return NULL;
+    }
+
+    QDataStream in(&file);
+    setupStream(in);
+
+    char magic[4];
+    quint16 version = 0;
+    if (in.readRawData(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, gcbMagic, sizeof(magic))) {
+        errors << "not a GoldenCheetah binary file" + file.fileName();
+        return NULL;
+    }
+    in >> version;
+    if (version > gcbVersion) {
+        errors << QString("unsupported GoldenCheetah binary version %1").arg(version);
+        return NULL;
+    }
+
+    RideFile *ride = new RideFile;
+
+    // first class variables
+    qint64 start;
+    double recIntSecs;
+    QString deviceType, id;
+    QMap<QString,QString> tags;
+    in >> start >> recIntSecs >> deviceType >> id >> tags >> ride->metricOverrides;
+    ride->setStartTime(QDateTime::fromMSecsSinceEpoch(start));
+    ride->setRecIntSecs(recIntSecs);
+    ride->setDeviceType(deviceType);
+    ride->setId(id);
+    QMapIterator<QString,QString> t(tags);
+    while (t.hasNext()) {
+        t.next();
+        ride->setTag(t.key(), t.value());
+    }
+
+    // intervals, all user intervals as with .json
+    quint32 count;
+    in >> count;
+    for (quint32 i=0; i<count && in.status() == QDataStream::Ok; i++) {
+        QString name, color;
+        double from, to;
+        bool test;
+        in >> name >> from >> to >> color >> test;
+        ride->addInterval(RideFileInterval::USER, from, to, name, QColor(color), test);
+    }
+
+    // calibrations
+    in >> count;
+    for (quint32 i=0; i<count && in.status() == QDataStream::Ok; i++) {
+        QString name;
+        double from;
+        qint32 value;
+        in >> name >> from >> value;
+        ride->addCalibration(from, value, name);
+    }
+
+    // references
+    in >> count;
+    for (quint32 i=0; i<count && in.status() == QDataStream::Ok; i++) {
+        RideFilePoint p;
+        in >> p.watts >> p.cad >> p.hr >> p.secs;
+        ride->appendReference(p);
+    }
+
+    // samples
+    quint32 samples, columns;
+    in >> samples >> columns;
+    bool ok = in.status() == QDataStream::Ok;
+
+    if (ok && samples) {
+
+        QVector<RideFilePoint> points(samples);
+        QVector<double> values;
+        for (quint32 c=0; ok && c<columns; c++) {
+
+            QString name;
+            bool got;
+            ok = readColumn(in, name, series, samples, values, got);
+            if (!ok || !got) continue;
+
+            // unknown series from a later version are ignored
+            for (int s=0; s<gcbSeriesCount; s++) {
+                if (name == gcbSeries[s].name) {
+                    for (quint32 i=0; i<samples; i++) points[i].*gcbSeries[s].value = values[i];
+                    break;
+                }
+            }
+        }
+
+        if (ok) {
+            foreach(const RideFilePoint &point, points) {
+                ride->appendPoint(point.secs, point.cad, point.hr, point.km, point.kph, point.nm, point.watts, point.alt,
+                                  point.lon, point.lat, point.headwind, point.slope, point.temp, point.lrbalance,
+                                  point.lte, point.rte, point.lps, point.rps, point.lpco, point.rpco,
+                                  point.lppb, point.rppb, point.lppe, point.rppe,
+                                  point.lpppb, point.rpppb, point.lpppe, point.rpppe,
+                                  point.smo2, point.thb, point.rvert, point.rcad, point.rcontact, point.tcore,
+                                  point.interval);
+            }
+        }
+    }
+
+    // xdata is last so we can just stop if not wanted
+    if (ok && withXData) {
+
+        in >> count;
+        for (quint32 x=0; ok && x<count; x++) {
+
+            XDataSeries *add = new XDataSeries;
+            quint32 points;
+            in >> add->name >> add->valuename >> add->unitname >> points;
+            ok = in.status() == QDataStream::Ok;
+
+            int n = qMin(add->valuename.count(), XDATA_MAXVALUES);
+            for (quint32 i=0; ok && i<points; i++) add->datapoints << new XDataPoint();
+
+            QVector<double> values;
+            // secs, km and one for each value, as many as were written
+            for (int c=0; ok && c < 2 + n; c++) {
+                QString name;
+                bool got;
+                ok = readColumn(in, name, QStringList(), points, values, got);
+                if (!ok) continue;
+                for (quint32 i=0; i<points; i++) {
+                    XDataPoint *p = add->datapoints[i];
+                    if (c == 0) p->secs = values[i];
+                    else if (c == 1) p->km = values[i];
+                    else p->number[c-2] = values[i];
+                }
+            }
+
+            if (ok) ride->addXData(add->name, add);
+            else delete add;
+        }
+    }
+
+    file.close();
+
+    if (!ok) {
+        errors << "truncated or corrupt GoldenCheetah binary file" + file.fileName();
+        delete ride;
+        return NULL;
+    }
+    return ride;
+}
+
+//
+// Convert an existing .json activity, the binary file is read back
+// and checked against the original before the .json is removed, so
+// everything we write must come back the same
+//
+static bool same(double x, double y)
+{
+    return x == y || (std::isnan(x) && std::isnan(y));
+}
+
+static bool sameSamples(const RideFile *a, const RideFile *b)
+{
+    if (a->dataPoints().count() != b->dataPoints().count()) return false;
+    for (int s=0; s<gcbSeriesCount; s++) {
+        if (!(a->areDataPresent()->*gcbSeries[s].present) && s) continue;
+        for (int i=0; i<a->dataPoints().count(); i++) {
+            if (!same(a->dataPoints()[i]->*gcbSeries[s].value, b->dataPoints()[i]->*gcbSeries[s].value))
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool sameIntervals(const RideFile *a, const RideFile *b)
+{
+    if (a->intervals().count() != b->intervals().count()) return false;
+    for (int i=0; i<a->intervals().count(); i++) {
+        const RideFileInterval *x = a->intervals()[i], *y = b->intervals()[i];
+        if (x->name != y->name || !same(x->start, y->start) || !same(x->stop, y->stop) || x->test != y->test)
+            return false;
+    }
+    return true;
+}
+
+static bool sameCalibrations(const RideFile *a, const RideFile *b)
+{
+    if (a->calibrations().count() != b->calibrations().count()) return false;
+    for (int i=0; i<a->calibrations().count(); i++) {
+        const RideFileCalibration *x = a->calibrations()[i], *y = b->calibrations()[i];
+        if (x->name != y->name || !same(x->start, y->start) || x->value != y->value) return false;
+    }
+    return true;
+}
+
+static bool sameReferences(const RideFile *a, const RideFile *b)
+{
+    if (a->referencePoints().count() != b->referencePoints().count()) return false;
+    for (int i=0; i<a->referencePoints().count(); i++) {
+        const RideFilePoint *x = a->referencePoints()[i], *y = b->referencePoints()[i];
+        if (!same(x->watts, y->watts) || !same(x->cad, y->cad) || !same(x->hr, y->hr) || !same(x->secs, y->secs))
+            return false;
+    }
+    return true;
+}
+
+// only the series with value names are written, as with .json
+static bool sameXData(RideFile *a, RideFile *b)
+{
+    QList<XDataSeries*> written;
+    foreach(XDataSeries *series, a->xdata())
+        if (!series->valuename.isEmpty()) written << series;
+    if (written.count() != b->xdata().count()) return false;
+
+    foreach(XDataSeries *x, written) {
+        XDataSeries *y = b->xdata().value(x->name, NULL);
+        if (y == NULL || x->valuename != y->valuename || x->unitname != y->unitname
+            || x->datapoints.count() != y->datapoints.count()) return false;
+
+        int n = qMin(x->valuename.count(), XDATA_MAXVALUES);
+        for (int i=0; i<x->datapoints.count(); i++) {
+            const XDataPoint *p = x->datapoints[i], *q = y->datapoints[i];
+            if (!same(p->secs, q->secs) || !same(p->km, q->km)) return false;
+            for (int v=0; v<n; v++) if (!same(p->number[v], q->number[v])) return false;
+        }
+    }
+    return true;
+}
+
+bool
+GcbFileReader::convert(Context *context, RideItem *item, QStringList &errors)
+{
+    // only clean .json files
+    QFileInfo info(item->path + "/" + item->fileName);
+    if (item->isDirty() || info.suffix().toLower() != "json") return false;
+
+    bool wasOpen = item->isOpen();
+    RideFile *ride = item->ride();
+    if (ride == NULL) {
+        errors << QString("%1: unable to open").arg(item->fileName);
+        return false;
+    }
+
+    GcbFileReader reader;
+    QString target = info.path() + "/" + info.completeBaseName() + ".gcb";
+    QFile out(target);
+    bool ok = reader.writeRideFile(context, ride, out);
+
+    // read it back to check
+    if (ok) {
+        QStringList readErrors;
+        QFile in(target);
+        RideFile *check = reader.openRideFile(in, readErrors);
+        ok = check && sameSamples(ride, check) && check->tags() == ride->tags()
+             && check->metricOverrides == ride->metricOverrides
+             && sameIntervals(ride, check) && sameCalibrations(ride, check)
+             && sameReferences(ride, check) && sameXData(ride, check);
+        delete check;
+    }
+
+    if (!wasOpen) item->close();
+
+    if (!ok) {
+        QFile::remove(target);
+        errors << QString("%1: conversion failed").arg(item->fileName);
+        return false;
+    }
+
+    QFile::remove(info.absoluteFilePath());
+    item->setFileName(info.path(), QFileInfo(target).fileName());
+    return true;
+}
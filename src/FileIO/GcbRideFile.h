@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GcbRideFile_h
+#define _GcbRideFile_h
+#include "GoldenCheetah.h"
+
+#include "RideFile.h"
+
+class RideItem;
+
+//
+// GoldenCheetah Binary (.gcb)
+//
+// A compact alternative to the native .json format holding exactly
+// the same content; the ride metadata, tags, metric overrides,
+// intervals, calibrations, references, samples and xdata.
+//
+// Samples are stored a column per series. Where every value in a
+// column is a whole number once scaled by a power of ten it is
+// stored as zigzag varint deltas of the scaled values, otherwise
+// as raw doubles, so values are always read back exactly.
+//
+// Each column is preceded by its name (the same names used in the
+// .json SAMPLES) and length, so a reader can skip the series it
+// doesn't want without decoding them and unknown series from a
+// later version are ignored.
+//
+struct GcbFileReader : public RideFileReader {
+    virtual RideFile *openRideFile(QFile &file, QStringList &errors, QList<RideFile*>* = 0) const;
+    bool writeRideFile(Context *, const RideFile *ride, QFile &file) const;
+    bool hasWrite() const { return true; }
+
+    // just the series named (e.g. "SECS", "WATTS", "HR"), the
+    // xdata is only read if asked for
+    RideFile *openRideFile(QFile &file, QStringList &errors, const QStringList &series, bool withXData) const;
+
+    // convert a .json activity to .gcb in place, the ride item
+    // is updated to refer to the new file
+    static bool convert(Context *context, RideItem *item, QStringList &errors);
+};
+
+#endif // _GcbRideFile_h
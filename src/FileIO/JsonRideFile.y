@@ -36,6 +36,10 @@
 
 #include "JsonRideFile.h"
 
+#include <QBuffer>
+#include <cmath>
+#include <cstring>
+
 // now we have a reentrant parser we save context data
 // in a structure rather than in global variables -- so
 // you can run the parser concurrently.
@@ -72,6 +76,7 @@ struct JsonContext {
 extern int JsonRideFilelex(YYSTYPE*,void*); // the lexer aka yylex()
 extern int JsonRideFilelex_init(void**);
 extern void JsonRideFile_setString(QString, void *);
+extern void JsonRideFile_setBytes(const QByteArray &, void *);
 extern int JsonRideFilelex_destroy(void*); // the cleaner for lexer
 
 // yacc parser
@@ -395,32 +400,246 @@ static int jsonFileReaderRegistered =
     RideFileFactory::instance().registerReader(
         "json", "GoldenCheetah Json", new JsonFileReader());
 
+//
+// Fast path for the ride SAMPLES array
+//
+// The samples are by far the biggest part of a .json file, so rather
+// than tokenise every key and number through the lexer and parser we
+// scan them here directly into RideFilePoints. Anything unexpected and
+// we give up and leave it all to the grammar above.
+//
+struct JsonSeriesKey {
+    const char *name;
+    int len;
+    double RideFilePoint::*member;
+};
+
+// ordered by how often they appear
+static const JsonSeriesKey jsonSeriesKeys[] = {
+    { "SECS", 4, &RideFilePoint::secs }, { "KM", 2, &RideFilePoint::km },
+    { "WATTS", 5, &RideFilePoint::watts }, { "CAD", 3, &RideFilePoint::cad },
+    { "KPH", 3, &RideFilePoint::kph }, { "HR", 2, &RideFilePoint::hr },
+    { "ALT", 3, &RideFilePoint::alt }, { "LAT", 3, &RideFilePoint::lat },
+    { "LON", 3, &RideFilePoint::lon }, { "NM", 2, &RideFilePoint::nm },
+    { "SLOPE", 5, &RideFilePoint::slope }, { "TEMP", 4, &RideFilePoint::temp },
+    { "HEADWIND", 8, &RideFilePoint::headwind }, { "LRBALANCE", 9, &RideFilePoint::lrbalance },
+    { "LTE", 3, &RideFilePoint::lte }, { "RTE", 3, &RideFilePoint::rte },
+    { "LPS", 3, &RideFilePoint::lps }, { "RPS", 3, &RideFilePoint::rps },
+    { "LPCO", 4, &RideFilePoint::lpco }, { "RPCO", 4, &RideFilePoint::rpco },
+    { "LPPB", 4, &RideFilePoint::lppb }, { "RPPB", 4, &RideFilePoint::rppb },
+    { "LPPE", 4, &RideFilePoint::lppe }, { "RPPE", 4, &RideFilePoint::rppe },
+    { "LPPPB", 5, &RideFilePoint::lpppb }, { "RPPPB", 5, &RideFilePoint::rpppb },
+    { "LPPPE", 5, &RideFilePoint::lpppe }, { "RPPPE", 5, &RideFilePoint::rpppe },
+    { "SMO2", 4, &RideFilePoint::smo2 }, { "THB", 3, &RideFilePoint::thb },
+    { "RVERT", 5, &RideFilePoint::rvert }, { "RCAD", 4, &RideFilePoint::rcad },
+    { "RCON", 4, &RideFilePoint::rcontact },
+    { NULL, 0, NULL }
+};
+
+static inline const char *skipSpace(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+// numbers as the lexer sees them, integers are converted with
+// QString::toInt (so overflow is zero) and anything else as a double
+static bool scanNumber(const char *&p, const char *end, double &value)
+{
+    const char *start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+    // mantissa, exact whilst it fits in 53 bits
+    quint64 mantissa = 0;
+    int digits = 0, scale = 0;
+    bool exact = true;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (mantissa < (1ULL<<53)/10) mantissa = mantissa * 10 + (*p - '0');
+        else exact = false;
+        p++; digits++;
+    }
+    if (digits == 0) return false;
+
+    if (p == end || (*p != '.' && *p != 'e' && *p != 'E')) {
+        if (!exact || mantissa > 2147483647ULL + (negative ? 1 : 0)) value = 0;
+        else value = negative ? -double(mantissa) : double(mantissa);
+        return true;
+    }
+
+    if (*p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (mantissa < (1ULL<<53)/10) { mantissa = mantissa * 10 + (*p - '0'); scale--; }
+            else if (*p != '0') exact = false;
+            p++;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negexp = false;
+        if (p < end && (*p == '-' || *p == '+')) negexp = (*p++ == '-');
+        int exp = 0;
+        if (p == end || *p < '0' || *p > '9') return false;
+        while (p < end && *p >= '0' && *p <= '9') { if (exp < 10000) exp = exp * 10 + (*p - '0'); p++; }
+        scale += negexp ? -exp : exp;
+    }
+
+    // both exact so the result is correctly rounded
+    static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    if (exact && scale >= -22 && scale <= 22) {
+        value = double(mantissa);
+        if (scale < 0) value /= powers[-scale];
+        else value *= powers[scale];
+        if (negative) value = -value;
+    } else {
+        value = QByteArray::fromRawData(start, p - start).toDouble();
+    }
+    return true;
+}
+
+// skip a string, p is on the opening quote
+static bool scanString(const char *&p, const char *end)
+{
+    for (p++; p < end; p++) {
+        if (*p == '\\') p++;
+        else if (*p == '"') { p++; return true; }
+    }
+    return false;
+}
+
+// p is just after the opening '[', on success it is just after the closing ']'
+static bool scanSamples(const char *&p, const char *end, QVector<RideFilePoint> &points)
+{
+    int count = 0;
+    while (true) {
+        p = skipSpace(p, end);
+        if (p == end || *p != '{') return false;
+        p++;
+
+        RideFilePoint point;
+        while (true) {
+            p = skipSpace(p, end);
+            if (p == end || *p != '"') return false;
+            const char *key = ++p;
+            while (p < end && *p != '"' && *p != '\\') p++;
+            if (p == end || *p != '"') return false;
+            int len = p - key;
+            p = skipSpace(p+1, end);
+            if (p == end || *p != ':') return false;
+            p = skipSpace(p+1, end);
+            if (p == end) return false;
+
+            const JsonSeriesKey *series = jsonSeriesKeys;
+            while (series->name && (series->len != len || memcmp(series->name, key, len))) series++;
+
+            if (*p == '"') {
+                // only unknown keys can have string values
+                if (series->name || !scanString(p, end)) return false;
+            } else {
+                double value;
+                if (!scanNumber(p, end, value)) return false;
+                if (series->name) point.*(series->member) = value;
+            }
+
+            p = skipSpace(p, end);
+            if (p == end) return false;
+            if (*p == ',') { p++; continue; }
+            if (*p == '}') { p++; break; }
+            return false;
+        }
+
+        points.append(point);
+        count++;
+
+        p = skipSpace(p, end);
+        if (p == end) return false;
+        if (*p == ',') { p++; continue; }
+        if (*p == ']') { p++; return count > 0; }
+        return false;
+    }
+}
+
+// find the SAMPLES for the first ride and load them into ride, the
+// document is returned without them for the parser to do the rest
+static bool fastSamples(QByteArray &document, RideFile *ride)
+{
+    const char *begin = document.constData();
+    const char *end = begin + document.size();
+
+    int at = document.indexOf("\"SAMPLES\"");
+    if (at < 0) return false;
+
+    // it must be a ride element, not inside xdata
+    int braces = 0, brackets = 0;
+    for (const char *p = begin; p < begin + at; p++) {
+        switch (*p) {
+        case '"': if (!scanString(p, begin + at)) return false; p--; break;
+        case '{': braces++; break;
+        case '}': braces--; break;
+        case '[': brackets++; break;
+        case ']': brackets--; break;
+        }
+    }
+    if (brackets != 0 || braces < 1 || braces > 2) return false;
+
+    const char *p = skipSpace(begin + at + 9, end);
+    if (p == end || *p != ':') return false;
+    p = skipSpace(p+1, end);
+    if (p == end || *p != '[') return false;
+    p++;
+
+    // scan them all before adding so a failure leaves no trace
+    QVector<RideFilePoint> points;
+    points.reserve(document.size() / 64);
+    if (!scanSamples(p, end, points)) return false;
+
+    // the element and its separating comma are cut out
+    int from = at, to = p - begin;
+    const char *q = begin + at - 1;
+    while (q > begin && (*q == ' ' || *q == '\n' || *q == '\t' || *q == '\r')) q--;
+    if (*q == ',') {
+        from = q - begin;
+    } else {
+        const char *r = skipSpace(p, end);
+        if (r == end || *r != ',') return false; // only element
+        to = r + 1 - begin;
+    }
+
+    foreach(const RideFilePoint &point, points) {
+        ride->appendPoint(point.secs, point.cad, point.hr, point.km, point.kph, point.nm, point.watts, point.alt,
+                          point.lon, point.lat, point.headwind, point.slope, point.temp, point.lrbalance,
+                          point.lte, point.rte, point.lps, point.rps, point.lpco, point.rpco,
+                          point.lppb, point.rppb, point.lppe, point.rppe,
+                          point.lpppb, point.rpppb, point.lpppe, point.rpppe,
+                          point.smo2, point.thb, point.rvert, point.rcad, point.rcontact, point.tcore,
+                          point.interval);
+    }
+    document.remove(from, to - from);
+    return true;
+}
+
 RideFile *
 JsonFileReader::openRideFile(QFile &file, QStringList &errors, QList<RideFile*>*) const
 {
-    // Read the entire file into a QString -- we avoid using fopen since it
+    // Read the entire file -- we avoid using fopen since it
     // doesn't handle foreign characters well. Instead we use QFile and parse
-    // from a QString
-    QString contents;
+    // the UTF-8 bytes
+    QByteArray contents;
     if (file.exists() && file.open(QFile::ReadOnly | QFile::Text)) {
 
         // read in the whole thing
-        QTextStream in(&file);
-        // GC .JSON is stored in UTF-8 with BOM(Byte order mark) for identification
-        in.setCodec ("UTF-8");
-        contents = in.readAll();
+        contents = file.readAll();
         file.close();
 
+        // GC .JSON is stored in UTF-8 with BOM(Byte order mark) for identification
+        if (contents.startsWith("\xEF\xBB\xBF")) contents.remove(0, 3);
+
         // check if the text string contains the replacement character for UTF-8 encoding
         // if yes, try to read with Latin1/ISO 8859-1 (assuming this is an "old" non-UTF-8 Json file)
-        if (contents.contains(QChar::ReplacementCharacter)) {
-           if (file.exists() && file.open(QFile::ReadOnly | QFile::Text)) {
-             QTextStream in(&file);
-             in.setCodec ("ISO 8859-1");
-             contents = in.readAll();
-             file.close();
-           }
-         }
+        if (QString::fromUtf8(contents).contains(QChar::ReplacementCharacter))
+            contents = QString::fromLatin1(contents).toUtf8();
 
     } else {
 
@@ -432,13 +651,16 @@ JsonFileReader::openRideFile(QFile &file, QStringList &errors, QList<RideFile*>*
     JsonContext *jc = new JsonContext;
     JsonRideFilelex_init(&scanner);
 
-    // inform the parser/lexer we have a new file
-    JsonRideFile_setString(contents, scanner);
-
     // setup
     jc->JsonRide = new RideFile;
     jc->JsonRideFileerrors.clear();
 
+    // the samples first, then everything else
+    fastSamples(contents, jc->JsonRide);
+
+    // inform the parser/lexer we have a new file
+    JsonRideFile_setBytes(contents, scanner);
+
     // set to non-zero if you want to
     // to debug the yyparse() state machine
     // sending state transitions to stderr
@@ -464,19 +686,70 @@ JsonFileReader::openRideFile(QFile &file, QStringList &errors, QList<RideFile*>*
     }
 }
 
-QByteArray
-JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool withWatts, bool withHr, bool withCad) const
+//
+// Buffered output straight to the device, numbers come out exactly
+// as QString("%1").arg() formats them but without building a QString
+// for every value
+//
+class JsonWriter
 {
-    QByteArray out;
+    public:
+        JsonWriter(QIODevice *device) : device(device) { buffer.reserve(chunk + 1024); }
+        ~JsonWriter() { flush(); }
+
+        JsonWriter &operator<<(const char *s) { buffer.append(s); check(); return *this; }
+        JsonWriter &operator<<(const QString &s) { buffer.append(s.toUtf8()); check(); return *this; }
+        JsonWriter &operator<<(int v) { integer(v); check(); return *this; }
+        JsonWriter &operator<<(double v) { number(v, 6); return *this; }
+
+        // %1 with 'g' and precision
+        void number(double v, int precision) {
+
+            // whole numbers that won't switch to exponent form are most samples
+            static const double limits[] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+            if (precision < 16 && v > -limits[precision] && v < limits[precision] && v == double(qint64(v))
+                && !(v == 0 && std::signbit(v))) {
+                integer(qint64(v));
+            } else {
+                buffer.append(QByteArray::number(v, 'g', precision));
+            }
+            check();
+        }
+
+        void flush() {
+            if (buffer.size()) {
+                device->write(buffer);
+                buffer.resize(0);
+            }
+        }
+
+    private:
+        void integer(qint64 v) {
+            char digits[24];
+            char *p = digits + sizeof(digits);
+            quint64 u = v < 0 ? quint64(-(v+1)) + 1 : quint64(v);
+            do { *--p = '0' + (u % 10); u /= 10; } while (u);
+            if (v < 0) *--p = '-';
+            buffer.append(p, digits + sizeof(digits) - p);
+        }
+        void check() { if (buffer.size() >= chunk) flush(); }
+
+        static const int chunk = 64 * 1024;
+        QIODevice *device;
+        QByteArray buffer;
+};
 
+static void
+writeJson(JsonWriter &out, const RideFile *ride, bool withAlt, bool withWatts, bool withHr, bool withCad)
+{
     // start of document and ride
-    out += "{\n\t\"RIDE\":{\n";
+    out << "{\n\t\"RIDE\":{\n";
 
     // first class variables
-    out += "\t\t\"STARTTIME\":\"" + protect(ride->startTime().toUTC().toString(DATETIME_FORMAT)) + "\",\n";
-    out += "\t\t\"RECINTSECS\":" + QString("%1").arg(ride->recIntSecs()) + ",\n";
-    out += "\t\t\"DEVICETYPE\":\"" + protect(ride->deviceType()) + "\",\n";
-    out += "\t\t\"IDENTIFIER\":\"" + protect(ride->id()) + "\"";
+    out << "\t\t\"STARTTIME\":\"" << protect(ride->startTime().toUTC().toString(DATETIME_FORMAT)) << "\",\n";
+    out << "\t\t\"RECINTSECS\":" << ride->recIntSecs() << ",\n";
+    out << "\t\t\"DEVICETYPE\":\"" << protect(ride->deviceType()) << "\",\n";
+    out << "\t\t\"IDENTIFIER\":\"" << protect(ride->id()) << "\"";
 
     //
     // OVERRIDES
@@ -492,28 +765,28 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
         for (k=ride->metricOverrides.constBegin(); k != ride->metricOverrides.constEnd(); k++) {
 
             if (nonblanks == false) {
-                out += ",\n\t\t\"OVERRIDES\":[\n";
+                out << ",\n\t\t\"OVERRIDES\":[\n";
                 nonblanks = true;
 
             }
             // begin of overrides
-            out += "\t\t\t{ \"" + k.key() + "\":{ ";
+            out << "\t\t\t{ \"" << k.key() << "\":{ ";
 
             // key/value pairs
             QMap<QString, QString>::const_iterator j;
             for (j=k.value().constBegin(); j != k.value().constEnd(); j++) {
 
                 // comma separated
-                out += "\"" + j.key() + "\":\"" + j.value() + "\"";
-                if (j+1 != k.value().constEnd()) out += ", ";
+                out << "\"" << j.key() << "\":\"" << j.value() << "\"";
+                if (j+1 != k.value().constEnd()) out << ", ";
             }
-            if (k+1 != ride->metricOverrides.constEnd()) out += " }},\n";
-            else out += " }}\n";
+            if (k+1 != ride->metricOverrides.constEnd()) out << " }},\n";
+            else out << " }}\n";
         }
 
         if (nonblanks == true) {
             // end of the overrides
-            out += "\t\t]";
+            out << "\t\t]";
         }
     }
 
@@ -522,18 +795,18 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
     //
     if (ride->tags().count()) {
 
-        out += ",\n\t\t\"TAGS\":{\n";
+        out << ",\n\t\t\"TAGS\":{\n";
 
         QMap<QString,QString>::const_iterator i;
         for (i=ride->tags().constBegin(); i != ride->tags().constEnd(); i++) {
 
-                out += "\t\t\t\"" + i.key() + "\":\"" + protect(i.value()) + "\"";
-                if (i+1 != ride->tags().constEnd()) out += ",\n";
-                else out += "\n";
+                out << "\t\t\t\"" << i.key() << "\":\"" << protect(i.value()) << "\"";
+                if (i+1 != ride->tags().constEnd()) out << ",\n";
+                else out << "\n";
         }
 
         // end of the tags
-        out += "\t\t}";
+        out << "\t\t}";
     }
 
     //
@@ -541,21 +814,21 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
     //
     if (!ride->intervals().empty()) {
 
-        out += ",\n\t\t\"INTERVALS\":[\n";
+        out << ",\n\t\t\"INTERVALS\":[\n";
         bool first = true;
 
         foreach (RideFileInterval *i, ride->intervals()) {
             if (first) first=false;
-            else out += ",\n";
-
-            out += "\t\t\t{ ";
-            out += "\"NAME\":\"" + protect(i->name) + "\"";
-            out += ", \"START\": " + QString("%1").arg(i->start);
-            out += ", \"STOP\": " + QString("%1").arg(i->stop);
-            out += ", \"COLOR\":" + QString("\"%1\"").arg(i->color.name());
-            out += ", \"PTEST\":\"" + QString("%1").arg(i->test ? "true" : "false") + "\" }";
+            else out << ",\n";
+
+            out << "\t\t\t{ ";
+            out << "\"NAME\":\"" << protect(i->name) << "\"";
+            out << ", \"START\": " << i->start;
+            out << ", \"STOP\": " << i->stop;
+            out << ", \"COLOR\":" << "\"" << i->color.name() << "\"";
+            out << ", \"PTEST\":\"" << (i->test ? "true" : "false") << "\" }";
         }
-        out += "\n\t\t]";
+        out << "\n\t\t]";
     }
 
     //
@@ -563,19 +836,19 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
     //
     if (!ride->calibrations().empty()) {
 
-        out += ",\n\t\t\"CALIBRATIONS\":[\n";
+        out << ",\n\t\t\"CALIBRATIONS\":[\n";
         bool first = true;
 
         foreach (RideFileCalibration *i, ride->calibrations()) {
             if (first) first=false;
-            else out += ",\n";
+            else out << ",\n";
 
-            out += "\t\t\t{ ";
-            out += "\"NAME\":\"" + protect(i->name) + "\"";
-            out += ", \"START\": " + QString("%1").arg(i->start);
-            out += ", \"VALUE\": " + QString("%1").arg(i->value) + " }";
+            out << "\t\t\t{ ";
+            out << "\"NAME\":\"" << protect(i->name) << "\"";
+            out << ", \"START\": " << i->start;
+            out << ", \"VALUE\": " << i->value << " }";
         }
-        out += "\n\t\t]";
+        out << "\n\t\t]";
     }
 
     //
@@ -583,24 +856,24 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
     //
     if (!ride->referencePoints().empty()) {
 
-        out += ",\n\t\t\"REFERENCES\":[\n";
+        out << ",\n\t\t\"REFERENCES\":[\n";
         bool first = true;
 
         foreach (RideFilePoint *p, ride->referencePoints()) {
             if (first) first=false;
-            else out += ",\n";
+            else out << ",\n";
 
-            out += "\t\t\t{ ";
+            out << "\t\t\t{ ";
 
-            if (p->watts > 0) out += " \"WATTS\":" + QString("%1").arg(p->watts);
-            if (p->cad > 0) out += " \"CAD\":" + QString("%1").arg(p->cad);
-            if (p->hr > 0) out += " \"HR\":"  + QString("%1").arg(p->hr);
-            if (p->secs > 0) out += " \"SECS\":" + QString("%1").arg(p->secs);
+            if (p->watts > 0) out << " \"WATTS\":" << p->watts;
+            if (p->cad > 0) out << " \"CAD\":" << p->cad;
+            if (p->hr > 0) out << " \"HR\":" << p->hr;
+            if (p->secs > 0) out << " \"SECS\":" << p->secs;
 
             // sample points in here!
-            out += " }";
+            out << " }";
         }
-        out +="\n\t\t]";
+        out << "\n\t\t]";
     }
 
     //
@@ -608,59 +881,59 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
     //
     if (ride->dataPoints().count()) {
 
-        out += ",\n\t\t\"SAMPLES\":[\n";
+        out << ",\n\t\t\"SAMPLES\":[\n";
         bool first = true;
 
+        // same for every sample
+        const RideFileDataPresent *present = ride->areDataPresent();
+
         foreach (RideFilePoint *p, ride->dataPoints()) {
 
             if (first) first=false;
-            else out += ",\n";
+            else out << ",\n";
 
-            out += "\t\t\t{ ";
+            out << "\t\t\t{ ";
 
             // always store time
-            out += "\"SECS\":" + QString("%1").arg(p->secs);
-
-            if (ride->areDataPresent()->km) out += ", \"KM\":" + QString("%1").arg(p->km);
-            if (ride->areDataPresent()->watts && withWatts) out += ", \"WATTS\":" + QString("%1").arg(p->watts);
-            if (ride->areDataPresent()->nm) out += ", \"NM\":" + QString("%1").arg(p->nm);
-            if (ride->areDataPresent()->cad && withCad) out += ", \"CAD\":" + QString("%1").arg(p->cad);
-            if (ride->areDataPresent()->kph) out += ", \"KPH\":" + QString("%1").arg(p->kph);
-            if (ride->areDataPresent()->hr && withHr) out += ", \"HR\":"  + QString("%1").arg(p->hr);
-            if (ride->areDataPresent()->alt && withAlt)
-			    out += ", \"ALT\":" + QString("%1").arg(p->alt, 0, 'g', 11);
-            if (ride->areDataPresent()->lat)
-                out += ", \"LAT\":" + QString("%1").arg(p->lat, 0, 'g', 11);
-            if (ride->areDataPresent()->lon)
-                out += ", \"LON\":" + QString("%1").arg(p->lon, 0, 'g', 11);
-            if (ride->areDataPresent()->headwind) out += ", \"HEADWIND\":" + QString("%1").arg(p->headwind);
-            if (ride->areDataPresent()->slope) out += ", \"SLOPE\":" + QString("%1").arg(p->slope);
-            if (ride->areDataPresent()->temp && p->temp != RideFile::NA) out += ", \"TEMP\":" + QString("%1").arg(p->temp);
-            if (ride->areDataPresent()->lrbalance && p->lrbalance != RideFile::NA) out += ", \"LRBALANCE\":" + QString("%1").arg(p->lrbalance);
-            if (ride->areDataPresent()->lte) out += ", \"LTE\":" + QString("%1").arg(p->lte);
-            if (ride->areDataPresent()->rte) out += ", \"RTE\":" + QString("%1").arg(p->rte);
-            if (ride->areDataPresent()->lps) out += ", \"LPS\":" + QString("%1").arg(p->lps);
-            if (ride->areDataPresent()->rps) out += ", \"RPS\":" + QString("%1").arg(p->rps);
-            if (ride->areDataPresent()->lpco) out += ", \"LPCO\":" + QString("%1").arg(p->lpco);
-            if (ride->areDataPresent()->rpco) out += ", \"RPCO\":" + QString("%1").arg(p->rpco);
-            if (ride->areDataPresent()->lppb) out += ", \"LPPB\":" + QString("%1").arg(p->lppb);
-            if (ride->areDataPresent()->rppb) out += ", \"RPPB\":" + QString("%1").arg(p->rppb);
-            if (ride->areDataPresent()->lppe) out += ", \"LPPE\":" + QString("%1").arg(p->lppe);
-            if (ride->areDataPresent()->rppe) out += ", \"RPPE\":" + QString("%1").arg(p->rppe);
-            if (ride->areDataPresent()->lpppb) out += ", \"LPPPB\":" + QString("%1").arg(p->lpppb);
-            if (ride->areDataPresent()->rpppb) out += ", \"RPPPB\":" + QString("%1").arg(p->rpppb);
-            if (ride->areDataPresent()->lpppe) out += ", \"LPPPE\":" + QString("%1").arg(p->lpppe);
-            if (ride->areDataPresent()->rpppe) out += ", \"RPPPE\":" + QString("%1").arg(p->rpppe);
-            if (ride->areDataPresent()->smo2) out += ", \"SMO2\":" + QString("%1").arg(p->smo2);
-            if (ride->areDataPresent()->thb) out += ", \"THB\":" + QString("%1").arg(p->thb);
-            if (ride->areDataPresent()->rcad) out += ", \"RCAD\":" + QString("%1").arg(p->rcad);
-            if (ride->areDataPresent()->rvert) out += ", \"RVERT\":" + QString("%1").arg(p->rvert);
-            if (ride->areDataPresent()->rcontact) out += ", \"RCON\":" + QString("%1").arg(p->rcontact);
+            out << "\"SECS\":" << p->secs;
+
+            if (present->km) out << ", \"KM\":" << p->km;
+            if (present->watts && withWatts) out << ", \"WATTS\":" << p->watts;
+            if (present->nm) out << ", \"NM\":" << p->nm;
+            if (present->cad && withCad) out << ", \"CAD\":" << p->cad;
+            if (present->kph) out << ", \"KPH\":" << p->kph;
+            if (present->hr && withHr) out << ", \"HR\":" << p->hr;
+            if (present->alt && withAlt) { out << ", \"ALT\":"; out.number(p->alt, 11); }
+            if (present->lat) { out << ", \"LAT\":"; out.number(p->lat, 11); }
+            if (present->lon) { out << ", \"LON\":"; out.number(p->lon, 11); }
+            if (present->headwind) out << ", \"HEADWIND\":" << p->headwind;
+            if (present->slope) out << ", \"SLOPE\":" << p->slope;
+            if (present->temp && p->temp != RideFile::NA) out << ", \"TEMP\":" << p->temp;
+            if (present->lrbalance && p->lrbalance != RideFile::NA) out << ", \"LRBALANCE\":" << p->lrbalance;
+            if (present->lte) out << ", \"LTE\":" << p->lte;
+            if (present->rte) out << ", \"RTE\":" << p->rte;
+            if (present->lps) out << ", \"LPS\":" << p->lps;
+            if (present->rps) out << ", \"RPS\":" << p->rps;
+            if (present->lpco) out << ", \"LPCO\":" << p->lpco;
+            if (present->rpco) out << ", \"RPCO\":" << p->rpco;
+            if (present->lppb) out << ", \"LPPB\":" << p->lppb;
+            if (present->rppb) out << ", \"RPPB\":" << p->rppb;
+            if (present->lppe) out << ", \"LPPE\":" << p->lppe;
+            if (present->rppe) out << ", \"RPPE\":" << p->rppe;
+            if (present->lpppb) out << ", \"LPPPB\":" << p->lpppb;
+            if (present->rpppb) out << ", \"RPPPB\":" << p->rpppb;
+            if (present->lpppe) out << ", \"LPPPE\":" << p->lpppe;
+            if (present->rpppe) out << ", \"RPPPE\":" << p->rpppe;
+            if (present->smo2) out << ", \"SMO2\":" << p->smo2;
+            if (present->thb) out << ", \"THB\":" << p->thb;
+            if (present->rcad) out << ", \"RCAD\":" << p->rcad;
+            if (present->rvert) out << ", \"RVERT\":" << p->rvert;
+            if (present->rcontact) out << ", \"RCON\":" << p->rcontact;
 
             // sample points in here!
-            out += " }";
+            out << " }";
         }
-        out +="\n\t\t]";
+        out << "\n\t\t]";
     }
 
     //
@@ -668,7 +941,7 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
     //
     if (const_cast<RideFile*>(ride)->xdata().count()) {
         // output the xdata series
-        out += ",\n\t\t\"XDATA\":[\n";
+        out << ",\n\t\t\"XDATA\":[\n";
 
         bool first = true;
         QMapIterator<QString,XDataSeries*> xdata(const_cast<RideFile*>(ride)->xdata());
@@ -683,95 +956,114 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
             // does it have values names?
             if (series->valuename.isEmpty()) continue;
 
-            if (!first) out += ",\n";
-            out += "\t\t{\n";
+            if (!first) out << ",\n";
+            out << "\t\t{\n";
 
             // series name
-            out += "\t\t\t\"NAME\" : \"" + xdata.key() + "\",\n";
+            out << "\t\t\t\"NAME\" : \"" << xdata.key() << "\",\n";
 
             // value names
             if (series->valuename.count() > 1) {
-                out += "\t\t\t\"VALUES\" : [ ";
+                out << "\t\t\t\"VALUES\" : [ ";
                 bool firstv=true;
                 foreach(QString x, series->valuename) {
-                    if (!firstv) out += ", ";
-                    out += "\"" + x + "\"";
+                    if (!firstv) out << ", ";
+                    out << "\"" << x << "\"";
                     firstv=false;
                 }
-                out += " ]";
+                out << " ]";
             } else {
-                out += "\t\t\t\"VALUE\" : \"" + series->valuename[0] + "\"";
+                out << "\t\t\t\"VALUE\" : \"" << series->valuename[0] << "\"";
             }
 
             // unit names
             if (series->unitname.count() > 1) {
-                out += ",\n\t\t\t\"UNITS\" : [ ";
+                out << ",\n\t\t\t\"UNITS\" : [ ";
                 bool firstv=true;
                 foreach(QString x, series->unitname) {
-                    if (!firstv) out += ", ";
-                    out += "\"" + x + "\"";
+                    if (!firstv) out << ", ";
+                    out << "\"" << x << "\"";
                     firstv=false;
                 }
-                out += " ]";
+                out << " ]";
             } else {
-                if (series->unitname.count() > 0) out += ",\n\t\t\t\"UNIT\" : \"" + series->unitname[0] + "\"";
+                if (series->unitname.count() > 0) out << ",\n\t\t\t\"UNIT\" : \"" << series->unitname[0] << "\"";
             }
 
             // samples
             if (series->datapoints.count()) {
-                out += ",\n\t\t\t\"SAMPLES\" : [\n";
+                out << ",\n\t\t\t\"SAMPLES\" : [\n";
 
                 bool firsts=true;
                 foreach(XDataPoint *p, series->datapoints) {
-                    if (!firsts) out += ",\n";
+                    if (!firsts) out << ",\n";
 
                     // multi value sample
                     if (series->valuename.count()>1) {
 
-                        out += "\t\t\t\t{ \"SECS\":"+QString("%1").arg(p->secs) +", "
-                            + "\"KM\":"+QString("%1").arg(p->km) + ", "
-                            + "\"VALUES\":[ ";
+                        out << "\t\t\t\t{ \"SECS\":" << p->secs << ", "
+                            << "\"KM\":" << p->km << ", "
+                            << "\"VALUES\":[ ";
 
                         bool firstvv=true;
                         for(int i=0; i<series->valuename.count(); i++) {
-                            if (!firstvv) out += ", ";
-                            out += QString("%1").arg(p->number[i]);
+                            if (!firstvv) out << ", ";
+                            out << p->number[i];
                             firstvv=false;
                          }
-                         out += " ] }";
+                         out << " ] }";
 
                     } else {
 
-                        out += "\t\t\t\t{ \"SECS\":"+QString("%1").arg(p->secs) + ", "
-                            + "\"KM\":"+QString("%1").arg(p->km) + ", "
-                            + "\"VALUE\":" + QString("%1").arg(p->number[0]) + " }";
+                        out << "\t\t\t\t{ \"SECS\":" << p->secs << ", "
+                            << "\"KM\":" << p->km << ", "
+                            << "\"VALUE\":" << p->number[0] << " }";
                     }
                     firsts = false;
                 }
 
-                out += "\n\t\t\t]\n";
+                out << "\n\t\t\t]\n";
             } else {
-                out += "\n";
+                out << "\n";
             }
 
-            out += "\t\t}";
+            out << "\t\t}";
 
             // now do next
             first = false;
         }
 
-        out += "\n\t\t]";
+        out << "\n\t\t]";
     }
 
     // end of ride and document
-    out += "\n\t}\n}\n";
+    out << "\n\t}\n}\n";
+}
+
+QByteArray
+JsonFileReader::toByteArray(Context *context, const RideFile *ride, bool withAlt, bool withWatts, bool withHr, bool withCad) const
+{
+    QByteArray returning;
+    QBuffer buffer(&returning);
+    buffer.open(QIODevice::WriteOnly);
+
+    toDevice(context, ride, buffer, withAlt, withWatts, withHr, withCad);
 
-    return out;
+    return returning;
+}
+
+// streamed to an open device in chunks, without the BOM
+void
+JsonFileReader::toDevice(Context *, const RideFile *ride, QIODevice &device, bool withAlt, bool withWatts, bool withHr, bool withCad) const
+{
+    JsonWriter out(&device);
+    writeJson(out, ride, withAlt, withWatts, withHr, withCad);
+    out.flush();
 }
 
 // Writes valid .json (validated at www.jsonlint.com)
 bool
-JsonFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &file) const
+JsonFileReader::writeRideFile(Context *, const RideFile *ride, QFile &file) const
 {
     // can we open the file for writing?
     if (!file.open(QIODevice::WriteOnly)) return false;
@@ -779,15 +1071,12 @@ JsonFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &fil
     // truncate existing
     file.resize(0);
 
-    QByteArray xml = toByteArray(context, ride, true, true, true, true);
-
-    // setup streamer
-    QTextStream out(&file);
     // unified codepage and BOM for identification on all platforms
-    out.setCodec("UTF-8");
-    out.setGenerateByteOrderMark(true);
+    file.write("\xEF\xBB\xBF");
 
-    out << xml;
+    // stream it out
+    JsonWriter out(&file);
+    writeJson(out, ride, true, true, true, true);
     out.flush();
 
     // close
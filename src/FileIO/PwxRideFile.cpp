@@ -597,8 +597,8 @@ PwxFileReader::PwxFromDomDoc(QDomDocument doc, QStringList&) const
     return rideFile;
 }
 
-bool
-PwxFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &file) const
+QByteArray
+PwxFileReader::toByteArray(Context *context, const RideFile *ride) const
 {
     QDomText text; // used all over
     QDomDocument doc;
@@ -981,7 +981,14 @@ PwxFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &file
         }
     }
 
-    QByteArray xml = doc.toByteArray(4);
+    return doc.toByteArray(4);
+}
+
+bool
+PwxFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &file) const
+{
+    QByteArray xml = toByteArray(context, ride);
+
     if (!file.open(QIODevice::WriteOnly)) return(false);
     file.resize(0);
     QTextStream out(&file);
@@ -26,6 +26,8 @@
 #include "RideEditor.h"
 #include "RideMetadata.h"
 #include "Settings.h"
+#include "SettingsSnapshot.h"
+#include "RebuildStats.h"
 #include "Colors.h"
 #include "Units.h"
 
@@ -941,12 +943,8 @@ RideFile *RideFileFactory::openRideFile(Context *context, QFile &file,
         XDataSeries *series = result->xdata("HRV");
 
         if (series && series->datapoints.count() > 0) {
-            double rrMax = appsettings->value(NULL, GC_RR_MAX, "2000.0").toDouble();
-            double rrMin = appsettings->value(NULL, GC_RR_MIN, "270.0").toDouble();
-            double rrFilt = appsettings->value(NULL, GC_RR_FILT, "0.2").toDouble();
-            int rrWindow = appsettings->value(NULL, GC_RR_WINDOW, "20").toInt();
-
-            FilterHrv(series, rrMin, rrMax, rrFilt, rrWindow);
+            const SettingsSnapshot *settings = SettingsSnapshot::current(context);
+            FilterHrv(series, settings->rrMin, settings->rrMax, settings->rrFilt, settings->rrWindow);
         }
 
         // calculate derived data series -- after data fixers applied above
@@ -2298,6 +2296,9 @@ RideFile::recalculateDerivedSeries(bool force)
     // be called after data is deleted or added
     if (!force && dstale == false) return; // we're already up to date
 
+    // headless rebuild wants to know how long we take
+    RebuildStats::Timer timer(RebuildStats::Derived);
+
     //
     // IsoPower Initialisation -- working variables
     //
@@ -2357,7 +2358,7 @@ RideFile::recalculateDerivedSeries(bool force)
 
     // wheelsize - use meta, then config then drop to 2100
     double wheelsize = getTag(tr("Wheelsize"), "0.0").toDouble();
-    if (wheelsize == 0) wheelsize = appsettings->cvalue(context->athlete->cyclist, GC_WHEELSIZE, 2100).toInt();
+    if (wheelsize == 0) wheelsize = SettingsSnapshot::current(context)->wheelsize;
     wheelsize /= 1000.00f; // need it in meters
 
     // last point looked at
@@ -28,6 +28,7 @@
 #include "LTMSettings.h" // getAllBestsFor needs this
 
 #include <cmath> // for pow()
+#include <cstring> // for memcpy()
 #include <QDebug>
 #include <QFileInfo>
 #include <QMessageBox>
@@ -115,7 +116,10 @@ RideFileCache::RideFileCache(Context *context, QString fileName, double weight,
                 head.crc == RideFile::computeFileCRC(rideFileName)) {
  
                 // it is the same ?
-                if (head.version == RideFileCacheVersion && head.WEIGHT == weight) {
+                // version 25 has the same data so can still be read, but when
+                // refreshing (check is true) it is rewritten with an index
+                bool version = head.version == RideFileCacheVersion || (!check && head.version == RideFileCacheOldestVersion);
+                if (version && head.WEIGHT == weight) {
 
                     // WE'RE GOOD
                     if (check == false) readCache(); // if check is false we aren't just checking
@@ -197,7 +201,8 @@ RideFileCache::checkStale(Context *context, RideItem*item)
             if (rideFileInfo.lastModified() <= cacheFileInfo.lastModified() ||
                 head.crc == RideFile::computeFileCRC(rideFileName)) {
 
-                // it is the same ?
+                // it is the same ? version 25 is stale so it gets rewritten
+                // with an index, it is still read until then
                 if (head.version == RideFileCacheVersion && head.WEIGHT == item->getWeight()) {
 
                     // WE'RE GOOD
@@ -211,108 +216,170 @@ RideFileCache::checkStale(Context *context, RideItem*item)
     return true;
 }
 
-// returns offset from end of head
-static long offsetForMeanMax(RideFileCacheHeader head, RideFile::SeriesType series)
+// the block holding the mean max array for a series, -1 if none
+static int blockForMeanMax(RideFile::SeriesType series)
 {
-    long offset = 0;
-
     switch (series) {
-    case RideFile::aPowerKg : offset += head.aPowerMeanMaxCount * sizeof(float); // intentional fallthrough
-    case RideFile::aPower : offset += head.vamMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::vam : offset += head.npMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::IsoPower : offset += head.xPowerMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::xPower : offset += head.kphMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::hrd : offset += head.hrdMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::nmd : offset += head.nmdMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::cadd : offset += head.caddMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::wattsd : offset += head.wattsdMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::kphd : offset += head.kphdMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::kph : offset += head.nmMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::nm : offset += head.cadMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::cad : offset += head.hrMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::hr : offset += head.wattsKgMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::wattsKg : offset += head.wattsMeanMaxCount * sizeof(float);  // intentional fallthrough
-    case RideFile::watts : offset += 0;  // intentional fallthrough
+    case RideFile::watts : return RideFileCacheIndex::wattsMeanMax;
+    case RideFile::wattsKg : return RideFileCacheIndex::wattsKgMeanMax;
+    case RideFile::hr : return RideFileCacheIndex::hrMeanMax;
+    case RideFile::cad : return RideFileCacheIndex::cadMeanMax;
+    case RideFile::nm : return RideFileCacheIndex::nmMeanMax;
+    case RideFile::kph : return RideFileCacheIndex::kphMeanMax;
+    case RideFile::kphd : return RideFileCacheIndex::kphdMeanMax;
+    case RideFile::wattsd : return RideFileCacheIndex::wattsdMeanMax;
+    case RideFile::cadd : return RideFileCacheIndex::caddMeanMax;
+    case RideFile::nmd : return RideFileCacheIndex::nmdMeanMax;
+    case RideFile::hrd : return RideFileCacheIndex::hrdMeanMax;
+    case RideFile::xPower : return RideFileCacheIndex::xPowerMeanMax;
+    case RideFile::IsoPower : return RideFileCacheIndex::npMeanMax;
+    case RideFile::vam : return RideFileCacheIndex::vamMeanMax;
+    case RideFile::aPower : return RideFileCacheIndex::aPowerMeanMax;
+    case RideFile::aPowerKg : return RideFileCacheIndex::aPowerKgMeanMax;
+    default:
+        break;
+    }
+
+    return -1;
+}
+
+// how many floats in each block
+static unsigned int countForBlock(const RideFileCacheHeader &head, int block)
+{
+    switch (block) {
+    case RideFileCacheIndex::wattsMeanMax : return head.wattsMeanMaxCount;
+    case RideFileCacheIndex::wattsKgMeanMax : return head.wattsKgMeanMaxCount;
+    case RideFileCacheIndex::hrMeanMax : return head.hrMeanMaxCount;
+    case RideFileCacheIndex::cadMeanMax : return head.cadMeanMaxCount;
+    case RideFileCacheIndex::nmMeanMax : return head.nmMeanMaxCount;
+    case RideFileCacheIndex::kphMeanMax : return head.kphMeanMaxCount;
+    case RideFileCacheIndex::kphdMeanMax : return head.kphdMeanMaxCount;
+    case RideFileCacheIndex::wattsdMeanMax : return head.wattsdMeanMaxCount;
+    case RideFileCacheIndex::caddMeanMax : return head.caddMeanMaxCount;
+    case RideFileCacheIndex::nmdMeanMax : return head.nmdMeanMaxCount;
+    case RideFileCacheIndex::hrdMeanMax : return head.hrdMeanMaxCount;
+    case RideFileCacheIndex::xPowerMeanMax : return head.xPowerMeanMaxCount;
+    case RideFileCacheIndex::npMeanMax : return head.npMeanMaxCount;
+    case RideFileCacheIndex::vamMeanMax : return head.vamMeanMaxCount;
+    case RideFileCacheIndex::aPowerMeanMax : return head.aPowerMeanMaxCount;
+    case RideFileCacheIndex::aPowerKgMeanMax : return head.aPowerKgMeanMaxCount;
+    case RideFileCacheIndex::wattsDist : return head.wattsDistCount;
+    case RideFileCacheIndex::hrDist : return head.hrDistCount;
+    case RideFileCacheIndex::cadDist : return head.cadDistCount;
+    case RideFileCacheIndex::gearDist : return head.gearDistCount;
+    case RideFileCacheIndex::nmDist : return head.nmDistrCount;
+    case RideFileCacheIndex::kphDist : return head.kphDistCount;
+    case RideFileCacheIndex::xPowerDist : return head.xPowerDistCount;
+    case RideFileCacheIndex::npDist : return head.npDistCount;
+    case RideFileCacheIndex::wattsKgDist : return head.wattsKgDistCount;
+    case RideFileCacheIndex::aPowerDist : return head.aPowerDistCount;
+    case RideFileCacheIndex::smo2Dist : return head.smo2DistCount;
+    case RideFileCacheIndex::wbalDist : return head.wbalDistCount;
+    case RideFileCacheIndex::tiz : return 3*(10+4) + 4;
     default:
         break;
     }
 
-    return offset;
+    return 0;
 }
 
-//offset to tiz table
-static long offsetForTiz(RideFileCacheHeader head, RideFile::SeriesType series)
+// tiz is currently just for RideFile:watts, RideFile:hr, RideFile:kph and RideFile:wbal
+// structure for "tiz" data - watts(10)/CPwatts(4)/HR(10)/CPhr(4)/PACE(10)/CPpace(4)/wbal(4)
+static unsigned int offsetForTiz(RideFile::SeriesType series)
 {
-    long offset = 0;
-
-    // skip past the mean max arrays
-    offset += head.aPowerKgMeanMaxCount * sizeof(float);
-    offset += head.aPowerMeanMaxCount * sizeof(float);
-    offset += head.vamMeanMaxCount * sizeof(float);
-    offset += head.npMeanMaxCount * sizeof(float);
-    offset += head.xPowerMeanMaxCount * sizeof(float);
-    offset += head.hrdMeanMaxCount * sizeof(float);
-    offset += head.nmdMeanMaxCount * sizeof(float);
-    offset += head.caddMeanMaxCount * sizeof(float);
-    offset += head.wattsdMeanMaxCount * sizeof(float);
-    offset += head.kphdMeanMaxCount * sizeof(float);
-    offset += head.kphMeanMaxCount * sizeof(float);
-    offset += head.nmMeanMaxCount * sizeof(float);
-    offset += head.cadMeanMaxCount * sizeof(float);
-    offset += head.hrMeanMaxCount * sizeof(float);
-    offset += head.wattsKgMeanMaxCount * sizeof(float);
-    offset += head.wattsMeanMaxCount * sizeof(float);
-
-    // skip past the distribution arrays
-    offset += head.wattsDistCount * sizeof(float);
-    offset += head.hrDistCount * sizeof(float);
-    offset += head.cadDistCount * sizeof(float);
-    offset += head.gearDistCount * sizeof(float);
-    offset += head.nmDistrCount * sizeof(float);
-    offset += head.kphDistCount * sizeof(float);
-    offset += head.xPowerDistCount * sizeof(float);
-    offset += head.npDistCount * sizeof(float);
-    offset += head.wattsKgDistCount * sizeof(float);
-    offset += head.aPowerDistCount * sizeof(float);
-    offset += head.smo2DistCount * sizeof(float);
-    offset += head.wbalDistCount * sizeof(float);
-
-    // tiz ist currently just for RideFile:watts, RideFile:hr, RideFile:kph and RideFile:wbal
-    // watts is first - so move on with offset only for 'hr' and 'kph' and 'wbal'
-    // structure for "tiz" data - watts(10)/CPwatts(4)/HR(10)/CPhr(4)/PACE(10)/CPpace
-    if (series == RideFile::hr) offset += (10+4) * sizeof(float);
-    if (series == RideFile::kph) offset += 2*(10+4) * sizeof(float);
-    if (series == RideFile::wbal) offset += 3*(10+4) * sizeof(float);
-
-    return offset;
+    if (series == RideFile::hr) return (10+4);
+    if (series == RideFile::kph) return 2*(10+4);
+    if (series == RideFile::wbal) return 3*(10+4);
+    return 0;
 }
 
+//
+// Reads blocks from a .cpx file, if the file can be mapped only the pages
+// holding the blocks asked for are read in. Version 25 files have no index
+// so the offsets are worked out from the counts in the header instead.
+//
+class RideFileCacheReader
+{
+    public:
+        RideFileCacheReader(QString filename);
+        ~RideFileCacheReader();
+
+        // opened and a version we can read
+        bool isValid() const { return valid; }
+
+        unsigned int count(int block) const { return countForBlock(head, block); }
+
+        // read n floats from a block starting at from, false if not there
+        bool read(int block, unsigned int from, unsigned int n, float *into);
+
+        RideFileCacheHeader head;
+
+    private:
+        bool readAt(qint64 offset, void *into, qint64 n);
+
+        QFile file;
+        qint64 size;
+        uchar *mapped;
+        RideFileCacheIndex index;
+        bool valid;
+};
 
-// returns offset from end of head
-static long countForMeanMax(RideFileCacheHeader head, RideFile::SeriesType series)
+RideFileCacheReader::RideFileCacheReader(QString filename) : file(filename), size(0), mapped(NULL), valid(false)
 {
-    switch (series) {
-    case RideFile::aPowerKg : return head.aPowerKgMeanMaxCount;
-    case RideFile::aPower : return head.aPowerMeanMaxCount;
-    case RideFile::wattsKg : return head.wattsKgMeanMaxCount;
-    case RideFile::vam : return head.vamMeanMaxCount;
-    case RideFile::IsoPower : return head.npMeanMaxCount;
-    case RideFile::xPower :  return head.xPowerMeanMaxCount;
-    case RideFile::kph :  return head.kphMeanMaxCount;
-    case RideFile::kphd :  return head.kphdMeanMaxCount;
-    case RideFile::wattsd :  return head.wattsdMeanMaxCount;
-    case RideFile::cadd :  return head.caddMeanMaxCount;
-    case RideFile::nmd :  return head.nmdMeanMaxCount;
-    case RideFile::hrd :  return head.hrdMeanMaxCount;
-    case RideFile::nm :  return head.nmMeanMaxCount;
-    case RideFile::cad :  return head.cadMeanMaxCount;
-    case RideFile::hr :  return head.hrMeanMaxCount;
-    case RideFile::watts :  return head.wattsMeanMaxCount;
-    default:
-        break;
+    if (file.open(QIODevice::ReadOnly | QIODevice::Unbuffered) == false) return;
+
+    size = file.size();
+    if (size < (qint64)sizeof(head)) return;
+
+    // some filesystems can't be mapped, we seek and read instead
+    mapped = file.map(0, size);
+
+    if (readAt(0, &head, sizeof(head)) == false) return;
+
+    if (head.version == RideFileCacheVersion) {
+
+        if (readAt(sizeof(head), &index, sizeof(index)) == false) return;
+
+    } else if (head.version == RideFileCacheOldestVersion) {
+
+        // the blocks follow the header one after another
+        qint64 offset = sizeof(head);
+        for (int i=0; i<RideFileCacheIndex::blocks; i++) {
+            index.offset[i] = offset;
+            offset += count(i) * sizeof(float);
+        }
+
+    } else return; // out of date
+
+    valid = true;
+}
+
+RideFileCacheReader::~RideFileCacheReader()
+{
+    if (mapped) file.unmap(mapped);
+    file.close();
+}
+
+bool
+RideFileCacheReader::readAt(qint64 offset, void *into, qint64 n)
+{
+    if (offset < 0 || offset + n > size) return false;
+
+    if (mapped) {
+        memcpy(into, mapped + offset, n);
+        return true;
     }
+    return file.seek(offset) && file.read((char *) into, n) == n;
+}
 
-    return 0;
+bool
+RideFileCacheReader::read(int block, unsigned int from, unsigned int n, float *into)
+{
+    if (block < 0 || block >= RideFileCacheIndex::blocks) return false;
+    if (qint64(from) + n > count(block)) return false;
+    if (n == 0) return true;
+
+    return readAt(qint64(index.offset[block]) + qint64(from) * sizeof(float), into, qint64(n) * sizeof(float));
 }
 
 QVector<float> RideFileCache::meanMaxPowerFor(Context *context, QVector<float> &wpk, QDate from, QDate to, QVector<QDate>*dates, bool wantruns)
@@ -384,46 +451,20 @@ QVector<float> RideFileCache::meanMaxPowerFor(Context *context, QVector<float>&w
     // Get info for ride file and cache file
     QFileInfo rideFileInfo(fileName);
     QString cacheFilename = context->athlete->home->cache().canonicalPath() + "/" + rideFileInfo.baseName() + ".cpx";
-    QFileInfo cacheFileInfo(cacheFilename);
 
-    // is it up-to-date?
-    if (cacheFileInfo.exists() && cacheFileInfo.size() >= (int)sizeof(struct RideFileCacheHeader)) {
+    // check its an up to date format and contains power
+    RideFileCacheReader reader(cacheFilename);
+    if (reader.isValid() && reader.head.wattsMeanMaxCount > 0) {
 
-        // we have a file, it is more recent than the ride file
-        // but is it the latest version?
-        RideFileCacheHeader head;
-        QFile cacheFile(cacheFilename);
-        if (cacheFile.open(QIODevice::ReadOnly) == true) {
-
-            // read the header
-            QDataStream inFile(&cacheFile);
-            inFile.readRawData((char *) &head, sizeof(head));
-
-            // check its an up to date format and contains power
-            if (head.version == RideFileCacheVersion && head.wattsMeanMaxCount > 0) {
-
-                // seek to start of meanmax array in the cache
-                long offset = offsetForMeanMax(head, RideFile::watts) + sizeof(head);
-                cacheFile.seek(qint64(offset));
-
-                // read from cache and put straight into QVector memory
-                // a little naughty but seems to work ok
-                returning.resize(head.wattsMeanMaxCount);
-                inFile.readRawData((char*)returning.constData(), head.wattsMeanMaxCount * sizeof(float));
-
-                offset = offsetForMeanMax(head, RideFile::wattsKg) + sizeof(head);
-                cacheFile.seek(qint64(offset));
-
-                wpk.resize(head.wattsKgMeanMaxCount);
-                inFile.readRawData((char*)wpk.constData(), head.wattsKgMeanMaxCount * sizeof(float));
-                for(int i=0; i<wpk.size(); i++) wpk[i] = wpk[i] / 100.00f;
+        // read from cache straight into QVector memory
+        returning.resize(reader.count(RideFileCacheIndex::wattsMeanMax));
+        reader.read(RideFileCacheIndex::wattsMeanMax, 0, returning.size(), returning.data());
 
-                //qDebug()<<"retrieved:"<<head.wattsMeanMaxCount<<"in:"<<start.elapsed()<<"ms";
-            }
+        wpk.resize(reader.count(RideFileCacheIndex::wattsKgMeanMax));
+        reader.read(RideFileCacheIndex::wattsKgMeanMax, 0, wpk.size(), wpk.data());
+        for(int i=0; i<wpk.size(); i++) wpk[i] = wpk[i] / 100.00f;
 
-            // we're done reading
-            cacheFile.close();
-        }
+        //qDebug()<<"retrieved:"<<returning.size()<<"in:"<<start.elapsed()<<"ms";
     }
 
     // will be empty if no up to date cache
@@ -441,40 +482,14 @@ QVector<float> RideFileCache::meanMaxFor(QString cacheFilename, RideFile::Series
 
     QVector<float> returning;
 
-    // Get info for ride file and cache file
-    QFileInfo cacheFileInfo(cacheFilename);
-
-    // is it up-to-date?
-    if (cacheFileInfo.exists() && cacheFileInfo.size() >= (int)sizeof(struct RideFileCacheHeader)) {
-
-        // we have a file, it is more recent than the ride file
-        // but is it the latest version?
-        RideFileCacheHeader head;
-        QFile cacheFile(cacheFilename);
-        if (cacheFile.open(QIODevice::ReadOnly) == true) {
+    // check its an up to date format and contains the series
+    int block = blockForMeanMax(series);
+    RideFileCacheReader reader(cacheFilename);
+    if (reader.isValid() && block >= 0 && reader.count(block) > 0) {
 
-            // read the header
-            QDataStream inFile(&cacheFile);
-            inFile.readRawData((char *) &head, sizeof(head));
-
-            int count = countForMeanMax(head, series);
-
-            // check its an up to date format and contains power
-            if (head.version == RideFileCacheVersion && count>0) {
-
-                // seek to start of meanmax array in the cache
-                long offset = offsetForMeanMax(head, series) + sizeof(head);
-                cacheFile.seek(qint64(offset));
-
-                // read from cache and put straight into QVector memory
-                // a little naughty but seems to work ok
-                returning.resize(count);
-                inFile.readRawData((char*)returning.constData(), count * sizeof(float));
-            }
-
-            // we're done reading
-            cacheFile.close();
-        }
+        // read from cache straight into QVector memory
+        returning.resize(reader.count(block));
+        if (!reader.read(block, 0, returning.size(), returning.data())) returning.clear();
     }
 
     // will be empty if no up to date cache
@@ -525,7 +540,7 @@ QVector<float> RideFileCache::meanMaxFor(QString cacheDir, RideFile::SeriesType
 
 }
 
-RideFileCache::RideFileCache(RideFile *ride) :
+RideFileCache::RideFileCache(RideFile *ride, bool compute) :
                incomplete(false), context(ride->context), rideFileName(""), ride(ride)
 {
     // resize all the arrays to zero
@@ -572,7 +587,7 @@ RideFileCache::RideFileCache(RideFile *ride) :
     ride->recalculateDerivedSeries(); // accel and others
 
     // calculate all the arrays
-    compute();
+    if (compute) this->compute();
 }
 
 int
@@ -946,16 +961,9 @@ void RideFileCache::RideFileCache::compute()
     MeanMaxComputer thread15(ride, hrdMeanMax, RideFile::hrd); thread15.start();
     MeanMaxComputer thread16(ride, aPowerKgMeanMax, RideFile::aPowerKg); thread16.start();
 
-    // all the different distributions
-    computeDistribution(wattsDistribution, RideFile::watts);
-    computeDistribution(hrDistribution, RideFile::hr);
-    computeDistribution(cadDistribution, RideFile::cad);
-    computeDistribution(gearDistribution, RideFile::gear);
-    computeDistribution(nmDistribution, RideFile::nm);
-    computeDistribution(kphDistribution, RideFile::kph);
-    computeDistribution(wattsKgDistribution, RideFile::wattsKg);
-    computeDistribution(aPowerDistribution, RideFile::aPower);
-    computeDistribution(smo2Distribution, RideFile::smo2);
+    // all the different distributions, wbal comes from the
+    // wprime data not the samples so is done on its own
+    computeDistributions();
     computeDistribution(wbalDistribution, RideFile::wbal);
 
     // wait for them threads
@@ -1690,6 +1698,151 @@ RideFileCache::computeDistribution(QVector<float> &array, RideFile::SeriesType s
     }
 }
 
+// the sample distributions and time in zone as they used to be computed,
+// a pass through the samples for each series. Only used to check and
+// time computeDistributions() against (--benchmark=distributions)
+void
+RideFileCache::computeDistributionsPerSeries()
+{
+    computeDistribution(wattsDistribution, RideFile::watts);
+    computeDistribution(hrDistribution, RideFile::hr);
+    computeDistribution(cadDistribution, RideFile::cad);
+    computeDistribution(gearDistribution, RideFile::gear);
+    computeDistribution(nmDistribution, RideFile::nm);
+    computeDistribution(kphDistribution, RideFile::kph);
+    computeDistribution(wattsKgDistribution, RideFile::wattsKg);
+    computeDistribution(aPowerDistribution, RideFile::aPower);
+    computeDistribution(smo2Distribution, RideFile::smo2);
+}
+
+// all of the sample distributions and time in zone in a single pass
+// through the samples, rather than a pass per series. The same as
+// calling computeDistribution() for each of them.
+void
+RideFileCache::computeDistributions()
+{
+    struct bins {
+        QVector<float> *array;
+        RideFile::SeriesType series;
+        double RideFilePoint::*value;   // the sample member, to avoid value() per point
+        bool perkg;
+    } all[] = {
+        { &wattsDistribution, RideFile::watts, &RideFilePoint::watts, false },
+        { &hrDistribution, RideFile::hr, &RideFilePoint::hr, false },
+        { &cadDistribution, RideFile::cad, &RideFilePoint::cad, false },
+        { &gearDistribution, RideFile::gear, &RideFilePoint::gear, false },
+        { &nmDistribution, RideFile::nm, &RideFilePoint::nm, false },
+        { &kphDistribution, RideFile::kph, &RideFilePoint::kph, false },
+        { &wattsKgDistribution, RideFile::wattsKg, &RideFilePoint::watts, true },
+        { &aPowerDistribution, RideFile::aPower, &RideFilePoint::apower, false },
+        { &smo2Distribution, RideFile::smo2, &RideFilePoint::smo2, false },
+    };
+    const int count = sizeof(all) / sizeof(all[0]);
+
+    // just the series that are present, set up as computeDistribution does
+    double RideFilePoint::*value[count];
+    double scale[count], min[count];
+    bool perkg[count];
+    float *array[count];
+    unsigned int size[count];
+    int n = 0;
+
+    for (int i=0; i<count; i++) {
+
+        RideFile::SeriesType need = all[i].series == RideFile::wattsKg ? RideFile::watts : all[i].series;
+        if (ride->isDataPresent(need) == false) continue;
+
+        int decimals = decimalsFor(all[i].series);
+        scale[n] = pow(10, decimals);
+        min[n] = RideFile::minimumFor(all[i].series) * scale[n];
+        double max = RideFile::maximumFor(all[i].series) * scale[n];
+
+        all[i].array->resize(max-min[n]+1);
+        array[n] = all[i].array->data();
+        size[n] = all[i].array->size();
+        value[n] = all[i].value;
+        perkg[n] = all[i].perkg;
+        n++;
+    }
+    if (n == 0) return;
+
+    // get zones that apply, if any
+    const Zones *zones = context->athlete->zones(ride->isRun());
+    const HrZones *hrZones = context->athlete->hrZones(ride->isRun());
+    const PaceZones *paceZones = context->athlete->paceZones(ride->isSwim());
+
+    int zoneRange = zones ? zones->whichRange(ride->startTime().date()) : -1;
+    int hrZoneRange = hrZones ? hrZones->whichRange(ride->startTime().date()) : -1;
+    int paceZoneRange = paceZones ? paceZones->whichRange(ride->startTime().date()) : -1;
+
+    CP = zoneRange != -1 ? zones->getCP(zoneRange) : 0;
+    WPRIME = zoneRange != -1 ? zones->getWprime(zoneRange) : 0;
+    LTHR = hrZoneRange != -1 ? hrZones->getLT(hrZoneRange) : 0;
+    CV = paceZoneRange != -1 ? paceZones->getCV(paceZoneRange) : 0;
+
+    // which zones we need, only for the series that are present
+    bool wattsZoned = zoneRange != -1 && ride->isDataPresent(RideFile::watts);
+    bool hrZoned = hrZoneRange != -1 && ride->isDataPresent(RideFile::hr);
+    bool paceZoned = paceZoneRange != -1 && ride->isDataPresent(RideFile::kph) && (ride->isRun() || ride->isSwim());
+    double paceI = ride->isRun() ? CV*0.9f : CV*0.975f;
+
+    // looked up once, not for every sample
+    const double weight = ride->getWeight();
+    const double secs = ride->recIntSecs();
+
+    foreach(RideFilePoint *dp, ride->dataPoints()) {
+
+        for (int i=0; i<n; i++) {
+            double v = dp->*value[i];
+            if (perkg[i]) v /= weight;
+
+            float lvalue = v * scale[i];
+            unsigned int offset = int(lvalue - min[i]);
+            if (offset < size[i]) array[i][offset] += secs;
+        }
+
+        // watts time in zone and polarized zones :- I(<0.85*CP), II (<CP and >0.85*CP), III (>CP)
+        if (wattsZoned) {
+            int index = zones->whichZone(zoneRange, dp->watts);
+            if (index >=0) wattsTimeInZone[index] += secs;
+
+            if (CP) {
+                if (dp->watts < 1) wattsCPTimeInZone[0] += secs; // I zero watts
+                else if (dp->watts < (CP*0.85f)) wattsCPTimeInZone[1] += secs; // I
+                else if (dp->watts < CP) wattsCPTimeInZone[2] += secs; // II
+                else wattsCPTimeInZone[3] += secs; // III
+            }
+        }
+
+        // hr time in zone and polarized zones :- I(<0.9*LTHR), II (<LTHR and >0.9*LTHR), III (>LTHR)
+        if (hrZoned) {
+            int index = hrZones->whichZone(hrZoneRange, dp->hr);
+            if (index >= 0) hrTimeInZone[index] += secs;
+
+            if (LTHR) {
+                if (dp->hr < 1) hrCPTimeInZone[0] += secs; // I zero
+                else if (dp->hr < (LTHR*0.9f)) hrCPTimeInZone[1] += secs; // I
+                else if (dp->hr < LTHR) hrCPTimeInZone[2] += secs; // II
+                else hrCPTimeInZone[3] += secs; // III
+            }
+        }
+
+        // pace time in zone, only for running and swimming activities
+        // polarized zones Run:- I(<0.9*CV), Swim:- I(<0.975*CV), II (<CV), III (>CV)
+        if (paceZoned) {
+            int index = paceZones->whichZone(paceZoneRange, dp->kph);
+            if (index >= 0) paceTimeInZone[index] += secs;
+
+            if (CV) {
+                if (dp->kph < 0.1) paceCPTimeInZone[0] += secs; // I zero
+                else if (dp->kph < paceI) paceCPTimeInZone[1] += secs; // I
+                else if (dp->kph < CV) paceCPTimeInZone[2] += secs; // II
+                else paceCPTimeInZone[3] += secs; // III
+            }
+        }
+    }
+}
+
 //
 // AGGREGATE FOR A GIVEN DATE RANGE
 //
@@ -1943,7 +2096,7 @@ RideFileCache::serialize(QDataStream *out)
     head.aPowerKgMeanMaxCount = aPowerKgMeanMax.size();
     head.wattsDistCount = wattsDistribution.size();
     head.xPowerDistCount = xPowerDistribution.size();
-    head.npDistCount = xPowerDistribution.size();
+    head.npDistCount = npDistribution.size();
     head.hrDistCount = hrDistribution.size();
     head.cadDistCount = cadDistribution.size();
     head.gearDistCount = gearDistribution.size();
@@ -1956,38 +2109,29 @@ RideFileCache::serialize(QDataStream *out)
 
     out->writeRawData((const char *) &head, sizeof(head));
 
-    // write meanmax
-    out->writeRawData((const char *) wattsMeanMax.data(), sizeof(float) * wattsMeanMax.size());
-    out->writeRawData((const char *) wattsKgMeanMax.data(), sizeof(float) * wattsKgMeanMax.size());
-    out->writeRawData((const char *) hrMeanMax.data(), sizeof(float) * hrMeanMax.size());
-    out->writeRawData((const char *) cadMeanMax.data(), sizeof(float) * cadMeanMax.size());
-    out->writeRawData((const char *) nmMeanMax.data(), sizeof(float) * nmMeanMax.size());
-    out->writeRawData((const char *) kphMeanMax.data(), sizeof(float) * kphMeanMax.size());
-    out->writeRawData((const char *) kphdMeanMax.data(), sizeof(float) * kphdMeanMax.size());
-    out->writeRawData((const char *) wattsdMeanMax.data(), sizeof(float) * wattsdMeanMax.size());
-    out->writeRawData((const char *) caddMeanMax.data(), sizeof(float) * caddMeanMax.size());
-    out->writeRawData((const char *) nmdMeanMax.data(), sizeof(float) * nmdMeanMax.size());
-    out->writeRawData((const char *) hrdMeanMax.data(), sizeof(float) * hrdMeanMax.size());
-    out->writeRawData((const char *) xPowerMeanMax.data(), sizeof(float) * xPowerMeanMax.size());
-    out->writeRawData((const char *) npMeanMax.data(), sizeof(float) * npMeanMax.size());
-    out->writeRawData((const char *) vamMeanMax.data(), sizeof(float) * vamMeanMax.size());
-    out->writeRawData((const char *) aPowerMeanMax.data(), sizeof(float) * aPowerMeanMax.size());
-    out->writeRawData((const char *) aPowerKgMeanMax.data(), sizeof(float) * aPowerKgMeanMax.size());
-
-
-    // write dist
-    out->writeRawData((const char *) wattsDistribution.data(), sizeof(float) * wattsDistribution.size());
-    out->writeRawData((const char *) hrDistribution.data(), sizeof(float) * hrDistribution.size());
-    out->writeRawData((const char *) cadDistribution.data(), sizeof(float) * cadDistribution.size());
-    out->writeRawData((const char *) gearDistribution.data(), sizeof(float) * gearDistribution.size());
-    out->writeRawData((const char *) nmDistribution.data(), sizeof(float) * nmDistribution.size());
-    out->writeRawData((const char *) kphDistribution.data(), sizeof(float) * kphDistribution.size());
-    out->writeRawData((const char *) xPowerDistribution.data(), sizeof(float) * xPowerDistribution.size());
-    out->writeRawData((const char *) npDistribution.data(), sizeof(float) * npDistribution.size());
-    out->writeRawData((const char *) wattsKgDistribution.data(), sizeof(float) * wattsKgDistribution.size());
-    out->writeRawData((const char *) aPowerDistribution.data(), sizeof(float) * aPowerDistribution.size());
-    out->writeRawData((const char *) smo2Distribution.data(), sizeof(float) * smo2Distribution.size());
-    out->writeRawData((const char *) wbalDistribution.data(), sizeof(float) * wbalDistribution.size());
+    // each block that isn't empty starts on a page boundary
+    RideFileCacheIndex index;
+    qint64 offset = sizeof(head) + sizeof(index);
+    for (int i=0; i<RideFileCacheIndex::blocks; i++) {
+        qint64 bytes = countForBlock(head, i) * sizeof(float);
+        if (bytes && offset % RIDEFILECACHE_PAGE) offset += RIDEFILECACHE_PAGE - (offset % RIDEFILECACHE_PAGE);
+        index.offset[i] = offset;
+        offset += bytes;
+    }
+    out->writeRawData((const char *) &index, sizeof(index));
+
+    // write meanmax and dist
+    static const char padding[RIDEFILECACHE_PAGE] = { 0 };
+    offset = sizeof(head) + sizeof(index);
+    for (int i=0; i<RideFileCacheIndex::tiz; i++) {
+        QVector<float> *array = blockArray(i);
+        if (array->isEmpty()) continue;
+
+        out->writeRawData(padding, index.offset[i] - offset);
+        out->writeRawData((const char *) array->constData(), sizeof(float) * array->size());
+        offset = index.offset[i] + sizeof(float) * array->size();
+    }
+    out->writeRawData(padding, index.offset[RideFileCacheIndex::tiz] - offset);
 
     // time in zone
     out->writeRawData((const char *) wattsTimeInZone.data(), sizeof(float) * wattsTimeInZone.size());
@@ -1999,89 +2143,67 @@ RideFileCache::serialize(QDataStream *out)
     out->writeRawData((const char *) wbalTimeInZone.data(), sizeof(float) * wbalTimeInZone.size());
 }
 
+QVector<float> *
+RideFileCache::blockArray(int block)
+{
+    switch (block) {
+    case RideFileCacheIndex::wattsMeanMax : return &wattsMeanMax;
+    case RideFileCacheIndex::wattsKgMeanMax : return &wattsKgMeanMax;
+    case RideFileCacheIndex::hrMeanMax : return &hrMeanMax;
+    case RideFileCacheIndex::cadMeanMax : return &cadMeanMax;
+    case RideFileCacheIndex::nmMeanMax : return &nmMeanMax;
+    case RideFileCacheIndex::kphMeanMax : return &kphMeanMax;
+    case RideFileCacheIndex::kphdMeanMax : return &kphdMeanMax;
+    case RideFileCacheIndex::wattsdMeanMax : return &wattsdMeanMax;
+    case RideFileCacheIndex::caddMeanMax : return &caddMeanMax;
+    case RideFileCacheIndex::nmdMeanMax : return &nmdMeanMax;
+    case RideFileCacheIndex::hrdMeanMax : return &hrdMeanMax;
+    case RideFileCacheIndex::xPowerMeanMax : return &xPowerMeanMax;
+    case RideFileCacheIndex::npMeanMax : return &npMeanMax;
+    case RideFileCacheIndex::vamMeanMax : return &vamMeanMax;
+    case RideFileCacheIndex::aPowerMeanMax : return &aPowerMeanMax;
+    case RideFileCacheIndex::aPowerKgMeanMax : return &aPowerKgMeanMax;
+    case RideFileCacheIndex::wattsDist : return &wattsDistribution;
+    case RideFileCacheIndex::hrDist : return &hrDistribution;
+    case RideFileCacheIndex::cadDist : return &cadDistribution;
+    case RideFileCacheIndex::gearDist : return &gearDistribution;
+    case RideFileCacheIndex::nmDist : return &nmDistribution;
+    case RideFileCacheIndex::kphDist : return &kphDistribution;
+    case RideFileCacheIndex::xPowerDist : return &xPowerDistribution;
+    case RideFileCacheIndex::npDist : return &npDistribution;
+    case RideFileCacheIndex::wattsKgDist : return &wattsKgDistribution;
+    case RideFileCacheIndex::aPowerDist : return &aPowerDistribution;
+    case RideFileCacheIndex::smo2Dist : return &smo2Distribution;
+    case RideFileCacheIndex::wbalDist : return &wbalDistribution;
+    default:
+        break;
+    }
+
+    return NULL;
+}
+
 void
 RideFileCache::readCache()
 {
-    RideFileCacheHeader head;
-    QFile cacheFile(cacheFileName);
+    RideFileCacheReader reader(cacheFileName);
 
-    if (cacheFile.open(QIODevice::ReadOnly) == true) {
-        QDataStream inFile(&cacheFile);
-
-        inFile.readRawData((char *) &head, sizeof(head));
-
-        // resize all the arrays to fit
-        wattsMeanMax.resize(head.wattsMeanMaxCount);
-        hrMeanMax.resize(head.hrMeanMaxCount);
-        cadMeanMax.resize(head.cadMeanMaxCount);
-        nmMeanMax.resize(head.nmMeanMaxCount);
-        kphMeanMax.resize(head.kphMeanMaxCount);
-        kphdMeanMax.resize(head.kphdMeanMaxCount);
-        wattsdMeanMax.resize(head.wattsdMeanMaxCount);
-        caddMeanMax.resize(head.caddMeanMaxCount);
-        nmdMeanMax.resize(head.nmdMeanMaxCount);
-        hrdMeanMax.resize(head.hrdMeanMaxCount);
-        npMeanMax.resize(head.npMeanMaxCount);
-        vamMeanMax.resize(head.vamMeanMaxCount);
-        xPowerMeanMax.resize(head.xPowerMeanMaxCount);
-        wattsKgMeanMax.resize(head.wattsKgMeanMaxCount);
-        aPowerMeanMax.resize(head.aPowerMeanMaxCount);
-        aPowerKgMeanMax.resize(head.aPowerKgMeanMaxCount);
-
-        wattsDistribution.resize(head.wattsDistCount);
-        hrDistribution.resize(head.hrDistCount);
-        cadDistribution.resize(head.cadDistCount);
-        gearDistribution.resize(head.gearDistCount);
-        nmDistribution.resize(head.nmDistrCount);
-        kphDistribution.resize(head.kphDistCount);
-        xPowerDistribution.resize(head.xPowerDistCount);
-        npDistribution.resize(head.npDistCount);
-        wattsKgDistribution.resize(head.wattsKgDistCount);
-        aPowerDistribution.resize(head.aPowerDistCount);
-        smo2Distribution.resize(head.smo2DistCount);
-        wbalDistribution.resize(head.wbalDistCount);
-
-        // read in the arrays
-        inFile.readRawData((char *) wattsMeanMax.data(), sizeof(float) * wattsMeanMax.size());
-        inFile.readRawData((char *) wattsKgMeanMax.data(), sizeof(float) * wattsKgMeanMax.size());
-        inFile.readRawData((char *) hrMeanMax.data(), sizeof(float) * hrMeanMax.size());
-        inFile.readRawData((char *) cadMeanMax.data(), sizeof(float) * cadMeanMax.size());
-        inFile.readRawData((char *) nmMeanMax.data(), sizeof(float) * nmMeanMax.size());
-        inFile.readRawData((char *) kphMeanMax.data(), sizeof(float) * kphMeanMax.size());
-        inFile.readRawData((char *) kphdMeanMax.data(), sizeof(float) * kphdMeanMax.size());
-        inFile.readRawData((char *) wattsdMeanMax.data(), sizeof(float) * wattsdMeanMax.size());
-        inFile.readRawData((char *) caddMeanMax.data(), sizeof(float) * caddMeanMax.size());
-        inFile.readRawData((char *) nmdMeanMax.data(), sizeof(float) * nmdMeanMax.size());
-        inFile.readRawData((char *) hrdMeanMax.data(), sizeof(float) * hrdMeanMax.size());
-        inFile.readRawData((char *) xPowerMeanMax.data(), sizeof(float) * xPowerMeanMax.size());
-        inFile.readRawData((char *) npMeanMax.data(), sizeof(float) * npMeanMax.size());
-        inFile.readRawData((char *) vamMeanMax.data(), sizeof(float) * vamMeanMax.size());
-        inFile.readRawData((char *) aPowerMeanMax.data(), sizeof(float) * aPowerMeanMax.size());
-        inFile.readRawData((char *) aPowerKgMeanMax.data(), sizeof(float) * aPowerKgMeanMax.size());
-
-
-        // write dist
-        inFile.readRawData((char *) wattsDistribution.data(), sizeof(float) * wattsDistribution.size());
-        inFile.readRawData((char *) hrDistribution.data(), sizeof(float) * hrDistribution.size());
-        inFile.readRawData((char *) cadDistribution.data(), sizeof(float) * cadDistribution.size());
-        inFile.readRawData((char *) gearDistribution.data(), sizeof(float) * gearDistribution.size());
-        inFile.readRawData((char *) nmDistribution.data(), sizeof(float) * nmDistribution.size());
-        inFile.readRawData((char *) kphDistribution.data(), sizeof(float) * kphDistribution.size());
-        inFile.readRawData((char *) xPowerDistribution.data(), sizeof(float) * xPowerDistribution.size());
-        inFile.readRawData((char *) npDistribution.data(), sizeof(float) * npDistribution.size());
-        inFile.readRawData((char *) wattsKgDistribution.data(), sizeof(float) * wattsKgDistribution.size());
-        inFile.readRawData((char *) aPowerDistribution.data(), sizeof(float) * aPowerDistribution.size());
-        inFile.readRawData((char *) smo2Distribution.data(), sizeof(float) * smo2Distribution.size());
-        inFile.readRawData((char *) wbalDistribution.data(), sizeof(float) * wbalDistribution.size());
+    if (reader.isValid()) {
+
+        // resize all the arrays to fit and read them in
+        for (int i=0; i<RideFileCacheIndex::tiz; i++) {
+            QVector<float> *array = blockArray(i);
+            array->resize(reader.count(i));
+            reader.read(i, 0, array->size(), array->data());
+        }
 
         // time in zone
-        inFile.readRawData((char *) wattsTimeInZone.data(), sizeof(float) * 10);
-        inFile.readRawData((char *) wattsCPTimeInZone.data(), sizeof(float) * 4);
-        inFile.readRawData((char *) hrTimeInZone.data(), sizeof(float) * 10);
-        inFile.readRawData((char *) hrCPTimeInZone.data(), sizeof(float) * 4);
-        inFile.readRawData((char *) paceTimeInZone.data(), sizeof(float) * 10);
-        inFile.readRawData((char *) paceCPTimeInZone.data(), sizeof(float) * 4);
-        inFile.readRawData((char *) wbalTimeInZone.data(), sizeof(float) * 4);
+        reader.read(RideFileCacheIndex::tiz, 0, 10, wattsTimeInZone.data());
+        reader.read(RideFileCacheIndex::tiz, 10, 4, wattsCPTimeInZone.data());
+        reader.read(RideFileCacheIndex::tiz, offsetForTiz(RideFile::hr), 10, hrTimeInZone.data());
+        reader.read(RideFileCacheIndex::tiz, offsetForTiz(RideFile::hr) + 10, 4, hrCPTimeInZone.data());
+        reader.read(RideFileCacheIndex::tiz, offsetForTiz(RideFile::kph), 10, paceTimeInZone.data());
+        reader.read(RideFileCacheIndex::tiz, offsetForTiz(RideFile::kph) + 10, 4, paceCPTimeInZone.data());
+        reader.read(RideFileCacheIndex::tiz, offsetForTiz(RideFile::wbal), 4, wbalTimeInZone.data());
 
         // setup the doubles the users use
         doubleArray(wattsMeanMaxDouble, wattsMeanMax, RideFile::watts);
@@ -2113,8 +2235,6 @@ RideFileCache::readCache()
         doubleArrayForDistribution(aPowerDistributionDouble, aPowerDistribution);
         doubleArrayForDistribution(smo2DistributionDouble, smo2Distribution);
         doubleArrayForDistribution(wbalDistributionDouble, wbalDistribution);
-
-        cacheFile.close();
     }
 }
 
@@ -2171,35 +2291,14 @@ RideFileCache::best(Context *context, QString filename, RideFile::SeriesType ser
     // read the header
     QFileInfo rideFileInfo(context->athlete->home->activities().canonicalPath() + "/" + filename);
     QString cacheFileName(context->athlete->home->cache().canonicalPath() + "/" + rideFileInfo.baseName() + ".cpx");
-    QFileInfo cacheFileInfo(cacheFileName);
 
-    // head
-    RideFileCacheHeader head;
-    QFile cacheFile(cacheFileName);
-
-    if (cacheFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered) == true) {
-        QDataStream inFile(&cacheFile);
-        inFile.readRawData((char *) &head, sizeof(head));
-
-        // out of date or not enough samples
-        if (head.version != RideFileCacheVersion || duration > countForMeanMax(head, series)) {
-            cacheFile.close();
-            return 0;
-        }
-
-        // jump to correct offset
-        long offset = offsetForMeanMax(head, series) + (sizeof(float) * (duration));
-        inFile.skipRawData(offset);
+    // out of date or not enough samples
+    float readhere = 0;
+    RideFileCacheReader reader(cacheFileName);
+    if (!reader.isValid() || !reader.read(blockForMeanMax(series), duration, 1, &readhere)) return 0;
 
-        float readhere = 0;
-        inFile.readRawData((char*)&readhere, sizeof(float));
-        cacheFile.close();
-
-        double divisor = pow(10, decimalsFor(series)); // ? 10 : 1;
-        return readhere / divisor; // will convert to double
-    }
-
-    return 0;
+    double divisor = pow(10, decimalsFor(series)); // ? 10 : 1;
+    return readhere / divisor; // will convert to double
 }
 
 int 
@@ -2210,34 +2309,13 @@ RideFileCache::tiz(Context *context, QString filename, RideFile::SeriesType seri
     // read the header
     QFileInfo rideFileInfo(context->athlete->home->activities().canonicalPath() + "/" + filename);
     QString cacheFileName(context->athlete->home->cache().canonicalPath() + "/" + rideFileInfo.baseName() + ".cpx");
-    QFileInfo cacheFileInfo(cacheFileName);
-
-    // head
-    RideFileCacheHeader head;
-    QFile cacheFile(cacheFileName);
-
-    if (cacheFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered) == true) {
-        QDataStream inFile(&cacheFile);
-        inFile.readRawData((char *) &head, sizeof(head));
-
-        // out of date 
-        if (head.version != RideFileCacheVersion) {
-            cacheFile.close();
-            return 0;
-        }
-
-        // jump to correct offset
-        long offset = offsetForTiz(head, series) + (sizeof(float) * (zone-1));
-        inFile.skipRawData(offset);
 
-        float readhere = 0;
-        inFile.readRawData((char*)&readhere, sizeof(float));
-        cacheFile.close();
-
-        return readhere; // will convert to double
-    }
+    // out of date
+    float readhere = 0;
+    RideFileCacheReader reader(cacheFileName);
+    if (!reader.isValid() || !reader.read(RideFileCacheIndex::tiz, offsetForTiz(series) + zone-1, 1, &readhere)) return 0;
 
-    return 0;
+    return readhere; // will convert to double
 }
 
 // get best values (as passed in the list of MetricDetails between the dates specified
@@ -2277,21 +2355,10 @@ RideFileCache::getAllBestsFor(Context *context, QList<MetricDetail> metrics, Spe
         // CPX ?
         QFileInfo rideFileInfo(context->athlete->home->activities().canonicalPath() + "/" + ride->fileName);
         QString cacheFileName(context->athlete->home->cache().canonicalPath() + "/" + rideFileInfo.baseName() + ".cpx");
-        RideFileCacheHeader head;
-        QFile cacheFile(cacheFileName);
+        RideFileCacheReader reader(cacheFileName);
 
-        // open ok ?
-        if (cacheFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered) == false) continue;
-
-        // get header
-        QDataStream inFile(&cacheFile);
-        inFile.readRawData((char *) &head, sizeof(head));
-
-        // out of date - just skip
-        if (head.version != RideFileCacheVersion) {
-            cacheFile.close();
-            continue;
-        }
+        // not there or out of date - just skip
+        if (!reader.isValid()) continue;
 
         RideBest add;
         add.setFileName(ride->fileName);
@@ -2301,21 +2368,12 @@ RideFileCache::getAllBestsFor(Context *context, QList<MetricDetail> metrics, Spe
         foreach (MetricDetail workitem, worklist) {
 
             int seconds = workitem.duration * workitem.duration_units;
-            float value;
-
-            if (seconds > countForMeanMax(head, workitem.series)) value=0.0;
-            else {
-
-                // get the values and place into the summarymetric map
-                long offset = offsetForMeanMax(head, workitem.series) + 
-                              (sizeof(head)) +
-                              (sizeof(float) * ((workitem.duration*workitem.duration_units)));
+            float value = 0.0;
 
-                cacheFile.seek(qint64(offset));
-                inFile.readRawData((char*)&value, sizeof(float));
+            // get the values and place into the summarymetric map
+            if (reader.read(blockForMeanMax(workitem.series), seconds, 1, &value)) {
                 double divisor = pow(10, decimalsFor(workitem.series));
                 value = value / divisor;
-
             }
             add.setForSymbol(workitem.bestSymbol, value);
 
@@ -2323,9 +2381,6 @@ RideFileCache::getAllBestsFor(Context *context, QList<MetricDetail> metrics, Spe
 
         // add to the results
         results << add;
-
-        // close CPX file
-        cacheFile.close();
     }
 
     // all done, return results
@@ -2348,21 +2403,10 @@ RideFileCache::getAllBestsFor(Context *context, RideFile::SeriesType series, int
         // CPX ?
         QFileInfo rideFileInfo(context->athlete->home->activities().canonicalPath() + "/" + ride->fileName);
         QString cacheFileName(context->athlete->home->cache().canonicalPath() + "/" + rideFileInfo.baseName() + ".cpx");
-        RideFileCacheHeader head;
-        QFile cacheFile(cacheFileName);
+        RideFileCacheReader reader(cacheFileName);
 
-        // open ok ?
-        if (cacheFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered) == false) continue;
-
-        // get header
-        QDataStream inFile(&cacheFile);
-        inFile.readRawData((char *) &head, sizeof(head));
-
-        // out of date - just skip
-        if (head.version != RideFileCacheVersion) {
-            cacheFile.close();
-            continue;
-        }
+        // not there or out of date - just skip
+        if (!reader.isValid()) continue;
 
         if (series == RideFile::none) {
 
@@ -2372,23 +2416,15 @@ RideFileCache::getAllBestsFor(Context *context, RideFile::SeriesType series, int
         } else {
 
             float value = 0.0;
-            if (duration <= countForMeanMax(head, series)) {
-
-                // get the values and place into the summarymetric map
-                long offset = offsetForMeanMax(head, series) + sizeof(head) + (sizeof(float) * duration);
 
-                cacheFile.seek(qint64(offset));
-                inFile.readRawData((char*)&value, sizeof(float));
+            // get the values and place into the summarymetric map
+            if (reader.read(blockForMeanMax(series), duration, 1, &value)) {
                 double divisor = pow(10, decimalsFor(series));
                 value = value / divisor;
-
             }
             results << double(value);
 
         }
-
-        // close CPX file
-        cacheFile.close();
     }
 
     // all done, return results
@@ -29,6 +29,7 @@ class RideFile;
 class RideBest;
 class MetricDetail;
 class Specification;
+class HeadlessBenchmark;
 
 #include "GoldenCheetah.h"
 
@@ -41,7 +42,8 @@ typedef double data_t;
 // arrays when plotting CP curves and histograms. It is precoputed
 // to save time and cached in a file .cpx
 //
-static const unsigned int RideFileCacheVersion = 25;
+static const unsigned int RideFileCacheVersion = 26;
+static const unsigned int RideFileCacheOldestVersion = 25; // same data, no index, read but stale
 // revision history:
 // version  date         description
 // 1        29-Apr-11    Initial - header, mean-max & distribution data blocks
@@ -68,13 +70,18 @@ static const unsigned int RideFileCacheVersion = 25;
 // 23       14-Jun-15    Added W'bal TiZ and Distribution
 // 24       15-Jun-15    Fix percentify error on W'bal Distribution
 // 25       19-Dec-16    Added aPower
+// 26       18-Oct-26    Added block index, blocks start on a page boundary
 
 // The cache file (.cpx) has a binary format:
 // 1 x Header data - describing the version and contents of the cache
+// 1 x Index - file offset of each block (from version 26)
 // n x Blocks - meanmax or distribution arrays
-// 1 x Watts TIZ - 10 floats
-// 1 x Heartrate TIZ - 10 floats
-// 1 x W'Bal TIX - 10 floats
+// 1 x TIZ - watts, hr and pace zones and polarized zones then W'bal zones
+//
+// From version 26 each block that isn't empty starts on a page boundary,
+// so a reader that maps the file only touches the pages of the series it
+// wants. Version 25 files have no index, the blocks follow on from each
+// other and are still read.
 
 // The header is written directly to disk, the only
 // field which is endian sensitive is the count field
@@ -122,6 +129,23 @@ struct RideFileCacheHeader {
                 
 };
 
+// Follows the header from version 26, the blocks in the
+// order they are written and the offset of each from the
+// start of the file
+#define RIDEFILECACHE_PAGE 4096
+struct RideFileCacheIndex {
+
+    enum block { wattsMeanMax=0, wattsKgMeanMax, hrMeanMax, cadMeanMax, nmMeanMax,
+                 kphMeanMax, kphdMeanMax, wattsdMeanMax, caddMeanMax, nmdMeanMax,
+                 hrdMeanMax, xPowerMeanMax, npMeanMax, vamMeanMax, aPowerMeanMax,
+                 aPowerKgMeanMax,
+                 wattsDist, hrDist, cadDist, gearDist, nmDist, kphDist, xPowerDist,
+                 npDist, wattsKgDist, aPowerDist, smo2Dist, wbalDist,
+                 tiz, blocks };
+
+    unsigned int offset[blocks];
+};
+
 
 // Each block of data is an array of uint32_t (32-bit "local-endian")
 // integers so the "count" setting within the block definition tells
@@ -143,6 +167,8 @@ struct RideFileCacheHeader {
 // This is the main user entry to the ridefile cached data.
 class RideFileCache
 {
+    friend class ::HeadlessBenchmark; // compares the distribution passes
+
     public:
         enum cachetype { meanmax, distribution, none };
         typedef enum cachetype CacheType;
@@ -184,7 +210,8 @@ class RideFileCache
         RideFileCache(RideFileCache *other) { *this = *other; }
 
         // just from a raw ride file class (usually for intervals)
-        RideFileCache(RideFile*);
+        // the arrays are left empty if compute is false
+        RideFileCache(RideFile*, bool compute = true);
 
         // get a single best or time in zone value from the cache file
         // intended to be very fast (using lseek to jump direct to the value requested
@@ -234,12 +261,15 @@ class RideFileCache
         void refreshCache();              // compute arrays and update cache
         void readCache();                 // just read from saved file and setup arrays
         void serialize(QDataStream *out); // write to file
+        QVector<float> *blockArray(int block); // the array for a RideFileCacheIndex block, NULL for tiz
 
         void compute();             // compute all arrays
 
         // NOW replaced computeMeanMax with MeanMaxComputer class see bottom of file
         //void computeMeanMax(QVector<float>&, RideFile::SeriesType);      // compute mean max arrays
         void computeDistribution(QVector<float>&, RideFile::SeriesType); // compute the distributions
+        void computeDistributions(); // all but wbal in one pass
+        void computeDistributionsPerSeries(); // as it was, a pass per series (--benchmark=distributions)
 
 
     private:
@@ -885,7 +885,8 @@ AddIntervalDialog::findPeaks(Context *context, bool typeTime, const RideFile *ri
         }
     }
 
-    std::sort(bests.begin(), bests.end(), CompareBests());
+    // stable, so equal bests stay in the order they were found
+    std::stable_sort(bests.begin(), bests.end(), CompareBests());
 
     while (!bests.empty() && (_results.size() < maxIntervals)) {
         AddedInterval candidate = bests.takeFirst();
@@ -543,6 +543,9 @@ BackupPage::BackupPage(Context *context) : context(context)
     //backupInput->addStretch();
     backupInput->addWidget(autoBackupUnitLabel);
 
+    autoBackupIncremental = new QCheckBox(tr("Only store files changed since the last backup"), this);
+    autoBackupIncremental->setChecked(appsettings->cvalue(context->athlete->cyclist, GC_AUTOBACKUP_INCREMENTAL, false).toBool());
+
     Qt::Alignment alignment = Qt::AlignLeft|Qt::AlignVCenter;
 
     grid->addWidget(autoBackupFolderLabel, 7,0, alignment);
@@ -550,6 +553,7 @@ BackupPage::BackupPage(Context *context) : context(context)
     grid->addWidget(autoBackupFolderBrowse, 7, 2, alignment);
     grid->addWidget(autoBackupPeriodLabel, 8, 0,alignment);
     grid->addLayout(backupInput, 8, 1, alignment);
+    grid->addWidget(autoBackupIncremental, 9, 1, alignment);
 
     all->addLayout(grid);
     all->addStretch();
@@ -572,6 +576,7 @@ BackupPage::saveClicked()
     // Auto Backup
     appsettings->setCValue(context->athlete->cyclist, GC_AUTOBACKUP_FOLDER, autoBackupFolder->text());
     appsettings->setCValue(context->athlete->cyclist, GC_AUTOBACKUP_PERIOD, autoBackupPeriod->value());
+    appsettings->setCValue(context->athlete->cyclist, GC_AUTOBACKUP_INCREMENTAL, autoBackupIncremental->isChecked());
     return 0;
 }
 
@@ -185,6 +185,7 @@ class BackupPage : public QWidget
         QSpinBox *autoBackupPeriod;
         QLineEdit *autoBackupFolder;
         QPushButton *autoBackupFolderBrowse;
+        QCheckBox *autoBackupIncremental;
 
     private slots:
 
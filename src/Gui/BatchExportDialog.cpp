@@ -24,9 +24,10 @@
 #include "Colors.h"
 #include "RideCache.h"
 #include "HelpWhatsThis.h"
-#include "CsvRideFile.h"
+#include "DataProcessorPipeline.h"
+#include "DataProcessor.h"
 
-BatchExportDialog::BatchExportDialog(Context *context) : QDialog(context->mainWindow), context(context)
+BatchExportDialog::BatchExportDialog(Context *context) : QDialog(context->mainWindow), context(context), pipeline(NULL)
 {
     setAttribute(Qt::WA_DeleteOnClose);
     //setWindowFlags(windowFlags() | Qt::WindowStaysOnTopHint); // must stop using this flag!
@@ -108,12 +109,27 @@ BatchExportDialog::BatchExportDialog(Context *context) : QDialog(context->mainWi
     all = new QCheckBox(tr("check/uncheck all"), this);
     all->setChecked(true);
 
+    // data processors to run on the exported copy, the activities are left as they are
+    processorsLabel = new QLabel(tr("Fix before export"), this);
+    processors = new QListWidget(this);
+    processors->setMaximumHeight(100 *dpiYFactor);
+    QMapIterator<QString, DataProcessor*> i(DataProcessorFactory::instance().getProcessors());
+    while (i.hasNext()) {
+        i.next();
+        QListWidgetItem *add = new QListWidgetItem(i.value()->name(), processors);
+        add->setData(Qt::UserRole, i.key());
+        add->setFlags(add->flags() | Qt::ItemIsUserCheckable);
+        add->setCheckState(Qt::Unchecked);
+    }
+
     grid->addWidget(formatLabel, 0,0, Qt::AlignLeft);
     grid->addWidget(format, 0,1, Qt::AlignLeft);
     grid->addWidget(dirLabel, 1,0, Qt::AlignLeft);
     grid->addWidget(dirName, 1,1, Qt::AlignLeft);
     grid->addWidget(selectDir, 1,2, Qt::AlignLeft);
-    grid->addWidget(all, 2,0, Qt::AlignLeft);
+    grid->addWidget(processorsLabel, 2,0, Qt::AlignLeft|Qt::AlignTop);
+    grid->addWidget(processors, 2,1, 1,2);
+    grid->addWidget(all, 3,0, Qt::AlignLeft);
     grid->setColumnStretch(0, 1);
     grid->setColumnStretch(1, 10);
 
@@ -173,9 +189,9 @@ void
 BatchExportDialog::okClicked()
 {
     if (ok->text() == "Export" || ok->text() == tr("Export")) {
-        aborted = false;
 
         overwrite->hide();
+        processors->setEnabled(false);
         status->setText(tr("Exporting..."));
         status->show();
         cancel->hide();
@@ -183,11 +199,9 @@ BatchExportDialog::okClicked()
         appsettings->setValue(GC_BE_LASTDIR, dirName->text());
         appsettings->setValue(GC_BE_LASTFMT, format->currentIndex());
         exportFiles();
-        status->setText(QString(tr("%1 activities exported, %2 failed or skipped.")).arg(exports).arg(fails));
-        ok->setText(tr("Finish"));
 
     } else if (ok->text() == "Abort" || ok->text() == tr("Abort")) {
-        aborted = true;
+        if (pipeline) pipeline->cancel();
     } else if (ok->text() == "Finish" || ok->text() == tr("Finish")) {
         accept(); // our work is done!
     }
@@ -205,79 +219,58 @@ BatchExportDialog::exportFiles()
     // what format to export as?
     QString type = format->currentIndex() > 0 ? RideFileFactory::instance().writeSuffixes().at(format->currentIndex()-1) : "csv";
 
-    // loop through the table and export all selected
+    // all those selected
+    QList<RideItem*> items;
+    exporting.clear();
     for(int i=0; i<files->invisibleRootItem()->childCount(); i++) {
 
-        // give user a chance to abort..
-        QApplication::processEvents();
-
-        // did they?
-        if (aborted == true) return; // user aborted!
-
         QTreeWidgetItem *current = files->invisibleRootItem()->child(i);
+        if (!static_cast<QCheckBox*>(files->itemWidget(current,0))->isChecked()) continue;
 
-        // is it selected
-        if (static_cast<QCheckBox*>(files->itemWidget(current,0))->isChecked()) {
-
-            files->setCurrentItem(current); QApplication::processEvents();
-
-            QString filename = dirName->text() + "/" + QFileInfo(current->text(1)).baseName() + "." + type;
-
-            if (QFile(filename).exists()) {
-                if (overwrite->isChecked() == false) {
-                    // skip existing files
-                    current->setText(4, tr("Exists - not exported")); QApplication::processEvents();
-                    fails++;
-                    continue;
-
-                } else {
-
-                    // remove existing
-                    QFile(filename).remove();
-                    current->setText(4, tr("Removing...")); QApplication::processEvents();
-                }
-
-            }
-            // this one then
-            current->setText(4, tr("Reading...")); QApplication::processEvents();
-
-            // open it..
-            QStringList errors;
-            QList<RideFile*> rides;
-            QFile thisfile(QString(context->athlete->home->activities().absolutePath()+"/"+current->text(1)));
-            RideFile *ride = RideFileFactory::instance().openRideFile(context, thisfile, errors, &rides);
+        RideItem *item = context->athlete->rideCache->getRide(current->text(1));
+        if (item == NULL) continue;
 
-            // open success?
-            if (ride) {
+        current->setText(4, tr("Waiting..."));
+        exporting << current;
+        items << item;
+    }
 
+    // any fixes are applied to the copy exported, not saved
+    QStringList names;
+    for(int i=0; i<processors->count(); i++)
+        if (processors->item(i)->checkState() == Qt::Checked) names << processors->item(i)->data(Qt::UserRole).toString();
 
-                current->setText(4, tr("Writing...")); QApplication::processEvents();
-                QFile out(filename);
+    pipeline = new DataProcessorPipeline(context, this);
+    pipeline->setSave(false);
+    pipeline->setProcessors(names);
+    pipeline->setExport(dirName->text(), type, overwrite->isChecked());
 
-                bool success = false;
-                if (format->currentIndex() > 0)
-                    success = RideFileFactory::instance().writeRideFile(context, ride, out, type);
-                else {
-                    CsvFileReader writer;
-                    success = writer.writeRideFile(context, ride, out, CsvFileReader::gc);
-                }
+    connect(pipeline, SIGNAL(itemStarted(int)), this, SLOT(itemStarted(int)));
+    connect(pipeline, SIGNAL(itemDone(int)), this, SLOT(itemDone(int)));
+    connect(pipeline, SIGNAL(finished()), this, SLOT(exportFinished()));
 
-                if (success) {
-                    exports++;
-                    current->setText(4, tr("Exported")); QApplication::processEvents();
-                } else {
-                    fails++;
-                    current->setText(4, tr("Write failed")); QApplication::processEvents();
-                }
+    pipeline->start(items);
+}
 
-                delete ride; // free memory!
+void
+BatchExportDialog::itemStarted(int index)
+{
+    files->setCurrentItem(exporting[index]);
+    exporting[index]->setText(4, tr("Writing..."));
+}
 
-            // open failed
-            } else {
+void
+BatchExportDialog::itemDone(int index)
+{
+    if (pipeline->result(index) == DataProcessorPipeline::Done) exports++;
+    else fails++;
 
-                current->setText(4, tr("Read error")); QApplication::processEvents();
+    exporting[index]->setText(4, pipeline->status(index));
+}
 
-            }
-        }
-    }
+void
+BatchExportDialog::exportFinished()
+{
+    status->setText(QString(tr("%1 activities exported, %2 failed or skipped.")).arg(exports).arg(fails));
+    ok->setText(tr("Finish"));
 }
@@ -33,10 +33,13 @@
 #include <QList>
 #include <QFileDialog>
 #include <QCheckBox>
+#include <QListWidget>
 #include <QLabel>
 #include <QListIterator>
 #include <QDebug>
 
+class DataProcessorPipeline;
+
 // Dialog class to show filenames, import progress and to capture user input
 // of ride date and time
 
@@ -60,12 +63,24 @@ private slots:
     void exportFiles();
     void allClicked();
 
+    // from the pipeline
+    void itemStarted(int index);
+    void itemDone(int index);
+    void exportFinished();
+
 private:
     Context *context;
-    bool aborted;
+
+    // does the work off the GUI thread
+    DataProcessorPipeline *pipeline;
+    QList<QTreeWidgetItem*> exporting;
 
     QCheckBox *all;
 
+    // fixes applied to what is exported, not the activities
+    QLabel *processorsLabel;
+    QListWidget *processors;
+
     QComboBox *format;
     QLabel *formatLabel;
 
@@ -21,6 +21,7 @@
 #include "TabView.h"
 #include "Athlete.h"
 #include "RideCache.h"
+#include "OverviewData.h"
 
 #include <cmath>
 #include <QGraphicsSceneMouseEvent>
@@ -36,7 +37,7 @@ static QIcon grayConfig, whiteConfig, accentConfig;
 ChartSpaceItemRegistry *ChartSpaceItemRegistry::_instance;
 
 ChartSpace::ChartSpace(Context *context, int scope) :
-    state(NONE), context(context), scope(scope), group(NULL), fixedZoom(0), _viewY(0),
+    state(NONE), context(context), scope(scope), group(NULL), fixedZoom(0), _viewY(0), dataservice(NULL),
     yresizecursor(false), xresizecursor(false), block(false), scrolling(false),
     setscrollbar(false), lasty(-1)
 {
@@ -116,7 +117,10 @@ ChartSpace::addItem(int order, int column, int deep, ChartSpaceItem *item)
     item->deep = deep;
     items.append(item);
     if (scope&OverviewScope::ANALYSIS && currentRideItem) item->setData(currentRideItem);
-    if (scope&OverviewScope::TRENDS) item->setDateRange(currentDateRange);
+    if (scope&OverviewScope::TRENDS) {
+        if (dataservice) dataservice->dateRangeChanged(currentDateRange, QList<ChartSpaceItem*>() << item);
+        else item->setDateRange(currentDateRange);
+    }
 }
 
 void
@@ -163,6 +167,7 @@ void
 ChartSpace::refresh()
 {
     stale = true;
+    if (dataservice) dataservice->invalidate();
     if (scope == TRENDS) dateRangeChanged(currentDateRange);
     else if (scope == ANALYSIS) rideSelected(currentRideItem);
 }
@@ -171,6 +176,7 @@ void
 ChartSpace::filterChanged()
 {
     // redo trends
+    if (dataservice) dataservice->invalidate();
     dateRangeChanged(currentDateRange);
 }
 
@@ -186,8 +192,10 @@ ChartSpace::dateRangeChanged(DateRange dr)
         return;
     }
 
-    // ride item changed
-    foreach(ChartSpaceItem *ChartSpaceItem, items) ChartSpaceItem->setDateRange(dr);
+    // date range changed, tiles that can share a scan have it done off
+    // the GUI thread and update the view themselves when it completes
+    if (dataservice) dataservice->dateRangeChanged(dr, items);
+    else foreach(ChartSpaceItem *ChartSpaceItem, items) ChartSpaceItem->setDateRange(dr);
 
     // update
     updateView();
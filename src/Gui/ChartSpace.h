@@ -27,6 +27,7 @@
 #include "Context.h"
 #include "Athlete.h"
 #include "RideItem.h"
+#include "Specification.h"
 
 // QGraphics
 #include <QGraphicsScene>
@@ -48,10 +49,25 @@ extern double gl_major;
 
 class ChartSpace;
 class ChartSpaceItemFactory;
+class OverviewDataService;
 
 // we need a scope for a chart space, one or more of
 enum OverviewScope { ANALYSIS=0x01, TRENDS=0x02, ATHLETES=0x04 };
 
+// trends items that aggregate over the activities in a date range can
+// leave the scan to the OverviewDataService; they return one of these
+// with the spec set and add() is called for every ride that passes it.
+// add() is called off the GUI thread, with rides in date order, so it
+// must only read from the ride item and keep what it needs itself
+class ChartSpaceAccumulator
+{
+    public:
+        virtual ~ChartSpaceAccumulator() {}
+        virtual void add(RideItem *item)=0;
+
+        Specification spec;
+};
+
 // must be subclassed to add items to a ChartSpace
 class ChartSpaceItem : public QGraphicsWidget
 {
@@ -66,6 +82,13 @@ class ChartSpaceItem : public QGraphicsWidget
         virtual void setDateRange(DateRange )=0;
         virtual QRectF hotspot() { return QRectF(0,0,0,0); } // don't steal events from this area of the item
 
+        // optionally reimplement to share a scan with other items, the
+        // accumulator is created and results applied on the GUI thread,
+        // the key is the item config (the accumulated results are cached)
+        virtual ChartSpaceAccumulator *accumulator(DateRange) { return NULL; }
+        virtual void setAccumulated(ChartSpaceAccumulator *) {}
+        virtual QString dataKey() const { return QString(); }
+
         virtual QWidget *config()=0; // must supply a widget to configure
 
         // turn off/on the config corner button
@@ -170,6 +193,10 @@ class ChartSpace : public QWidget
         RideItem *currentRideItem;
         DateRange currentDateRange;
 
+        // shared scan for trends items, owned by us, NULL if not set
+        void setDataService(OverviewDataService *x) { dataservice = x; }
+        OverviewDataService *dataService() { return dataservice; }
+
         // to get paint device
         QGraphicsView *device() { return view; }
         const QList<ChartSpaceItem*> allItems() { return items; }
@@ -249,6 +276,7 @@ class ChartSpace : public QWidget
         // content
         QVector<int> columns;                // column widths
         QList<ChartSpaceItem*> items;         // tiles
+        OverviewDataService *dataservice;    // scans for trends tiles
 
         // state data
         bool yresizecursor;          // is the cursor set to resize?
@@ -19,6 +19,7 @@
 
 // QT
 #include <QApplication>
+#include <QProgressDialog>
 #include <QtGui>
 #include <QRegExp>
 #include <QDesktopWidget>
@@ -38,6 +39,7 @@
 
 #include "Colors.h"
 #include "RideCache.h"
+#include "GcbRideFile.h"
 #include "RideItem.h"
 #include "IntervalItem.h"
 #include "RideFile.h"
@@ -463,6 +465,7 @@ MainWindow::MainWindow(const QDir &home)
     connect(backupAthleteMenu, SIGNAL(aboutToShow()), this, SLOT(setBackupAthleteMenu()));
     backupMapper = new QSignalMapper(this); // maps each option
     connect(backupMapper, SIGNAL(mapped(const QString &)), this, SLOT(backupAthlete(const QString &)));
+    fileMenu->addAction(tr("Restore Backup..."), this, SLOT(restoreAthlete()));
 
     fileMenu->addSeparator();
     fileMenu->addAction(tr("Save all modified activities"), this, SLOT(saveAllUnsavedRides()));
@@ -539,6 +542,7 @@ MainWindow::MainWindow(const QDir &home)
 
     optionsMenu->addAction(tr("Create Heat Map..."), this, SLOT(generateHeatMap()), tr(""));
     optionsMenu->addAction(tr("Export Metrics as CSV..."), this, SLOT(exportMetrics()), tr(""));
+    optionsMenu->addAction(tr("Convert Activities to Binary Format..."), this, SLOT(convertActivities()), tr(""));
 
 #ifdef GC_HAS_CLOUD_DB
     // CloudDB options
@@ -1940,6 +1944,12 @@ MainWindow::backupAthlete(QString name)
     delete backup;
 }
 
+void
+MainWindow::restoreAthlete()
+{
+    AthleteBackup::restoreImmediate();
+}
+
 void
 MainWindow::saveGCState(Context *context)
 {
@@ -2008,7 +2018,7 @@ MainWindow::exportMetrics()
     // if the refresh process is running, try again when its completed
     if (currentTab->context->athlete->rideCache->isRunning()) {
         QMessageBox::warning(this, tr("Refresh in Progress"),
-        "A metric refresh is currently running, please try again once that has completed.");
+        tr("A metric refresh is currently running, please try again once that has completed."));
         return;
     }
 
@@ -2020,6 +2030,53 @@ MainWindow::exportMetrics()
     currentTab->context->athlete->rideCache->writeAsCSV(fileName);
 }
 
+void
+MainWindow::convertActivities()
+{
+    // if the refresh process is running, try again when its completed
+    if (currentTab->context->athlete->rideCache->isRunning()) {
+        QMessageBox::warning(this, tr("Refresh in Progress"),
+        tr("A metric refresh is currently running, please try again once that has completed."));
+        return;
+    }
+
+    // only saved .json activities are converted
+    QList<RideItem*> list;
+    foreach(RideItem *item, currentTab->context->athlete->rideCache->rides())
+        if (!item->isDirty() && item->fileName.endsWith(".json", Qt::CaseInsensitive)) list << item;
+
+    if (list.isEmpty()) {
+        QMessageBox::information(this, tr("Convert Activities"), tr("There are no activities to convert."));
+        return;
+    }
+
+    if (QMessageBox::question(this, tr("Convert Activities"),
+                              tr("Convert %1 activities to the compact binary format?\n\n"
+                                 "Each activity is checked after conversion and the .json file is then removed. "
+                                 "You may want to backup the athlete first.").arg(list.count()),
+                              QMessageBox::Ok | QMessageBox::Cancel) != QMessageBox::Ok) return;
+
+    QProgressDialog progress(tr("Converting activities..."), tr("Abort"), 0, list.count(), this);
+    progress.setWindowModality(Qt::WindowModal);
+
+    QStringList errors;
+    int converted = 0;
+    for (int i=0; i<list.count() && !progress.wasCanceled(); i++) {
+        progress.setValue(i);
+        QApplication::processEvents();
+        if (GcbFileReader::convert(currentTab->context, list[i], errors)) converted++;
+    }
+    progress.setValue(list.count());
+
+    // the cache refers to the files by name
+    currentTab->context->athlete->rideCache->save();
+
+    if (errors.count()) {
+        QMessageBox::warning(this, tr("Convert Activities"),
+                             tr("%1 activities converted, %2 failed.\n\n").arg(converted).arg(errors.count()) + errors.join("\n"));
+    }
+}
+
 /*----------------------------------------------------------------------
  * Import Workout from Disk
  *--------------------------------------------------------------------*/
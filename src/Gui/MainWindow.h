@@ -163,6 +163,7 @@ class MainWindow : public QMainWindow
         // Athlete Backup
         void setBackupAthleteMenu();
         void backupAthlete(QString name);
+        void restoreAthlete();
 
         // Search / Filter
         void setFilter(QStringList);
@@ -232,6 +233,7 @@ class MainWindow : public QMainWindow
         void exportBatch();
         void generateHeatMap();
         void exportMetrics();
+        void convertActivities();
         void addAccount();
         void manualProcess(QString);
         void importFile();
@@ -1388,6 +1388,13 @@ RideNavigatorSortProxyModel::RideNavigatorSortProxyModel(QObject *parent) : QSor
 bool RideNavigatorSortProxyModel::lessThan(const QModelIndex &left,
                                            const QModelIndex &right) const
 {
+    // metric columns sort on their raw value
+    QVariant leftValue = sourceModel()->data(left, RideCacheModel::SortRole);
+    QVariant rightValue = sourceModel()->data(right, RideCacheModel::SortRole);
+    if (leftValue.type() == QVariant::Double && rightValue.type() == QVariant::Double) {
+        return leftValue.toDouble() < rightValue.toDouble();
+    }
+
     QVariant leftData = sourceModel()->data(left);
     QVariant rightData = sourceModel()->data(right);
 
@@ -22,6 +22,7 @@
 #include "Estimator.h"
 #include "GcRideFile.h"
 #include "JsonRideFile.h"
+#include "GcbRideFile.h"
 #include "RideItem.h"
 #include "RideFile.h"
 #include "RideFileCommand.h"
@@ -126,8 +127,10 @@ MainWindow::saveSilent(Context *context, RideItem *rideItem)
     bool    convert;
 
     // Do we need to convert the file type?
-    if (currentType != "JSON") convert = true;
+    // both .json and the compact binary .gcb are native
+    if (currentType != "JSON" && currentType != "GCB") convert = true;
     else convert = false;
+    QString suffix = currentType == "GCB" ? ".gcb" : ".json";
 
     // Has the date/time changed?
     QDateTime ridedatetime = rideItem->ride()->startTime();
@@ -158,7 +161,7 @@ MainWindow::saveSilent(Context *context, RideItem *rideItem)
         convert = false; // we just did it already!
 
         // set the new filename & Start time everywhere
-        currentFile.setFileName(rideItem->path + QDir::separator() + targetnosuffix + ".json");
+        currentFile.setFileName(rideItem->path + QDir::separator() + targetnosuffix + suffix);
         rideItem->setFileName(QFileInfo(currentFile).canonicalPath(), QFileInfo(currentFile).fileName());
     }
 
@@ -181,8 +184,13 @@ MainWindow::saveSilent(Context *context, RideItem *rideItem)
     rideItem->ride()->setTag("Change History", log);
 
     // save in GC format
-    JsonFileReader reader;
-    reader.writeRideFile(context, rideItem->ride(), savedFile);
+    if (suffix == ".gcb") {
+        GcbFileReader reader;
+        reader.writeRideFile(context, rideItem->ride(), savedFile);
+    } else {
+        JsonFileReader reader;
+        reader.writeRideFile(context, rideItem->ride(), savedFile);
+    }
 
     // rename the file and update the rideItem list to reflect the change
     if (convert) {
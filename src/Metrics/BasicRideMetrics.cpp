@@ -20,6 +20,7 @@
 #include "Athlete.h"
 #include "Context.h"
 #include "Settings.h"
+#include "SettingsSnapshot.h"
 #include "RideItem.h"
 #include "IntervalItem.h"
 #include "LTMOutliers.h"
@@ -54,6 +55,7 @@ class RideDate : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new RideDate(*this); }
 };
 
@@ -83,6 +85,7 @@ class RideCount : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new RideCount(*this); }
 };
 
@@ -119,6 +122,7 @@ class ToExhaustion : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new ToExhaustion(*this); }
 };
 
@@ -152,6 +156,7 @@ class ElapsedTime : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new ElapsedTime(*this); }
 };
 
@@ -202,6 +207,7 @@ class WorkoutTime : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new WorkoutTime(*this); }
 };
 
@@ -250,6 +256,7 @@ class TimeRecording : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new TimeRecording(*this); }
 };
 
@@ -306,6 +313,7 @@ class TimeRiding : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new TimeRiding(*this); }
 };
 
@@ -350,7 +358,7 @@ class TimeCarrying : public RideMetric {
         if (item->ride()->areDataPresent()->kph) {
 
             // hysteresis can be configured, we default to 3.0
-            double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+            double hysteresis = SettingsSnapshot::current(item->context)->hysteresis;
             if (hysteresis <= 0.1) hysteresis = 3.00;
 
             RideFileIterator it(item->ride(), spec);
@@ -387,6 +395,7 @@ class TimeCarrying : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new TimeCarrying(*this); }
 };
 
@@ -427,7 +436,7 @@ class ElevationGainCarrying : public RideMetric {
         }
 
         // hysteresis can be configured, we default to 3.0
-        double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+        double hysteresis = SettingsSnapshot::current(item->context)->hysteresis;
         if (hysteresis <= 0.1) hysteresis = 3.00;
 
         bool first = true;
@@ -461,6 +470,7 @@ class ElevationGainCarrying : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new ElevationGainCarrying(*this); }
 };
 
@@ -526,6 +536,7 @@ class TotalDistance : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new TotalDistance(*this); }
 };
 
@@ -578,6 +589,7 @@ class ClimbRating : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new ClimbRating(*this); }
 };
 
@@ -617,7 +629,7 @@ class AthleteWeight : public RideMetric {
         if (!weight) weight = item->getText("Weight", "0.0").toDouble();
 
         // global options
-        if (!weight) weight = appsettings->cvalue(item->context->athlete->cyclist, GC_WEIGHT, "75.0").toString().toDouble(); // default to 75kg
+        if (!weight) weight = SettingsSnapshot::current(item->context)->weight; // default to 75kg
 
         // No weight default is weird, we'll set to 80kg
         if (weight <= 0.00) weight = 80.00;
@@ -627,6 +639,7 @@ class AthleteWeight : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new AthleteWeight(*this); }
 };
 
@@ -664,6 +677,7 @@ class AthleteFat : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new AthleteFat(*this); }
 };
 
@@ -700,6 +714,7 @@ class AthleteBones : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new AthleteBones(*this); }
 };
 
@@ -736,6 +751,7 @@ class AthleteMuscles : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new AthleteMuscles(*this); }
 };
 
@@ -772,6 +788,7 @@ class AthleteLean : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new AthleteLean(*this); }
 };
 
@@ -807,6 +824,7 @@ class AthleteFatP : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new AthleteFatP(*this); }
 };
 
@@ -847,7 +865,7 @@ class ElevationGain : public RideMetric {
         }
 
         // hysteresis can be configured, we default to 3.0
-        double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+        double hysteresis = SettingsSnapshot::current(item->context)->hysteresis;
         if (hysteresis <= 0.1) hysteresis = 3.00;
 
         bool first = true;
@@ -874,6 +892,7 @@ class ElevationGain : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new ElevationGain(*this); }
 };
 
@@ -915,7 +934,7 @@ class ElevationLoss : public RideMetric {
         }
 
         // hysteresis can be configured, we default to 3.0
-        double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+        double hysteresis = SettingsSnapshot::current(item->context)->hysteresis;
         if (hysteresis <= 0.1) hysteresis = 3.00;
 
         bool first = true;
@@ -941,6 +960,7 @@ class ElevationLoss : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new ElevationLoss(*this); }
 };
 
@@ -993,6 +1013,7 @@ class TotalWork : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new TotalWork(*this); }
 };
 
@@ -1053,6 +1074,7 @@ class AvgSpeed : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgSpeed(*this); }
 };
 
@@ -1110,6 +1132,7 @@ struct AvgPower : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgPower(*this); }
 };
 
@@ -1167,6 +1190,7 @@ struct AvgSmO2 : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgSmO2(*this); }
 };
 
@@ -1222,6 +1246,7 @@ struct AvgtHb : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgtHb(*this); }
 };
 
@@ -1276,6 +1301,7 @@ struct AAvgPower : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AAvgPower(*this); }
 };
 
@@ -1331,6 +1357,7 @@ struct NonZeroPower : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new NonZeroPower(*this); }
 };
 
@@ -1386,6 +1413,7 @@ struct AvgHeartRate : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgHeartRate(*this); }
 };
 
@@ -1442,6 +1470,7 @@ struct AvgCoreTemp : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgCoreTemp(*this); }
 };
 
@@ -1493,6 +1522,7 @@ struct HeartBeats : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new HeartBeats(*this); }
 };
 
@@ -1534,6 +1564,7 @@ class HrPw : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new HrPw(*this); }
 };
 
@@ -1581,6 +1612,7 @@ class Workbeat : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new Workbeat(*this); }
 };
 
@@ -1630,6 +1662,7 @@ class WattsRPE : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new WattsRPE(*this); }
 };
 
@@ -1681,6 +1714,7 @@ class APPercent : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new APPercent(*this); }
 };
 
@@ -1731,6 +1765,7 @@ class HrNp : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new HrNp(*this); }
 };
 
@@ -1795,6 +1830,7 @@ struct AvgCadence : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgCadence(*this); }
 };
 
@@ -1863,6 +1899,7 @@ struct AvgTemp : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgTemp(*this); }
 };
 
@@ -1909,6 +1946,7 @@ class MaxPower : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxPower(*this); }
 };
 
@@ -1957,6 +1995,7 @@ class MaxSmO2 : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxSmO2(*this); }
 };
 
@@ -2005,6 +2044,7 @@ class MaxtHb : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxtHb(*this); }
 };
 
@@ -2056,6 +2096,7 @@ class MinSmO2 : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MinSmO2(*this); }
 };
 
@@ -2104,6 +2145,7 @@ class MintHb : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MintHb(*this); }
 };
 
@@ -2152,6 +2194,7 @@ class MaxHr : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxHr(*this); }
 };
 
@@ -2206,6 +2249,7 @@ class MinHr : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MinHr(*this); }
 };
 
@@ -2256,6 +2300,7 @@ class MaxCT : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxCT(*this); }
 };
 
@@ -2309,6 +2354,7 @@ class MaxSpeed : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxSpeed(*this); }
 };
 
@@ -2359,6 +2405,7 @@ class MaxCadence : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxCadence(*this); }
 };
 
@@ -2415,6 +2462,7 @@ class MaxTemp : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxTemp(*this); }
 };
 
@@ -2471,6 +2519,7 @@ class MinTemp : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MinTemp(*this); }
 };
 
@@ -2522,6 +2571,7 @@ class NinetyFivePercentHeartRate : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("H"); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new NinetyFivePercentHeartRate(*this); }
 };
 
@@ -2557,6 +2607,7 @@ class VAM : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new VAM(*this); }
 };
 
@@ -2602,6 +2653,7 @@ class EOA : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new EOA(*this); }
 };
 
@@ -2650,6 +2702,7 @@ class Gradient : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new Gradient(*this); }
 };
 
@@ -2725,6 +2778,7 @@ class MeanPowerVariance : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MeanPowerVariance(*this); }
 };
 
@@ -2783,6 +2837,7 @@ class MaxPowerVariance : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new MaxPowerVariance(*this); }
 };
 
@@ -2848,6 +2903,7 @@ class AvgLTE : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLTE(*this); }
 };
 
@@ -2902,6 +2958,7 @@ class AvgRTE : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRTE(*this); }
 };
 
@@ -2956,6 +3013,7 @@ class AvgLPS : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPS(*this); }
 };
 
@@ -3009,6 +3067,7 @@ class AvgRPS : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPS(*this); }
 };
 
@@ -3064,6 +3123,7 @@ class AvgLPCO : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPCO(*this); }
 };
 
@@ -3118,6 +3178,7 @@ class AvgRPCO : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPCO(*this); }
 };
 
@@ -3170,6 +3231,7 @@ class AvgLPPB : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPPB(*this); }
 };
 
@@ -3223,6 +3285,7 @@ class AvgRPPB : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPPB(*this); }
 };
 
@@ -3276,6 +3339,7 @@ class AvgLPPE : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPPE(*this); }
 };
 
@@ -3329,6 +3393,7 @@ class AvgRPPE : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPPE(*this); }
 };
 
@@ -3382,6 +3447,7 @@ class AvgLPPPB : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPPPB(*this); }
 };
 
@@ -3435,6 +3501,7 @@ class AvgRPPPB : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPPPB(*this); }
 };
 
@@ -3488,6 +3555,7 @@ class AvgLPPPE : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPPPE(*this); }
 };
 
@@ -3541,6 +3609,7 @@ class AvgRPPPE : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPPPE(*this); }
 };
 
@@ -3586,6 +3655,7 @@ class AvgLPP : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPP(*this); }
 };
 
@@ -3631,6 +3701,7 @@ class AvgRPP : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPP(*this); }
 };
 
@@ -3676,6 +3747,7 @@ class AvgLPPP : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgLPPP(*this); }
 };
 
@@ -3721,6 +3793,7 @@ class AvgRPPP : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new AvgRPPP(*this); }
 };
 
@@ -3788,8 +3861,9 @@ struct TotalCalories : public RideMetric {
         athlete_weight = deps.value("athlete_weight")->value(true);
         duration = deps.value("time_riding")->value(true); // time_riding or workout_time ?
 
-        athlete_age = item->dateTime.date().year() - appsettings->cvalue(item->context->athlete->cyclist, GC_DOB).toDate().year();
-        bool male = appsettings->cvalue(item->context->athlete->cyclist, GC_SEX).toInt() == 0;
+        const SettingsSnapshot *settings = SettingsSnapshot::current(item->context);
+        athlete_age = item->dateTime.date().year() - settings->dob.year();
+        bool male = settings->sex == 0;
 
         double kcalories = 0.0;
 
@@ -3860,6 +3934,7 @@ struct ActivityCRC : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new ActivityCRC(*this); }
 };
 
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "BestEfforts.h"
+#include "RideItem.h"
+
+#include <QThreadStorage>
+
+// the ones for the item this thread is refreshing
+static QThreadStorage<BestEfforts*> refreshing;
+
+BestEfforts::BestEfforts(const RideFile *ride, Specification spec) : item(NULL), last(0)
+{
+    secsDelta = ride->recIntSecs();
+    if (ride->dataPoints().count()) last = ride->dataPoints().last()->secs;
+
+    RideFileIterator it(const_cast<RideFile*>(ride), spec);
+    while (it.hasNext()) {
+        struct RideFilePoint *point = it.next();
+
+        secs << point->secs;
+        watts << point->value(RideFile::watts);
+        hr << point->value(RideFile::hr);
+        kph << point->value(RideFile::kph);
+    }
+}
+
+const QVector<double> *
+BestEfforts::values(RideFile::SeriesType series) const
+{
+    switch(series) {
+    case RideFile::watts : return &watts;
+    case RideFile::hr : return &hr;
+    case RideFile::kph : return &kph;
+    default: return NULL;
+    }
+}
+
+void
+BestEfforts::findPeak(RideFile::SeriesType series, double windowSize, QList<AddIntervalDialog::AddedInterval> &results)
+{
+    // seen it before ?
+    QPair<int,double> key(static_cast<int>(series), windowSize);
+    QHash<QPair<int,double>, QList<AddIntervalDialog::AddedInterval> >::const_iterator f = found.constFind(key);
+    if (f != found.constEnd()) {
+        results << f.value();
+        return;
+    }
+
+    QList<AddIntervalDialog::AddedInterval> best;
+    const QVector<double> *v = values(series);
+
+    // ride is shorter than the window size!
+    if (v && secs.count() && windowSize <= last + secsDelta) {
+
+        const double *t = secs.constData();
+        const double *value = v->constData();
+        double total = 0.0;
+        int first = 0;
+
+        // same as findPeaks, window is first..i and we're looking for
+        // intervals with durations in [windowSize, windowSize + secsDelta)
+        for(int i=0; i<secs.count(); i++) {
+
+            // discard points until interval duration is < windowSize + secsDelta
+            while (first < i && t[i] - t[first] + secsDelta >= windowSize + secsDelta) {
+                total -= value[first];
+                first++;
+            }
+
+            // add points until interval duration is >= windowSize
+            total += value[i];
+            double duration = t[i] - t[first] + secsDelta;
+
+            if (duration >= windowSize) {
+                double avg = total * secsDelta / duration;
+
+                // highest average, then earliest start
+                if (best.isEmpty() || avg > best[0].avg)
+                    best = QList<AddIntervalDialog::AddedInterval>() << AddIntervalDialog::AddedInterval(t[first], t[i], avg);
+            }
+        }
+    }
+
+    found.insert(key, best);
+    results << best;
+}
+
+void
+BestEfforts::findPeak(RideItem *item, Specification spec, RideFile::SeriesType series, double secs,
+                      QList<AddIntervalDialog::AddedInterval> &results)
+{
+    // whole ride whilst this thread is refreshing it
+    BestEfforts *bests = refreshing.localData();
+    if (bests && bests->item == item && spec.interval() == NULL && bests->values(series)) {
+        bests->findPeak(series, secs, results);
+        return;
+    }
+
+    // intervals, or not refreshing
+    AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, series, RideFile::original, secs, 1, results, "", "");
+}
+
+void
+BestEfforts::beginRefresh(const RideItem *item, const RideFile *ride)
+{
+    // replaces (and deletes) any left behind
+    BestEfforts *bests = new BestEfforts(ride, Specification());
+    bests->item = item;
+    refreshing.setLocalData(bests);
+}
+
+void
+BestEfforts::endRefresh()
+{
+    // deletes them
+    refreshing.setLocalData(NULL);
+}
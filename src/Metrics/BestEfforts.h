@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_BestEfforts_h
+#define _GC_BestEfforts_h 1
+#include "GoldenCheetah.h"
+
+#include "RideFile.h"
+#include "Specification.h"
+#include "AddIntervalDialog.h"
+
+#include <QVector>
+#include <QHash>
+#include <QPair>
+
+class RideItem;
+
+//
+// Best efforts for a time window, as found by AddIntervalDialog::findPeaks
+// with one interval, but without walking the ride samples each time.
+//
+// The peak power, hr and pace metrics and the PEAKPOWER and PEAKPACE
+// interval discovery all look for the same peaks, often for the same
+// durations, so whilst a ride item is being refreshed it holds one of
+// these for the whole ride. The samples are extracted once and each
+// peak is only found once, later requests for the same series and
+// duration are answered from what was found before. They belong to
+// the thread doing the refresh, nothing else sees them, so they are
+// never shared with another thread or used after the refresh ends.
+//
+// The windows and running totals are exactly the same as findPeaks so
+// the values found are identical, ties go to the earliest start.
+//
+class BestEfforts
+{
+    public:
+
+        // extract watts, hr and kph for the samples in spec
+        BestEfforts(const RideFile *ride, Specification spec);
+
+        // best average for a window of secs, appended to results
+        // nothing is appended if there isn't one (e.g. ride too short)
+        void findPeak(RideFile::SeriesType series, double secs, QList<AddIntervalDialog::AddedInterval> &results);
+
+        // use the ones held whilst the item is refreshed by this thread when
+        // the spec is for the whole ride, otherwise find it from scratch
+        static void findPeak(RideItem *item, Specification spec, RideFile::SeriesType series, double secs,
+                             QList<AddIntervalDialog::AddedInterval> &results);
+
+        // held by the calling thread whilst it refreshes the item
+        static void beginRefresh(const RideItem *item, const RideFile *ride);
+        static void endRefresh();
+
+    private:
+
+        const QVector<double> *values(RideFile::SeriesType series) const;
+
+        const RideItem *item;       // being refreshed, if any
+        double secsDelta;           // recording interval
+        double last;                // last sample in the ride, not the spec
+
+        QVector<double> secs, watts, hr, kph;
+
+        // found already, empty when there isn't one
+        QHash<QPair<int,double>, QList<AddIntervalDialog::AddedInterval> > found;
+};
+
+#endif // _GC_BestEfforts_h
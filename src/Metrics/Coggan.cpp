@@ -21,6 +21,7 @@
 #include "RideItem.h"
 #include "Zones.h"
 #include "Settings.h"
+#include "SettingsSnapshot.h"
 #include "Athlete.h"
 #include "Specification.h"
 #include "Units.h"
@@ -184,7 +185,7 @@ class IntensityFactor : public RideMetric {
 
         int ftp = item->getText("FTP","0").toInt();
 
-        bool useCPForFTP = (appsettings->cvalue(item->context->athlete->cyclist, item->context->athlete->zones(item->isRun)->useCPforFTPSetting(), 0).toInt() == 0);
+        bool useCPForFTP = (SettingsSnapshot::current(item->context)->cpforftp[item->isRun] == 0);
 
         if (useCPForFTP) {
             int cp = item->getText("CP","0").toInt();
@@ -245,7 +246,7 @@ class BikeStress : public RideMetric {
 
         int ftp = item->getText("FTP","0").toInt();
 
-        bool useCPForFTP = (appsettings->cvalue(item->context->athlete->cyclist, item->context->athlete->zones(item->isRun)->useCPforFTPSetting(), 0).toInt() == 0);
+        bool useCPForFTP = (SettingsSnapshot::current(item->context)->cpforftp[item->isRun] == 0);
 
         if (useCPForFTP) {
             int cp = item->getText("CP","0").toInt();
@@ -21,6 +21,7 @@
 #include "PaceZones.h"
 #include "Units.h"
 #include "Settings.h"
+#include "SettingsSnapshot.h"
 #include "RideItem.h"
 #include "Context.h"
 #include "Athlete.h"
@@ -182,17 +183,17 @@ class XPace : public RideMetric {
 
     // Overrides to use Pace units setting
     QString units(bool) const {
-        bool metricPace = appsettings->value(NULL, GC_PACE, GlobalContext::context()->useMetricUnits).toBool();
+        bool metricPace = SettingsSnapshot::current(NULL)->metricPace[0];
         return RideMetric::units(metricPace);
     }
 
     double value(bool) const {
-        bool metricPace = appsettings->value(NULL, GC_PACE, GlobalContext::context()->useMetricUnits).toBool();
+        bool metricPace = SettingsSnapshot::current(NULL)->metricPace[0];
         return RideMetric::value(metricPace);
     }
 
     double value(double v, bool) const {
-        bool metricPace = appsettings->value(NULL, GC_PACE, GlobalContext::context()->useMetricUnits).toBool();
+        bool metricPace = SettingsSnapshot::current(NULL)->metricPace[0];
         return RideMetric::value(v, metricPace);
     }
 
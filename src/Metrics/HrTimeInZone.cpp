@@ -81,6 +81,7 @@ public:
     void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new HrZoneTime(*this); }
 };
 
@@ -345,6 +346,7 @@ class HrZonePTime1 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime1(*this); }
 };
 
@@ -389,6 +391,7 @@ class HrZonePTime2 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime2(*this); }
 };
 
@@ -433,6 +436,7 @@ class HrZonePTime3 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime3(*this); }
 };
 
@@ -477,6 +481,7 @@ class HrZonePTime4 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime4(*this); }
 };
 
@@ -521,6 +526,7 @@ class HrZonePTime5 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime5(*this); }
 };
 
@@ -565,6 +571,7 @@ class HrZonePTime6 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime6(*this); }
 };
 
@@ -609,6 +616,7 @@ class HrZonePTime7 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime7(*this); }
 };
 
@@ -653,6 +661,7 @@ class HrZonePTime8 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime8(*this); }
 };
 class HrZonePTime9 : public RideMetric {
@@ -696,6 +705,7 @@ class HrZonePTime9 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime9(*this); }
 };
 class HrZonePTime10 : public RideMetric {
@@ -739,6 +749,7 @@ class HrZonePTime10 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new HrZonePTime10(*this); }
 };
 static bool addAllHrZones() {
@@ -82,6 +82,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new RRNormalFraction(*this); }
 };
 
@@ -144,6 +145,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new avnn(*this); }
 };
 
@@ -222,6 +224,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new sdnn(*this); }
 };
 
@@ -321,6 +324,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new sdann(*this); }
 };
 
@@ -403,6 +407,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new sdnnidx(*this); }
 };
 
@@ -462,6 +467,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new rmssd(*this); }
 };
 
@@ -526,6 +532,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new pnnx(*this); }
     bool isRelevantForRide(const RideItem *) const { return true; }
 };
@@ -571,6 +578,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new rest_hr(*this); }
 };
 
@@ -607,6 +615,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new rest_avnn(*this); }
 };
 
@@ -644,6 +653,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new rest_sdnn(*this); }
 };
 
@@ -681,6 +691,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new rest_rmssd(*this); }
 };
 
@@ -718,6 +729,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new rest_pNN50(*this); }
 };
 
@@ -756,6 +768,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new rest_lf(*this); }
 };
 
@@ -794,6 +807,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new rest_hf(*this); }
 };
 
@@ -837,6 +851,7 @@ public:
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputHrv; }
     RideMetric *clone() const { return new hrv_recovery_points(*this); }
 };
 
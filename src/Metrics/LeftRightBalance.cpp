@@ -80,6 +80,7 @@ class LeftRightBalance : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new LeftRightBalance(*this); }
 };
 
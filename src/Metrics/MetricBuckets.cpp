@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "MetricBuckets.h"
+
+#include "Athlete.h"
+#include "Context.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "RideFile.h"
+#include "LTMSettings.h" // LTM_DAY etc
+
+#include <cmath>
+#include <algorithm>
+
+// rides are sorted by date, so we can find a day quickly
+static bool rideBeforeDay(const RideItem *item, int day) { return item->dateTime.date().toJulianDay() < day; }
+
+MetricBuckets::MetricBuckets(Context *context, QString symbol, bool metadata, int type, bool useMetricUnits)
+    : context(context), symbol_(symbol), metadata_(metadata), type_(type), useMetricUnits_(useMetricUnits),
+      metric_(NULL), aggZero_(false), isstale(true)
+{
+    if (!metadata_) {
+        metric_ = RideMetricFactory::instance().rideMetric(symbol_);
+        if (metric_) aggZero_ = metric_->aggregateZero();
+    }
+
+    // rides coming and going only affect their own day
+    connect(context, SIGNAL(rideAdded(RideItem*)), this, SLOT(invalidate(RideItem*)));
+    connect(context, SIGNAL(rideDeleted(RideItem*)), this, SLOT(invalidate(RideItem*)));
+    connect(context->athlete->rideCache, SIGNAL(itemChanged(RideItem*)), this, SLOT(invalidate(RideItem*)));
+
+    // but a background refresh touches everything
+    connect(context, SIGNAL(refreshUpdate(QDate)), this, SLOT(invalidate()));
+    connect(context, SIGNAL(refreshEnd()), this, SLOT(invalidate()));
+}
+
+QString
+MetricBuckets::key(QString symbol, bool metadata, int type, bool useMetricUnits)
+{
+    return QString("%1:%2:%3:%4").arg(metadata ? "meta" : "metric").arg(symbol).arg(type).arg(useMetricUnits);
+}
+
+int
+MetricBuckets::groupForDate(QDate date, int groupBy, QDate start)
+{
+    switch(groupBy) {
+    case LTM_WEEK:
+        {
+        // must start from 1 not zero!
+        return 1 + ((date.toJulianDay() - start.toJulianDay()) / 7);
+        }
+    case LTM_MONTH: return (date.year()*12) + date.month();
+    case LTM_YEAR:  return date.year();
+    case LTM_DAY:
+    default:
+        return date.toJulianDay();
+    case LTM_ALL: return 1;
+
+    }
+}
+
+void
+MetricBuckets::invalidate()
+{
+    isstale = true;
+    dirty_.clear();
+    rollups_.clear();
+}
+
+void
+MetricBuckets::invalidate(RideItem *item)
+{
+    if (isstale || item == NULL) return;
+
+    // the day it was on, and the day it is on now
+    // (they differ when the ride date is edited)
+    int was = rideday_.value(item->fileName, -1);
+    if (was >= 0) dirty_ << was;
+    dirty_ << item->dateTime.date().toJulianDay();
+
+    rollups_.clear();
+}
+
+bool
+MetricBuckets::rideValue(RideItem *ride, double &value, double &count, double &mean) const
+{
+    if (metadata_) value = ride->getText(symbol_, "0.0").toDouble();
+    else value = ride->getForSymbol(symbol_);
+
+    // check values are bounded to stop QWT going berserk
+    if (std::isnan(value) || std::isinf(value)) value = 0;
+
+    // skip unavailable values
+    if (value == RideFile::NA) return false;
+
+    if (metric_) {
+        // convert from stored metric value to imperial
+        if (useMetricUnits_ == false) {
+            value *= metric_->conversion();
+            value += metric_->conversionSum();
+        }
+
+        // convert seconds to hours
+        if (metric_->units(true) == "seconds" ||
+            metric_->units(true) == tr("seconds")) value /= 3600;
+    }
+
+    // whole seconds, as LTMPlot always used
+    count = metric_ ? (unsigned long) ride->getCountForSymbol(metric_->symbol()) : 1;
+    mean = ride->getStdMeanForSymbol(symbol_);
+    return true;
+}
+
+void
+MetricBuckets::fold(Bucket &b, double value, double count, double mean) const
+{
+    // first one in sets the bucket
+    if (b.rides == 0) {
+        b.value = value;
+        b.mean = mean;
+        // only count if nonzero or we aggregate zeroes
+        b.count = (value || aggZero_) ? count : 0;
+        b.rides = 1;
+        return;
+    }
+
+    // sum totals, average averages and choose best for Peaks
+    switch (type_) {
+    case RideMetric::Total:
+        b.value += value;
+        break;
+    case RideMetric::Average:
+        // average should be calculated taking into account
+        // the duration of the ride, otherwise high value but
+        // short rides will skew the overall average
+        if (value || aggZero_) b.value = ((b.value*b.count)+(count*value)) / (b.count+count);
+        break;
+    case RideMetric::Low:
+        if (value < b.value) b.value = value;
+        break;
+    case RideMetric::Peak:
+        if (value > b.value) b.value = value;
+        break;
+    case RideMetric::MeanSquareRoot:
+        if (value) b.value = sqrt((pow(b.value,2)*b.count + pow(value,2)*count)/(b.count+count));
+        break;
+    case RideMetric::StdDev:
+        if (value) {
+            // Combining two standard deviations using
+            // the formula:
+            //
+            //   sqrt(((n1-1)*S1^2+(n2-1)*S2^2+n1*(ymean_1-ymean)^2+n2*(ymean_2-ymean)^2)/(n1+n2))
+            //
+            // where:
+            //
+            //   ymean = (n1*ymean_1 + n2*ymean_2)/(n1+n2)
+            double ymean = (b.count*b.mean + mean*count)/(b.count + count);
+            double y = pow(b.value,2)*(b.count-1) + pow(value,2)*(count-1);
+            y += pow(b.mean - ymean,2)*b.count + pow(mean - ymean,2)*count;
+            y /= (b.count + count);
+            b.value = sqrt(y);
+            b.mean = ymean;
+        }
+        break;
+    }
+
+    // increment counter if nonzero or we aggregate zeroes
+    if (value || aggZero_) b.count += count;
+    b.rides++;
+}
+
+void
+MetricBuckets::foldDay(int day)
+{
+    days_[0].remove(day);
+    days_[1].remove(day);
+
+    QVector<RideItem*> &rides = context->athlete->rideCache->rides();
+    QVector<RideItem*>::iterator it = std::lower_bound(rides.begin(), rides.end(), day, rideBeforeDay);
+
+    Bucket nonzero, all;
+    for(; it != rides.end() && (*it)->dateTime.date().toJulianDay() == day; ++it) {
+
+        double value, count, mean;
+        if (!rideValue(*it, value, count, mean)) continue;
+
+        rideday_.insert((*it)->fileName, day);
+
+        fold(all, value, count, mean);
+        if (value) fold(nonzero, value, count, mean);
+    }
+
+    if (nonzero.rides) days_[0].insert(day, nonzero);
+    if (all.rides) days_[1].insert(day, all);
+}
+
+void
+MetricBuckets::refresh()
+{
+    if (isstale) {
+
+        days_[0].clear();
+        days_[1].clear();
+        rideday_.clear();
+        dirty_.clear();
+
+        // rides are in date order so each day is contiguous
+        int day = -1;
+        Bucket nonzero, all;
+        foreach(RideItem *ride, context->athlete->rideCache->rides()) {
+
+            double value, count, mean;
+            if (!rideValue(ride, value, count, mean)) continue;
+
+            int rday = ride->dateTime.date().toJulianDay();
+            if (rday != day) {
+                if (nonzero.rides) days_[0].insert(day, nonzero);
+                if (all.rides) days_[1].insert(day, all);
+                nonzero = all = Bucket();
+                day = rday;
+            }
+            rideday_.insert(ride->fileName, rday);
+
+            fold(all, value, count, mean);
+            if (value) fold(nonzero, value, count, mean);
+        }
+        if (nonzero.rides) days_[0].insert(day, nonzero);
+        if (all.rides) days_[1].insert(day, all);
+
+        isstale = false;
+
+    } else if (dirty_.count()) {
+
+        foreach(int day, dirty_) foldDay(day);
+        dirty_.clear();
+    }
+}
+
+QList<QPair<int,double> >
+MetricBuckets::aggregate(DateRange range, int groupBy, QDate start, bool wantZero)
+{
+    refresh();
+
+    // already rolled up ?
+    QString rkey = QString("%1:%2:%3:%4:%5").arg(range.from.toJulianDay()).arg(range.to.toJulianDay())
+                                            .arg(groupBy).arg(start.toJulianDay()).arg(wantZero);
+    if (rollups_.contains(rkey)) return rollups_.value(rkey);
+
+    // fold the day buckets into groups, the groups are
+    // always increasing as we iterate over the days.
+    // NOTE: totals, averages, peaks and lows roll up exactly,
+    //       stddev is combined pairwise using the bucket means
+    QList<QPair<int,double> > returning;
+    const QMap<int, Bucket> &days = days_[wantZero ? 1 : 0];
+    QMap<int, Bucket>::const_iterator it = range.from.isValid() ? days.lowerBound(range.from.toJulianDay()) : days.constBegin();
+
+    Bucket group;
+    int current = 0;
+    for(; it != days.constEnd(); ++it) {
+
+        QDate date = QDate::fromJulianDay(it.key());
+        if (range.to.isValid() && date > range.to) break;
+        if (!range.pass(date)) continue;
+
+        int g = groupForDate(date, groupBy, start);
+        if (group.rides && g != current) {
+            returning << QPair<int,double>(current, group.value);
+            group = Bucket();
+        }
+        current = g;
+        fold(group, it.value().value, it.value().count, it.value().mean);
+    }
+    if (group.rides) returning << QPair<int,double>(current, group.value);
+
+    rollups_.insert(rkey, returning);
+    return returning;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020 Mark Liversedge (liversedge@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_MetricBuckets_h
+#define _GC_MetricBuckets_h 1
+#include "GoldenCheetah.h"
+
+#include "RideMetric.h"
+#include "TimeUtils.h"
+
+#include <QObject>
+#include <QString>
+#include <QDate>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QList>
+
+class Context;
+class RideItem;
+
+//
+// Per-metric day buckets for the trends charts
+//
+// LTMPlot used to scan every ride, look up the metric value and fold
+// it into day/week/month buckets every time a chart was replotted.
+// This class holds the same aggregates (value, duration, mean) for a
+// single metric (or metadata field) at day granularity so they only
+// need to be computed once; a week/month/year rollup is then just a
+// fold over the day buckets.
+//
+// Buckets are maintained incrementally, when a ride is added, deleted
+// or changed only the day(s) it affects are recomputed.
+//
+// There are two sets of buckets; one for only the rides that have a
+// non-zero value and one for all rides, LTMPlot uses the latter
+// when plotting steps or the caller has asked for zeroes.
+//
+// The aggregation follows RideMetric::type() semantics exactly as
+// LTMPlot::createMetricData always has, so results are unchanged.
+//
+class MetricBuckets : public QObject {
+
+    Q_OBJECT
+
+    public:
+
+        // symbol is a metric symbol or a metadata field name
+        // type is the RideMetric::MetricType used to aggregate
+        MetricBuckets(Context *, QString symbol, bool metadata, int type, bool useMetricUnits);
+
+        // the key used by Athlete::getBucketsFor()
+        static QString key(QString symbol, bool metadata, int type, bool useMetricUnits);
+
+        // same grouping as LTMPlot::groupForDate
+        static int groupForDate(QDate date, int groupBy, QDate start);
+
+        // aggregate for the date range, grouped by LTM_DAY, LTM_WEEK etc
+        // returns a list of group number and value in date order
+        // start is the first date of the chart (weeks count from it)
+        QList<QPair<int,double> > aggregate(DateRange range, int groupBy, QDate start, bool wantZero);
+
+    public slots:
+
+        // rebuild everything on next access
+        void invalidate();
+
+        // just the days a ride touches
+        void invalidate(RideItem *);
+
+    private:
+
+        struct Bucket {
+            Bucket() : value(0), count(0), mean(0), rides(0) {}
+            double value;   // aggregated value
+            double count;   // duration (or count) used for weighting
+            double mean;    // running mean used to combine stddev
+            int rides;      // how many folded in
+        };
+
+        // fold a value into a bucket, ride->day and day->group
+        void fold(Bucket &, double value, double count, double mean) const;
+
+        // value for the ride, false if unavailable
+        bool rideValue(RideItem *, double &value, double &count, double &mean) const;
+
+        // recompute buckets as needed
+        void refresh();
+        void foldDay(int day);
+
+        Context *context;
+        QString symbol_;
+        bool metadata_;
+        int type_;
+        bool useMetricUnits_;
+        const RideMetric *metric_;
+        bool aggZero_;
+
+        // julian day -> bucket, [0] non-zero rides, [1] all rides
+        QMap<int, Bucket> days_[2];
+
+        // filename -> julian day it was folded into
+        QHash<QString, int> rideday_;
+
+        // days needing a refold
+        QSet<int> dirty_;
+
+        // last rollups, cleared whenever a bucket changes
+        QHash<QString, QList<QPair<int,double> > > rollups_;
+
+        bool isstale;
+};
+
+#endif // _GC_MetricBuckets_h
@@ -20,6 +20,10 @@
 #include "LTMTrend.h"
 #include "lmcurve.h"
 
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
 //extern ztable PD_ZTABLE;
 // base class for all models
 PDModel::PDModel(Context *context) :
@@ -986,8 +990,78 @@ ExtendedModel::onIntervalsChanged()
     setInterval(QwtInterval(etau, PDMODEL_MAXT));
 }
 
+// fits we keep
+#define EXTENDEDFITS 64
+
+QMutex ExtendedModel::fitsMutex;
+QCache<QString, ExtendedModel::Fit> ExtendedModel::fits(EXTENDEDFITS);
+
+void
+ExtendedModel::prefit(QList<QVector<double> > data, bool minutes, double sanI1, double sanI2, double anI1, double anI2,
+                      double aeI1, double aeI2, double laeI1, double laeI2)
+{
+    // each worker fits its own model, which leaves the result in the cache
+    QtConcurrent::blockingMap(data, [=](QVector<double> &meanmax) {
+        ExtendedModel model(NULL);
+        model.setMinutes(minutes);
+        model.setIntervals(sanI1, sanI2, anI1, anI2, aeI1, aeI2, laeI1, laeI2);
+        model.setData(meanmax);
+    });
+}
+
 void
 ExtendedModel::deriveExtCPParameters()
+{
+    // the fit only depends on the mean max data and the intervals, but
+    // the rmse and cv in the summary come from y() which uses minutes
+    QString key = QString("%1:%2:%3:%4:%5:%6:%7:%8:%9:%10:%11").arg(data.size()).arg(qHash(data))
+                  .arg(sanI1).arg(sanI2).arg(anI1).arg(anI2).arg(aeI1).arg(aeI2).arg(laeI1).arg(laeI2)
+                  .arg(minutes ? 1 : 0);
+
+    // fit it before ?
+    {
+        QMutexLocker locker(&fitsMutex);
+        Fit *found = fits.object(key);
+        if (found) {
+            setParms(found->parms);
+            map = found->map;
+            fitsummary = found->fitsummary;
+            if (fitsummary != "") fitsummary += " [cached]";
+            return;
+        }
+    }
+
+    // not what we found for the last data if we can't fit
+    map.clear();
+    fitsummary = "";
+
+    QElapsedTimer timer;
+    timer.start();
+    fitExtCPParameters();
+    qint64 elapsed = timer.elapsed();
+
+    Fit *add = new Fit;
+    add->parms[0] = paa;
+    add->parms[1] = paa_dec;
+    add->parms[2] = ecp;
+    add->parms[3] = etau;
+    add->parms[4] = tau_del;
+    add->parms[5] = ecp_del;
+    add->parms[6] = ecp_dec;
+    add->parms[7] = ecp_dec_del;
+    add->map = map;
+    add->fitsummary = fitsummary;
+    {
+        QMutexLocker locker(&fitsMutex);
+        fits.insert(key, add);
+    }
+
+    // so the intervals can be tuned
+    if (fitsummary != "") fitsummary += QString(" [fit %1ms]").arg(elapsed);
+}
+
+void
+ExtendedModel::fitExtCPParameters()
 {
     // initial estimates
     paa = 1000;
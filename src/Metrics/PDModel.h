@@ -19,6 +19,7 @@
 #include <QObject>
 #include <QMutex>
 #include <QString>
+#include <QCache>
 
 #include "Context.h"
 #include <cmath>
@@ -479,6 +480,12 @@ class ExtendedModel : public PDModel
         void saveParameters(QList<double>&here);
         void loadParameters(QList<double>&here);
 
+        // fit each of these in parallel, the results are cached
+        // so setting the same data on a model afterwards is immediate,
+        // minutes must match the model's since it is part of the key
+        static void prefit(QList<QVector<double> > data, bool minutes, double sanI1, double sanI2, double anI1, double anI2,
+                           double aeI1, double aeI2, double laeI1, double laeI2);
+
     public slots:
 
         void onDataChanged();      // catch data changes
@@ -486,6 +493,17 @@ class ExtendedModel : public PDModel
 
     private:
         void deriveExtCPParameters();
+        void fitExtCPParameters();
+
+        // fits already done, keyed by the data and intervals
+        // used by the estimator thread and workers too, hence the mutex
+        struct Fit {
+            double parms[8];
+            QMap<int,double> map;
+            QString fitsummary;
+        };
+        static QMutex fitsMutex;
+        static QCache<QString, Fit> fits;
 };
 
 #endif
@@ -86,6 +86,7 @@ class PaceZoneTime : public RideMetric {
     void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new PaceZoneTime(*this); }
 };
 
@@ -353,6 +354,7 @@ class PaceZonePTime1 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime1(*this); }
 };
 
@@ -397,6 +399,7 @@ class PaceZonePTime2 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime2(*this); }
 };
 
@@ -441,6 +444,7 @@ class PaceZonePTime3 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime3(*this); }
 };
 
@@ -485,6 +489,7 @@ class PaceZonePTime4 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime4(*this); }
 };
 
@@ -529,6 +534,7 @@ class PaceZonePTime5 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime5(*this); }
 };
 
@@ -573,6 +579,7 @@ class PaceZonePTime6 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime6(*this); }
 };
 
@@ -617,6 +624,7 @@ class PaceZonePTime7 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime7(*this); }
 };
 
@@ -661,6 +669,7 @@ class PaceZonePTime8 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime8(*this); }
 };
 
@@ -705,6 +714,7 @@ class PaceZonePTime9 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime9(*this); }
 };
 
@@ -749,6 +759,7 @@ class PaceZonePTime10 : public RideMetric {
         void aggregateWith(const RideMetric &) {}
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new PaceZonePTime10(*this); }
 };
 
@@ -20,6 +20,7 @@
 #include "RideMetric.h"
 #include "RideItem.h"
 #include "AddIntervalDialog.h"
+#include "BestEfforts.h"
 #include "Context.h"
 #include "Athlete.h"
 #include "Specification.h"
@@ -123,7 +124,7 @@ class PeakHr : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::hr, RideFile::original, secs, 1, results, "", "");
+        BestEfforts::findPeak(item, spec, RideFile::hr, secs, results);
         if (results.count() > 0 && results.first().avg < 300) hr = results.first().avg;
         else hr = 0.0;
 
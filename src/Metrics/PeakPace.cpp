@@ -19,6 +19,7 @@
 
 #include "RideMetric.h"
 #include "AddIntervalDialog.h"
+#include "BestEfforts.h"
 #include "RideItem.h"
 #include "Context.h"
 #include "Athlete.h"
@@ -65,7 +66,7 @@ class PeakPace : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::kph, RideFile::original, secs, 1, results, "", "");
+        BestEfforts::findPeak(item, spec, RideFile::kph, secs, results);
         if (results.count() > 0 && results.first().avg > 0 && results.first().avg < 36) pace = 60.0 / results.first().avg;
         else pace = 0.0;
 
@@ -408,7 +409,7 @@ class PeakPaceSwim : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::kph, RideFile::original, secs, 1, results, "", "");
+        BestEfforts::findPeak(item, spec, RideFile::kph, secs, results);
         if (results.count() > 0 && results.first().avg > 0 && results.first().avg < 9) pace = 6.0 / results.first().avg;
         else pace = 0.0;
         setValue(pace);
@@ -1139,7 +1140,7 @@ class PeakPaceHr : public RideMetric {
 
         // find peak pace interval
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::kph, RideFile::original, secs, 1, results, "", "");
+        BestEfforts::findPeak(item, spec, RideFile::kph, secs, results);
 
         // work out average hr during that interval
         if (results.count() > 0) {
@@ -19,6 +19,7 @@
 #include "RideMetric.h"
 #include "RideItem.h"
 #include "AddIntervalDialog.h"
+#include "BestEfforts.h"
 #include "Context.h"
 #include "Athlete.h"
 #include "Specification.h"
@@ -296,7 +297,7 @@ class PeakPower : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::watts, RideFile::original, secs, 1, results, "", "");
+        BestEfforts::findPeak(item, spec, RideFile::watts, secs, results);
         if (results.count() > 0 && results.first().avg < 3000) watts = results.first().avg;
         else watts = 0.0;
 
@@ -636,7 +637,7 @@ class PeakPowerHr : public RideMetric {
 
         // find peak power interval
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::watts, RideFile::original, secs, 1, results, "", "");
+        BestEfforts::findPeak(item, spec, RideFile::watts, secs, results);
 
         // work out average hr during that interval
         if (results.count() > 0) {
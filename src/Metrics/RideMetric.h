@@ -40,6 +40,7 @@ class RideFile;
 class RideItem;
 class DataFilter;
 class DataFilterRuntime;
+class DataFilterReduction;
 class Leaf;
 
 // keep track of schema changes
@@ -77,6 +78,13 @@ public:
     enum metricvalidity { Unreliable, Unknown, Unclear, Useful, Reliable, High };
     typedef enum metricvalidity MetricValidity;
 
+    // What a metric depends upon besides the ride samples (OR'ed together)
+    // when these change only the metrics that use them are recomputed, see
+    // RideItem::checkStale(). Samples only means no athlete settings at all.
+    enum metricinput { InputSamples=0x00, InputZones=0x01, InputWeight=0x02, InputHrv=0x04,
+                       InputSettings=0x07, InputProgram=0x08 };
+    typedef enum metricinput MetricInput;
+
     int index_;
 
     RideMetric() {
@@ -157,6 +165,10 @@ public:
     // is this metric relevant
     virtual bool isRelevantForRide(const RideItem *) const { return true; }
 
+    // which settings does it use, assume all of them unless we know better
+    // dependencies are accounted for by RideMetricFactory::inputs()
+    virtual int inputs() const { return InputSettings; }
+
     // Factor to multiple value to convert from metric to imperial
     virtual double conversion() const { return conversion_; }
     // And sum for example Fahrenheit from CentigradE
@@ -272,12 +284,19 @@ public:
     // is this a user defined one?
     bool isUser() const { return true; }
 
+    // the program can use anything
+    int inputs() const { return InputSettings | InputProgram; }
+
     // did we clone (i.e. datafilter doesn't belong to us)
     bool isClone() const { return clone_; }
 
     void initialize();
     static void addCompatibility(QList<UserMetricSettings> &metrics);
 
+    // run the per sample functions a column at a time where we can, it
+    // is only ever turned off to compare with eval (--benchmark=usermetrics)
+    static bool reductions;
+
     QString symbol() const;
 
     QString name() const; 
@@ -341,6 +360,10 @@ public:
         // functions, to save lots of lookups
         Leaf *finit, *frelevant, *fsample, *fbefore, *fafter, *fvalue, *fcount;
 
+        // per sample functions that just accumulate run a column at a
+        // time, NULL when they need evaluating for each sample
+        DataFilterReduction *rsample, *rbefore, *rafter;
+
         // our runtime
         DataFilterRuntime *rt;
 
@@ -457,6 +480,25 @@ private:
         QVector<QString> *result = dependencyMap.value(symbol);
         return result ? *result : noDeps;
     }
+
+    // the inputs a metric uses, directly or via its dependencies
+    // not cached since refresh threads call this concurrently
+    int inputs(const QString &symbol) const {
+        const RideMetric *m = metrics.value(symbol, NULL);
+        if (!m) return RideMetric::InputSamples;
+        int returning = m->inputs();
+        foreach(const QString &dependency, dependencies(symbol))
+            if (dependency != symbol) returning |= inputs(dependency);
+        return returning;
+    }
+
+    // all the metrics that need recomputing when the inputs change
+    QStringList metricsFor(int changed) const {
+        QStringList returning;
+        foreach(const QString &symbol, metricNames)
+            if (inputs(symbol) & changed) returning << symbol;
+        return returning;
+    }
 };
 
 #endif // _GC_RideMetric_h
@@ -55,6 +55,7 @@ class L1Sustain : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L1Sustain(*this); }
 };
 
@@ -82,6 +83,7 @@ class L2Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L2Sustain(*this); }
 };
 
@@ -108,6 +110,7 @@ class L3Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L3Sustain(*this); }
 };
 
@@ -134,6 +137,7 @@ class L4Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L4Sustain(*this); }
 };
 
@@ -160,6 +164,7 @@ class L5Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L5Sustain(*this); }
 };
 
@@ -186,6 +191,7 @@ class L6Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L6Sustain(*this); }
 };
 
@@ -212,6 +218,7 @@ class L7Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L7Sustain(*this); }
 };
 
@@ -238,6 +245,7 @@ class L8Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L8Sustain(*this); }
 };
 
@@ -264,6 +272,7 @@ class L9Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L9Sustain(*this); }
 };
 
@@ -290,6 +299,7 @@ class L10Sustain : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new L10Sustain(*this); }
 };
 
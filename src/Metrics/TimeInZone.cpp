@@ -77,6 +77,7 @@ class ZoneTime : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputZones; }
     RideMetric *clone() const { return new ZoneTime(*this); }
 };
 
@@ -342,6 +343,7 @@ class ZonePTime1 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime1(*this); }
 };
 
@@ -384,6 +386,7 @@ class ZonePTime2 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime2(*this); }
 };
 
@@ -426,6 +429,7 @@ class ZonePTime3 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime3(*this); }
 };
 
@@ -468,6 +472,7 @@ class ZonePTime4 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime4(*this); }
 };
 
@@ -510,6 +515,7 @@ class ZonePTime5 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime5(*this); }
 };
 
@@ -552,6 +558,7 @@ class ZonePTime6 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime6(*this); }
 };
 
@@ -594,6 +601,7 @@ class ZonePTime7 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime7(*this); }
 };
 
@@ -636,6 +644,7 @@ class ZonePTime8 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime8(*this); }
 };
 
@@ -678,6 +687,7 @@ class ZonePTime9 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime9(*this); }
 };
 
@@ -720,6 +730,7 @@ class ZonePTime10 : public RideMetric {
         bool aggregateZero() const { return true; }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+        int inputs() const { return InputSamples; }
         RideMetric *clone() const { return new ZonePTime10(*this); }
 };
 
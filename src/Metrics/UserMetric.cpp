@@ -20,6 +20,8 @@
 #include "UserMetricSettings.h"
 #include "DataFilter.h"
 
+bool UserMetric::reductions = true;
+
 UserMetric::UserMetric(Context *context, UserMetricSettings settings)
     : RideMetric(), settings(settings)
 {
@@ -38,6 +40,11 @@ UserMetric::UserMetric(Context *context, UserMetricSettings settings)
     fvalue = rt->functions.contains("value") ? rt->functions.value("value") : NULL;
     fcount = rt->functions.contains("count") ? rt->functions.value("count") : NULL;
 
+    // can we avoid evaluating for every sample ?
+    rsample = DataFilterReduction::compile(rt, fsample);
+    rbefore = DataFilterReduction::compile(rt, fbefore);
+    rafter = DataFilterReduction::compile(rt, fafter);
+
     // we're not a clone, we're the original
     clone_ = false;
 }
@@ -57,6 +64,9 @@ UserMetric::UserMetric(const UserMetric *from) : RideMetric()
     this->fafter = from->fafter;
     this->fvalue = from->fvalue;
     this->fcount = from->fcount;
+    this->rsample = from->rsample;
+    this->rbefore = from->rbefore;
+    this->rafter = from->rafter;
 
     this->index_ = from->index_;
 
@@ -76,7 +86,12 @@ UserMetric::~UserMetric()
     RideMetricFactory::instance().mutex.lock();
     if (program) {
         program->refcount--;
-        if (!program->refcount) delete program;
+        if (!program->refcount) {
+            delete program;
+            delete rsample;
+            delete rbefore;
+            delete rafter;
+        }
     }
     if (clone_) delete rt;
     RideMetricFactory::instance().mutex.unlock();
@@ -230,9 +245,12 @@ UserMetric::compute(RideItem *item, Specification spec, const QHash<QString,Ride
     if (!spec.isEmpty(item->ride()) && fbefore) {
         RideFileIterator it(item->ride(), spec, RideFileIterator::Before);
 
-        while(it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            root->eval(rt, fbefore, 0, 0, const_cast<RideItem*>(item), point, c, spec);
+        // column at a time if we can, otherwise sample by sample
+        if (!rbefore || !reductions || !rbefore->run(rt, item, c, spec, it)) {
+            while(it.hasNext()) {
+                struct RideFilePoint *point = it.next();
+                root->eval(rt, fbefore, 0, 0, const_cast<RideItem*>(item), point, c, spec);
+            }
         }
     }
 
@@ -241,9 +259,12 @@ UserMetric::compute(RideItem *item, Specification spec, const QHash<QString,Ride
     if (!spec.isEmpty(item->ride()) && fsample) {
         RideFileIterator it(item->ride(), spec);
 
-        while(it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            root->eval(rt, fsample, 0, 0, const_cast<RideItem*>(item), point, c, spec);
+        // column at a time if we can, otherwise sample by sample
+        if (!rsample || !reductions || !rsample->run(rt, item, c, spec, it)) {
+            while(it.hasNext()) {
+                struct RideFilePoint *point = it.next();
+                root->eval(rt, fsample, 0, 0, const_cast<RideItem*>(item), point, c, spec);
+            }
         }
     }
 
@@ -251,9 +272,12 @@ UserMetric::compute(RideItem *item, Specification spec, const QHash<QString,Ride
     if (!spec.isEmpty(item->ride()) && fafter) {
         RideFileIterator it(item->ride(), spec, RideFileIterator::After);
 
-        while(it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            root->eval(rt, fafter, 0, 0, const_cast<RideItem*>(item), point, c, spec);
+        // column at a time if we can, otherwise sample by sample
+        if (!rafter || !reductions || !rafter->run(rt, item, c, spec, it)) {
+            while(it.hasNext()) {
+                struct RideFilePoint *point = it.next();
+                root->eval(rt, fafter, 0, 0, const_cast<RideItem*>(item), point, c, spec);
+            }
         }
     }
 
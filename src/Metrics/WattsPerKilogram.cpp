@@ -18,6 +18,7 @@
 
 #include "RideMetric.h"
 #include "AddIntervalDialog.h"
+#include "BestEfforts.h"
 #include "RideItem.h"
 #include "Zones.h"
 #include "Context.h"
@@ -60,6 +61,7 @@ class AverageWPK : public RideMetric {
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new AverageWPK(*this); }
 };
 
@@ -91,13 +93,14 @@ class PeakWPK : public RideMetric {
 
         weight = item->ride()->getWeight();
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::watts, RideFile::original, secs, 1, results, "", "");
+        BestEfforts::findPeak(item, spec, RideFile::watts, secs, results);
         if (results.count() > 0 && results.first().avg < 3000) wpk = results.first().avg / weight;
         else wpk = 0.0;
         setValue(wpk);
     }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new PeakWPK(*this); }
 };
 
@@ -351,6 +354,7 @@ class Vo2max : public RideMetric {
     bool isRelevantForRide(const RideItem *ride) const {return ride->present.contains("P"); }
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputSamples; }
     RideMetric *clone() const { return new Vo2max(*this); }
 };
 
@@ -391,6 +395,7 @@ class EtimatedAverageWPK_DrF : public RideMetric {
 
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
+    int inputs() const { return InputWeight; }
     RideMetric *clone() const { return new EtimatedAverageWPK_DrF(*this); }
 };
 
@@ -182,7 +182,7 @@ RTool::RTool()
             // just a 1 item list with the current ride
             { "GC.activities", (DL_FUNC) &RTool::activities, 1 },
             { "GC.activity", (DL_FUNC) &RTool::activity, 4 },
-            { "GC.activity.metrics", (DL_FUNC) &RTool::activityMetrics, 1 },
+            { "GC.activity.metrics", (DL_FUNC) &RTool::activityMetrics, 2 },
             { "GC.activity.meanmax", (DL_FUNC) &RTool::activityMeanmax, 1 },
             { "GC.activity.wbal", (DL_FUNC) &RTool::activityWBal, 1 },
             // name="", compare=FALSE
@@ -192,7 +192,7 @@ RTool::RTool()
 
             // all=FALSE, compare=FALSE
             { "GC.season", (DL_FUNC) &RTool::season, 2 },
-            { "GC.season.metrics", (DL_FUNC) &RTool::metrics, 3 },
+            { "GC.season.metrics", (DL_FUNC) &RTool::metrics, 4 },
             // type=any, compare=FALSE
             { "GC.season.intervals", (DL_FUNC) &RTool::seasonIntervals, 2 },
             { "GC.season.meanmax", (DL_FUNC) &RTool::seasonMeanmax, 3 },
@@ -279,7 +279,7 @@ RTool::RTool()
                                // activity
                                "GC.activities <- function(filter=\"\") { .Call(\"GC.activities\", filter) }\n"
                                "GC.activity <- function(activity=0, compare=FALSE, split=0, join=\"repeat\") { .Call(\"GC.activity\", activity, compare, split, join) }\n"
-                               "GC.activity.metrics <- function(compare=FALSE) { .Call(\"GC.activity.metrics\", compare) }\n"
+                               "GC.activity.metrics <- function(compare=FALSE, columns=NULL) { .Call(\"GC.activity.metrics\", compare, columns) }\n"
                                "GC.activity.meanmax <- function(compare=FALSE) { .Call(\"GC.activity.meanmax\", compare) }\n"
                                "GC.activity.wbal <- function(compare=FALSE) { .Call(\"GC.activity.wbal\", compare) }\n"
                                "GC.activity.xdata <- function(name=\"\", compare=FALSE) { .Call(\"GC.activity.xdata\", name, compare) }\n"
@@ -287,7 +287,7 @@ RTool::RTool()
 
                                // season
                                "GC.season <- function(all=FALSE, compare=FALSE) { .Call(\"GC.season\", all, compare) }\n"
-                               "GC.season.metrics <- function(all=FALSE, filter=\"\", compare=FALSE) { .Call(\"GC.season.metrics\", all, filter, compare) }\n"
+                               "GC.season.metrics <- function(all=FALSE, filter=\"\", compare=FALSE, columns=NULL) { .Call(\"GC.season.metrics\", all, filter, compare, columns) }\n"
                                "GC.season.intervals <- function(type=NULL, compare=FALSE) { .Call(\"GC.season.intervals\", type, compare) }\n"
                                "GC.season.pmc <- function(all=FALSE, metric=\"BikeStress\") { .Call(\"GC.season.pmc\", all, metric) }\n"
                                "GC.season.measures <- function(all=FALSE, group=\"Body\") { .Call(\"GC.season.measures\", all, group) }\n"
@@ -300,7 +300,7 @@ RTool::RTool()
                                "   .Call(\"GC.season.peaks\", all, filter, compare, series, duration)"
                                "}\n"
                                // these 2 added for backward compatibility, may be deprecated
-                               "GC.metrics <- function(all=FALSE, filter=\"\", compare=FALSE) { .Call(\"GC.season.metrics\", all, filter, compare) }\n"
+                               "GC.metrics <- function(all=FALSE, filter=\"\", compare=FALSE, columns=NULL) { .Call(\"GC.season.metrics\", all, filter, compare, columns) }\n"
                                "GC.pmc <- function(all=FALSE, metric=\"BikeStress\") { .Call(\"GC.season.pmc\", all, metric) }\n"
 
                                // charts
@@ -993,200 +993,36 @@ RTool::activities(SEXP filter)
     return dates;
 }
 
-SEXP
-RTool::dfForRideItem(const RideItem *ri)
+QStringList
+RTool::columnsFor(SEXP pColumns)
 {
-    RideItem *item = const_cast<RideItem*>(ri);
-
-    const RideMetricFactory &factory = RideMetricFactory::instance();
-    int rides = rtool->context->athlete->rideCache->count();
-    int metrics = factory.metricCount();
-
-    // count the number of meta fields to add
-    int meta = 0;
-    if (rtool->context) {
-
-        // count active fields
-        foreach(FieldDefinition def, GlobalContext::context()->rideMetadata->getFields()) {
-            if (def.name != "" && def.tab != "" &&
-                !GlobalContext::context()->specialFields.isMetric(def.name))
-                meta++;
-        }
-    }
-
-    // just this ride !
-    rides = 1;
-
-    // get a listAllocated
-    SEXP ans;
-    SEXP names; // column names
-    SEXP rownames; // row names (numeric)
-
-    // +3 is for date and datetime and color
-    PROTECT(ans=Rf_allocVector(VECSXP, metrics+meta+3));
-    PROTECT(names = Rf_allocVector(STRSXP, metrics+meta+3));
-
-    // we have to give a name to each row
-    PROTECT(rownames = Rf_allocVector(STRSXP, rides));
-    for(int i=0; i<rides; i++) {
-        QString rownumber=QString("%1").arg(i+1);
-        SET_STRING_ELT(rownames, i, Rf_mkChar(rownumber.toLatin1().constData()));
-    }
-
-    // next name, nextS is next metric
-    int next=0;
-
-    // DATE
-    SEXP date;
-    PROTECT(date=Rf_allocVector(INTSXP, rides));
-    QDate d1970(1970,01,01);
-    INTEGER(date)[0] = d1970.daysTo(item->dateTime.date());
-
-    SEXP dclas;
-    PROTECT(dclas=Rf_allocVector(STRSXP, 1));
-    SET_STRING_ELT(dclas, 0, Rf_mkChar("Date"));
-    Rf_classgets(date,dclas);
-
-    // add to the data.frame and give it a name
-    SET_VECTOR_ELT(ans, next, date);
-    SET_STRING_ELT(names, next++, Rf_mkChar("date"));
-
-    // TIME
-    SEXP time;
-    PROTECT(time=Rf_allocVector(REALSXP, rides));
-    REAL(time)[0] = item->dateTime.toUTC().toTime_t();
-
-    // POSIXct class
-    SEXP clas;
-    PROTECT(clas=Rf_allocVector(STRSXP, 2));
-    SET_STRING_ELT(clas, 0, Rf_mkChar("POSIXct"));
-    SET_STRING_ELT(clas, 1, Rf_mkChar("POSIXt"));
-    Rf_classgets(time,clas);
-
-    // we use "UTC" for all timezone
-    Rf_setAttrib(time, Rf_install("tzone"), Rf_mkString("UTC"));
-
-    // add to the data.frame and give it a name
-    SET_VECTOR_ELT(ans, next, time);
-    SET_STRING_ELT(names, next++, Rf_mkChar("time"));
-
-    // time + clas, but not ans!
-    UNPROTECT(4);
-
-    //
-    // METRICS
-    //
-    for(int i=0; i<factory.metricCount();i++) {
-
-        // set a vector
-        SEXP m;
-        PROTECT(m=Rf_allocVector(REALSXP, rides));
-
-        QString symbol = factory.metricName(i);
-        const RideMetric *metric = factory.rideMetric(symbol);
-        QString name = GlobalContext::context()->specialFields.internalName(factory.rideMetric(symbol)->name());
-        name = name.replace(" ","_");
-        name = name.replace("'","_");
-
-        bool useMetricUnits = GlobalContext::context()->useMetricUnits;
-        REAL(m)[0] = item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion()) + (useMetricUnits ? 0.0f : metric->conversionSum());
-
-        // add to the list
-        SET_VECTOR_ELT(ans, next, m);
-
-        // give it a name
-        SET_STRING_ELT(names, next, Rf_mkChar(name.toLatin1().constData()));
-
-        next++;
-
-        // vector
-        UNPROTECT(1);
-    }
-
-    //
-    // META
-    //
-    foreach(FieldDefinition field, GlobalContext::context()->rideMetadata->getFields()) {
-
-        // don't add incomplete meta definitions or metric override fields
-        if (field.name == "" || field.tab == "" ||
-            GlobalContext::context()->specialFields.isMetric(field.name)) continue;
-
-        // Create a string vector
-        SEXP m;
-        PROTECT(m=Rf_allocVector(STRSXP, rides));
-        SET_STRING_ELT(m, 0, Rf_mkChar(item->getText(field.name, "").toLatin1().constData()));
-
-        // add to the list
-        SET_VECTOR_ELT(ans, next, m);
-
-        // give it a name
-        SET_STRING_ELT(names, next, Rf_mkChar(field.name.replace(" ","_").toLatin1().constData()));
-
-        next++;
-
-        // vector
-        UNPROTECT(1);
+    // NULL or empty means all of them
+    QStringList columns;
+    if (Rf_length(pColumns) == 0) return columns;
+
+    PROTECT(pColumns=Rf_coerceVector(pColumns, STRSXP));
+    for(int i=0; i<Rf_length(pColumns); i++) {
+        QString column(CHAR(STRING_ELT(pColumns,i)));
+        if (column != "") columns << column;
     }
-
-    // add Color
-    SEXP color;
-    PROTECT(color=Rf_allocVector(STRSXP, rides));
-
-    // apply item color, remembering that 1,1,1 means use default (reverse in this case)
-    if (item->color == QColor(1,1,1,1)) {
-
-        // use the inverted color, not plot marker as that hideous
-        QColor col =GCColor::invertColor(GColor(CPLOTBACKGROUND));
-
-        // white is jarring on a dark background!
-        if (col==QColor(Qt::white)) col=QColor(127,127,127);
-
-        SET_STRING_ELT(color, 0, Rf_mkChar(col.name().toLatin1().constData()));
-    } else
-        SET_STRING_ELT(color, 0, Rf_mkChar(item->color.name().toLatin1().constData()));
-
-    // add to the list and name it
-    SET_VECTOR_ELT(ans, next, color);
-    SET_STRING_ELT(names, next, Rf_mkChar("color"));
-    next++;
-
     UNPROTECT(1);
 
-    // turn the list into a data frame + set column names
-    Rf_setAttrib(ans, R_ClassSymbol, Rf_mkString("data.frame"));
-    Rf_setAttrib(ans, R_RowNamesSymbol, rownames);
-    Rf_namesgets(ans, names);
-
-    // ans + names
-    UNPROTECT(3);
-
-    // return it
-    return ans;
+    return columns;
 }
 
 SEXP
-RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
+RTool::dfForRideItem(const RideItem *ri, QStringList columns)
 {
-    const RideMetricFactory &factory = RideMetricFactory::instance();
-    int rides = rtool->context->athlete->rideCache->count();
-    int metrics = factory.metricCount();
-
-    // count the number of meta fields to add
-    int meta = 0;
-    if (rtool->context) {
-
-        // count active fields
-        foreach(FieldDefinition def, GlobalContext::context()->rideMetadata->getFields()) {
-            if (def.name != "" && def.tab != "" &&
-                !GlobalContext::context()->specialFields.isMetric(def.name))
-                meta++;
-        }
-    }
+    // just this ride !
+    QVector<RideItem*> items;
+    items << const_cast<RideItem*>(ri);
 
-    // how many rides to return if we're limiting to the
-    // currently selected date range ?
+    return dfForRideItems(items, columns);
+}
 
+SEXP
+RTool::dfForDateRange(bool all, DateRange range, SEXP filter, QStringList columns)
+{
     // apply any global filters
     Specification specification;
     FilterSet fs;
@@ -1211,21 +1047,65 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     specification.setFilterSet(fs);
     UNPROTECT(1);
 
-    // we need to count rides that are in range...
-    rides = 0;
+    // the rides that are in range, once, rather than
+    // checking the specification for every column
+    QVector<RideItem*> items;
     foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
         if (!specification.pass(ride)) continue;
-        if (all || range.pass(ride->dateTime.date())) rides++;
+        if (all || range.pass(ride->dateTime.date())) items << ride;
     }
 
+    return dfForRideItems(items, columns);
+}
+
+SEXP
+RTool::dfForRideItems(QVector<RideItem*> items, QStringList columns)
+{
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    int rides = items.count();
+
+    // work out which columns are wanted before allocating anything,
+    // a script that only uses a couple of them doesn't need to pay
+    // for all the metrics and metadata in every row
+    bool wantdate = columns.isEmpty() || columns.contains("date");
+    bool wanttime = columns.isEmpty() || columns.contains("time");
+    bool wantcolor = columns.isEmpty() || columns.contains("color");
+
+    QList<int> metrics;
+    QStringList metricnames;
+    for(int i=0; i<factory.metricCount();i++) {
+
+        QString symbol = factory.metricName(i);
+        QString name = GlobalContext::context()->specialFields.internalName(factory.rideMetric(symbol)->name());
+        name = name.replace(" ","_");
+        name = name.replace("'","_");
+
+        if (columns.isEmpty() || columns.contains(name)) {
+            metrics << i;
+            metricnames << name;
+        }
+    }
+
+    QList<FieldDefinition> meta;
+    foreach(FieldDefinition field, GlobalContext::context()->rideMetadata->getFields()) {
+
+        // don't add incomplete meta definitions or metric override fields
+        if (field.name == "" || field.tab == "" ||
+            GlobalContext::context()->specialFields.isMetric(field.name)) continue;
+
+        if (columns.isEmpty() || columns.contains(QString(field.name).replace(" ","_")))
+            meta << field;
+    }
+
+    int count = (wantdate ? 1 : 0) + (wanttime ? 1 : 0) + metrics.count() + meta.count() + (wantcolor ? 1 : 0);
+
     // get a listAllocated
     SEXP ans;
     SEXP names; // column names
     SEXP rownames; // row names (numeric)
 
-    // +3 is for date and datetime and color
-    PROTECT(ans=Rf_allocVector(VECSXP, metrics+meta+3));
-    PROTECT(names = Rf_allocVector(STRSXP, metrics+meta+3));
+    PROTECT(ans=Rf_allocVector(VECSXP, count));
+    PROTECT(names = Rf_allocVector(STRSXP, count));
 
     // we have to give a name to each row
     PROTECT(rownames = Rf_allocVector(STRSXP, rides));
@@ -1238,86 +1118,77 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     int next=0;
 
     // DATE
-    SEXP date;
-    PROTECT(date=Rf_allocVector(INTSXP, rides));
+    if (wantdate) {
+        SEXP date;
+        PROTECT(date=Rf_allocVector(INTSXP, rides));
 
-    int k=0;
-    QDate d1970(1970,01,01);
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (all || range.pass(ride->dateTime.date()))
-            INTEGER(date)[k++] = d1970.daysTo(ride->dateTime.date());
-    }
+        QDate d1970(1970,01,01);
+        for(int k=0; k<rides; k++)
+            INTEGER(date)[k] = d1970.daysTo(items[k]->dateTime.date());
 
-    SEXP dclas;
-    PROTECT(dclas=Rf_allocVector(STRSXP, 1));
-    SET_STRING_ELT(dclas, 0, Rf_mkChar("Date"));
-    Rf_classgets(date,dclas);
+        SEXP dclas;
+        PROTECT(dclas=Rf_allocVector(STRSXP, 1));
+        SET_STRING_ELT(dclas, 0, Rf_mkChar("Date"));
+        Rf_classgets(date,dclas);
 
-    // add to the data.frame and give it a name
-    SET_VECTOR_ELT(ans, next, date);
-    SET_STRING_ELT(names, next++, Rf_mkChar("date"));
+        // add to the data.frame and give it a name
+        SET_VECTOR_ELT(ans, next, date);
+        SET_STRING_ELT(names, next++, Rf_mkChar("date"));
+
+        // date + dclas, but not ans!
+        UNPROTECT(2);
+    }
 
     // TIME
-    SEXP time;
-    PROTECT(time=Rf_allocVector(REALSXP, rides));
+    if (wanttime) {
+        SEXP time;
+        PROTECT(time=Rf_allocVector(REALSXP, rides));
 
-    // fill with values for date and class if its one we need to return
-    k=0;
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (all || range.pass(ride->dateTime.date()))
-            REAL(time)[k++] = ride->dateTime.toUTC().toTime_t();
-    }
+        for(int k=0; k<rides; k++)
+            REAL(time)[k] = items[k]->dateTime.toUTC().toTime_t();
 
-    // POSIXct class
-    SEXP clas;
-    PROTECT(clas=Rf_allocVector(STRSXP, 2));
-    SET_STRING_ELT(clas, 0, Rf_mkChar("POSIXct"));
-    SET_STRING_ELT(clas, 1, Rf_mkChar("POSIXt"));
-    Rf_classgets(time,clas);
+        // POSIXct class
+        SEXP clas;
+        PROTECT(clas=Rf_allocVector(STRSXP, 2));
+        SET_STRING_ELT(clas, 0, Rf_mkChar("POSIXct"));
+        SET_STRING_ELT(clas, 1, Rf_mkChar("POSIXt"));
+        Rf_classgets(time,clas);
 
-    // we use "UTC" for all timezone
-    Rf_setAttrib(time, Rf_install("tzone"), Rf_mkString("UTC"));
+        // we use "UTC" for all timezone
+        Rf_setAttrib(time, Rf_install("tzone"), Rf_mkString("UTC"));
 
-    // add to the data.frame and give it a name
-    SET_VECTOR_ELT(ans, next, time);
-    SET_STRING_ELT(names, next++, Rf_mkChar("time"));
+        // add to the data.frame and give it a name
+        SET_VECTOR_ELT(ans, next, time);
+        SET_STRING_ELT(names, next++, Rf_mkChar("time"));
 
-    // time + clas, but not ans!
-    UNPROTECT(4);
+        // time + clas, but not ans!
+        UNPROTECT(2);
+    }
 
     //
     // METRICS
     //
-    for(int i=0; i<factory.metricCount();i++) {
+    bool useMetricUnits = GlobalContext::context()->useMetricUnits;
+    for(int j=0; j<metrics.count(); j++) {
+
+        int i = metrics[j];
+        const RideMetric *metric = factory.rideMetric(factory.metricName(i));
+        double multiplier = useMetricUnits ? 1.0f : metric->conversion();
+        double offset = useMetricUnits ? 0.0f : metric->conversionSum();
 
         // set a vector
         SEXP m;
         PROTECT(m=Rf_allocVector(REALSXP, rides));
 
-        QString symbol = factory.metricName(i);
-        const RideMetric *metric = factory.rideMetric(symbol);
-        QString name = GlobalContext::context()->specialFields.internalName(factory.rideMetric(symbol)->name());
-        name = name.replace(" ","_");
-        name = name.replace("'","_");
-
-        bool useMetricUnits = GlobalContext::context()->useMetricUnits;
-
-        int index=0;
-        foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-            if (!specification.pass(item)) continue;
-            if (all || range.pass(item->dateTime.date())) {
-                REAL(m)[index++] = item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion())
-                                                      + (useMetricUnits ? 0.0f : metric->conversionSum());
-            }
-        }
+        double *values = REAL(m);
+        for(int k=0; k<rides; k++)
+            values[k] = items[k]->metrics()[i] * multiplier + offset;
 
         // add to the list
         SET_VECTOR_ELT(ans, next, m);
 
         // give it a name
-        SET_STRING_ELT(names, next, Rf_mkChar(name.toLatin1().constData()));
+        SET_STRING_ELT(names, next, Rf_mkChar(metricnames[j].toLatin1().constData()));
 
         next++;
 
@@ -1328,23 +1199,14 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     //
     // META
     //
-    foreach(FieldDefinition field, GlobalContext::context()->rideMetadata->getFields()) {
-
-        // don't add incomplete meta definitions or metric override fields
-        if (field.name == "" || field.tab == "" ||
-            GlobalContext::context()->specialFields.isMetric(field.name)) continue;
+    foreach(FieldDefinition field, meta) {
 
         // Create a string vector
         SEXP m;
         PROTECT(m=Rf_allocVector(STRSXP, rides));
 
-        int index=0;
-        foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-            if (!specification.pass(item)) continue;
-            if (all || range.pass(item->dateTime.date())) {
-                SET_STRING_ELT(m, index++, Rf_mkChar(item->getText(field.name, "").toLatin1().constData()));
-            }
-        }
+        for(int k=0; k<rides; k++)
+            SET_STRING_ELT(m, k, Rf_mkChar(items[k]->getText(field.name, "").toLatin1().constData()));
 
         // add to the list
         SET_VECTOR_ELT(ans, next, m);
@@ -1359,35 +1221,32 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     }
 
     // add Color
-    SEXP color;
-    PROTECT(color=Rf_allocVector(STRSXP, rides));
+    if (wantcolor) {
+        SEXP color;
+        PROTECT(color=Rf_allocVector(STRSXP, rides));
 
-    int index=0;
-    foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(item)) continue;
-        if (all || range.pass(item->dateTime.date())) {
-
-            // apply item color, remembering that 1,1,1 means use default (reverse in this case)
-            if (item->color == QColor(1,1,1,1)) {
+        // use the inverted color, not plot marker as that hideous
+        QColor inverted = GCColor::invertColor(GColor(CPLOTBACKGROUND));
 
-                // use the inverted color, not plot marker as that hideous
-                QColor col =GCColor::invertColor(GColor(CPLOTBACKGROUND));
+        // white is jarring on a dark background!
+        if (inverted==QColor(Qt::white)) inverted=QColor(127,127,127);
 
-                // white is jarring on a dark background!
-                if (col==QColor(Qt::white)) col=QColor(127,127,127);
+        for(int k=0; k<rides; k++) {
 
-                SET_STRING_ELT(color, index++, Rf_mkChar(col.name().toLatin1().constData()));
-            } else
-                SET_STRING_ELT(color, index++, Rf_mkChar(item->color.name().toLatin1().constData()));
+            // apply item color, remembering that 1,1,1 means use default (reverse in this case)
+            if (items[k]->color == QColor(1,1,1,1))
+                SET_STRING_ELT(color, k, Rf_mkChar(inverted.name().toLatin1().constData()));
+            else
+                SET_STRING_ELT(color, k, Rf_mkChar(items[k]->color.name().toLatin1().constData()));
         }
-    }
 
-    // add to the list and name it
-    SET_VECTOR_ELT(ans, next, color);
-    SET_STRING_ELT(names, next, Rf_mkChar("color"));
-    next++;
+        // add to the list and name it
+        SET_VECTOR_ELT(ans, next, color);
+        SET_STRING_ELT(names, next, Rf_mkChar("color"));
+        next++;
 
-    UNPROTECT(1);
+        UNPROTECT(1);
+    }
 
     // turn the list into a data frame + set column names
     Rf_setAttrib(ans, R_ClassSymbol, Rf_mkString("data.frame"));
@@ -2044,7 +1903,7 @@ RTool::activityIntervals(SEXP pTypes, SEXP datetime)
 }
 
 SEXP
-RTool::metrics(SEXP pAll, SEXP pFilter, SEXP pCompare)
+RTool::metrics(SEXP pAll, SEXP pFilter, SEXP pCompare, SEXP pColumns)
 {
     // p1 - all=TRUE|FALSE - return all metrics or just within
     //                       the currently selected date range
@@ -2055,6 +1914,9 @@ RTool::metrics(SEXP pAll, SEXP pFilter, SEXP pCompare)
     pCompare = Rf_coerceVector(pCompare, LGLSXP);
     bool compare = LOGICAL(pCompare)[0];
 
+    // p4 - columns=c(...) - just these columns, all if NULL
+    QStringList columns = columnsFor(pColumns);
+
     // want a list of compares not a dataframe
     if (compare && rtool->context) {
 
@@ -2087,7 +1949,7 @@ RTool::metrics(SEXP pAll, SEXP pFilter, SEXP pCompare)
                     PROTECT(namedlist=Rf_allocVector(VECSXP, 2));
 
                     // add the ride
-                    SEXP df = rtool->dfForDateRange(all, DateRange(p.start, p.end), pFilter);
+                    SEXP df = rtool->dfForDateRange(all, DateRange(p.start, p.end), pFilter, columns);
                     SET_VECTOR_ELT(namedlist, 0, df);
 
                     // add the color
@@ -2127,7 +1989,7 @@ RTool::metrics(SEXP pAll, SEXP pFilter, SEXP pCompare)
 
             // add the metrics
             DateRange range = rtool->context->currentDateRange();
-            SEXP df = rtool->dfForDateRange(all, range, pFilter);
+            SEXP df = rtool->dfForDateRange(all, range, pFilter, columns);
             SET_VECTOR_ELT(namedlist, 0, df);
 
             // add the color
@@ -2150,7 +2012,7 @@ RTool::metrics(SEXP pAll, SEXP pFilter, SEXP pCompare)
 
         // just a datafram of metrics
         DateRange range = rtool->context->currentDateRange();
-        return rtool->dfForDateRange(all, range, pFilter);
+        return rtool->dfForDateRange(all, range, pFilter, columns);
 
     }
 
@@ -3231,7 +3093,7 @@ RTool::activityMeanmax(SEXP pCompare)
 }
 
 SEXP
-RTool::activityMetrics(SEXP pCompare)
+RTool::activityMetrics(SEXP pCompare, SEXP pColumns)
 {
     // a dataframe to return
     SEXP ans=NULL;
@@ -3240,6 +3102,9 @@ RTool::activityMetrics(SEXP pCompare)
     pCompare = Rf_coerceVector(pCompare, LGLSXP);
     bool compare = LOGICAL(pCompare)[0];
 
+    // p2 - columns=c(...) - just these columns, all if NULL
+    QStringList columns = columnsFor(pColumns);
+
     // return a list
     if (compare && rtool->context) {
 
@@ -3272,7 +3137,7 @@ RTool::activityMetrics(SEXP pCompare)
                     PROTECT(namedlist=Rf_allocVector(VECSXP, 2));
 
                     // add the ride
-                    SEXP df = rtool->dfForRideItem(p.rideItem);
+                    SEXP df = rtool->dfForRideItem(p.rideItem, columns);
                     SET_VECTOR_ELT(namedlist, 0, df);
 
                     // add the color
@@ -3312,7 +3177,7 @@ RTool::activityMetrics(SEXP pCompare)
             PROTECT(namedlist=Rf_allocVector(VECSXP, 2));
 
             // add the ride
-            SEXP df = rtool->dfForRideItem(rtool->context->currentRideItem());
+            SEXP df = rtool->dfForRideItem(rtool->context->currentRideItem(), columns);
             SET_VECTOR_ELT(namedlist, 0, df);
 
             // add the color
@@ -3337,7 +3202,7 @@ RTool::activityMetrics(SEXP pCompare)
         if(rtool->context && rtool->context->currentRideItem() && const_cast<RideItem*>(rtool->context->currentRideItem())->ride()) {
 
             // get as a data frame
-            ans = rtool->dfForRideItem(rtool->context->currentRideItem());
+            ans = rtool->dfForRideItem(rtool->context->currentRideItem(), columns);
             return ans;
         }
     }
@@ -57,12 +57,12 @@ class RTool {
         static SEXP activityMeanmax(SEXP compare);
         static SEXP activityWBal(SEXP compare);
         static SEXP activityXData(SEXP name, SEXP compare);
-        static SEXP activityMetrics(SEXP compare);
+        static SEXP activityMetrics(SEXP compare, SEXP columns);
         static SEXP activityIntervals(SEXP type, SEXP datetime);
 
         // seasons
         static SEXP season(SEXP all, SEXP compare);
-        static SEXP metrics(SEXP all, SEXP filter, SEXP compare);
+        static SEXP metrics(SEXP all, SEXP filter, SEXP compare, SEXP columns);
         static SEXP seasonIntervals(SEXP type, SEXP compare);
         static SEXP seasonMeanmax(SEXP all, SEXP filter, SEXP compare);
         static SEXP seasonPeaks(SEXP all, SEXP filter, SEXP compare, SEXP series, SEXP duration);
@@ -112,8 +112,10 @@ class RTool {
         SEXP dfForActivityWBal(RideFile *f);            // returns w' bal series for an activity
         SEXP dfForActivityXData(RideFile *f, QString name); // returns XData series by name for an activity
         SEXP dfForActivityMeanmax(const RideItem *i);   // returns mean maximals for an activity
-        SEXP dfForRideItem(const RideItem *i);          // returns metrics and meradata for an activity
-        SEXP dfForDateRange(bool all, DateRange range, SEXP filter); // returns metrics and metadata for a season
+        SEXP dfForRideItem(const RideItem *i, QStringList columns); // returns metrics and meradata for an activity
+        SEXP dfForDateRange(bool all, DateRange range, SEXP filter, QStringList columns); // returns metrics and metadata for a season
+        SEXP dfForRideItems(QVector<RideItem*> items, QStringList columns); // metrics and metadata for rides, just the columns asked for
+        static QStringList columnsFor(SEXP columns);    // columns asked for, empty means all of them
         SEXP dfForDateRangeIntervals(DateRange range, QStringList types); // returns metrics and metadata for a season
         SEXP dfForDateRangeMeanmax(bool all, DateRange range, SEXP filter); // returns the meanmax for a season
         SEXP dfForDateRangePeaks(bool all, DateRange range, SEXP filter, QList<RideFile::SeriesType> series, QList<int> durations);
@@ -22,6 +22,7 @@
 #include "Settings.h"
 #include "LibraryParser.h"
 #include "TrainDB.h"
+#include "Zones.h"
 #include "HelpWhatsThis.h"
 #include <QVBoxLayout>
 #include <QHeaderView>
@@ -29,6 +30,7 @@
 #include <QApplication>
 #include <QDirIterator>
 #include <QFileInfo>
+#include <QtConcurrent>
 
 // helpers
 #if defined(GC_VIDEO_AV) || defined(GC_VIDEO_QUICKTIME)
@@ -601,33 +603,109 @@ LibrarySearchDialog::removeReference()
     }
 }
 
+//
+// Workouts are parsed in a worker pool, the results are
+// imported on the main thread which owns the db connection
+//
+struct WorkoutParser {
+    typedef ErgFile *result_type;
+
+    WorkoutParser(Context *context) : context(context) {}
+    ErgFile *operator()(const QString &filename) const {
+        ErgFile *file = new ErgFile(filename, 0, context);
+        if (file->isValid()) return file;
+        delete file;
+        return NULL;
+    }
+
+    Context *context;
+};
+
+// files with the same size and modified time as last time are
+// unchanged, if only the modified time changed we compare the
+// contents hash before deciding to parse it again
+static bool
+unchangedWorkout(QString pathname, double cp, const QHash<QString, TrainDB::Signature> &known,
+                 QHash<QString, TrainDB::Signature> &signatures)
+{
+    TrainDB::Signature sig = TrainDB::signature(pathname, false);
+    TrainDB::Signature was = known.value(pathname);
+    bool samesize = known.contains(pathname) && was.size == sig.size;
+
+    if (samesize && was.modified == sig.modified) sig.hash = was.hash;
+    else sig.hash = TrainDB::signature(pathname, true).hash;
+    sig.cp = cp;
+
+    signatures.insert(pathname, sig);
+    return samesize && sig.hash == was.hash && sig.cp == was.cp;
+}
+
 void
 LibrarySearchDialog::updateDB()
 {
-    // wipe away all user data before updating
-    trainDB->rebuildDB();
+    // workout metrics depend upon CP
+    double cp = 0;
+    if (context->athlete->zones(false)) {
+        int zonerange = context->athlete->zones(false)->whichRange(QDate::currentDate());
+        if (zonerange >= 0) cp = context->athlete->zones(false)->getCP(zonerange);
+    }
 
-    trainDB->startLUW();
+    // what we have already, rather than wiping it all away
+    // we only update what has changed since the last search
+    QHash<QString, TrainDB::Signature> known = trainDB->getSignatures();
+    QSet<QString> haveWorkouts = trainDB->getFilepaths("workouts");
+    QSet<QString> haveVideos = trainDB->getFilepaths("videos");
+    QSet<QString> haveVideoSyncs = trainDB->getFilepaths("videosyncs");
 
-    // workouts
+    QHash<QString, TrainDB::Signature> signatures;
+    QStringList parse;
     foreach(QString ergFile, workoutsFound) {
-        int mode=0;
-        ErgFile file(ergFile, mode, context);
-        if (file.isValid()) {
-            trainDB->importWorkout(ergFile, &file);
+        if (!unchangedWorkout(ergFile, cp, known, signatures) || !haveWorkouts.contains(ergFile))
+            parse << ergFile;
+    }
+
+    trainDB->startLUW();
+
+    // remove whatever wasn't found this time (the default
+    // entries start with "//"), references are re-added below
+    QSet<QString> found = workoutsFound.toSet();
+    foreach(QString path, haveWorkouts)
+        if (!path.startsWith("//") && !found.contains(path)) trainDB->deleteWorkout(path);
+    found = videosFound.toSet();
+    foreach(QString path, haveVideos)
+        if (!path.startsWith("//") && !found.contains(path)) trainDB->deleteVideo(path);
+    found = videosyncsFound.toSet();
+    foreach(QString path, haveVideoSyncs)
+        if (!path.startsWith("//") && !found.contains(path)) trainDB->deleteVideoSync(path);
+    foreach(QString path, known.keys())
+        if (!signatures.contains(path)) trainDB->deleteSignature(path);
+
+    // workouts, a chunk at a time so we don't hold
+    // too many parsed files in memory at once
+    WorkoutParser parser(context);
+    const int chunk = 64;
+    for(int i=0; i<parse.count(); i += chunk) {
+        QStringList batch = parse.mid(i, chunk);
+        QList<ErgFile*> files = QtConcurrent::blockingMapped<QList<ErgFile*> >(batch, parser);
+        for(int j=0; j<batch.count(); j++) {
+            if (files[j]) {
+                trainDB->importWorkout(batch[j], files[j]);
+                delete files[j];
+            } else {
+                trainDB->deleteWorkout(batch[j]);
+            }
         }
     }
+    foreach(QString path, signatures.keys()) trainDB->setSignature(path, signatures.value(path));
 
     // videos
     foreach(QString video, videosFound) {
-        trainDB->importVideo(video);
+        if (!haveVideos.contains(video)) trainDB->importVideo(video);
     }
 
-    // videosyncs
+    // videosyncs, the file contents are not used by the db
     foreach(QString videosync, videosyncsFound) {
-        int mode=0;
-        VideoSyncFile file(videosync, mode, context);
-        trainDB->importVideoSync(videosync, &file);
+        if (!haveVideoSyncs.contains(videosync)) trainDB->importVideoSync(videosync, NULL);
     }
 
     // Now check and re-add references, if there are any
@@ -20,6 +20,8 @@
 #include "ErgFile.h"
 #include "VideoSyncFile.h"
 
+#include <QCryptographicHash>
+
 // DB Schema Version - YOU MUST UPDATE THIS IF THE TRAIN DB SCHEMA CHANGES
 
 // Revision History
@@ -225,6 +227,39 @@ bool TrainDB::createWorkoutTable()
     return rc;
 }
 
+// signatures are not user data, they are not dropped
+// when the library is rebuilt so a rescan can use them
+bool TrainDB::createSignatureTable()
+{
+    QSqlQuery query(db->database(sessionid));
+    bool rc;
+    bool createTables = true;
+
+    // does the table exist?
+    rc = query.exec("SELECT name FROM sqlite_master WHERE type='table' ORDER BY name;");
+    if (rc) {
+        while (query.next()) {
+
+            QString table = query.value(0).toString();
+            if (table == "signatures") {
+                createTables = false;
+                break;
+            }
+        }
+    }
+    // we need to create it!
+    if (rc && createTables) {
+        QString createSignatureTable = "create table signatures (filepath varchar primary key,"
+                                    "size integer,"
+                                    "modified integer,"
+                                    "hash varchar,"
+                                    "cp double);";
+
+        rc = query.exec(createSignatureTable);
+    }
+    return rc;
+}
+
 bool TrainDB::dropVideoTable()
 {
     QSqlQuery query("DROP TABLE videos", db->database(sessionid));
@@ -255,6 +290,7 @@ bool TrainDB::createDatabase()
 	createWorkoutTable();
 	createVideoTable();
 	createVideoSyncTable();
+	createSignatureTable();
 
     return true;
 }
@@ -476,6 +512,77 @@ bool TrainDB::importVideo(QString pathname)
 	return rc;
 }
 
+TrainDB::Signature TrainDB::signature(QString pathname, bool withHash)
+{
+    Signature returning;
+    QFileInfo info(pathname);
+    returning.size = info.size();
+    returning.modified = info.lastModified().toMSecsSinceEpoch();
+
+    // hashing means reading the whole file, so only when needed
+    if (withHash) {
+        QFile file(pathname);
+        if (file.open(QIODevice::ReadOnly)) {
+            QCryptographicHash hash(QCryptographicHash::Md5);
+            hash.addData(&file);
+            returning.hash = QString(hash.result().toHex());
+        }
+    }
+    return returning;
+}
+
+QHash<QString, TrainDB::Signature> TrainDB::getSignatures()
+{
+    QHash<QString, Signature> returning;
+
+    QSqlQuery query("SELECT filepath, size, modified, hash, cp FROM signatures;", db->database(sessionid));
+    if (query.exec()) {
+        while (query.next()) {
+            Signature sig;
+            sig.size = query.value(1).toLongLong();
+            sig.modified = query.value(2).toLongLong();
+            sig.hash = query.value(3).toString();
+            sig.cp = query.value(4).toDouble();
+            returning.insert(query.value(0).toString(), sig);
+        }
+    }
+    return returning;
+}
+
+bool TrainDB::setSignature(QString pathname, const Signature &sig)
+{
+	QSqlQuery query(db->database(sessionid));
+
+    query.prepare("INSERT OR REPLACE INTO signatures ( filepath, size, modified, hash, cp ) values ( ?,?,?,?,? );");
+	query.addBindValue(pathname);
+	query.addBindValue(sig.size);
+	query.addBindValue(sig.modified);
+	query.addBindValue(sig.hash);
+	query.addBindValue(sig.cp);
+
+    return query.exec();
+}
+
+bool TrainDB::deleteSignature(QString pathname)
+{
+	QSqlQuery query(db->database(sessionid));
+
+    query.prepare("DELETE FROM signatures WHERE filepath = ?;");
+    query.addBindValue(pathname);
+    return query.exec();
+}
+
+QSet<QString> TrainDB::getFilepaths(QString table)
+{
+    QSet<QString> returning;
+
+    QSqlQuery query(QString("SELECT filepath FROM %1;").arg(table), db->database(sessionid));
+    if (query.exec()) {
+        while (query.next()) returning << query.value(0).toString();
+    }
+    return returning;
+}
+
 bool TrainDB::createDefaultEntriesWorkout()
 {
 
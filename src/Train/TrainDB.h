@@ -23,6 +23,7 @@
 #include <QMessageBox>
 #include <QDir>
 #include <QHash>
+#include <QSet>
 #include <QtSql>
 
 class ErgFile;
@@ -61,6 +62,23 @@ class TrainDB : public QObject
     bool importVideoSync(QString pathname, VideoSyncFile *videosyncFile);
     bool deleteVideoSync(QString pathname);
 
+    // file signatures so a library rescan can skip unchanged files
+    // cp is the CP workout metrics were computed with, they need
+    // recomputing if it changes even when the file has not
+    struct Signature {
+        Signature() : size(0), modified(0), cp(0) {}
+        qint64 size, modified;
+        QString hash;
+        double cp;
+    };
+    static Signature signature(QString pathname, bool withHash);
+    QHash<QString, Signature> getSignatures();
+    bool setSignature(QString pathname, const Signature &);
+    bool deleteSignature(QString pathname);
+
+    // all the filepaths in a table (workouts, videos, videosyncs)
+    QSet<QString> getFilepaths(QString table);
+
     // for 3.3
     bool upgradeDefaultEntriesWorkout();
 
@@ -84,6 +102,7 @@ class TrainDB : public QObject
         bool dropVideoTable();
         bool createVideoSyncTable();
         bool dropVideoSyncTable();
+        bool createSignatureTable();
 
         bool createDefaultEntriesWorkout();
         bool createDefaultEntriesVideosync();
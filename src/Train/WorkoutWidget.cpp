@@ -31,6 +31,7 @@
 #include <QMessageBox>
 #include <QFontMetrics>
 #include <QRegExp>
+#include <QtConcurrent>
 
 #include <cmath>
 #include <float.h> // DBL_EPSILON
@@ -85,7 +86,8 @@ void WorkoutWidget::adjustLayout()
 }
 
 WorkoutWidget::WorkoutWidget(WorkoutWindow *parent, Context *context) :
-    QWidget(parent),  state(none), ergFile(NULL), dragging(NULL), parent(parent), context(context), stackptr(0), recording_(false)
+    QWidget(parent),  state(none), ergFile(NULL), dragging(NULL), parent(parent), context(context), stackptr(0), recording_(false),
+    computed(NULL), computing(NULL), pending(NULL)
 {
     minVX_=0;
     maxVX_=maxWX_=3600;
@@ -109,9 +111,19 @@ WorkoutWidget::WorkoutWidget(WorkoutWindow *parent, Context *context) :
     connect(context, SIGNAL(configChanged(qint32)), this, SLOT(configChanged(qint32)));
     connect(context, SIGNAL(telemetryUpdate(RealtimeData)), this, SLOT(telemetryUpdate(RealtimeData)));
     connect(context, SIGNAL(setNow(long)), this, SLOT(setNow(long)));
+    connect(&watcher, SIGNAL(finished()), this, SLOT(recomputed()));
     configChanged(CONFIG_APPEARANCE);
 }
 
+WorkoutWidget::~WorkoutWidget()
+{
+    // the worker uses them
+    future.waitForFinished();
+    delete computed;
+    delete computing;
+    delete pending;
+}
+
 void
 WorkoutWidget::updateErgFile(ErgFile *f)
 {
@@ -1572,7 +1584,6 @@ WorkoutWidget::recompute(bool editing)
 
     // truncate
     wattsArray.resize(0);
-    mmpArray.resize(0);
 
     // running time and watts for interpolating
     int ctime = 0;
@@ -1652,38 +1663,132 @@ WorkoutWidget::recompute(bool editing)
     parent->IFlabel->setText(QString("%1 Intensity").arg(IF, 0, 'f', 2));
     parent->TSSlabel->setText(QString("%1 Stress").arg(BikeStress, 0, 'f', 0));
 
+    //
+    // W'BAL, MEAN MAX AND TTE EFFORTS
+    //
+    // these are done on a worker and the results swapped in
+    // when they are ready, see recomputeWorker() below
+    WWRecompute *job = new WWRecompute;
+    job->context = context;
+    job->watts = wattsArray;
+    job->CP = CP;
+    job->WPRIME = WPRIME;
+    job->K = K;
+    startRecompute(job);
+
+    // set the properties if not editing
+    if (!editing) {
+        qwkactive = true;
+        parent->code->document()->setPlainText(qwkcode());
+        qwkactive = false;
+    }
+
+    // update scrollbar e.g. when pasting and workout gets longer
+    parent->setScroller(QPointF(minVX_,maxVX_));
+}
+
+void
+WorkoutWidget::startRecompute(WWRecompute *job)
+{
+    // busy, so do the latest when it finishes
+    if (computing) {
+        delete pending;
+        pending = job;
+        return;
+    }
+
+    computing = job;
+    future = QtConcurrent::run(WorkoutWidget::recomputeWorker, job, computed);
+    watcher.setFuture(future);
+}
+
+void
+WorkoutWidget::recomputed()
+{
+    // swap in the results, they're the starting point for next time
+    delete computed;
+    computed = computing;
+    computing = NULL;
+
+    wpBal = computed->wpBal;
+    mmpArray = computed->mmp;
+    mmpOffsets = computed->offsets;
+    efforts = computed->efforts;
+    update();
+
+    // edited whilst we were busy
+    if (pending) {
+        WWRecompute *job = pending;
+        pending = NULL;
+        startRecompute(job);
+    }
+}
+
+void
+WorkoutWidget::recomputeWorker(WWRecompute *job, const WWRecompute *base)
+{
+    int CP = job->CP;
+    int WPRIME = job->WPRIME;
+    int K = job->K;
+
     //
     // COMPUTE W'BAL
     //
-    wpBal.setWatts(context, wattsArray, CP, WPRIME);
+    job->wpBal.setWatts(job->context, job->watts, CP, WPRIME);
 
     //
     // MEAN MAX [works but need to think about UI]
     //
-    RideFileCache::fastSearch(wattsArray, mmpArray, mmpOffsets);
-    //qDebug()<<"RECOMPUTE:"<<timer.elapsed()<<"ms"<<wattsArray.count()<<"samples";
+    RideFileCache::fastSearch(job->watts, job->mmp, job->offsets);
 
     //
     // SEARCH FOR IMPOSSIBLE TTE SECTIONS
     //
     QVector<long> integrated;
-    integrated.resize(wattsArray.size());
+    integrated.resize(job->watts.size());
     long rt=0;
-    int secs=wattsArray.size();
-    for(int i=0; i<wattsArray.size(); i++) {
-        rt += wattsArray[i];
+    int secs=job->watts.size();
+    for(int i=0; i<job->watts.size(); i++) {
+        rt += job->watts[i];
         integrated[i] = rt;
     }
 
-    // clear what we found last time
-    efforts.clear();
+    // searching from i only looks at the hour that follows it, so
+    // everything up to an hour before the first second that changed
+    // will be found again just the same; we resume from there
+    int resume = 0;
+    if (base && base->CP == CP && base->WPRIME == WPRIME && base->K == K) {
+        int changed = 0;
+        int common = qMin(secs, base->watts.size());
+        while (changed < common && base->watts[changed] == job->watts[changed]) changed++;
+
+        if (changed > 3600) resume = qMin((changed - 3600) / WWRESUME, base->state[0].count()-1);
+        if (resume > base->state[1].count()-1) resume = base->state[1].count()-1;
+        if (resume < 0) resume = 0;
+    }
 
     for (int j=0; j<2; j++) {
 
         // 2 iterations:- 85% sustained, then 100% or higher
         WWEffort tte; tte.start = tte.duration = 0;
 
-        for (int i=0; i<secs; i++) {
+        // carry on from where we were
+        int from = 0;
+        if (resume > 0) {
+            from = resume * WWRESUME;
+            tte = base->state[j][resume];
+            job->found[j] = base->found[j].mid(0, base->count[j][resume]);
+            job->state[j] = base->state[j].mid(0, resume);
+            job->count[j] = base->count[j].mid(0, resume);
+        }
+
+        for (int i=from; i<secs; i++) {
+
+            // remember where we were for next time
+            if (i % WWRESUME == 0) {
+                job->state[j] << tte;
+                job->count[j] << job->found[j].count();
+            }
 
             // start out at 30 minutes and drop back to
             // 2 minutes, anything shorter and we are done
@@ -1728,7 +1833,7 @@ WorkoutWidget::recompute(bool editing)
 
                         // add 100 or more on second round
                         // quick way of doing overlapping
-                        if ((j && tc >= t) || (!j && tc < t)) efforts << tte;
+                        if ((j && tc >= t) || (!j && tc < t)) job->found[j] << tte;
                     }
 
 
@@ -1745,15 +1850,8 @@ WorkoutWidget::recompute(bool editing)
         }
     }
 
-    // set the properties if not editing
-    if (!editing) {
-        qwkactive = true;
-        parent->code->document()->setPlainText(qwkcode());
-        qwkactive = false;
-    }
-
-    // update scrollbar e.g. when pasting and workout gets longer
-    parent->setScroller(QPointF(minVX_,maxVX_));
+    // both passes
+    job->efforts = job->found[0] + job->found[1];
 }
 
 // as 1m or 60s etc
@@ -36,6 +36,8 @@
 #include <QPainterPath>
 #include <QPropertyAnimation>
 #include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
 
 #include "../qtsolutions/codeeditor/codeeditor.h"
 
@@ -106,6 +108,31 @@ struct WWEffort {
     double quality;
 };
 
+// the tte search state is kept every WWRESUME seconds so it can resume
+// from before the first second that was changed rather than from 0
+#define WWRESUME 60
+
+// W'bal, mean max and TTE efforts for the watts in a workout, these
+// are expensive for long workouts so are computed on a worker thread
+struct WWRecompute {
+
+    // inputs
+    Context *context;
+    QVector<int> watts;
+    int CP, WPRIME, K;
+
+    // results
+    WPrime wpBal;
+    QVector<int> mmp, offsets;
+    QList<WWEffort> efforts;
+
+    // tte search for each pass, what it found and its state
+    // (with how many found by then) every WWRESUME seconds
+    QList<WWEffort> found[2];
+    QVector<WWEffort> state[2];
+    QVector<int> count[2];
+};
+
 class WorkoutWidget : public QWidget
 {
     Q_OBJECT
@@ -116,6 +143,7 @@ class WorkoutWidget : public QWidget
     public:
 
         WorkoutWidget(WorkoutWindow *parent, Context *context);
+        ~WorkoutWidget();
 
         // qwkode string
         QString qwkcode();
@@ -318,6 +346,11 @@ class WorkoutWidget : public QWidget
         int ventilationPlotAvgLength();
         int speedPlotAvgLength();
 
+    private slots:
+
+        // results from the worker are ready
+        void recomputed();
+
     protected:
 
         // interacting with points
@@ -389,6 +422,14 @@ class WorkoutWidget : public QWidget
         // for computing W'bal
         WPrime wpBal;
 
+        // results are computed on a worker, only one at a time and
+        // the latest asked for whilst busy is done when it finishes
+        static void recomputeWorker(WWRecompute *job, const WWRecompute *base);
+        void startRecompute(WWRecompute *job);
+        WWRecompute *computed, *computing, *pending;
+        QFuture<void> future;
+        QFutureWatcher<void> watcher;
+
         // sizing
         double IHEIGHT;         // interval gap at bottom (used for TTE warning)
         double THEIGHT;         // top section height (lap markers)